@@ -20,7 +20,7 @@ from Common import GlobalData
 from Common import EdkLogger
 import Common.LongFilePathOs as os
 
-DATABASE_VERSION = 7
+DATABASE_VERSION = 8
 
 gPcdDatabaseAutoGenC = TemplateString("""
 //
@@ -188,7 +188,8 @@ typedef struct {
   //UINT16                LocalTokenCount;  // LOCAL_TOKEN_NUMBER for all
   //UINT16                ExTokenCount;     // EX_TOKEN_NUMBER for DynamicEx
   //UINT16                GuidTableCount;   // The Number of Guid in GuidTable
-  //UINT8                 Pad[6];
+  //UINT16                ExMapHashBucketCount; // The Number of buckets of the ExMap hash table
+  //TABLE_OFFSET          ExMapHashTableOffset;
   ${PHASE}_PCD_DATABASE_INIT    Init;
   ${PHASE}_PCD_DATABASE_UNINIT  Uninit;
 } ${PHASE}_PCD_DATABASE;
@@ -591,6 +592,78 @@ def GetTokenTypeValue(TokenType):
         }
     return eval(TokenType, TokenTypeDict)
 
+## Hash a DynamicEx Pcd {token space guid: token number} pair
+#
+#   The hash must match PcdExMapHash() in the PEI and DXE Pcd drivers.
+#
+#   @param      GuidBuffer     The token space guid as packed in the Pcd database
+#   @param      ExTokenNumber  The DynamicEx token number
+#   @param      Seed           The seed of the hash
+#
+#   @retval                    A 32-bit hash value
+#
+def PcdExMapHash(GuidBuffer, ExTokenNumber, Seed):
+    Hash = Seed
+    for Word in unpack('<4L', GuidBuffer) + (ExTokenNumber,):
+        Hash = ((Hash ^ Word) * 0x9E3779B1) & 0xFFFFFFFF
+        Hash ^= Hash >> 16
+    Hash ^= Hash >> 13
+    Hash = (Hash * 0x85EBCA6B) & 0xFFFFFFFF
+    Hash ^= Hash >> 16
+    return Hash
+
+## Build the minimal perfect hash table of the ExMap table
+#
+#   The pairs are spread over buckets of about two pairs with seed 0. The buckets
+#   are then placed from the largest to the smallest, each with the first seed
+#   that moves all of its pairs to free slots of a table of one slot per pair.
+#
+#   @param      ExTokenCount  The number of DynamicEx Pcds
+#   @param      ExMapTable    The (ExTokenNumber, TokenNumber, GuidIndex) entries
+#   @param      GuidTable     The Guid table in C structure format
+#
+#   @retval     (BucketCount, Table)  The bucket seeds followed by the ExMap index
+#                                     of each slot, or (0, []) if no seed fits
+#
+def BuildExMapHash(ExTokenCount, ExMapTable, GuidTable):
+    if ExTokenCount == 0:
+        return 0, []
+    BucketCount = (ExTokenCount + 1) // 2
+    Keys = []
+    for (ExTokenNumber, TokenNumber, GuidIndex) in ExMapTable[:ExTokenCount]:
+        GuidString = GuidStructureStringToGuidString(GuidTable[GetIntegerValue(GuidIndex)])
+        Keys.append((bytes(PackGUID(GuidString.split('-'))), GetIntegerValue(ExTokenNumber)))
+    Buckets = [[] for Index in range(BucketCount)]
+    for (Index, Key) in enumerate(Keys):
+        Buckets[PcdExMapHash(Key[0], Key[1], 0) % BucketCount].append(Index)
+
+    Seeds = [0] * BucketCount
+    Slots = [None] * ExTokenCount
+    for Bucket in sorted(range(BucketCount), key=lambda Bucket: -len(Buckets[Bucket])):
+        if not Buckets[Bucket]:
+            break
+        for Seed in range(1, 0x10000):
+            Taken = set()
+            for Index in Buckets[Bucket]:
+                Slot = PcdExMapHash(Keys[Index][0], Keys[Index][1], Seed) % ExTokenCount
+                if Slots[Slot] is not None or Slot in Taken:
+                    break
+                Taken.add(Slot)
+            else:
+                break
+        else:
+            EdkLogger.verbose("No perfect hash found for the %d DynamicEx PCDs" % ExTokenCount)
+            return 0, []
+        Seeds[Bucket] = Seed
+        for Index in Buckets[Bucket]:
+            Slots[PcdExMapHash(Keys[Index][0], Keys[Index][1], Seed) % ExTokenCount] = Index
+
+    Table = Seeds + Slots
+    # Keep the tables after it 4-byte aligned
+    if len(Table) % 2:
+        Table.append(0)
+    return BucketCount, Table
+
 ## construct the external Pcd database using data from Dict
 #
 #   @param      Dict  A dictionary contains Pcd related tables
@@ -611,6 +684,8 @@ def BuildExDataBase(Dict):
     DbVpdHeadValue = DbComItemList(4, RawDataList = VpdHeadValue)
     ExMapTable = list(zip(Dict['EXMAPPING_TABLE_EXTOKEN'], Dict['EXMAPPING_TABLE_LOCAL_TOKEN'], Dict['EXMAPPING_TABLE_GUID_INDEX']))
     DbExMapTable = DbExMapTblItemList(8, RawDataList = ExMapTable)
+    ExMapHashBucketCount, ExMapHashTable = BuildExMapHash(GetIntegerValue(Dict['EX_TOKEN_NUMBER']), ExMapTable, Dict['GUID_STRUCTURE'])
+    DbExMapHashTable = DbItemList(2, RawDataList = ExMapHashTable)
     LocalTokenNumberTable = Dict['LOCAL_TOKEN_NUMBER_DB_VALUE']
     DbLocalTokenNumberTable = DbItemList(4, RawDataList = LocalTokenNumberTable)
     GuidTable = Dict['GUID_STRUCTURE']
@@ -675,23 +750,23 @@ def BuildExDataBase(Dict):
     DbUnInitValueBoolean = DbItemList(1, RawDataList = UnInitValueBoolean)
     PcdTokenNumberMap = Dict['PCD_ORDER_TOKEN_NUMBER_MAP']
 
-    DbNameTotle = ["SkuidValue",  "InitValueUint64", "VardefValueUint64", "InitValueUint32", "VardefValueUint32", "VpdHeadValue", "ExMapTable",
+    DbNameTotle = ["SkuidValue",  "InitValueUint64", "VardefValueUint64", "InitValueUint32", "VardefValueUint32", "VpdHeadValue", "ExMapTable", "ExMapHashTable",
                "LocalTokenNumberTable", "GuidTable", "StringHeadValue",  "PcdNameOffsetTable", "VariableTable", "StringTableLen", "PcdTokenTable", "PcdCNameTable",
                "SizeTableValue", "InitValueUint16", "VardefValueUint16", "InitValueUint8", "VardefValueUint8", "InitValueBoolean",
                "VardefValueBoolean", "UnInitValueUint64", "UnInitValueUint32", "UnInitValueUint16", "UnInitValueUint8", "UnInitValueBoolean"]
 
-    DbTotal = [SkuidValue,  InitValueUint64, VardefValueUint64, InitValueUint32, VardefValueUint32, VpdHeadValue, ExMapTable,
+    DbTotal = [SkuidValue,  InitValueUint64, VardefValueUint64, InitValueUint32, VardefValueUint32, VpdHeadValue, ExMapTable, ExMapHashTable,
                LocalTokenNumberTable, GuidTable, StringHeadValue,  PcdNameOffsetTable, VariableTable, StringTableLen, PcdTokenTable, PcdCNameTable,
                SizeTableValue, InitValueUint16, VardefValueUint16, InitValueUint8, VardefValueUint8, InitValueBoolean,
                VardefValueBoolean, UnInitValueUint64, UnInitValueUint32, UnInitValueUint16, UnInitValueUint8, UnInitValueBoolean]
-    DbItemTotal = [DbSkuidValue,  DbInitValueUint64, DbVardefValueUint64, DbInitValueUint32, DbVardefValueUint32, DbVpdHeadValue, DbExMapTable,
+    DbItemTotal = [DbSkuidValue,  DbInitValueUint64, DbVardefValueUint64, DbInitValueUint32, DbVardefValueUint32, DbVpdHeadValue, DbExMapTable, DbExMapHashTable,
                DbLocalTokenNumberTable, DbGuidTable, DbStringHeadValue,  DbPcdNameOffsetTable, DbVariableTable, DbStringTableLen, DbPcdTokenTable, DbPcdCNameTable,
                DbSizeTableValue, DbInitValueUint16, DbVardefValueUint16, DbInitValueUint8, DbVardefValueUint8, DbInitValueBoolean,
                DbVardefValueBoolean, DbUnInitValueUint64, DbUnInitValueUint32, DbUnInitValueUint16, DbUnInitValueUint8, DbUnInitValueBoolean]
 
     # VardefValueBoolean is the last table in the init table items
     InitTableNum = DbNameTotle.index("VardefValueBoolean") + 1
-    # The FixedHeader length of the PCD_DATABASE_INIT, from Signature to Pad
+    # The FixedHeader length of the PCD_DATABASE_INIT, from Signature to ExMapHashTableOffset
     FixedHeaderLen = 80
 
     # Get offset of SkuId table in the database
@@ -759,6 +834,8 @@ def BuildExDataBase(Dict):
             LocalTokenNumberTableOffset = DbTotalLength
         elif DbItemTotal[DbIndex] is DbExMapTable:
             ExMapTableOffset = DbTotalLength
+        elif DbItemTotal[DbIndex] is DbExMapHashTable:
+            ExMapHashTableOffset = DbTotalLength
         elif DbItemTotal[DbIndex] is DbGuidTable:
             GuidTableOffset = DbTotalLength
         elif DbItemTotal[DbIndex] is DbStringTableLen:
@@ -774,6 +851,8 @@ def BuildExDataBase(Dict):
         DbTotalLength += DbItemTotal[DbIndex].GetListSize()
     if not Dict['PCD_INFO_FLAG']:
         DbPcdNameOffset  = 0
+    if not ExMapHashBucketCount:
+        ExMapHashTableOffset = 0
     LocalTokenCount = GetIntegerValue(Dict['LOCAL_TOKEN_NUMBER'])
     ExTokenCount = GetIntegerValue(Dict['EX_TOKEN_NUMBER'])
     GuidTableCount = GetIntegerValue(Dict['GUID_TABLE_SIZE'])
@@ -836,12 +915,11 @@ def BuildExDataBase(Dict):
     b = pack('=H', GuidTableCount)
 
     Buffer += b
-    b = pack('=B', Pad)
-    Buffer += b
-    Buffer += b
-    Buffer += b
-    Buffer += b
+    b = pack('=H', ExMapHashBucketCount)
+
     Buffer += b
+    b = pack('=L', ExMapHashTableOffset)
+
     Buffer += b
 
     Index = 0
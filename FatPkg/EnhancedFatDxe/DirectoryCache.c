@@ -1,6 +1,10 @@
 /** @file
   Functions for directory cache operation.
 
+  The volume keeps the directories of closed OFiles in a LRU list. The list is
+  bounded by the memory the directories use rather than by their count, so
+  that many small directories or a few large ones can be cached.
+
 Copyright (c) 2005, Intel Corporation. All rights reserved.<BR>
 SPDX-License-Identifier: BSD-2-Clause-Patent
 
@@ -37,6 +41,7 @@ FatFreeODir (
     FatFreeDirEnt (DirEnt);
   }
 
+  FatFreeHashTable (ODir);
   FreePool (ODir);
 }
 
@@ -63,6 +68,10 @@ FatAllocateODir (
     ODir->Signature = FAT_ODIR_SIGNATURE;
     InitializeListHead (&ODir->ChildList);
     ODir->CurrentCursor = &ODir->ChildList;
+    if (EFI_ERROR (FatCreateHashTable (ODir))) {
+      FreePool (ODir);
+      ODir = NULL;
+    }
   }
 
   return ODir;
@@ -91,29 +100,31 @@ FatDiscardODir (
     // If OFile does not represent a deleted file, then we will cache the directory
     // We use OFile's first cluster as the directory's tag
     //
-    ODir->DirCacheTag = OFile->FileCluster;
+    ODir->DirCacheTag      = OFile->FileCluster;
+    ODir->DirCacheFileSize = OFile->FileSize;
+    ODir->DirCacheSize     = sizeof (FAT_ODIR) + 2 * ODir->HashTableSize * sizeof (FAT_DIRENT *) + ODir->DirEntSize;
     InsertHeadList (&Volume->DirCacheList, &ODir->DirCacheLink);
-    if (Volume->DirCacheCount == FAT_MAX_DIR_CACHE_COUNT) {
-      //
-      // Replace the least recent used directory
-      //
+    Volume->DirCacheCount++;
+    Volume->DirCacheSize += ODir->DirCacheSize;
+    //
+    // Replace the least recent used directories until the cache fits in its
+    // memory budget. A directory larger than the budget is not kept either.
+    //
+    while (Volume->DirCacheSize > FAT_MAX_DIR_CACHE_SIZE) {
       ODir = ODIR_FROM_DIRCACHELINK (Volume->DirCacheList.BackLink);
       RemoveEntryList (&ODir->DirCacheLink);
-    } else {
-      //
-      // No need to find a replace
-      //
-      Volume->DirCacheCount++;
-      ODir = NULL;
+      Volume->DirCacheCount--;
+      Volume->DirCacheSize -= ODir->DirCacheSize;
+      FatFreeODir (ODir);
     }
+
+    return;
   }
 
   //
   // Release ODir Structure
   //
-  if (ODir != NULL) {
-    FatFreeODir (ODir);
-  }
+  FatFreeODir (ODir);
 }
 
 /**
@@ -149,7 +160,8 @@ FatRequestODir (
     if (CurrentODir->DirCacheTag == DirCacheTag) {
       RemoveEntryList (&CurrentODir->DirCacheLink);
       Volume->DirCacheCount--;
-      ODir = CurrentODir;
+      Volume->DirCacheSize -= CurrentODir->DirCacheSize;
+      ODir                  = CurrentODir;
       break;
     }
   }
@@ -181,6 +193,7 @@ FatCleanupODirCache (
   while (Volume->DirCacheCount > 0) {
     ODir = ODIR_FROM_DIRCACHELINK (Volume->DirCacheList.BackLink);
     RemoveEntryList (&ODir->DirCacheLink);
+    Volume->DirCacheSize -= ODir->DirCacheSize;
     FatFreeODir (ODir);
     Volume->DirCacheCount--;
   }
@@ -1181,22 +1181,27 @@ FatOpenDirEnt (
       }
     }
 
-    OFile->FileCurrentCluster = OFile->FileCluster;
-    OFile->Volume             = Volume;
+    OFile->Volume = Volume;
     InsertHeadList (&Volume->CheckRef, &OFile->CheckLink);
 
     OFile->FileSize = DirEnt->Entry.FileSize;
     if ((DirEnt->Entry.Attributes & FAT_ATTRIBUTE_DIRECTORY) != 0) {
+      FatRequestODir (OFile);
+      if (OFile->ODir == NULL) {
+        return EFI_OUT_OF_RESOURCES;
+      }
+
       if (OFile->IsFixedRootDir) {
         OFile->FileSize = Volume->RootEntries * sizeof (FAT_DIRECTORY_ENTRY);
+      } else if (OFile->ODir->DirCacheFileSize != 0) {
+        //
+        // The directory comes from the directory cache, which saves running
+        // its cluster chain again
+        //
+        OFile->FileSize = OFile->ODir->DirCacheFileSize;
       } else {
         OFile->FileSize = FatPhysicalDirSize (Volume, OFile->FileCluster);
       }
-
-      FatRequestODir (OFile);
-      if (OFile->ODir == NULL) {
-        return EFI_OUT_OF_RESOURCES;
-      }
     }
 
     DirEnt->OFile = OFile;
@@ -1228,6 +1233,10 @@ FatCloseDirEnt (
     FatDiscardODir (OFile);
   }
 
+  if (OFile->Extents != NULL) {
+    FreePool (OFile->Extents);
+  }
+
   if (OFile->Parent == NULL) {
     Volume->Root = NULL;
   } else {
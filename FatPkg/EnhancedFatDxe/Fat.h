@@ -103,8 +103,18 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #define LC_ISO_639_2_ENTRY_SIZE  3
 #define MAX_LANG_CODE_SIZE       100
 
-#define FAT_MAX_DIR_CACHE_COUNT  8
-#define FAT_MAX_DIRENTRY_COUNT   0xFFFF
+//
+// Memory used by the directories cached by a volume, beyond which the least
+// recently used directories are freed
+//
+#define FAT_MAX_DIR_CACHE_SIZE  SIZE_4MB
+#define FAT_MAX_DIRENTRY_COUNT  0xFFFF
+
+//
+// Count of the extents a file first allocates room for, the room doubles
+// whenever it is full
+//
+#define FAT_MIN_EXTENT_COUNT  0x10
 typedef CHAR8 LC_ISO_639_2;
 
 //
@@ -159,10 +169,11 @@ typedef struct {
 } DISK_CACHE;
 
 //
-// Hash table size
+// Hash table size of a directory, which doubles whenever the directory has
+// more entries than buckets
 //
-#define HASH_TABLE_SIZE  0x400
-#define HASH_TABLE_MASK  (HASH_TABLE_SIZE - 1)
+#define FAT_HASH_TABLE_MIN_SIZE  0x10
+#define FAT_HASH_TABLE_MAX_SIZE  0x10000
 
 //
 // The directory entry for opened directory
@@ -182,6 +193,8 @@ struct _FAT_DIRENT {
   FAT_OFILE              *OFile;                // The OFile of the corresponding directory entry
   FAT_DIRENT             *ShortNameForwardLink; // Hash successor link for short filename
   FAT_DIRENT             *LongNameForwardLink;  // Hash successor link for long filename
+  UINT32                 ShortNameHash;         // Hash value of short filename
+  UINT32                 LongNameHash;          // Hash value of long filename
   LIST_ENTRY             Link;                  // Connection of every directory entry
   FAT_DIRECTORY_ENTRY    Entry;                 // The physical directory entry stored in disk
 };
@@ -195,8 +208,13 @@ struct _FAT_ODIR {
   BOOLEAN       EndOfDir;                     // Indicate whether we have reached the end of the directory
   LIST_ENTRY    DirCacheLink;                 // Linked in Volume->DirCacheList when discarded
   UINTN         DirCacheTag;                  // The identification of the directory when in directory cache
-  FAT_DIRENT    *LongNameHashTable[HASH_TABLE_SIZE];
-  FAT_DIRENT    *ShortNameHashTable[HASH_TABLE_SIZE];
+  UINTN         DirCacheSize;                 // The memory used by the directory when in directory cache
+  UINTN         DirCacheFileSize;             // The physical size of the directory when in directory cache
+  UINTN         DirEntCount;                  // The count of the directory entries in the hash tables
+  UINTN         DirEntSize;                   // The memory used by the directory entries in the hash tables
+  UINTN         HashTableSize;                // The bucket count of each hash table, a power of 2
+  FAT_DIRENT    **LongNameHashTable;
+  FAT_DIRENT    **ShortNameHashTable;
 };
 
 typedef struct {
@@ -228,6 +246,15 @@ typedef struct {
   LIST_ENTRY            Link;
 } FAT_SUBTASK;
 
+//
+// FAT_EXTENT - A run of clusters of a file that are contiguous on the disk
+//
+typedef struct {
+  UINTN    FileCluster;                         // Index of the first cluster of the run in the file
+  UINTN    DiskCluster;                         // The first cluster of the run on the disk
+  UINTN    ClusterCount;                        // Count of the clusters in the run
+} FAT_EXTENT;
+
 //
 // FAT_OFILE - Each opened file
 //
@@ -249,9 +276,18 @@ struct _FAT_OFILE {
   //
   UINTN         FileSize;
   UINTN         FileCluster;
-  UINTN         FileCurrentCluster;
   UINTN         FileLastCluster;
 
+  //
+  // The extents map the cluster chain of the file from its start.
+  // They are built as the file is accessed and extended as it grows,
+  // so that the chain is only run once.
+  //
+  FAT_EXTENT    *Extents;
+  UINTN         ExtentCount;
+  UINTN         ExtentMaxCount;
+  UINTN         ExtentClusters;   // count of the clusters mapped
+
   //
   // Dirty is set if there have been any updates to the
   // file
@@ -267,7 +303,6 @@ struct _FAT_OFILE {
   //
   // Set by an OFile SetPosition
   //
-  UINTN         Position;       // within file
   UINT64        PosDisk;        // on the disk
   UINTN         PosRem;         // remaining in this disk run
   //
@@ -368,6 +403,7 @@ struct _FAT_VOLUME {
   //
   LIST_ENTRY                         DirCacheList;
   UINTN                              DirCacheCount;
+  UINTN                              DirCacheSize;
 
   //
   // Disk Cache for this volume
@@ -939,6 +975,7 @@ FatPhysicalFileSize (
 
   @retval EFI_SUCCESS           - Set the info successfully.
   @retval EFI_VOLUME_CORRUPTED  - Cluster chain corrupt.
+  @retval EFI_OUT_OF_RESOURCES  - There is no memory to map the cluster chain.
 
 **/
 EFI_STATUS
@@ -1768,6 +1805,33 @@ FatSetVolumeEntry (
 // Hash.c
 //
 
+/**
+
+  Allocate the hash tables of a directory with the minimum size.
+
+  @param  ODir                  - The directory.
+
+  @retval EFI_SUCCESS           - The hash tables are allocated.
+  @retval EFI_OUT_OF_RESOURCES  - Can not allocate the memory.
+
+**/
+EFI_STATUS
+FatCreateHashTable (
+  IN FAT_ODIR  *ODir
+  );
+
+/**
+
+  Free the hash tables of a directory.
+
+  @param  ODir                  - The directory.
+
+**/
+VOID
+FatFreeHashTable (
+  IN FAT_ODIR  *ODir
+  );
+
 /**
 
   Search the long name hash table for the directory entry.
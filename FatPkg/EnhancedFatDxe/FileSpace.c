@@ -341,6 +341,91 @@ FatSizeToClusters (
   return Clusters;
 }
 
+/**
+
+  Map the cluster that follows the mapped clusters of the open file, extending
+  the last extent if the cluster follows it on the disk.
+
+  @param  OFile                 - The open file.
+  @param  Cluster               - The cluster that follows the mapped clusters in the file.
+
+  @retval EFI_SUCCESS           - The cluster is mapped.
+  @retval EFI_OUT_OF_RESOURCES  - There is no memory to add an extent.
+
+**/
+STATIC
+EFI_STATUS
+FatAppendExtent (
+  IN FAT_OFILE  *OFile,
+  IN UINTN      Cluster
+  )
+{
+  FAT_EXTENT  *Extent;
+  FAT_EXTENT  *Extents;
+  UINTN       MaxCount;
+
+  if (OFile->ExtentCount != 0) {
+    Extent = &OFile->Extents[OFile->ExtentCount - 1];
+    if (Extent->DiskCluster + Extent->ClusterCount == Cluster) {
+      Extent->ClusterCount  += 1;
+      OFile->ExtentClusters += 1;
+      return EFI_SUCCESS;
+    }
+  }
+
+  if (OFile->ExtentCount == OFile->ExtentMaxCount) {
+    MaxCount = MAX (OFile->ExtentMaxCount * 2, FAT_MIN_EXTENT_COUNT);
+    Extents  = ReallocatePool (
+                 OFile->ExtentMaxCount * sizeof (FAT_EXTENT),
+                 MaxCount * sizeof (FAT_EXTENT),
+                 OFile->Extents
+                 );
+    if (Extents == NULL) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+
+    OFile->Extents        = Extents;
+    OFile->ExtentMaxCount = MaxCount;
+  }
+
+  Extent                = &OFile->Extents[OFile->ExtentCount];
+  Extent->FileCluster   = OFile->ExtentClusters;
+  Extent->DiskCluster   = Cluster;
+  Extent->ClusterCount  = 1;
+  OFile->ExtentCount   += 1;
+  OFile->ExtentClusters = Extent->FileCluster + 1;
+  return EFI_SUCCESS;
+}
+
+/**
+
+  Drop the clusters of the open file beyond the given count from its extents.
+
+  @param  OFile                 - The open file.
+  @param  ClusterCount          - The count of the clusters left in the file.
+
+**/
+STATIC
+VOID
+FatTruncateExtents (
+  IN FAT_OFILE  *OFile,
+  IN UINTN      ClusterCount
+  )
+{
+  FAT_EXTENT  *Extent;
+
+  while (OFile->ExtentClusters > ClusterCount) {
+    Extent = &OFile->Extents[OFile->ExtentCount - 1];
+    if (Extent->FileCluster >= ClusterCount) {
+      OFile->ExtentClusters = Extent->FileCluster;
+      OFile->ExtentCount   -= 1;
+    } else {
+      Extent->ClusterCount  = ClusterCount - Extent->FileCluster;
+      OFile->ExtentClusters = ClusterCount;
+    }
+  }
+}
+
 /**
 
   Shrink the end of the open file base on the file size.
@@ -400,12 +485,11 @@ FatShrinkEof (
   }
 
   //
-  // Set CurrentCluster == FileCluster
-  // to force a recalculation of Position related stuffs
+  // The freed clusters must not be mapped any more
   //
-  OFile->FileCurrentCluster = OFile->FileCluster;
-  OFile->FileLastCluster    = LastCluster;
-  OFile->Dirty              = TRUE;
+  FatTruncateExtents (OFile, NewSize);
+  OFile->FileLastCluster = LastCluster;
+  OFile->Dirty           = TRUE;
   //
   // Free the remaining cluster chain
   //
@@ -513,8 +597,15 @@ FatGrowEof (
       if (LastCluster != 0) {
         FatSetFatEntry (Volume, LastCluster, NewCluster);
       } else {
-        OFile->FileCluster        = NewCluster;
-        OFile->FileCurrentCluster = NewCluster;
+        OFile->FileCluster = NewCluster;
+      }
+
+      //
+      // If the whole file is mapped, keep it so. Otherwise the new cluster is
+      // mapped when the file is accessed there.
+      //
+      if (OFile->ExtentClusters == CurSize) {
+        FatAppendExtent (OFile, NewCluster);
       }
 
       LastCluster = NewCluster;
@@ -545,6 +636,58 @@ Done:
   return Status;
 }
 
+/**
+
+  Run the cluster chain of the open file on from its mapped clusters, until the
+  extents map the cluster at the given index of the file.
+
+  @param  OFile                 - The open file.
+  @param  ClusterIndex          - Index of the cluster in the file to map.
+
+  @retval EFI_SUCCESS           - The cluster is mapped.
+  @retval EFI_VOLUME_CORRUPTED  - Cluster chain corrupt.
+  @retval EFI_OUT_OF_RESOURCES  - There is no memory to add an extent.
+
+**/
+STATIC
+EFI_STATUS
+FatMapExtents (
+  IN FAT_OFILE  *OFile,
+  IN UINTN      ClusterIndex
+  )
+{
+  FAT_VOLUME  *Volume;
+  FAT_EXTENT  *Extent;
+  EFI_STATUS  Status;
+  UINTN       Cluster;
+
+  Volume = OFile->Volume;
+  if (OFile->ExtentCount == 0) {
+    Cluster = OFile->FileCluster;
+  } else {
+    Extent  = &OFile->Extents[OFile->ExtentCount - 1];
+    Cluster = FatGetFatEntry (Volume, Extent->DiskCluster + Extent->ClusterCount - 1);
+  }
+
+  for ( ; ;) {
+    if ((Cluster < FAT_MIN_CLUSTER) || (Cluster > Volume->MaxCluster + 1)) {
+      DEBUG ((DEBUG_INIT | DEBUG_ERROR, "FatOFilePosition:" " cluster chain corrupt\n"));
+      return EFI_VOLUME_CORRUPTED;
+    }
+
+    Status = FatAppendExtent (OFile, Cluster);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+
+    if (OFile->ExtentClusters > ClusterIndex) {
+      return EFI_SUCCESS;
+    }
+
+    Cluster = FatGetFatEntry (Volume, Cluster);
+  }
+}
+
 /**
 
   Seek OFile to requested position, and calculate the number of
@@ -556,6 +699,7 @@ Done:
 
   @retval EFI_SUCCESS           - Set the info successfully.
   @retval EFI_VOLUME_CORRUPTED  - Cluster chain corrupt.
+  @retval EFI_OUT_OF_RESOURCES  - There is no memory to map the cluster chain.
 
 **/
 EFI_STATUS
@@ -566,13 +710,17 @@ FatOFilePosition (
   )
 {
   FAT_VOLUME  *Volume;
-  UINTN       ClusterSize;
-  UINTN       Cluster;
-  UINTN       StartPos;
-  UINTN       Run;
+  FAT_EXTENT  *Extent;
+  EFI_STATUS  Status;
+  UINTN       ClusterIndex;
+  UINTN       LastIndex;
+  UINTN       Offset;
+  UINTN       Low;
+  UINTN       High;
+  UINTN       Middle;
+  UINT64      Run;
 
-  Volume      = OFile->Volume;
-  ClusterSize = Volume->ClusterSize;
+  Volume = OFile->Volume;
 
   ASSERT_VOLUME_LOCKED (Volume);
 
@@ -585,57 +733,53 @@ FatOFilePosition (
     Run            = OFile->FileSize - Position;
   } else {
     //
-    // Run the file's cluster chain to find the current position
-    // If possible, run from the current cluster rather than
-    // start from beginning
-    // Assumption: OFile->Position is always consistent with
-    // OFile->FileCurrentCluster.
-    // OFile->Position is not modified outside this function;
-    // OFile->FileCurrentCluster is modified outside this function
-    // to be the same as OFile->FileCluster
-    // when OFile->FileCluster is updated, so make a check of this
-    // and invalidate the original OFile->Position in this case
+    // Map the file's cluster chain up to the last cluster that may be
+    // accessed, so that a run of consecutive clusters is found in one
+    // extent. The chain is only run the first time a cluster is accessed.
     //
-    Cluster  = OFile->FileCurrentCluster;
-    StartPos = OFile->Position;
-    if ((Position < StartPos) || (OFile->FileCluster == Cluster)) {
-      StartPos = 0;
-      Cluster  = OFile->FileCluster;
+    ClusterIndex = Position >> Volume->ClusterAlignment;
+    Offset       = Position & (Volume->ClusterSize - 1);
+    LastIndex    = ClusterIndex;
+    if ((Position < OFile->FileSize) && (PosLimit > 0)) {
+      LastIndex = (Position + MIN (PosLimit, OFile->FileSize - Position) - 1) >> Volume->ClusterAlignment;
     }
 
-    while (StartPos + ClusterSize <= Position) {
-      StartPos += ClusterSize;
-      if ((Cluster == FAT_CLUSTER_FREE) || (Cluster >= FAT_CLUSTER_SPECIAL)) {
-        DEBUG ((DEBUG_INIT | DEBUG_ERROR, "FatOFilePosition:" " cluster chain corrupt\n"));
-        return EFI_VOLUME_CORRUPTED;
+    if (OFile->ExtentClusters <= LastIndex) {
+      Status = FatMapExtents (OFile, LastIndex);
+      if (EFI_ERROR (Status)) {
+        return Status;
       }
-
-      Cluster = FatGetFatEntry (Volume, Cluster);
     }
 
-    if ((Cluster < FAT_MIN_CLUSTER) || (Cluster > Volume->MaxCluster + 1)) {
-      return EFI_VOLUME_CORRUPTED;
+    //
+    // Find the extent of the position
+    //
+    Low  = 0;
+    High = OFile->ExtentCount - 1;
+    while (Low < High) {
+      Middle = (Low + High + 1) / 2;
+      if (OFile->Extents[Middle].FileCluster > ClusterIndex) {
+        High = Middle - 1;
+      } else {
+        Low = Middle;
+      }
     }
 
+    Extent         = &OFile->Extents[Low];
     OFile->PosDisk = Volume->FirstClusterPos +
-                     LShiftU64 (Cluster - FAT_MIN_CLUSTER, Volume->ClusterAlignment) +
-                     Position - StartPos;
-    OFile->FileCurrentCluster = Cluster;
-    OFile->Position           = StartPos;
+                     LShiftU64 (Extent->DiskCluster + ClusterIndex - Extent->FileCluster - FAT_MIN_CLUSTER, Volume->ClusterAlignment) +
+                     Offset;
 
     //
-    // Compute the number of consecutive clusters in the file
+    // The rest of the extent is consecutive on the disk
     //
-    Run = StartPos + ClusterSize - Position;
-    if (!FAT_END_OF_FAT_CHAIN (Cluster)) {
-      while ((FatGetFatEntry (Volume, Cluster) == Cluster + 1) && Run < PosLimit) {
-        Run     += ClusterSize;
-        Cluster += 1;
-      }
+    Run = LShiftU64 (Extent->FileCluster + Extent->ClusterCount - ClusterIndex, Volume->ClusterAlignment) - Offset;
+    if (Run > MAX_UINTN) {
+      Run = MAX_UINTN;
     }
   }
 
-  OFile->PosRem = Run;
+  OFile->PosRem = (UINTN)Run;
   return EFI_SUCCESS;
 }
 
@@ -1,6 +1,10 @@
 /** @file
   Hash table operations.
 
+  The hash tables of a directory start small and double whenever the directory
+  has more entries than buckets, so that the chains stay short in directories
+  with thousands of files without wasting memory in small ones.
+
 Copyright (c) 2005 - 2015, Intel Corporation. All rights reserved.<BR>
 SPDX-License-Identifier: BSD-2-Clause-Patent
 
@@ -34,7 +38,7 @@ FatHashLongName (
     );
   FatStrUpr (UpCasedLongFileName);
   gBS->CalculateCrc32 (UpCasedLongFileName, StrSize (UpCasedLongFileName), &HashValue);
-  return (HashValue & HASH_TABLE_MASK);
+  return HashValue;
 }
 
 /**
@@ -55,7 +59,106 @@ FatHashShortName (
   UINT32  HashValue;
 
   gBS->CalculateCrc32 (ShortNameString, FAT_NAME_LEN, &HashValue);
-  return (HashValue & HASH_TABLE_MASK);
+  return HashValue;
+}
+
+/**
+
+  Allocate the hash tables of a directory with the minimum size.
+
+  @param  ODir                  - The directory.
+
+  @retval EFI_SUCCESS           - The hash tables are allocated.
+  @retval EFI_OUT_OF_RESOURCES  - Can not allocate the memory.
+
+**/
+EFI_STATUS
+FatCreateHashTable (
+  IN FAT_ODIR  *ODir
+  )
+{
+  //
+  // Both tables share one allocation, the short name table follows the long name table
+  //
+  ODir->LongNameHashTable = AllocateZeroPool (2 * FAT_HASH_TABLE_MIN_SIZE * sizeof (FAT_DIRENT *));
+  if (ODir->LongNameHashTable == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  ODir->ShortNameHashTable = ODir->LongNameHashTable + FAT_HASH_TABLE_MIN_SIZE;
+  ODir->HashTableSize      = FAT_HASH_TABLE_MIN_SIZE;
+  return EFI_SUCCESS;
+}
+
+/**
+
+  Free the hash tables of a directory.
+
+  @param  ODir                  - The directory.
+
+**/
+VOID
+FatFreeHashTable (
+  IN FAT_ODIR  *ODir
+  )
+{
+  if (ODir->LongNameHashTable != NULL) {
+    FreePool (ODir->LongNameHashTable);
+    ODir->LongNameHashTable  = NULL;
+    ODir->ShortNameHashTable = NULL;
+  }
+}
+
+/**
+
+  Double the size of the hash tables of a directory and move the directory
+  entries to the new buckets. The tables are left as they are if the memory
+  can not be allocated, which only makes the chains longer.
+
+  @param  ODir                  - The directory.
+
+**/
+STATIC
+VOID
+FatGrowHashTable (
+  IN FAT_ODIR  *ODir
+  )
+{
+  FAT_DIRENT  **LongNameHashTable;
+  FAT_DIRENT  **ShortNameHashTable;
+  FAT_DIRENT  *DirEnt;
+  FAT_DIRENT  *NextDirEnt;
+  UINTN       HashTableSize;
+  UINTN       HashTableIndex;
+  UINTN       Index;
+
+  HashTableSize     = ODir->HashTableSize * 2;
+  LongNameHashTable = AllocateZeroPool (2 * HashTableSize * sizeof (FAT_DIRENT *));
+  if (LongNameHashTable == NULL) {
+    return;
+  }
+
+  ShortNameHashTable = LongNameHashTable + HashTableSize;
+  for (Index = 0; Index < ODir->HashTableSize; Index++) {
+    for (DirEnt = ODir->ShortNameHashTable[Index]; DirEnt != NULL; DirEnt = NextDirEnt) {
+      NextDirEnt                         = DirEnt->ShortNameForwardLink;
+      HashTableIndex                     = DirEnt->ShortNameHash & (HashTableSize - 1);
+      DirEnt->ShortNameForwardLink       = ShortNameHashTable[HashTableIndex];
+      ShortNameHashTable[HashTableIndex] = DirEnt;
+    }
+
+    for (DirEnt = ODir->LongNameHashTable[Index]; DirEnt != NULL; DirEnt = NextDirEnt) {
+      NextDirEnt                        = DirEnt->LongNameForwardLink;
+      HashTableIndex                    = DirEnt->LongNameHash & (HashTableSize - 1);
+      DirEnt->LongNameForwardLink       = LongNameHashTable[HashTableIndex];
+      LongNameHashTable[HashTableIndex] = DirEnt;
+    }
+  }
+
+  FreePool (ODir->LongNameHashTable);
+  ODir->LongNameHashTable  = LongNameHashTable;
+  ODir->ShortNameHashTable = ShortNameHashTable;
+  ODir->HashTableSize      = HashTableSize;
 }
 
 /**
@@ -76,7 +179,7 @@ FatLongNameHashSearch (
 {
   FAT_DIRENT  **PreviousHashNode;
 
-  for (PreviousHashNode   = &ODir->LongNameHashTable[FatHashLongName (LongNameString)];
+  for (PreviousHashNode   = &ODir->LongNameHashTable[FatHashLongName (LongNameString) & (ODir->HashTableSize - 1)];
        *PreviousHashNode != NULL;
        PreviousHashNode   = &(*PreviousHashNode)->LongNameForwardLink
        )
@@ -107,7 +210,7 @@ FatShortNameHashSearch (
 {
   FAT_DIRENT  **PreviousHashNode;
 
-  for (PreviousHashNode   = &ODir->ShortNameHashTable[FatHashShortName (ShortNameString)];
+  for (PreviousHashNode   = &ODir->ShortNameHashTable[FatHashShortName (ShortNameString) & (ODir->HashTableSize - 1)];
        *PreviousHashNode != NULL;
        PreviousHashNode   = &(*PreviousHashNode)->ShortNameForwardLink
        )
@@ -135,22 +238,30 @@ FatInsertToHashTable (
   )
 {
   FAT_DIRENT  **HashTable;
-  UINT32      HashTableIndex;
+  UINTN       HashTableIndex;
 
   //
   // Insert hash table index for short name
   //
-  HashTableIndex               = FatHashShortName (DirEnt->Entry.FileName);
+  DirEnt->ShortNameHash        = FatHashShortName (DirEnt->Entry.FileName);
+  HashTableIndex               = DirEnt->ShortNameHash & (ODir->HashTableSize - 1);
   HashTable                    = ODir->ShortNameHashTable;
   DirEnt->ShortNameForwardLink = HashTable[HashTableIndex];
   HashTable[HashTableIndex]    = DirEnt;
   //
   // Insert hash table index for long name
   //
-  HashTableIndex              = FatHashLongName (DirEnt->FileString);
+  DirEnt->LongNameHash        = FatHashLongName (DirEnt->FileString);
+  HashTableIndex              = DirEnt->LongNameHash & (ODir->HashTableSize - 1);
   HashTable                   = ODir->LongNameHashTable;
   DirEnt->LongNameForwardLink = HashTable[HashTableIndex];
   HashTable[HashTableIndex]   = DirEnt;
+
+  ODir->DirEntCount++;
+  ODir->DirEntSize += sizeof (FAT_DIRENT) + StrSize (DirEnt->FileString);
+  if ((ODir->DirEntCount > ODir->HashTableSize) && (ODir->HashTableSize < FAT_HASH_TABLE_MAX_SIZE)) {
+    FatGrowHashTable (ODir);
+  }
 }
 
 /**
@@ -169,4 +280,7 @@ FatDeleteFromHashTable (
 {
   *FatShortNameHashSearch (ODir, DirEnt->Entry.FileName) = DirEnt->ShortNameForwardLink;
   *FatLongNameHashSearch (ODir, DirEnt->FileString)      = DirEnt->LongNameForwardLink;
+
+  ODir->DirEntCount--;
+  ODir->DirEntSize -= sizeof (FAT_DIRENT) + StrSize (DirEnt->FileString);
 }
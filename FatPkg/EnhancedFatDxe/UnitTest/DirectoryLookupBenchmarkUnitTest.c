@@ -0,0 +1,695 @@
+/** @file
+  This is a host-based benchmark of file name lookups in the FAT driver.
+
+  The FAT driver mounts a FAT16 image that is synthesized in memory. The image
+  holds a number of directories in its root directory, and every directory
+  holds files with long names, like an ESP full of drivers and firmware
+  updates. The benchmark opens and closes every file by its path, visiting the
+  directories in turn, so that every lookup goes through the cache of closed
+  directories and the hash tables of a directory. It reports the lookups per
+  second, the worst case latency of a lookup and the disk reads, and fails if a
+  lookup fails or, for the scenarios whose directories fit in the directory
+  cache, if a directory is dropped from the cache.
+
+  The scenarios in mBenchmarkConfig run by default. A custom scenario can be
+  given on the command line:
+
+    DirectoryLookupBenchmarkUnitTest [-d DirectoryCount] [-n FilesPerDirectory]
+                                     [-p Passes] [-m MinOpsPerSecond]
+
+  -m fails any benchmark that runs fewer lookups per second than given.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include <Library/UnitTestLib.h>
+
+#include "FatBenchmarkHarness.h"
+
+/// === TEST DATA ==================================================================================
+
+#define BENCHMARK_RESERVED_SECTORS     1
+#define BENCHMARK_ROOT_ENTRIES         512
+#define BENCHMARK_MIN_CLUSTERS         (FAT_MAX_FAT12_CLUSTER + 0x100)
+#define BENCHMARK_MAX_DIRECTORIES      (BENCHMARK_ROOT_ENTRIES - 1)
+#define BENCHMARK_MAX_PATH_LENGTH      64
+#define BENCHMARK_FILE_NAME_PREFIX     L"FirmwareUpdate-"
+#define BENCHMARK_FILE_NAME_SUFFIX     L".efi"
+//
+// Stride through the files of a directory, a prime so that every file is
+// visited once per pass unless the file count is a multiple of it
+//
+#define BENCHMARK_LOOKUP_STRIDE  7919
+
+typedef struct {
+  CHAR8      *Name;
+  UINTN      DirectoryCount;
+  UINTN      FilesPerDirectory;
+  UINTN      Passes;
+  //
+  // Every directory fits in the directory cache, so every directory must
+  // still be cached after the last pass
+  //
+  BOOLEAN    FitsInCache;
+} DIRECTORY_BENCHMARK_CONFIG;
+
+typedef struct {
+  UINTN     Count;
+  UINT64    TotalTime;
+  UINT64    MaxTime;
+  UINTN     DiskReads;
+} DIRECTORY_BENCHMARK_RESULT;
+
+DIRECTORY_BENCHMARK_CONFIG  mBenchmarkConfig[] = {
+  { "Small",    4,  64,    8, TRUE },
+  { "ManyDirs", 64, 256,   4, TRUE },
+  { "LargeDir", 4,  4096,  4, TRUE },
+  { "HugeDir",  1,  16000, 2, TRUE },
+};
+
+DIRECTORY_BENCHMARK_CONFIG  mCustomConfig = {
+  "Custom", 16, 1024, 4, FALSE
+};
+
+FAT_BENCHMARK_OPTION  mCustomConfigOptions[] = {
+  FAT_BENCHMARK_OPTION_ENTRY ('d', DIRECTORY_BENCHMARK_CONFIG, DirectoryCount),
+  FAT_BENCHMARK_OPTION_ENTRY ('n', DIRECTORY_BENCHMARK_CONFIG, FilesPerDirectory),
+  FAT_BENCHMARK_OPTION_ENTRY ('p', DIRECTORY_BENCHMARK_CONFIG, Passes),
+};
+
+UINTN  mDiskReads = 0;
+
+/// === EMULATED DISK ==============================================================================
+
+/**
+  Read from the emulated disk.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+BenchmarkReadDisk (
+  IN  EFI_DISK_IO_PROTOCOL  *This,
+  IN  UINT32                MediaId,
+  IN  UINT64                Offset,
+  IN  UINTN                 BufferSize,
+  OUT VOID                  *Buffer
+  )
+{
+  if ((Offset > mImageSize) || (BufferSize > mImageSize - Offset)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  CopyMem (Buffer, mImage + Offset, BufferSize);
+  mDiskReads++;
+  return EFI_SUCCESS;
+}
+
+/**
+  Write to the emulated disk.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+BenchmarkWriteDisk (
+  IN EFI_DISK_IO_PROTOCOL  *This,
+  IN UINT32                MediaId,
+  IN UINT64                Offset,
+  IN UINTN                 BufferSize,
+  IN VOID                  *Buffer
+  )
+{
+  if ((Offset > mImageSize) || (BufferSize > mImageSize - Offset)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  CopyMem (mImage + Offset, Buffer, BufferSize);
+  return EFI_SUCCESS;
+}
+
+EFI_DISK_IO_PROTOCOL  mBenchmarkDiskIo = {
+  EFI_DISK_IO_PROTOCOL_REVISION,
+  BenchmarkReadDisk,
+  BenchmarkWriteDisk
+};
+
+/// === HELPER FUNCTIONS ===========================================================================
+
+/**
+  Append a decimal number with a fixed count of digits to a string.
+
+  @param[in, out] String  The string, with room for Digits more characters.
+  @param[in]      Value   The number.
+  @param[in]      Digits  The count of digits, including leading zeros.
+
+  @return The end of the string.
+**/
+STATIC
+CHAR16 *
+AppendDecimal (
+  IN OUT CHAR16  *String,
+  IN     UINTN   Value,
+  IN     UINTN   Digits
+  )
+{
+  UINTN  Position;
+
+  for (Position = Digits; Position > 0; Position--) {
+    String[Position - 1] = (CHAR16)(L'0' + Value % 10);
+    Value               /= 10;
+  }
+
+  String[Digits] = L'\0';
+  return String + Digits;
+}
+
+/**
+  Build the name of a benchmark directory, "DIR" followed by the zero padded
+  decimal index, which is a valid 8.3 name.
+
+  @param[in]  DirIndex  Index of the directory.
+  @param[out] Name      Buffer of at least 8 characters for the name.
+
+  @return The end of the name.
+**/
+STATIC
+CHAR16 *
+GetBenchmarkDirectoryName (
+  IN  UINTN   DirIndex,
+  OUT CHAR16  *Name
+  )
+{
+  StrCpyS (Name, 4, L"DIR");
+  return AppendDecimal (Name + 3, DirIndex, 4);
+}
+
+/**
+  Build the long name of a benchmark file, which depends on the directory so
+  that the same name is never hashed in two directories.
+
+  @param[in]  DirIndex   Index of the directory of the file.
+  @param[in]  FileIndex  Index of the file in its directory.
+  @param[out] Name       Buffer of BENCHMARK_MAX_PATH_LENGTH characters for the name.
+
+  @return The end of the name.
+**/
+STATIC
+CHAR16 *
+GetBenchmarkFileName (
+  IN  UINTN   DirIndex,
+  IN  UINTN   FileIndex,
+  OUT CHAR16  *Name
+  )
+{
+  CHAR16  *End;
+
+  StrCpyS (Name, BENCHMARK_MAX_PATH_LENGTH, BENCHMARK_FILE_NAME_PREFIX);
+  End    = AppendDecimal (Name + StrLen (Name), DirIndex, 4);
+  *End++ = L'-';
+  End    = AppendDecimal (End, FileIndex, 6);
+  StrCpyS (End, BENCHMARK_MAX_PATH_LENGTH - (UINTN)(End - Name), BENCHMARK_FILE_NAME_SUFFIX);
+  return End + StrLen (End);
+}
+
+/**
+  Build the path of a benchmark file from the root directory.
+
+  @param[in]  DirIndex   Index of the directory of the file.
+  @param[in]  FileIndex  Index of the file in its directory.
+  @param[out] Path       Buffer of BENCHMARK_MAX_PATH_LENGTH characters for the path.
+**/
+STATIC
+VOID
+GetBenchmarkFilePath (
+  IN  UINTN   DirIndex,
+  IN  UINTN   FileIndex,
+  OUT CHAR16  *Path
+  )
+{
+  CHAR16  *End;
+
+  End    = GetBenchmarkDirectoryName (DirIndex, Path);
+  *End++ = L'\\';
+  GetBenchmarkFileName (DirIndex, FileIndex, End);
+}
+
+/**
+  Build a space padded 8.3 name from a prefix, a zero padded decimal number
+  and an extension.
+
+  @param[out] ShortName  Buffer of FAT_NAME_LEN characters for the name.
+  @param[in]  Prefix     The beginning of the main name.
+  @param[in]  Value      The number that ends the main name.
+  @param[in]  Digits     The count of digits of the number.
+  @param[in]  Extension  The extension, without the dot.
+**/
+STATIC
+VOID
+GetBenchmarkShortName (
+  OUT CHAR8  *ShortName,
+  IN  CHAR8  *Prefix,
+  IN  UINTN  Value,
+  IN  UINTN  Digits,
+  IN  CHAR8  *Extension
+  )
+{
+  UINTN  Length;
+  UINTN  Position;
+
+  SetMem (ShortName, FAT_NAME_LEN, ' ');
+  Length = AsciiStrLen (Prefix);
+  CopyMem (ShortName, Prefix, Length);
+  for (Position = Length + Digits; Position > Length; Position--) {
+    ShortName[Position - 1] = (CHAR8)('0' + Value % 10);
+    Value                  /= 10;
+  }
+
+  CopyMem (ShortName + FAT_MAIN_NAME_LEN, Extension, AsciiStrLen (Extension));
+}
+
+/**
+  Write a directory entry with an 8.3 name and no long name.
+
+  @param[out] Entry       The directory entry.
+  @param[in]  Name        The 11 characters of the 8.3 name, space padded.
+  @param[in]  Attributes  The attributes of the file.
+  @param[in]  Cluster     The first cluster of the file, or 0 if it is empty.
+**/
+STATIC
+VOID
+WriteShortEntry (
+  OUT FAT_DIRECTORY_ENTRY  *Entry,
+  IN  CHAR8                *Name,
+  IN  UINT8                Attributes,
+  IN  UINTN                Cluster
+  )
+{
+  CopyMem (Entry->FileName, Name, FAT_NAME_LEN);
+  Entry->Attributes                      = Attributes;
+  Entry->FileCluster                     = (UINT16)Cluster;
+  Entry->FileModificationTime.Date.Day   = 1;
+  Entry->FileModificationTime.Date.Month = 1;
+  Entry->FileModificationTime.Date.Year  = 2026 - 1980;
+}
+
+/**
+  Write a file with a long name, as the long name entries followed by the 8.3
+  entry.
+
+  @param[out] Entry      The first directory entry of the file.
+  @param[in]  LongName   The long name.
+  @param[in]  ShortName  The 11 characters of the 8.3 name, space padded.
+
+  @return The count of directory entries written.
+**/
+STATIC
+UINTN
+WriteLongNameFile (
+  OUT FAT_DIRECTORY_ENTRY  *Entry,
+  IN  CHAR16               *LongName,
+  IN  CHAR8                *ShortName
+  )
+{
+  FAT_DIRECTORY_LFN  *LfnEntry;
+  CHAR16             Buffer[MAX_LFN_ENTRIES * LFN_CHAR_TOTAL];
+  CHAR16             *Chars;
+  UINTN              Length;
+  UINTN              EntryCount;
+  UINTN              Ordinal;
+  UINT8              Checksum;
+
+  Length     = StrLen (LongName);
+  EntryCount = LFN_ENTRY_NUMBER (Length);
+  SetMem16 (Buffer, sizeof (Buffer), 0xffff);
+  CopyMem (Buffer, LongName, StrSize (LongName));
+
+  CopyMem (Entry[EntryCount].FileName, ShortName, FAT_NAME_LEN);
+  Checksum = FatCheckSum (Entry[EntryCount].FileName);
+  for (Ordinal = EntryCount; Ordinal > 0; Ordinal--) {
+    LfnEntry             = (FAT_DIRECTORY_LFN *)&Entry[EntryCount - Ordinal];
+    Chars                = Buffer + (Ordinal - 1) * LFN_CHAR_TOTAL;
+    LfnEntry->Ordinal    = (UINT8)(Ordinal | (Ordinal == EntryCount ? FAT_LFN_LAST : 0));
+    LfnEntry->Attributes = FAT_ATTRIBUTE_LFN;
+    LfnEntry->Checksum   = Checksum;
+    CopyMem (LfnEntry->Name1, Chars, LFN_CHAR1_LEN * sizeof (CHAR16));
+    CopyMem (LfnEntry->Name2, Chars + LFN_CHAR1_LEN, LFN_CHAR2_LEN * sizeof (CHAR16));
+    CopyMem (LfnEntry->Name3, Chars + LFN_CHAR1_LEN + LFN_CHAR2_LEN, LFN_CHAR3_LEN * sizeof (CHAR16));
+  }
+
+  WriteShortEntry (&Entry[EntryCount], ShortName, FAT_ATTRIBUTE_ARCHIVE, 0);
+  return EntryCount + 1;
+}
+
+/**
+  Build a FAT16 image with the directories and files of a benchmark scenario
+  on the emulated disk.
+
+  Every directory occupies consecutive clusters, and the FAT is written to
+  match.
+
+  @param[in] Config  The benchmark scenario.
+
+  @retval EFI_SUCCESS           The image was built.
+  @retval EFI_OUT_OF_RESOURCES  The image could not be allocated.
+**/
+STATIC
+EFI_STATUS
+FormatImage (
+  IN DIRECTORY_BENCHMARK_CONFIG  *Config
+  )
+{
+  FAT_BOOT_SECTOR      *BootSector;
+  EFI_STATUS           Status;
+  FAT_DIRECTORY_ENTRY  *RootEntry;
+  FAT_DIRECTORY_ENTRY  *Entry;
+  UINT16               *Fat;
+  CHAR16               Name[BENCHMARK_MAX_PATH_LENGTH];
+  CHAR8                ShortName[FAT_NAME_LEN];
+  UINTN                Length;
+  UINTN                DirEntryCount;
+  UINTN                DirClusters;
+  UINTN                ClusterCount;
+  UINTN                SectorsPerFat;
+  UINTN                RootSectors;
+  UINTN                Sectors;
+  UINTN                DataPos;
+  UINTN                Cluster;
+  UINTN                DirIndex;
+  UINTN                FileIndex;
+  UINTN                Index;
+
+  //
+  // "." and ".." and, for every file, the long name entries and the 8.3 entry
+  //
+  Length        = GetBenchmarkFileName (Config->DirectoryCount, Config->FilesPerDirectory, Name) - Name;
+  DirEntryCount = 2 + Config->FilesPerDirectory * (LFN_ENTRY_NUMBER (Length) + 1);
+  DirClusters   = (DirEntryCount * sizeof (FAT_DIRECTORY_ENTRY) + BENCHMARK_CLUSTER_SIZE - 1) / BENCHMARK_CLUSTER_SIZE;
+  ClusterCount  = MAX (Config->DirectoryCount * DirClusters, BENCHMARK_MIN_CLUSTERS);
+  SectorsPerFat = ((ClusterCount + FAT_MIN_CLUSTER) * sizeof (UINT16) + BENCHMARK_SECTOR_SIZE - 1) / BENCHMARK_SECTOR_SIZE;
+  RootSectors   = BENCHMARK_ROOT_ENTRIES * sizeof (FAT_DIRECTORY_ENTRY) / BENCHMARK_SECTOR_SIZE;
+  Sectors       = BENCHMARK_RESERVED_SECTORS + BENCHMARK_NUM_FATS * SectorsPerFat + RootSectors +
+                  ClusterCount * BENCHMARK_SECTORS_PER_CLUSTER;
+  if (ClusterCount >= FAT_MAX_FAT16_CLUSTER) {
+    return EFI_UNSUPPORTED;
+  }
+
+  Status = BenchmarkFormatImage (Fat16, Sectors * BENCHMARK_SECTOR_SIZE, Sectors, BENCHMARK_RESERVED_SECTORS, SectorsPerFat);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  BootSector                     = (FAT_BOOT_SECTOR *)mImage;
+  BootSector->FatBsb.RootEntries = BENCHMARK_ROOT_ENTRIES;
+
+  Fat       = (UINT16 *)(mImage + BENCHMARK_RESERVED_SECTORS * BENCHMARK_SECTOR_SIZE);
+  RootEntry = (FAT_DIRECTORY_ENTRY *)((UINT8 *)Fat + BENCHMARK_NUM_FATS * SectorsPerFat * BENCHMARK_SECTOR_SIZE);
+  DataPos   = (UINT8 *)(RootEntry + BENCHMARK_ROOT_ENTRIES) - mImage;
+
+  Cluster = FAT_MIN_CLUSTER;
+  for (DirIndex = 0; DirIndex < Config->DirectoryCount; DirIndex++) {
+    //
+    // Chain the clusters of the directory
+    //
+    for (Index = 0; Index < DirClusters - 1; Index++) {
+      Fat[Cluster + Index] = (UINT16)(Cluster + Index + 1);
+    }
+
+    Fat[Cluster + Index] = 0xFFFF;
+
+    GetBenchmarkShortName (ShortName, "DIR", DirIndex, 4, "");
+    WriteShortEntry (RootEntry++, ShortName, FAT_ATTRIBUTE_DIRECTORY, Cluster);
+
+    Entry = (FAT_DIRECTORY_ENTRY *)(mImage + DataPos + (Cluster - FAT_MIN_CLUSTER) * BENCHMARK_CLUSTER_SIZE);
+    WriteShortEntry (Entry++, ".          ", FAT_ATTRIBUTE_DIRECTORY, Cluster);
+    WriteShortEntry (Entry++, "..         ", FAT_ATTRIBUTE_DIRECTORY, 0);
+    for (FileIndex = 0; FileIndex < Config->FilesPerDirectory; FileIndex++) {
+      GetBenchmarkFileName (DirIndex, FileIndex, Name);
+      GetBenchmarkShortName (ShortName, "F", FileIndex, 7, "EFI");
+      Entry += WriteLongNameFile (Entry, Name, ShortName);
+    }
+
+    Cluster += DirClusters;
+  }
+
+  //
+  // The second FAT mirrors the first one
+  //
+  CopyMem ((UINT8 *)Fat + SectorsPerFat * BENCHMARK_SECTOR_SIZE, Fat, SectorsPerFat * BENCHMARK_SECTOR_SIZE);
+  return EFI_SUCCESS;
+}
+
+/**
+  Open a benchmark file by its path from the root directory, and close it.
+
+  @param[in] Root       The root directory.
+  @param[in] DirIndex   Index of the directory of the file.
+  @param[in] FileIndex  Index of the file in its directory.
+  @param[in] Result     The benchmark result the lookup is accounted in.
+
+  @return The status of the open.
+**/
+STATIC
+EFI_STATUS
+LookupFile (
+  IN     EFI_FILE_PROTOCOL           *Root,
+  IN     UINTN                       DirIndex,
+  IN     UINTN                       FileIndex,
+  IN OUT DIRECTORY_BENCHMARK_RESULT  *Result
+  )
+{
+  EFI_STATUS         Status;
+  EFI_FILE_PROTOCOL  *File;
+  CHAR16             Path[BENCHMARK_MAX_PATH_LENGTH];
+  UINT64             Start;
+  UINT64             Time;
+
+  GetBenchmarkFilePath (DirIndex, FileIndex, Path);
+  Start  = GetBenchmarkTimeStamp ();
+  Status = Root->Open (Root, &File, Path, EFI_FILE_MODE_READ, 0);
+  if (!EFI_ERROR (Status)) {
+    File->Close (File);
+  }
+
+  Time               = GetBenchmarkTimeStamp () - Start;
+  Result->TotalTime += Time;
+  Result->MaxTime    = MAX (Result->MaxTime, Time);
+  Result->Count++;
+  return Status;
+}
+
+/**
+  Print the result of a benchmark and check it against the throughput gate.
+
+  @param[in] Operation  Name of the benchmarked operation.
+  @param[in] Result     The benchmark result.
+
+  @retval TRUE   The benchmark met the throughput gate.
+  @retval FALSE  The benchmark ran fewer lookups per second than required.
+**/
+STATIC
+BOOLEAN
+ReportResult (
+  IN CHAR8                       *Operation,
+  IN DIRECTORY_BENCHMARK_RESULT  *Result
+  )
+{
+  UINT64  OpsPerSecond;
+
+  OpsPerSecond = 0;
+  if (Result->TotalTime != 0) {
+    OpsPerSecond = DivU64x64Remainder (MultU64x32 (Result->Count, 1000000000), Result->TotalTime, NULL);
+  }
+
+  DEBUG ((
+    DEBUG_INFO,
+    "  %-20a %8Lu ops %10Lu ops/s  max %8Lu ns  %6Lu disk reads\n",
+    Operation,
+    (UINT64)Result->Count,
+    OpsPerSecond,
+    Result->MaxTime,
+    (UINT64)Result->DiskReads
+    ));
+
+  return (BOOLEAN)(OpsPerSecond >= mBenchmarkMinRate);
+}
+
+/// === TEST CASES =================================================================================
+
+/**
+  Build the image of a benchmark scenario and mount it with the FAT driver.
+
+  @param[in] Context  The benchmark scenario.
+
+  @retval UNIT_TEST_PASSED                      The volume is mounted.
+  @retval UNIT_TEST_ERROR_PREREQUISITE_NOT_MET  The volume could not be mounted.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+BenchmarkSetup (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  DIRECTORY_BENCHMARK_CONFIG  *Config;
+
+  Config = (DIRECTORY_BENCHMARK_CONFIG *)Context;
+  if ((Config->DirectoryCount == 0) || (Config->DirectoryCount > BENCHMARK_MAX_DIRECTORIES) ||
+      (Config->FilesPerDirectory == 0) || (Config->FilesPerDirectory > 999999) || (Config->Passes == 0))
+  {
+    return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+  }
+
+  if (EFI_ERROR (FormatImage (Config)) || EFI_ERROR (BenchmarkMountImage (&mBenchmarkDiskIo))) {
+    BenchmarkUnmountImage ();
+    return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Look up every file of a benchmark scenario by its path, and a missing file in
+  every directory, and report the throughput and the disk reads.
+
+  @param[in] Context  The benchmark scenario.
+
+  @retval UNIT_TEST_PASSED               Every lookup succeeded within the gates.
+  @retval UNIT_TEST_ERROR_TEST_FAILED    A lookup failed or a gate was missed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+DirectoryLookupBenchmark (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  DIRECTORY_BENCHMARK_CONFIG  *Config;
+  DIRECTORY_BENCHMARK_RESULT  Cold;
+  DIRECTORY_BENCHMARK_RESULT  Warm;
+  DIRECTORY_BENCHMARK_RESULT  Missing;
+  DIRECTORY_BENCHMARK_RESULT  *Result;
+  EFI_STATUS                  Status;
+  EFI_FILE_PROTOCOL           *Root;
+  FAT_VOLUME                  *Volume;
+  UINTN                       Pass;
+  UINTN                       Index;
+  UINTN                       FileIndex;
+  UINTN                       DirIndex;
+  UINTN                       DiskReads;
+  UINTN                       DirCacheCount;
+  BOOLEAN                     GateMet;
+
+  Config = (DIRECTORY_BENCHMARK_CONFIG *)Context;
+  Volume = VOLUME_FROM_VOL_INTERFACE (mFileSystem);
+  ZeroMem (&Cold, sizeof (Cold));
+  ZeroMem (&Warm, sizeof (Warm));
+  ZeroMem (&Missing, sizeof (Missing));
+
+  DEBUG ((
+    DEBUG_INFO,
+    "%a: %Lu directories of %Lu files, %Lu passes, image 0x%Lx bytes\n",
+    Config->Name,
+    (UINT64)Config->DirectoryCount,
+    (UINT64)Config->FilesPerDirectory,
+    (UINT64)Config->Passes,
+    (UINT64)mImageSize
+    ));
+
+  Status = mFileSystem->OpenVolume (mFileSystem, &Root);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  //
+  // The first pass loads every directory from the disk, later passes find
+  // them in the directory cache if they fit.
+  //
+  for (Pass = 0; Pass < Config->Passes; Pass++) {
+    Result    = (Pass == 0) ? &Cold : &Warm;
+    DiskReads = mDiskReads;
+    for (Index = 0; Index < Config->FilesPerDirectory; Index++) {
+      FileIndex = (Index * BENCHMARK_LOOKUP_STRIDE + Pass) % Config->FilesPerDirectory;
+      for (DirIndex = 0; DirIndex < Config->DirectoryCount; DirIndex++) {
+        Status = LookupFile (Root, DirIndex, FileIndex, Result);
+        UT_ASSERT_NOT_EFI_ERROR (Status);
+      }
+    }
+
+    Result->DiskReads += mDiskReads - DiskReads;
+  }
+
+  DiskReads = mDiskReads;
+  for (DirIndex = 0; DirIndex < Config->DirectoryCount; DirIndex++) {
+    Status = LookupFile (Root, DirIndex, Config->FilesPerDirectory, &Missing);
+    UT_ASSERT_STATUS_EQUAL (Status, EFI_NOT_FOUND);
+  }
+
+  Missing.DiskReads = mDiskReads - DiskReads;
+
+  GateMet = ReportResult ("Open (cold)", &Cold);
+  GateMet = (BOOLEAN)(ReportResult ("Open (warm)", &Warm) && GateMet);
+  GateMet = (BOOLEAN)(ReportResult ("Open (missing)", &Missing) && GateMet);
+
+  DirCacheCount = Volume->DirCacheCount;
+  DEBUG ((
+    DEBUG_INFO,
+    "  %Lu directories cached in 0x%Lx bytes\n",
+    (UINT64)DirCacheCount,
+    (UINT64)Volume->DirCacheSize
+    ));
+
+  Root->Close (Root);
+
+  UT_ASSERT_TRUE (GateMet);
+  if (Config->FitsInCache) {
+    UT_ASSERT_EQUAL (DirCacheCount, Config->DirectoryCount);
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/// === TEST ENGINE ================================================================================
+
+FAT_BENCHMARK  mDirectoryLookupBenchmark = {
+  "FAT Directory Lookup Benchmark",
+  "FAT Directory Lookup Benchmarks",
+  "Fat.DirectoryLookup.Benchmark",
+  "Directory lookup throughput",
+  DirectoryLookupBenchmark,
+  BenchmarkSetup,
+  mBenchmarkConfig,
+  sizeof (mBenchmarkConfig[0]),
+  ARRAY_SIZE (mBenchmarkConfig),
+  &mCustomConfig,
+  mCustomConfigOptions,
+  ARRAY_SIZE (mCustomConfigOptions),
+  "[-d DirectoryCount] [-n FilesPerDirectory] [-p Passes] [-m MinOpsPerSecond]"
+};
+
+///
+/// Avoid ECC error for function name that starts with lower case letter
+///
+#define Main  main
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+
+  @param[in] Argc  Number of arguments
+  @param[in] Argv  Array of pointers to arguments
+
+  @retval 0      Success
+  @retval other  Error
+**/
+INT32
+Main (
+  IN INT32  Argc,
+  IN CHAR8  *Argv[]
+  )
+{
+  return RunFatBenchmark (&mDirectoryLookupBenchmark, Argc, Argv);
+}
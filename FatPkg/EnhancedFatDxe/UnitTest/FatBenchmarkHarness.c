@@ -0,0 +1,653 @@
+/** @file
+  Emulated firmware of the host-based benchmarks of the FAT driver.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "FatBenchmarkHarness.h"
+
+#define BENCHMARK_VERSION  "1.0"
+
+UINT8  *mImage    = NULL;
+UINTN  mImageSize = 0;
+
+EFI_SIMPLE_FILE_SYSTEM_PROTOCOL  *mFileSystem = NULL;
+
+UINTN  mBenchmarkMinRate = 0;
+
+/// === EMULATED DISK ==============================================================================
+
+/**
+  Return a monotonic time stamp.
+
+  @return The time in nanoseconds.
+**/
+UINT64
+GetBenchmarkTimeStamp (
+  VOID
+  )
+{
+  struct timespec  Time;
+
+  timespec_get (&Time, TIME_UTC);
+  return (UINT64)Time.tv_sec * 1000000000 + (UINT64)Time.tv_nsec;
+}
+
+/**
+  The FAT driver only accesses the emulated disk through Disk I/O.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+BenchmarkBlockIoReset (
+  IN EFI_BLOCK_IO_PROTOCOL  *This,
+  IN BOOLEAN                ExtendedVerification
+  )
+{
+  return EFI_SUCCESS;
+}
+
+/**
+  The FAT driver only accesses the emulated disk through Disk I/O.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+BenchmarkBlockIoReadWrite (
+  IN EFI_BLOCK_IO_PROTOCOL  *This,
+  IN UINT32                 MediaId,
+  IN EFI_LBA                Lba,
+  IN UINTN                  BufferSize,
+  IN OUT VOID               *Buffer
+  )
+{
+  return EFI_UNSUPPORTED;
+}
+
+/**
+  Nothing is ever pending on the emulated disk.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+BenchmarkBlockIoFlush (
+  IN EFI_BLOCK_IO_PROTOCOL  *This
+  )
+{
+  return EFI_SUCCESS;
+}
+
+EFI_BLOCK_IO_MEDIA  mBenchmarkMedia = {
+  0,                      // MediaId
+  FALSE,                  // RemovableMedia
+  TRUE,                   // MediaPresent
+  FALSE,                  // LogicalPartition
+  TRUE,                   // ReadOnly
+  FALSE,                  // WriteCaching
+  BENCHMARK_SECTOR_SIZE,  // BlockSize
+  0,                      // IoAlign
+  0                       // LastBlock
+};
+
+EFI_BLOCK_IO_PROTOCOL  mBenchmarkBlockIo = {
+  EFI_BLOCK_IO_PROTOCOL_REVISION,
+  &mBenchmarkMedia,
+  BenchmarkBlockIoReset,
+  (EFI_BLOCK_READ)BenchmarkBlockIoReadWrite,
+  (EFI_BLOCK_WRITE)BenchmarkBlockIoReadWrite,
+  BenchmarkBlockIoFlush
+};
+
+/// === FAT DRIVER ENVIRONMENT =====================================================================
+
+//
+// The FAT driver runs without events, at a single TPL and with English file
+// name collation.
+//
+
+/**
+  Compute the CRC32 that the FAT driver hashes file names with.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+BenchmarkCalculateCrc32 (
+  IN  VOID    *Data,
+  IN  UINTN   DataSize,
+  OUT UINT32  *Crc32
+  )
+{
+  *Crc32 = CalculateCrc32 (Data, DataSize);
+  return EFI_SUCCESS;
+}
+
+/**
+  Remember the Simple File System protocol that the FAT driver installs.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+BenchmarkInstallMultipleProtocolInterfaces (
+  IN OUT EFI_HANDLE  *Handle,
+  ...
+  )
+{
+  VA_LIST   Args;
+  EFI_GUID  *Protocol;
+
+  VA_START (Args, Handle);
+  Protocol = VA_ARG (Args, EFI_GUID *);
+  if (CompareGuid (Protocol, &gEfiSimpleFileSystemProtocolGuid)) {
+    mFileSystem = VA_ARG (Args, EFI_SIMPLE_FILE_SYSTEM_PROTOCOL *);
+  }
+
+  VA_END (Args);
+  return EFI_SUCCESS;
+}
+
+/**
+  Forget the Simple File System protocol when the FAT driver abandons the volume.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+BenchmarkUninstallMultipleProtocolInterfaces (
+  IN EFI_HANDLE  Handle,
+  ...
+  )
+{
+  mFileSystem = NULL;
+  return EFI_SUCCESS;
+}
+
+/**
+  The time stamps of the emulated disk are all the same.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+BenchmarkGetTime (
+  OUT EFI_TIME               *Time,
+  OUT EFI_TIME_CAPABILITIES  *Capabilities OPTIONAL
+  )
+{
+  ZeroMem (Time, sizeof (EFI_TIME));
+  Time->Year  = 2026;
+  Time->Month = 1;
+  Time->Day   = 1;
+  return EFI_SUCCESS;
+}
+
+EFI_BOOT_SERVICES     mBenchmarkBootServices;
+EFI_RUNTIME_SERVICES  mBenchmarkRuntimeServices;
+EFI_BOOT_SERVICES     *gBS = &mBenchmarkBootServices;
+EFI_RUNTIME_SERVICES  *gRT = &mBenchmarkRuntimeServices;
+
+EFI_TPL
+EFIAPI
+EfiGetCurrentTpl (
+  VOID
+  )
+{
+  return TPL_APPLICATION;
+}
+
+VOID
+EFIAPI
+EfiAcquireLock (
+  IN EFI_LOCK  *Lock
+  )
+{
+  ASSERT (Lock->Lock == EfiLockReleased);
+  Lock->Lock = EfiLockAcquired;
+}
+
+EFI_STATUS
+EFIAPI
+EfiAcquireLockOrFail (
+  IN EFI_LOCK  *Lock
+  )
+{
+  if (Lock->Lock == EfiLockAcquired) {
+    return EFI_ACCESS_DENIED;
+  }
+
+  Lock->Lock = EfiLockAcquired;
+  return EFI_SUCCESS;
+}
+
+VOID
+EFIAPI
+EfiReleaseLock (
+  IN EFI_LOCK  *Lock
+  )
+{
+  ASSERT (Lock->Lock == EfiLockAcquired);
+  Lock->Lock = EfiLockReleased;
+}
+
+/**
+  Lowercase an ASCII character, leaving other characters alone.
+**/
+STATIC
+CHAR16
+BenchmarkToLower (
+  IN CHAR16  Char
+  )
+{
+  return (Char >= L'A' && Char <= L'Z') ? (CHAR16)(Char - L'A' + L'a') : Char;
+}
+
+/**
+  Uppercase an ASCII character, leaving other characters alone.
+**/
+STATIC
+CHAR16
+BenchmarkToUpper (
+  IN CHAR16  Char
+  )
+{
+  return (Char >= L'a' && Char <= L'z') ? (CHAR16)(Char - L'a' + L'A') : Char;
+}
+
+/**
+  Check whether a character is valid in an 8.3 name.
+**/
+STATIC
+BOOLEAN
+BenchmarkIsFatChar (
+  IN CHAR16  Char
+  )
+{
+  CONST CHAR8  *Special;
+
+  if (((Char >= L'0') && (Char <= L'9')) || ((BenchmarkToUpper (Char) >= L'A') && (BenchmarkToUpper (Char) <= L'Z'))) {
+    return TRUE;
+  }
+
+  for (Special = "$%'-_@~`!(){}^#&"; *Special != '\0'; Special++) {
+    if (Char == (CHAR16)*Special) {
+      return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
+INTN
+FatStriCmp (
+  IN CHAR16  *Str1,
+  IN CHAR16  *Str2
+  )
+{
+  while ((*Str1 != 0) && (BenchmarkToUpper (*Str1) == BenchmarkToUpper (*Str2))) {
+    Str1++;
+    Str2++;
+  }
+
+  return (INTN)BenchmarkToUpper (*Str1) - (INTN)BenchmarkToUpper (*Str2);
+}
+
+VOID
+FatStrUpr (
+  IN CHAR16  *Str
+  )
+{
+  for ( ; *Str != 0; Str++) {
+    *Str = BenchmarkToUpper (*Str);
+  }
+}
+
+VOID
+FatStrLwr (
+  IN CHAR16  *Str
+  )
+{
+  for ( ; *Str != 0; Str++) {
+    *Str = BenchmarkToLower (*Str);
+  }
+}
+
+VOID
+FatFatToStr (
+  IN  UINTN   FatSize,
+  IN  CHAR8   *Fat,
+  OUT CHAR16  *String
+  )
+{
+  for ( ; FatSize != 0 && *Fat != 0; FatSize--) {
+    *String++ = (CHAR16)(UINT8)*Fat++;
+  }
+
+  *String = 0;
+}
+
+BOOLEAN
+FatStrToFat (
+  IN  CHAR16  *String,
+  IN  UINTN   FatSize,
+  OUT CHAR8   *Fat
+  )
+{
+  BOOLEAN  SpecialCharFlag;
+
+  SpecialCharFlag = FALSE;
+  for ( ; *String != 0 && FatSize != 0; String++) {
+    if ((*String == L'.') || (*String == L' ')) {
+      continue;
+    }
+
+    if (BenchmarkIsFatChar (*String)) {
+      *Fat = (CHAR8)BenchmarkToUpper (*String);
+    } else {
+      *Fat            = '_';
+      SpecialCharFlag = TRUE;
+    }
+
+    Fat++;
+    FatSize--;
+  }
+
+  return SpecialCharFlag;
+}
+
+/// === IMAGE ======================================================================================
+
+/**
+  Allocate the image of the emulated disk, and write the boot sector and the
+  first two entries of the first FAT of a FAT16 or FAT32 volume in it.
+
+  The caller writes the root directory location, the rest of the FAT, the
+  second FAT and the directories.
+
+  @param[in] FatType          Fat16 or Fat32.
+  @param[in] ImageSize        The size of the image, which may be smaller than
+                              the volume if the caller emulates the rest.
+  @param[in] Sectors          The count of the sectors of the volume.
+  @param[in] ReservedSectors  The count of the reserved sectors.
+  @param[in] SectorsPerFat    The count of the sectors of a FAT.
+
+  @retval EFI_SUCCESS           The image was allocated.
+  @retval EFI_OUT_OF_RESOURCES  The image could not be allocated.
+**/
+EFI_STATUS
+BenchmarkFormatImage (
+  IN FAT_VOLUME_TYPE  FatType,
+  IN UINTN            ImageSize,
+  IN UINTN            Sectors,
+  IN UINTN            ReservedSectors,
+  IN UINTN            SectorsPerFat
+  )
+{
+  FAT_BOOT_SECTOR  *BootSector;
+  UINT8            *Fat;
+
+  ASSERT ((FatType == Fat16) || (FatType == Fat32));
+  ASSERT (ImageSize >= (ReservedSectors + SectorsPerFat) * BENCHMARK_SECTOR_SIZE);
+
+  mImageSize = ImageSize;
+  mImage     = AllocateZeroPool (mImageSize);
+  if (mImage == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  mBenchmarkMedia.LastBlock = Sectors - 1;
+
+  //
+  // The jump skips the extended BPB, which is longer on FAT32
+  //
+  BootSector = (FAT_BOOT_SECTOR *)mImage;
+  CopyMem (BootSector->FatBsb.Ia32Jump, (FatType == Fat32) ? "\xEB\x58\x90" : "\xEB\x3C\x90", 3);
+  CopyMem (BootSector->FatBsb.OemId, "EDK2HOST", 8);
+  BootSector->FatBsb.SectorSize        = BENCHMARK_SECTOR_SIZE;
+  BootSector->FatBsb.SectorsPerCluster = BENCHMARK_SECTORS_PER_CLUSTER;
+  BootSector->FatBsb.ReservedSectors   = (UINT16)ReservedSectors;
+  BootSector->FatBsb.NumFats           = BENCHMARK_NUM_FATS;
+  BootSector->FatBsb.Media             = 0xF8;
+  if ((FatType == Fat16) && (Sectors <= MAX_UINT16)) {
+    BootSector->FatBsb.Sectors = (UINT16)Sectors;
+  } else {
+    BootSector->FatBsb.LargeSectors = (UINT32)Sectors;
+  }
+
+  Fat = mImage + ReservedSectors * BENCHMARK_SECTOR_SIZE;
+  if (FatType == Fat32) {
+    BootSector->FatBse.Fat32Bse.LargeSectorsPerFat = (UINT32)SectorsPerFat;
+    ((UINT32 *)Fat)[0]                             = 0x0FFFFFF8;
+    ((UINT32 *)Fat)[1]                             = 0x0FFFFFFF;
+  } else {
+    BootSector->FatBsb.SectorsPerFat = (UINT16)SectorsPerFat;
+    ((UINT16 *)Fat)[0]               = 0xFFF8;
+    ((UINT16 *)Fat)[1]               = 0xFFFF;
+  }
+
+  mImage[BENCHMARK_SECTOR_SIZE - 2] = 0x55;
+  mImage[BENCHMARK_SECTOR_SIZE - 1] = 0xAA;
+  return EFI_SUCCESS;
+}
+
+/**
+  Mount the image with the FAT driver.
+
+  @param[in] DiskIo  The Disk I/O protocol of the emulated disk.
+
+  @retval EFI_SUCCESS  The image is mounted and mFileSystem is set.
+  @return              The FAT driver could not mount the image.
+**/
+EFI_STATUS
+BenchmarkMountImage (
+  IN EFI_DISK_IO_PROTOCOL  *DiskIo
+  )
+{
+  EFI_STATUS  Status;
+
+  mBenchmarkBootServices.CalculateCrc32                      = BenchmarkCalculateCrc32;
+  mBenchmarkBootServices.InstallMultipleProtocolInterfaces   = BenchmarkInstallMultipleProtocolInterfaces;
+  mBenchmarkBootServices.UninstallMultipleProtocolInterfaces = BenchmarkUninstallMultipleProtocolInterfaces;
+  mBenchmarkRuntimeServices.GetTime                          = BenchmarkGetTime;
+
+  Status = FatAllocateVolume ((EFI_HANDLE)DiskIo, DiskIo, NULL, &mBenchmarkBlockIo);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  return (mFileSystem != NULL) ? EFI_SUCCESS : EFI_NOT_FOUND;
+}
+
+/**
+  Unmount the image if it is mounted, and free it.
+**/
+VOID
+BenchmarkUnmountImage (
+  VOID
+  )
+{
+  FAT_VOLUME  *Volume;
+
+  if (mFileSystem != NULL) {
+    Volume = VOLUME_FROM_VOL_INTERFACE (mFileSystem);
+    FatAbandonVolume (Volume);
+  }
+
+  if (mImage != NULL) {
+    FreePool (mImage);
+    mImage = NULL;
+  }
+}
+
+/// === TEST ENGINE ================================================================================
+
+/**
+  Unmount the volume and free the image.
+
+  @param[in] Context  The benchmark scenario.
+**/
+STATIC
+VOID
+EFIAPI
+BenchmarkCleanup (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  BenchmarkUnmountImage ();
+}
+
+/**
+  Parse the custom scenario and the throughput gate of a benchmark from the
+  command line.
+
+  @param[in]  Benchmark    The benchmark.
+  @param[in]  Argc         Number of arguments
+  @param[in]  Argv         Array of pointers to arguments
+  @param[out] CustomGiven  Whether an option of the custom scenario is given.
+
+  @retval TRUE   The command line is valid.
+  @retval FALSE  The command line is not valid.
+**/
+STATIC
+BOOLEAN
+ParseCommandLine (
+  IN  FAT_BENCHMARK  *Benchmark,
+  IN  INT32          Argc,
+  IN  CHAR8          *Argv[],
+  OUT BOOLEAN        *CustomGiven
+  )
+{
+  FAT_BENCHMARK_OPTION  *Option;
+  UINT8                 *Field;
+  INT32                 Index;
+  UINTN                 OptionIndex;
+  UINTN                 Value;
+
+  *CustomGiven = FALSE;
+  for (Index = 1; Index < Argc; Index += 2) {
+    if ((strlen (Argv[Index]) != 2) || (Argv[Index][0] != '-') || (Index + 1 >= Argc)) {
+      return FALSE;
+    }
+
+    Value = (UINTN)strtoull (Argv[Index + 1], NULL, 0);
+    if (Argv[Index][1] == 'm') {
+      mBenchmarkMinRate = Value;
+      continue;
+    }
+
+    for (OptionIndex = 0; OptionIndex < Benchmark->OptionCount; OptionIndex++) {
+      if (Benchmark->Options[OptionIndex].Letter == Argv[Index][1]) {
+        break;
+      }
+    }
+
+    if (OptionIndex == Benchmark->OptionCount) {
+      return FALSE;
+    }
+
+    Option = &Benchmark->Options[OptionIndex];
+    Field  = (UINT8 *)Benchmark->CustomScenario + Option->Offset;
+    if (Option->Size == sizeof (BOOLEAN)) {
+      *(BOOLEAN *)Field = (BOOLEAN)(Value != 0);
+    } else {
+      ASSERT (Option->Size == sizeof (UINTN));
+      *(UINTN *)Field = Value;
+    }
+
+    *CustomGiven = TRUE;
+  }
+
+  return TRUE;
+}
+
+/**
+  Run a benchmark as a unit test suite. The options on the command line set
+  the fields of the custom scenario, which then runs instead of the default
+  scenarios, and -m sets mBenchmarkMinRate.
+
+  The volume is unmounted after every scenario; the setup of the benchmark
+  builds the image and mounts it.
+
+  @param[in] Benchmark  The benchmark.
+  @param[in] Argc       Number of arguments
+  @param[in] Argv       Array of pointers to arguments
+
+  @retval 0      Success
+  @retval other  Error
+**/
+INT32
+RunFatBenchmark (
+  IN FAT_BENCHMARK  *Benchmark,
+  IN INT32          Argc,
+  IN CHAR8          *Argv[]
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      BenchmarkTests;
+  BOOLEAN                     CustomGiven;
+  VOID                        *Scenario;
+  UINTN                       Index;
+
+  if (!ParseCommandLine (Benchmark, Argc, Argv, &CustomGiven)) {
+    DEBUG ((DEBUG_ERROR, "Usage: %a %a\n", Argv[0], Benchmark->Usage));
+    return 1;
+  }
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", Benchmark->Name, BENCHMARK_VERSION));
+
+  //
+  // Start setting up the test framework for running the tests.
+  //
+  Status = InitUnitTestFramework (&Framework, Benchmark->Name, gEfiCallerBaseName, BENCHMARK_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  //
+  // Add all test suites and tests.
+  //
+  Status = CreateUnitTestSuite (
+             &BenchmarkTests,
+             Framework,
+             Benchmark->SuiteName,
+             Benchmark->SuitePackage,
+             NULL,
+             NULL
+             );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for BenchmarkTests\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  for (Index = 0; Index < (CustomGiven ? 1 : Benchmark->ScenarioCount); Index++) {
+    Scenario = CustomGiven ? Benchmark->CustomScenario : (UINT8 *)Benchmark->Scenarios + Index * Benchmark->ScenarioSize;
+    AddTestCase (
+      BenchmarkTests,
+      Benchmark->Description,
+      *(CHAR8 **)Scenario,
+      Benchmark->Function,
+      Benchmark->Setup,
+      BenchmarkCleanup,
+      Scenario
+      );
+  }
+
+  //
+  // Execute the tests.
+  //
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework != NULL) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return EFI_ERROR (Status) ? 1 : 0;
+}
@@ -0,0 +1,163 @@
+/** @file
+  Emulated firmware of the host-based benchmarks of the FAT driver.
+
+  The benchmarks mount a FAT image held in memory with the FAT driver. The
+  harness provides the boot services, the locks and the file name collation
+  the FAT driver needs, the Block I/O protocol of the emulated disk, and the
+  boot sector of the image. Every benchmark provides the Disk I/O protocol
+  that the FAT driver reads and writes the image with.
+
+  The harness also runs a benchmark: it reads a custom scenario and the
+  throughput gate from the command line, and runs the custom scenario or the
+  default scenarios of the benchmark as unit tests.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef FAT_BENCHMARK_HARNESS_H_
+#define FAT_BENCHMARK_HARNESS_H_
+
+#include <Library/UnitTestLib.h>
+
+#include "../Fat.h"
+
+#define BENCHMARK_SECTOR_SIZE          512
+#define BENCHMARK_SECTORS_PER_CLUSTER  8
+#define BENCHMARK_CLUSTER_SIZE         (BENCHMARK_SECTOR_SIZE * BENCHMARK_SECTORS_PER_CLUSTER)
+#define BENCHMARK_NUM_FATS             2
+
+//
+// The image on the emulated disk, allocated by BenchmarkFormatImage()
+//
+extern UINT8  *mImage;
+extern UINTN  mImageSize;
+
+extern EFI_BLOCK_IO_MEDIA  mBenchmarkMedia;
+
+//
+// The file system the FAT driver installed on the image, NULL while the image
+// is not mounted
+//
+extern EFI_SIMPLE_FILE_SYSTEM_PROTOCOL  *mFileSystem;
+
+//
+// The throughput gate given by -m on the command line, in the unit of the
+// benchmark. 0 if no gate is given.
+//
+extern UINTN  mBenchmarkMinRate;
+
+//
+// A command line option that sets a UINTN or a BOOLEAN field of the custom
+// scenario of a benchmark
+//
+typedef struct {
+  CHAR8    Letter;
+  UINTN    Offset;
+  UINTN    Size;
+} FAT_BENCHMARK_OPTION;
+
+#define FAT_BENCHMARK_OPTION_ENTRY(Letter, Type, Field) \
+  { (Letter), OFFSET_OF (Type, Field), sizeof (((Type *)0)->Field) }
+
+//
+// A benchmark. Every scenario starts with the CHAR8 * name of its unit test,
+// and is the context of the unit test.
+//
+typedef struct {
+  CHAR8                     *Name;
+  CHAR8                     *SuiteName;
+  CHAR8                     *SuitePackage;
+  CHAR8                     *Description;
+  UNIT_TEST_FUNCTION        Function;
+  UNIT_TEST_PREREQUISITE    Setup;
+  VOID                      *Scenarios;
+  UINTN                     ScenarioSize;
+  UINTN                     ScenarioCount;
+  VOID                      *CustomScenario;
+  FAT_BENCHMARK_OPTION      *Options;
+  UINTN                     OptionCount;
+  CHAR8                     *Usage;
+} FAT_BENCHMARK;
+
+/**
+  Return a monotonic time stamp.
+
+  @return The time in nanoseconds.
+**/
+UINT64
+GetBenchmarkTimeStamp (
+  VOID
+  );
+
+/**
+  Allocate the image of the emulated disk, and write the boot sector and the
+  first two entries of the first FAT of a FAT16 or FAT32 volume in it.
+
+  The caller writes the root directory location, the rest of the FAT, the
+  second FAT and the directories.
+
+  @param[in] FatType          Fat16 or Fat32.
+  @param[in] ImageSize        The size of the image, which may be smaller than
+                              the volume if the caller emulates the rest.
+  @param[in] Sectors          The count of the sectors of the volume.
+  @param[in] ReservedSectors  The count of the reserved sectors.
+  @param[in] SectorsPerFat    The count of the sectors of a FAT.
+
+  @retval EFI_SUCCESS           The image was allocated.
+  @retval EFI_OUT_OF_RESOURCES  The image could not be allocated.
+**/
+EFI_STATUS
+BenchmarkFormatImage (
+  IN FAT_VOLUME_TYPE  FatType,
+  IN UINTN            ImageSize,
+  IN UINTN            Sectors,
+  IN UINTN            ReservedSectors,
+  IN UINTN            SectorsPerFat
+  );
+
+/**
+  Mount the image with the FAT driver.
+
+  @param[in] DiskIo  The Disk I/O protocol of the emulated disk.
+
+  @retval EFI_SUCCESS  The image is mounted and mFileSystem is set.
+  @return              The FAT driver could not mount the image.
+**/
+EFI_STATUS
+BenchmarkMountImage (
+  IN EFI_DISK_IO_PROTOCOL  *DiskIo
+  );
+
+/**
+  Unmount the image if it is mounted, and free it.
+**/
+VOID
+BenchmarkUnmountImage (
+  VOID
+  );
+
+/**
+  Run a benchmark as a unit test suite. The options on the command line set
+  the fields of the custom scenario, which then runs instead of the default
+  scenarios, and -m sets mBenchmarkMinRate.
+
+  The volume is unmounted after every scenario; the setup of the benchmark
+  builds the image and mounts it.
+
+  @param[in] Benchmark  The benchmark.
+  @param[in] Argc       Number of arguments
+  @param[in] Argv       Array of pointers to arguments
+
+  @retval 0      Success
+  @retval other  Error
+**/
+INT32
+RunFatBenchmark (
+  IN FAT_BENCHMARK  *Benchmark,
+  IN INT32          Argc,
+  IN CHAR8          *Argv[]
+  );
+
+#endif
@@ -0,0 +1,723 @@
+/** @file
+  This is a host-based benchmark of reading a large file with the FAT driver.
+
+  The FAT driver mounts a FAT32 image with one large file in its root
+  directory, like a kernel or an initrd on an ESP. Only the metadata of the
+  image is held in memory; the data of the file is generated as it is read,
+  so a file of several GB can be read without the memory to hold it. Every
+  sector of the file starts with its position in the file, which the benchmark
+  checks after every read. The file is either laid out in one run of
+  consecutive clusters, or in runs that are one free cluster apart.
+
+  The benchmark reads the file sequentially twice, or at random positions, and
+  reports the throughput, the time spent in the driver, the disk reads and the
+  bytes per disk read. It fails if a read fails or returns the wrong data. A
+  scenario can also write the file by appending to an empty file first, the
+  whole image is then held in memory.
+
+  The scenarios in mBenchmarkConfig run by default. A custom scenario can be
+  given on the command line:
+
+    FileReadBenchmarkUnitTest [-s FileSizeMb] [-c RunClusters] [-b ReadSize]
+                              [-r RandomReads] [-a Append] [-m MinMbPerSecond]
+
+  -m fails any benchmark that reads fewer MB per second than given.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include <Library/UnitTestLib.h>
+
+#include "FatBenchmarkHarness.h"
+
+/// === TEST DATA ==================================================================================
+
+#define BENCHMARK_RESERVED_SECTORS     32
+#define BENCHMARK_MIN_CLUSTERS         (FAT_MAX_FAT16_CLUSTER + 0x100)
+#define BENCHMARK_MAX_FILE_SIZE_MB     (MAX_UINT32 / SIZE_1MB)
+#define BENCHMARK_ROOT_CLUSTER         FAT_MIN_CLUSTER
+#define BENCHMARK_FILE_CLUSTER         (BENCHMARK_ROOT_CLUSTER + 1)
+#define BENCHMARK_FILE_PATH            L"VMLINUZ.EFI"
+#define BENCHMARK_FILE_SHORT_NAME      "VMLINUZ EFI"
+#define BENCHMARK_FAT32_LAST           0x0FFFFFFF
+//
+// Seed of the random positions, so that every run reads the same positions
+//
+#define BENCHMARK_RANDOM_SEED  0x2545F491
+
+typedef struct {
+  CHAR8      *Name;
+  UINTN      FileSizeMb;
+  //
+  // Count of the clusters in a run of consecutive clusters of the file, the
+  // runs are one cluster apart. 0 lays the file out in one run.
+  //
+  UINTN      RunClusters;
+  UINTN      ReadSize;
+  //
+  // Count of the reads at random positions, 0 reads the file sequentially
+  //
+  UINTN      RandomReads;
+  //
+  // Write the file by appending to an empty file before reading it
+  //
+  BOOLEAN    Append;
+} FILE_READ_BENCHMARK_CONFIG;
+
+typedef struct {
+  UINT64    Bytes;
+  UINT64    TotalTime;
+  UINT64    DiskTime;
+  UINTN     DiskReads;
+  UINT64    DiskReadBytes;
+} FILE_READ_BENCHMARK_RESULT;
+
+FILE_READ_BENCHMARK_CONFIG  mBenchmarkConfig[] = {
+  { "Sequential", 2048, 0,  SIZE_1MB,  0,    FALSE },
+  { "Fragmented", 2048, 16, SIZE_1MB,  0,    FALSE },
+  { "Random",     2048, 16, SIZE_64KB, 1024, FALSE },
+  { "Append",     64,   16, SIZE_1MB,  0,    TRUE  },
+};
+
+FILE_READ_BENCHMARK_CONFIG  mCustomConfig = {
+  "Custom", 1024, 0, SIZE_1MB, 0, FALSE
+};
+
+FAT_BENCHMARK_OPTION  mCustomConfigOptions[] = {
+  FAT_BENCHMARK_OPTION_ENTRY ('s', FILE_READ_BENCHMARK_CONFIG, FileSizeMb),
+  FAT_BENCHMARK_OPTION_ENTRY ('c', FILE_READ_BENCHMARK_CONFIG, RunClusters),
+  FAT_BENCHMARK_OPTION_ENTRY ('b', FILE_READ_BENCHMARK_CONFIG, ReadSize),
+  FAT_BENCHMARK_OPTION_ENTRY ('r', FILE_READ_BENCHMARK_CONFIG, RandomReads),
+  FAT_BENCHMARK_OPTION_ENTRY ('a', FILE_READ_BENCHMARK_CONFIG, Append),
+};
+
+//
+// The emulated disk. The image holds the metadata, and the data of the file
+// beyond it is generated; it holds the whole volume if the file is written.
+//
+UINT64  mVolumeSize    = 0;
+UINT64  mDataPos       = 0;
+UINTN   mFileClusters  = 0;
+UINTN   mRunClusters   = 0;
+UINTN   mDiskReads     = 0;
+UINT64  mDiskReadBytes = 0;
+UINT64  mDiskTime      = 0;
+
+/// === EMULATED DISK ==============================================================================
+
+/**
+  Get the cluster on the disk of a cluster of the file.
+
+  @param[in] FileCluster  Index of the cluster in the file.
+
+  @return The cluster on the disk.
+**/
+STATIC
+UINTN
+GetDiskCluster (
+  IN UINTN  FileCluster
+  )
+{
+  if (mRunClusters == 0) {
+    return BENCHMARK_FILE_CLUSTER + FileCluster;
+  }
+
+  return BENCHMARK_FILE_CLUSTER + FileCluster + FileCluster / mRunClusters;
+}
+
+/**
+  Get the position in the file of a position on the disk.
+
+  @param[in]  DiskPos  The position on the disk.
+  @param[out] FilePos  The position in the file.
+
+  @retval TRUE   The position on the disk is in the file.
+  @retval FALSE  The position on the disk is not in the file.
+**/
+STATIC
+BOOLEAN
+GetFilePosition (
+  IN  UINT64  DiskPos,
+  OUT UINT64  *FilePos
+  )
+{
+  UINT64  Cluster;
+  UINT64  FileCluster;
+
+  if (DiskPos < mDataPos) {
+    return FALSE;
+  }
+
+  Cluster = (DiskPos - mDataPos) / BENCHMARK_CLUSTER_SIZE + FAT_MIN_CLUSTER;
+  if (Cluster < BENCHMARK_FILE_CLUSTER) {
+    return FALSE;
+  }
+
+  FileCluster = Cluster - BENCHMARK_FILE_CLUSTER;
+  if (mRunClusters != 0) {
+    if (FileCluster % (mRunClusters + 1) == mRunClusters) {
+      return FALSE;
+    }
+
+    FileCluster = FileCluster / (mRunClusters + 1) * mRunClusters + FileCluster % (mRunClusters + 1);
+  }
+
+  if (FileCluster >= mFileClusters) {
+    return FALSE;
+  }
+
+  *FilePos = FileCluster * BENCHMARK_CLUSTER_SIZE + (DiskPos - mDataPos) % BENCHMARK_CLUSTER_SIZE;
+  return TRUE;
+}
+
+/**
+  Read from the emulated disk.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+BenchmarkReadDisk (
+  IN  EFI_DISK_IO_PROTOCOL  *This,
+  IN  UINT32                MediaId,
+  IN  UINT64                Offset,
+  IN  UINTN                 BufferSize,
+  OUT VOID                  *Buffer
+  )
+{
+  UINT64  Start;
+  UINT64  End;
+  UINT64  Sector;
+  UINT64  Begin;
+  UINT64  Stop;
+  UINT64  FilePos;
+  UINT64  Time;
+  UINTN   Length;
+
+  if ((Offset > mVolumeSize) || (BufferSize > mVolumeSize - Offset)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Time = GetBenchmarkTimeStamp ();
+  mDiskReads++;
+  mDiskReadBytes += BufferSize;
+
+  Length = 0;
+  if (Offset < mImageSize) {
+    Length = (UINTN)MIN (BufferSize, mImageSize - Offset);
+    CopyMem (Buffer, mImage + Offset, Length);
+  }
+
+  //
+  // Generate the data beyond the image, every sector of the file starts with
+  // its position in the file
+  //
+  Start = Offset + Length;
+  End   = Offset + BufferSize;
+  ZeroMem ((UINT8 *)Buffer + Length, BufferSize - Length);
+  for (Sector = Start & ~(UINT64)(BENCHMARK_SECTOR_SIZE - 1); Sector < End; Sector += BENCHMARK_SECTOR_SIZE) {
+    Begin = MAX (Sector, Start);
+    Stop  = MIN (Sector + sizeof (FilePos), End);
+    if ((Begin < Stop) && GetFilePosition (Sector, &FilePos)) {
+      CopyMem ((UINT8 *)Buffer + (Begin - Offset), (UINT8 *)&FilePos + (Begin - Sector), (UINTN)(Stop - Begin));
+    }
+  }
+
+  mDiskTime += GetBenchmarkTimeStamp () - Time;
+  return EFI_SUCCESS;
+}
+
+/**
+  Write to the emulated disk, which is only writable where the image holds it.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+BenchmarkWriteDisk (
+  IN EFI_DISK_IO_PROTOCOL  *This,
+  IN UINT32                MediaId,
+  IN UINT64                Offset,
+  IN UINTN                 BufferSize,
+  IN VOID                  *Buffer
+  )
+{
+  UINT64  Time;
+
+  if ((Offset > mImageSize) || (BufferSize > mImageSize - Offset)) {
+    return EFI_WRITE_PROTECTED;
+  }
+
+  Time = GetBenchmarkTimeStamp ();
+  CopyMem (mImage + Offset, Buffer, BufferSize);
+  mDiskTime += GetBenchmarkTimeStamp () - Time;
+  return EFI_SUCCESS;
+}
+
+EFI_DISK_IO_PROTOCOL  mBenchmarkDiskIo = {
+  EFI_DISK_IO_PROTOCOL_REVISION,
+  BenchmarkReadDisk,
+  BenchmarkWriteDisk
+};
+
+
+/// === HELPER FUNCTIONS ===========================================================================
+
+/**
+  Build a FAT32 image with the file of a benchmark scenario on the emulated
+  disk.
+
+  The root directory occupies the first cluster and the file the clusters that
+  follow, in runs of consecutive clusters one cluster apart. If the file is to
+  be written, it is left empty and the clusters between the runs are taken, so
+  that the file grows in the same runs.
+
+  @param[in] Config  The benchmark scenario.
+
+  @retval EFI_SUCCESS           The image was built.
+  @retval EFI_OUT_OF_RESOURCES  The image could not be allocated.
+**/
+STATIC
+EFI_STATUS
+FormatImage (
+  IN FILE_READ_BENCHMARK_CONFIG  *Config
+  )
+{
+  FAT_BOOT_SECTOR      *BootSector;
+  EFI_STATUS           Status;
+  FAT_DIRECTORY_ENTRY  *Entry;
+  UINT32               *Fat;
+  UINT64               FileSize;
+  UINTN                ClusterCount;
+  UINTN                SectorsPerFat;
+  UINTN                Sectors;
+  UINTN                Cluster;
+  UINTN                Index;
+
+  FileSize      = MultU64x32 (Config->FileSizeMb, SIZE_1MB);
+  mRunClusters  = Config->RunClusters;
+  mFileClusters = (UINTN)DivU64x32 (FileSize + BENCHMARK_CLUSTER_SIZE - 1, BENCHMARK_CLUSTER_SIZE);
+  ClusterCount  = MAX (GetDiskCluster (mFileClusters) - FAT_MIN_CLUSTER, BENCHMARK_MIN_CLUSTERS);
+  SectorsPerFat = ((ClusterCount + FAT_MIN_CLUSTER) * sizeof (UINT32) + BENCHMARK_SECTOR_SIZE - 1) / BENCHMARK_SECTOR_SIZE;
+  Sectors       = BENCHMARK_RESERVED_SECTORS + BENCHMARK_NUM_FATS * SectorsPerFat + ClusterCount * BENCHMARK_SECTORS_PER_CLUSTER;
+
+  mDataPos    = (BENCHMARK_RESERVED_SECTORS + BENCHMARK_NUM_FATS * SectorsPerFat) * BENCHMARK_SECTOR_SIZE;
+  mVolumeSize = MultU64x32 (Sectors, BENCHMARK_SECTOR_SIZE);
+  Status      = BenchmarkFormatImage (
+                  Fat32,
+                  Config->Append ? (UINTN)mVolumeSize : (UINTN)mDataPos + BENCHMARK_CLUSTER_SIZE,
+                  Sectors,
+                  BENCHMARK_RESERVED_SECTORS,
+                  SectorsPerFat
+                  );
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  mBenchmarkMedia.ReadOnly = (BOOLEAN)!Config->Append;
+
+  BootSector                                      = (FAT_BOOT_SECTOR *)mImage;
+  BootSector->FatBse.Fat32Bse.RootDirFirstCluster = BENCHMARK_ROOT_CLUSTER;
+
+  Fat                         = (UINT32 *)(mImage + BENCHMARK_RESERVED_SECTORS * BENCHMARK_SECTOR_SIZE);
+  Fat[BENCHMARK_ROOT_CLUSTER] = BENCHMARK_FAT32_LAST;
+
+  Entry = (FAT_DIRECTORY_ENTRY *)(mImage + mDataPos);
+  CopyMem (Entry->FileName, BENCHMARK_FILE_SHORT_NAME, FAT_NAME_LEN);
+  Entry->Attributes                      = FAT_ATTRIBUTE_ARCHIVE;
+  Entry->FileModificationTime.Date.Day   = 1;
+  Entry->FileModificationTime.Date.Month = 1;
+  Entry->FileModificationTime.Date.Year  = 2026 - 1980;
+
+  if (Config->Append) {
+    //
+    // Take the clusters between the runs, as a lost cluster each
+    //
+    for (Index = 1; Index < mFileClusters; Index++) {
+      for (Cluster = GetDiskCluster (Index - 1) + 1; Cluster < GetDiskCluster (Index); Cluster++) {
+        Fat[Cluster] = BENCHMARK_FAT32_LAST;
+      }
+    }
+  } else {
+    //
+    // Chain the clusters of the file
+    //
+    for (Index = 0; Index < mFileClusters - 1; Index++) {
+      Fat[GetDiskCluster (Index)] = (UINT32)GetDiskCluster (Index + 1);
+    }
+
+    Fat[GetDiskCluster (Index)] = BENCHMARK_FAT32_LAST;
+    Entry->FileClusterHigh      = (UINT16)(BENCHMARK_FILE_CLUSTER >> 16);
+    Entry->FileCluster          = (UINT16)BENCHMARK_FILE_CLUSTER;
+    Entry->FileSize             = (UINT32)FileSize;
+  }
+
+  //
+  // The second FAT mirrors the first one
+  //
+  CopyMem ((UINT8 *)Fat + SectorsPerFat * BENCHMARK_SECTOR_SIZE, Fat, SectorsPerFat * BENCHMARK_SECTOR_SIZE);
+  return EFI_SUCCESS;
+}
+
+/**
+  Fill a buffer with the data of the benchmark file, every sector starts with
+  its position in the file.
+
+  @param[in]  Position    The position of the buffer in the file.
+  @param[in]  BufferSize  The size of the buffer.
+  @param[out] Buffer      The buffer.
+**/
+STATIC
+VOID
+FillFileData (
+  IN  UINT64  Position,
+  IN  UINTN   BufferSize,
+  OUT UINT8   *Buffer
+  )
+{
+  UINT64  Sector;
+  UINT64  Begin;
+  UINT64  Stop;
+
+  ZeroMem (Buffer, BufferSize);
+  for (Sector = Position & ~(UINT64)(BENCHMARK_SECTOR_SIZE - 1); Sector < Position + BufferSize; Sector += BENCHMARK_SECTOR_SIZE) {
+    Begin = MAX (Sector, Position);
+    Stop  = MIN (Sector + sizeof (Sector), Position + BufferSize);
+    if (Begin < Stop) {
+      CopyMem (Buffer + (Begin - Position), (UINT8 *)&Sector + (Begin - Sector), (UINTN)(Stop - Begin));
+    }
+  }
+}
+
+/**
+  Check that a buffer holds the data of the benchmark file, by the position
+  every whole sector starts with.
+
+  @param[in] Position    The position of the buffer in the file.
+  @param[in] BufferSize  The size of the buffer.
+  @param[in] Buffer      The buffer.
+
+  @retval TRUE   The buffer holds the data of the file.
+  @retval FALSE  The buffer holds other data.
+**/
+STATIC
+BOOLEAN
+CheckFileData (
+  IN UINT64  Position,
+  IN UINTN   BufferSize,
+  IN UINT8   *Buffer
+  )
+{
+  UINTN  Offset;
+
+  Offset = (UINTN)(ALIGN_VALUE (Position, BENCHMARK_SECTOR_SIZE) - Position);
+  for ( ; Offset + sizeof (UINT64) <= BufferSize; Offset += BENCHMARK_SECTOR_SIZE) {
+    if (ReadUnaligned64 ((UINT64 *)(Buffer + Offset)) != Position + Offset) {
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+/**
+  Read the benchmark file at a position, and check the data read.
+
+  @param[in]     File        The benchmark file.
+  @param[in]     Position    The position to read at.
+  @param[in]     BufferSize  The count of bytes to read.
+  @param[out]    Buffer      The buffer to read to.
+  @param[in,out] Result      The benchmark result the read is accounted in.
+
+  @retval EFI_SUCCESS           The data read is the data of the file.
+  @retval EFI_VOLUME_CORRUPTED  The data read is not the data of the file.
+  @return others                The read failed.
+**/
+STATIC
+EFI_STATUS
+ReadFileAt (
+  IN     EFI_FILE_PROTOCOL           *File,
+  IN     UINT64                      Position,
+  IN     UINTN                       BufferSize,
+  OUT    UINT8                       *Buffer,
+  IN OUT FILE_READ_BENCHMARK_RESULT  *Result
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       Size;
+  UINT64      Start;
+  UINT64      DiskTime;
+
+  Status = File->SetPosition (File, Position);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Size     = BufferSize;
+  DiskTime = mDiskTime;
+  Start    = GetBenchmarkTimeStamp ();
+  Status   = File->Read (File, &Size, Buffer);
+
+  Result->TotalTime += GetBenchmarkTimeStamp () - Start;
+  Result->DiskTime  += mDiskTime - DiskTime;
+  Result->Bytes     += Size;
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  if ((Size != BufferSize) || !CheckFileData (Position, Size, Buffer)) {
+    return EFI_VOLUME_CORRUPTED;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Print the result of a benchmark and check it against the throughput gate.
+  The time spent in the driver leaves out the time spent by the emulated disk.
+
+  @param[in] Operation  Name of the benchmarked operation.
+  @param[in] Result     The benchmark result.
+
+  @retval TRUE   The benchmark met the throughput gate.
+  @retval FALSE  The benchmark read fewer MB per second than required.
+**/
+STATIC
+BOOLEAN
+ReportResult (
+  IN CHAR8                       *Operation,
+  IN FILE_READ_BENCHMARK_RESULT  *Result
+  )
+{
+  UINT64  MbPerSecond;
+  UINT64  BytesPerRead;
+
+  MbPerSecond = 0;
+  if (Result->TotalTime != 0) {
+    MbPerSecond = DivU64x32 (DivU64x64Remainder (MultU64x32 (Result->Bytes, 1000000000), Result->TotalTime, NULL), SIZE_1MB);
+  }
+
+  BytesPerRead = 0;
+  if (Result->DiskReads != 0) {
+    BytesPerRead = DivU64x64Remainder (Result->DiskReadBytes, Result->DiskReads, NULL);
+  }
+
+  DEBUG ((
+    DEBUG_INFO,
+    "  %-16a %6Lu MB %8Lu MB/s  %6Lu ms in driver  %8Lu disk reads  %8Lu bytes/read\n",
+    Operation,
+    DivU64x32 (Result->Bytes, SIZE_1MB),
+    MbPerSecond,
+    DivU64x32 (Result->TotalTime - Result->DiskTime, 1000000),
+    (UINT64)Result->DiskReads,
+    BytesPerRead
+    ));
+
+  return (BOOLEAN)(MbPerSecond >= mBenchmarkMinRate);
+}
+
+/// === TEST CASES =================================================================================
+
+/**
+  Build the image of a benchmark scenario and mount it with the FAT driver.
+
+  @param[in] Context  The benchmark scenario.
+
+  @retval UNIT_TEST_PASSED                      The volume is mounted.
+  @retval UNIT_TEST_ERROR_PREREQUISITE_NOT_MET  The volume could not be mounted.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+BenchmarkSetup (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  FILE_READ_BENCHMARK_CONFIG  *Config;
+
+  Config = (FILE_READ_BENCHMARK_CONFIG *)Context;
+  if ((Config->FileSizeMb == 0) || (Config->FileSizeMb > BENCHMARK_MAX_FILE_SIZE_MB) ||
+      (Config->ReadSize == 0) || (Config->ReadSize > SIZE_1GB) ||
+      ((Config->RandomReads != 0) && (Config->ReadSize > MultU64x32 (Config->FileSizeMb, SIZE_1MB))))
+  {
+    return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+  }
+
+  if (EFI_ERROR (FormatImage (Config)) || EFI_ERROR (BenchmarkMountImage (&mBenchmarkDiskIo))) {
+    BenchmarkUnmountImage ();
+    return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Read the file of a benchmark scenario, after writing it if the scenario
+  appends to it, and report the throughput and the disk reads.
+
+  @param[in] Context  The benchmark scenario.
+
+  @retval UNIT_TEST_PASSED               Every read succeeded within the gates.
+  @retval UNIT_TEST_ERROR_TEST_FAILED    A read failed or a gate was missed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+FileReadBenchmark (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  FILE_READ_BENCHMARK_CONFIG  *Config;
+  FILE_READ_BENCHMARK_RESULT  Write;
+  FILE_READ_BENCHMARK_RESULT  First;
+  FILE_READ_BENCHMARK_RESULT  Again;
+  FILE_READ_BENCHMARK_RESULT  *Result;
+  EFI_STATUS                  Status;
+  EFI_FILE_PROTOCOL           *Root;
+  EFI_FILE_PROTOCOL           *File;
+  UINT8                       *Buffer;
+  UINT64                      FileSize;
+  UINT64                      Position;
+  UINT64                      Start;
+  UINT64                      Seed;
+  UINTN                       Size;
+  UINTN                       Pass;
+  UINTN                       Index;
+  UINTN                       DiskReads;
+  UINT64                      DiskReadBytes;
+  UINT64                      DiskTime;
+  BOOLEAN                     GateMet;
+
+  Config   = (FILE_READ_BENCHMARK_CONFIG *)Context;
+  FileSize = MultU64x32 (Config->FileSizeMb, SIZE_1MB);
+  ZeroMem (&Write, sizeof (Write));
+  ZeroMem (&First, sizeof (First));
+  ZeroMem (&Again, sizeof (Again));
+
+  DEBUG ((
+    DEBUG_INFO,
+    "%a: file 0x%Lx bytes in runs of %Lu clusters, %Lu byte reads, %Lu random reads%a\n",
+    Config->Name,
+    FileSize,
+    (UINT64)Config->RunClusters,
+    (UINT64)Config->ReadSize,
+    (UINT64)Config->RandomReads,
+    Config->Append ? ", appended" : ""
+    ));
+
+  Buffer = AllocatePool (Config->ReadSize);
+  UT_ASSERT_NOT_NULL (Buffer);
+
+  Status = mFileSystem->OpenVolume (mFileSystem, &Root);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+  Status = Root->Open (Root, &File, BENCHMARK_FILE_PATH, EFI_FILE_MODE_READ | (Config->Append ? EFI_FILE_MODE_WRITE : 0), 0);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  if (Config->Append) {
+    for (Position = 0; Position < FileSize; Position += Size) {
+      Size = (UINTN)MIN (Config->ReadSize, FileSize - Position);
+      FillFileData (Position, Size, Buffer);
+      DiskTime = mDiskTime;
+      Start    = GetBenchmarkTimeStamp ();
+      Status   = File->Write (File, &Size, Buffer);
+
+      Write.TotalTime += GetBenchmarkTimeStamp () - Start;
+      Write.DiskTime  += mDiskTime - DiskTime;
+      Write.Bytes     += Size;
+      UT_ASSERT_NOT_EFI_ERROR (Status);
+    }
+
+    Status = File->Flush (File);
+    UT_ASSERT_NOT_EFI_ERROR (Status);
+  }
+
+  //
+  // The first pass runs the cluster chain of the file, the second one finds
+  // it mapped
+  //
+  for (Pass = 0; Pass < 2; Pass++) {
+    Result        = (Pass == 0) ? &First : &Again;
+    DiskReads     = mDiskReads;
+    DiskReadBytes = mDiskReadBytes;
+    if (Config->RandomReads == 0) {
+      for (Position = 0; Position < FileSize; Position += Size) {
+        Size   = (UINTN)MIN (Config->ReadSize, FileSize - Position);
+        Status = ReadFileAt (File, Position, Size, Buffer, Result);
+        UT_ASSERT_NOT_EFI_ERROR (Status);
+      }
+    } else {
+      Seed = BENCHMARK_RANDOM_SEED + Pass;
+      for (Index = 0; Index < Config->RandomReads; Index++) {
+        Seed     = Seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        Position = (Seed >> 16) % (FileSize - Config->ReadSize + 1);
+        Status   = ReadFileAt (File, Position, Config->ReadSize, Buffer, Result);
+        UT_ASSERT_NOT_EFI_ERROR (Status);
+      }
+    }
+
+    Result->DiskReads     = mDiskReads - DiskReads;
+    Result->DiskReadBytes = mDiskReadBytes - DiskReadBytes;
+  }
+
+  GateMet = TRUE;
+  if (Config->Append) {
+    GateMet = ReportResult ("Write (append)", &Write);
+  }
+
+  GateMet = (BOOLEAN)(ReportResult ("Read (first)", &First) && GateMet);
+  GateMet = (BOOLEAN)(ReportResult ("Read (again)", &Again) && GateMet);
+
+  File->Close (File);
+  Root->Close (Root);
+  FreePool (Buffer);
+
+  UT_ASSERT_TRUE (GateMet);
+  return UNIT_TEST_PASSED;
+}
+
+/// === TEST ENGINE ================================================================================
+
+FAT_BENCHMARK  mFileReadBenchmark = {
+  "FAT File Read Benchmark",
+  "FAT File Read Benchmarks",
+  "Fat.FileRead.Benchmark",
+  "File read throughput",
+  FileReadBenchmark,
+  BenchmarkSetup,
+  mBenchmarkConfig,
+  sizeof (mBenchmarkConfig[0]),
+  ARRAY_SIZE (mBenchmarkConfig),
+  &mCustomConfig,
+  mCustomConfigOptions,
+  ARRAY_SIZE (mCustomConfigOptions),
+  "[-s FileSizeMb] [-c RunClusters] [-b ReadSize] [-r RandomReads] [-a Append] [-m MinMbPerSecond]"
+};
+
+///
+/// Avoid ECC error for function name that starts with lower case letter
+///
+#define Main  main
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+
+  @param[in] Argc  Number of arguments
+  @param[in] Argv  Array of pointers to arguments
+
+  @retval 0      Success
+  @retval other  Error
+**/
+INT32
+Main (
+  IN INT32  Argc,
+  IN CHAR8  *Argv[]
+  )
+{
+  return RunFatBenchmark (&mFileReadBenchmark, Argc, Argv);
+}
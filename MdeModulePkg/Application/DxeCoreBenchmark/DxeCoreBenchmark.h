@@ -0,0 +1,166 @@
+/** @file
+  Common definitions of the DXE core benchmark application.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef _DXE_CORE_BENCHMARK_H_
+#define _DXE_CORE_BENCHMARK_H_
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/TimerLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/UefiLib.h>
+
+/**
+  Run one benchmark.
+
+  @param[in] Count    Number of objects the benchmark works on.
+
+  @retval EFI_SUCCESS           The benchmark completed.
+  @retval others                The benchmark could not be completed.
+**/
+typedef
+EFI_STATUS
+(*DXE_CORE_BENCHMARK_FUNCTION) (
+  IN UINTN  Count
+  );
+
+typedef struct {
+  CHAR16                         *Name;
+  DXE_CORE_BENCHMARK_FUNCTION    Function;
+} DXE_CORE_BENCHMARK;
+
+/**
+  Print the average cost of one operation of a timed loop.
+
+  @param[in] Operation    Name of the operation.
+  @param[in] Count        Number of operations done in the loop.
+  @param[in] StartTicks   Performance counter value before the loop.
+  @param[in] EndTicks     Performance counter value after the loop.
+**/
+VOID
+BenchmarkReport (
+  IN CHAR16  *Operation,
+  IN UINTN   Count,
+  IN UINT64  StartTicks,
+  IN UINT64  EndTicks
+  );
+
+/**
+  Build the GUID of the Index-th synthetic protocol used by the benchmarks.
+
+  @param[in]  Index   Index of the protocol.
+  @param[out] Guid    The generated GUID.
+**/
+VOID
+BenchmarkProtocolGuid (
+  IN  UINTN     Index,
+  OUT EFI_GUID  *Guid
+  );
+
+/**
+  Measure InstallProtocolInterface(), LocateProtocol(), HandleProtocol(),
+  LocateHandleBuffer() and UninstallProtocolInterface().
+
+  @param[in] Count    Number of handles and protocols to create.
+
+  @retval EFI_SUCCESS           The benchmark completed.
+  @retval others                The benchmark could not be completed.
+**/
+EFI_STATUS
+ProtocolDatabaseBenchmark (
+  IN UINTN  Count
+  );
+
+/**
+  Measure the handle validation done by every boot service that takes an
+  EFI_HANDLE, and LocateHandleBuffer (AllHandles).
+
+  @param[in] Count    Number of handles to create.
+
+  @retval EFI_SUCCESS           The benchmark completed.
+  @retval others                The benchmark could not be completed.
+**/
+EFI_STATUS
+HandleDatabaseBenchmark (
+  IN UINTN  Count
+  );
+
+/**
+  Measure the per child cost of installing the protocols of a bus driver child
+  handle with one InstallProtocolInterface() call per protocol, and with one
+  InstallMultipleProtocolInterfaces() call.
+
+  @param[in] Count    Number of child handles to create.
+
+  @retval EFI_SUCCESS           The benchmark completed.
+  @retval others                The benchmark could not be completed.
+**/
+EFI_STATUS
+ChildHandleBenchmark (
+  IN UINTN  Count
+  );
+
+/**
+  Measure SetTimer() with many armed timers, as created by network stacks.
+
+  @param[in] Count    Number of timer events to create.
+
+  @retval EFI_SUCCESS           The benchmark completed.
+  @retval others                The benchmark could not be completed.
+**/
+EFI_STATUS
+TimerBenchmark (
+  IN UINTN  Count
+  );
+
+/**
+  Measure RaiseTPL()/RestoreTPL() pairs and SignalEvent() on an event that is
+  already signaled, then print the TPL trace of the DXE core.
+
+  @param[in] Count    Number of operations, in hundreds.
+
+  @retval EFI_SUCCESS           The benchmark completed.
+  @retval others                The benchmark could not be completed.
+**/
+EFI_STATUS
+TplBenchmark (
+  IN UINTN  Count
+  );
+
+/**
+  Measure GetMemoryMap() on an unchanged memory map and on a memory map that
+  changed since the previous call, and the memory map changes protocol.
+
+  @param[in] Count    Number of calls of each kind.
+
+  @retval EFI_SUCCESS           The benchmark completed.
+  @retval others                The benchmark could not be completed.
+**/
+EFI_STATUS
+MemoryMapBenchmark (
+  IN UINTN  Count
+  );
+
+/**
+  Measure the {token space guid:token number} lookup done by every PcdGetEx
+  and PcdSetEx call, by reading the size of every DynamicEx PCD.
+
+  @param[in] Count    Number of passes over the DynamicEx PCDs.
+
+  @retval EFI_SUCCESS           The benchmark completed.
+  @retval others                The benchmark could not be completed.
+**/
+EFI_STATUS
+PcdBenchmark (
+  IN UINTN  Count
+  );
+
+#endif
@@ -0,0 +1,133 @@
+/** @file
+  Memory map benchmark of the DXE core benchmark application.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "DxeCoreBenchmark.h"
+
+#include <Protocol/MemoryMapChanges.h>
+
+//
+// Extra room for the descriptors added by the allocations of the benchmark
+//
+#define MEMORY_MAP_BENCHMARK_SLACK  (64 * sizeof (EFI_MEMORY_DESCRIPTOR))
+
+/**
+  Measure GetMemoryMap() on an unchanged memory map and on a memory map that
+  changed since the previous call, and the memory map changes protocol.
+
+  @param[in] Count    Number of calls of each kind.
+
+  @retval EFI_SUCCESS           The benchmark completed.
+  @retval others                The benchmark could not be completed.
+**/
+EFI_STATUS
+MemoryMapBenchmark (
+  IN UINTN  Count
+  )
+{
+  EFI_STATUS                         Status;
+  EDKII_MEMORY_MAP_CHANGES_PROTOCOL  *MemoryMapChanges;
+  EFI_MEMORY_DESCRIPTOR              *MemoryMap;
+  UINTN                              BufferSize;
+  UINTN                              MemoryMapSize;
+  UINTN                              MapKey;
+  UINTN                              DescriptorSize;
+  UINT32                             DescriptorVersion;
+  UINT64                             Generation;
+  BOOLEAN                            FullMap;
+  EFI_PHYSICAL_ADDRESS               Address;
+  UINTN                              Changed;
+  UINTN                              Index;
+  UINT64                             Start;
+  UINT64                             End;
+
+  BufferSize = 0;
+  Status     = gBS->GetMemoryMap (&BufferSize, NULL, &MapKey, &DescriptorSize, &DescriptorVersion);
+  if (Status != EFI_BUFFER_TOO_SMALL) {
+    return Status;
+  }
+
+  BufferSize += MEMORY_MAP_BENCHMARK_SLACK;
+  MemoryMap   = AllocatePool (BufferSize);
+  if (MemoryMap == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Start = GetPerformanceCounter ();
+  for (Index = 0; Index < Count; Index++) {
+    MemoryMapSize = BufferSize;
+    Status        = gBS->GetMemoryMap (&MemoryMapSize, MemoryMap, &MapKey, &DescriptorSize, &DescriptorVersion);
+    if (EFI_ERROR (Status)) {
+      goto Done;
+    }
+  }
+
+  End = GetPerformanceCounter ();
+  BenchmarkReport (L"GetMemoryMap (unchanged)", Count, Start, End);
+  Print (L"  %Lu descriptors\n", (UINT64)(MemoryMapSize / DescriptorSize));
+
+  //
+  // Every allocation and free below changes the memory map
+  //
+  Start = GetPerformanceCounter ();
+  for (Index = 0; Index < Count; Index++) {
+    Status = gBS->AllocatePages (AllocateAnyPages, EfiBootServicesData, 1, &Address);
+    if (EFI_ERROR (Status)) {
+      goto Done;
+    }
+
+    MemoryMapSize = BufferSize;
+    Status        = gBS->GetMemoryMap (&MemoryMapSize, MemoryMap, &MapKey, &DescriptorSize, &DescriptorVersion);
+    gBS->FreePages (Address, 1);
+    if (EFI_ERROR (Status)) {
+      goto Done;
+    }
+  }
+
+  End = GetPerformanceCounter ();
+  BenchmarkReport (L"AllocatePages+GetMemoryMap+FreePages", Count, Start, End);
+
+  Status = gBS->LocateProtocol (&gEdkiiMemoryMapChangesProtocolGuid, NULL, (VOID **)&MemoryMapChanges);
+  if (EFI_ERROR (Status)) {
+    Print (L"  Memory map changes protocol not available\n");
+    Status = EFI_SUCCESS;
+    goto Done;
+  }
+
+  Generation    = 0;
+  MemoryMapSize = BufferSize;
+  Status        = MemoryMapChanges->GetMemoryMapChanges (&Generation, &MemoryMapSize, MemoryMap, NULL, NULL, NULL, &FullMap);
+  if (EFI_ERROR (Status)) {
+    goto Done;
+  }
+
+  Changed = 0;
+  Start   = GetPerformanceCounter ();
+  for (Index = 0; Index < Count; Index++) {
+    Status = gBS->AllocatePages (AllocateAnyPages, EfiBootServicesData, 1, &Address);
+    if (EFI_ERROR (Status)) {
+      goto Done;
+    }
+
+    MemoryMapSize = BufferSize;
+    Status        = MemoryMapChanges->GetMemoryMapChanges (&Generation, &MemoryMapSize, MemoryMap, NULL, NULL, NULL, &FullMap);
+    gBS->FreePages (Address, 1);
+    if (EFI_ERROR (Status)) {
+      goto Done;
+    }
+
+    Changed += MemoryMapSize / DescriptorSize;
+  }
+
+  End = GetPerformanceCounter ();
+  BenchmarkReport (L"AllocatePages+GetMemoryMapChanges+FreePages", Count, Start, End);
+  Print (L"  %Lu changed descriptors per call\n", (UINT64)(Changed / MAX (Count, 1)));
+
+Done:
+  FreePool (MemoryMap);
+  return Status;
+}
@@ -0,0 +1,128 @@
+/** @file
+  PCD benchmark of the DXE core benchmark application.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "DxeCoreBenchmark.h"
+
+#include <Protocol/PiPcd.h>
+
+typedef struct {
+  CONST EFI_GUID    *TokenSpace;
+  UINTN             TokenNumber;
+} PCD_BENCHMARK_TOKEN;
+
+/**
+  Walk the DynamicEx PCDs of the PCD database.
+
+  @param[in]  Pcd         The PI PCD protocol.
+  @param[out] Tokens      Buffer that receives the PCDs, or NULL to count them.
+  @param[in]  MaxTokens   Number of entries of Tokens.
+
+  @return The number of DynamicEx PCDs.
+**/
+STATIC
+UINTN
+CollectDynamicExPcds (
+  IN  EFI_PCD_PROTOCOL     *Pcd,
+  OUT PCD_BENCHMARK_TOKEN  *Tokens OPTIONAL,
+  IN  UINTN                MaxTokens
+  )
+{
+  EFI_STATUS      Status;
+  CONST EFI_GUID  *TokenSpace;
+  UINTN           TokenNumber;
+  UINTN           Count;
+
+  Count      = 0;
+  TokenSpace = NULL;
+  while (TRUE) {
+    Status = Pcd->GetNextTokenSpace (&TokenSpace);
+    if (EFI_ERROR (Status) || (TokenSpace == NULL)) {
+      break;
+    }
+
+    TokenNumber = 0;
+    while (TRUE) {
+      Status = Pcd->GetNextToken (TokenSpace, &TokenNumber);
+      if (EFI_ERROR (Status) || (TokenNumber == 0)) {
+        break;
+      }
+
+      if ((Tokens != NULL) && (Count < MaxTokens)) {
+        Tokens[Count].TokenSpace  = TokenSpace;
+        Tokens[Count].TokenNumber = TokenNumber;
+      }
+
+      Count++;
+    }
+  }
+
+  return Count;
+}
+
+/**
+  Measure the {token space guid:token number} lookup done by every PcdGetEx
+  and PcdSetEx call, by reading the size of every DynamicEx PCD.
+
+  @param[in] Count    Number of passes over the DynamicEx PCDs.
+
+  @retval EFI_SUCCESS           The benchmark completed.
+  @retval others                The benchmark could not be completed.
+**/
+EFI_STATUS
+PcdBenchmark (
+  IN UINTN  Count
+  )
+{
+  EFI_STATUS           Status;
+  EFI_PCD_PROTOCOL     *Pcd;
+  PCD_BENCHMARK_TOKEN  *Tokens;
+  UINTN                TokenCount;
+  UINTN                Accesses;
+  UINTN                Pass;
+  UINTN                Index;
+  UINT64               Start;
+  UINT64               End;
+
+  Status = gBS->LocateProtocol (&gEfiPcdProtocolGuid, NULL, (VOID **)&Pcd);
+  if (EFI_ERROR (Status)) {
+    Print (L"  PCD protocol not available\n");
+    return EFI_SUCCESS;
+  }
+
+  TokenCount = CollectDynamicExPcds (Pcd, NULL, 0);
+  if (TokenCount == 0) {
+    Print (L"  No DynamicEx PCD, or the PCD database cannot be traversed\n");
+    return EFI_SUCCESS;
+  }
+
+  Tokens = AllocatePool (TokenCount * sizeof (PCD_BENCHMARK_TOKEN));
+  if (Tokens == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  TokenCount = MIN (TokenCount, CollectDynamicExPcds (Pcd, Tokens, TokenCount));
+
+  Start = GetPerformanceCounter ();
+  for (Pass = 0; Pass < Count; Pass++) {
+    for (Index = 0; Index < TokenCount; Index++) {
+      Pcd->GetSize (Tokens[Index].TokenSpace, Tokens[Index].TokenNumber);
+    }
+  }
+
+  End      = GetPerformanceCounter ();
+  Accesses = Count * TokenCount;
+  BenchmarkReport (L"GetSize (DynamicEx)", Accesses, Start, End);
+  Print (
+    L"  %Lu DynamicEx PCDs, %Lu ticks/op\n",
+    (UINT64)TokenCount,
+    (Accesses == 0) ? 0 : DivU64x64Remainder ((End > Start) ? End - Start : Start - End, Accesses, NULL)
+    );
+
+  FreePool (Tokens);
+  return EFI_SUCCESS;
+}
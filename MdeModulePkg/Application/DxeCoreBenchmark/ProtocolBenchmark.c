@@ -0,0 +1,371 @@
+/** @file
+  Protocol database benchmarks of the DXE core benchmark application.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "DxeCoreBenchmark.h"
+
+//
+// Number of protocols a bus driver typically installs on a child handle
+//
+#define CHILD_HANDLE_PROTOCOLS  6
+
+/**
+  Measure InstallProtocolInterface(), LocateProtocol(), HandleProtocol(),
+  LocateHandleBuffer() and UninstallProtocolInterface().
+
+  Every handle gets its own protocol, so the cost of the protocol GUID lookup
+  and of the per-handle lookup both grow with Count when they are linear.
+
+  @param[in] Count    Number of handles and protocols to create.
+
+  @retval EFI_SUCCESS           The benchmark completed.
+  @retval others                The benchmark could not be completed.
+**/
+EFI_STATUS
+ProtocolDatabaseBenchmark (
+  IN UINTN  Count
+  )
+{
+  EFI_STATUS  Status;
+  EFI_GUID    *Guids;
+  EFI_HANDLE  *Handles;
+  EFI_HANDLE  *Buffer;
+  UINTN       BufferCount;
+  VOID        *Interface;
+  UINTN       Index;
+  UINTN       Installed;
+  UINT64      Start;
+  UINT64      End;
+
+  Guids   = AllocatePool (Count * sizeof (EFI_GUID));
+  Handles = AllocateZeroPool (Count * sizeof (EFI_HANDLE));
+  if ((Guids == NULL) || (Handles == NULL)) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto Done;
+  }
+
+  for (Index = 0; Index < Count; Index++) {
+    BenchmarkProtocolGuid (Index, &Guids[Index]);
+  }
+
+  Status = EFI_SUCCESS;
+  Start  = GetPerformanceCounter ();
+  for (Installed = 0; Installed < Count; Installed++) {
+    Status = gBS->InstallProtocolInterface (
+                    &Handles[Installed],
+                    &Guids[Installed],
+                    EFI_NATIVE_INTERFACE,
+                    &Guids[Installed]
+                    );
+    if (EFI_ERROR (Status)) {
+      break;
+    }
+  }
+
+  End = GetPerformanceCounter ();
+  if (EFI_ERROR (Status)) {
+    goto Uninstall;
+  }
+
+  BenchmarkReport (L"InstallProtocolInterface", Count, Start, End);
+
+  Start = GetPerformanceCounter ();
+  for (Index = 0; Index < Count; Index++) {
+    gBS->LocateProtocol (&Guids[Index], NULL, &Interface);
+  }
+
+  End = GetPerformanceCounter ();
+  BenchmarkReport (L"LocateProtocol", Count, Start, End);
+
+  Start = GetPerformanceCounter ();
+  for (Index = 0; Index < Count; Index++) {
+    gBS->HandleProtocol (Handles[Index], &Guids[Index], &Interface);
+  }
+
+  End = GetPerformanceCounter ();
+  BenchmarkReport (L"HandleProtocol (present)", Count, Start, End);
+
+  Start = GetPerformanceCounter ();
+  for (Index = 0; Index < Count; Index++) {
+    gBS->HandleProtocol (Handles[Index], &Guids[(Index + 1) % Count], &Interface);
+  }
+
+  End = GetPerformanceCounter ();
+  BenchmarkReport (L"HandleProtocol (absent)", Count, Start, End);
+
+  Start = GetPerformanceCounter ();
+  for (Index = 0; Index < Count; Index++) {
+    Status = gBS->LocateHandleBuffer (ByProtocol, &Guids[Index], NULL, &BufferCount, &Buffer);
+    if (!EFI_ERROR (Status)) {
+      FreePool (Buffer);
+    }
+  }
+
+  End = GetPerformanceCounter ();
+  BenchmarkReport (L"LocateHandleBuffer (ByProtocol)", Count, Start, End);
+
+  Status = EFI_SUCCESS;
+
+Uninstall:
+  Start = GetPerformanceCounter ();
+  for (Index = 0; Index < Installed; Index++) {
+    gBS->UninstallProtocolInterface (Handles[Index], &Guids[Index], &Guids[Index]);
+  }
+
+  End = GetPerformanceCounter ();
+  if (!EFI_ERROR (Status)) {
+    BenchmarkReport (L"UninstallProtocolInterface", Count, Start, End);
+  }
+
+Done:
+  if (Guids != NULL) {
+    FreePool (Guids);
+  }
+
+  if (Handles != NULL) {
+    FreePool (Handles);
+  }
+
+  return Status;
+}
+
+/**
+  Measure the handle validation done by every boot service that takes an
+  EFI_HANDLE, and LocateHandleBuffer (AllHandles).
+
+  @param[in] Count    Number of handles to create.
+
+  @retval EFI_SUCCESS           The benchmark completed.
+  @retval others                The benchmark could not be completed.
+**/
+EFI_STATUS
+HandleDatabaseBenchmark (
+  IN UINTN  Count
+  )
+{
+  EFI_STATUS  Status;
+  EFI_GUID    Guid;
+  EFI_HANDLE  *Handles;
+  EFI_HANDLE  *Buffer;
+  UINTN       BufferCount;
+  VOID        *Interface;
+  UINTN       Index;
+  UINTN       Installed;
+  UINT64      Start;
+  UINT64      End;
+
+  Handles = AllocateZeroPool (Count * sizeof (EFI_HANDLE));
+  if (Handles == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  BenchmarkProtocolGuid (0, &Guid);
+  Status = EFI_SUCCESS;
+  for (Installed = 0; Installed < Count; Installed++) {
+    Status = gBS->InstallProtocolInterface (&Handles[Installed], &Guid, EFI_NATIVE_INTERFACE, NULL);
+    if (EFI_ERROR (Status)) {
+      goto Uninstall;
+    }
+  }
+
+  //
+  // OpenProtocol() validates the user, agent and controller handles.
+  //
+  Start = GetPerformanceCounter ();
+  for (Index = 0; Index < Count; Index++) {
+    gBS->OpenProtocol (
+           Handles[Index],
+           &Guid,
+           &Interface,
+           gImageHandle,
+           NULL,
+           EFI_OPEN_PROTOCOL_GET_PROTOCOL
+           );
+  }
+
+  End = GetPerformanceCounter ();
+  BenchmarkReport (L"OpenProtocol (GET_PROTOCOL)", Count, Start, End);
+
+  Start = GetPerformanceCounter ();
+  for (Index = 0; Index < Count; Index++) {
+    gBS->OpenProtocol (
+           (EFI_HANDLE)&Handles[Index],
+           &Guid,
+           &Interface,
+           gImageHandle,
+           NULL,
+           EFI_OPEN_PROTOCOL_GET_PROTOCOL
+           );
+  }
+
+  End = GetPerformanceCounter ();
+  BenchmarkReport (L"OpenProtocol (invalid handle)", Count, Start, End);
+
+  Start = GetPerformanceCounter ();
+  for (Index = 0; Index < Count / 10 + 1; Index++) {
+    Status = gBS->LocateHandleBuffer (AllHandles, NULL, NULL, &BufferCount, &Buffer);
+    if (!EFI_ERROR (Status)) {
+      FreePool (Buffer);
+    }
+  }
+
+  End = GetPerformanceCounter ();
+  BenchmarkReport (L"LocateHandleBuffer (AllHandles)", Count / 10 + 1, Start, End);
+
+  Status = EFI_SUCCESS;
+
+Uninstall:
+  for (Index = 0; Index < Installed; Index++) {
+    gBS->UninstallProtocolInterface (Handles[Index], &Guid, NULL);
+  }
+
+  FreePool (Handles);
+  return Status;
+}
+
+/**
+  Uninstall the protocols of the child handles created by ChildHandleBenchmark().
+
+  @param[in] Handles  The child handles. Every entry is set to NULL.
+  @param[in] Count    Number of child handles.
+  @param[in] Guids    The protocols installed on the child handles.
+**/
+STATIC
+VOID
+UninstallChildHandles (
+  IN EFI_HANDLE  *Handles,
+  IN UINTN       Count,
+  IN EFI_GUID    *Guids
+  )
+{
+  UINTN  Child;
+  UINTN  Index;
+
+  for (Child = 0; Child < Count; Child++) {
+    if (Handles[Child] == NULL) {
+      continue;
+    }
+
+    //
+    // The handle is freed with its last protocol, and later calls fail its
+    // validation, so a partially installed handle is fine
+    //
+    for (Index = 0; Index < CHILD_HANDLE_PROTOCOLS; Index++) {
+      gBS->UninstallProtocolInterface (Handles[Child], &Guids[Index], &Guids[Index]);
+    }
+
+    Handles[Child] = NULL;
+  }
+}
+
+/**
+  Measure the per child cost of installing the protocols of a bus driver child
+  handle with one InstallProtocolInterface() call per protocol, and with one
+  InstallMultipleProtocolInterfaces() call.
+
+  @param[in] Count    Number of child handles to create.
+
+  @retval EFI_SUCCESS           The benchmark completed.
+  @retval others                The benchmark could not be completed.
+**/
+EFI_STATUS
+ChildHandleBenchmark (
+  IN UINTN  Count
+  )
+{
+  EFI_STATUS  Status;
+  EFI_GUID    Guids[CHILD_HANDLE_PROTOCOLS];
+  EFI_HANDLE  *Handles;
+  UINTN       Child;
+  UINTN       Index;
+  UINT64      Start;
+  UINT64      End;
+
+  Handles = AllocateZeroPool (Count * sizeof (EFI_HANDLE));
+  if (Handles == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  for (Index = 0; Index < CHILD_HANDLE_PROTOCOLS; Index++) {
+    BenchmarkProtocolGuid (Index, &Guids[Index]);
+  }
+
+  Status = EFI_SUCCESS;
+  Start  = GetPerformanceCounter ();
+  for (Child = 0; Child < Count && !EFI_ERROR (Status); Child++) {
+    for (Index = 0; Index < CHILD_HANDLE_PROTOCOLS && !EFI_ERROR (Status); Index++) {
+      Status = gBS->InstallProtocolInterface (&Handles[Child], &Guids[Index], EFI_NATIVE_INTERFACE, &Guids[Index]);
+    }
+  }
+
+  End = GetPerformanceCounter ();
+  UninstallChildHandles (Handles, Count, Guids);
+  if (EFI_ERROR (Status)) {
+    goto Done;
+  }
+
+  BenchmarkReport (L"InstallProtocolInterface x6 per child", Count, Start, End);
+
+  Start = GetPerformanceCounter ();
+  for (Child = 0; Child < Count; Child++) {
+    Status = gBS->InstallMultipleProtocolInterfaces (
+                    &Handles[Child],
+                    &Guids[0],
+                    &Guids[0],
+                    &Guids[1],
+                    &Guids[1],
+                    &Guids[2],
+                    &Guids[2],
+                    &Guids[3],
+                    &Guids[3],
+                    &Guids[4],
+                    &Guids[4],
+                    &Guids[5],
+                    &Guids[5],
+                    NULL
+                    );
+    if (EFI_ERROR (Status)) {
+      break;
+    }
+  }
+
+  End = GetPerformanceCounter ();
+  if (EFI_ERROR (Status)) {
+    UninstallChildHandles (Handles, Count, Guids);
+    goto Done;
+  }
+
+  BenchmarkReport (L"InstallMultipleProtocolInterfaces (6) per child", Count, Start, End);
+
+  Start = GetPerformanceCounter ();
+  for (Child = 0; Child < Count; Child++) {
+    gBS->UninstallMultipleProtocolInterfaces (
+           Handles[Child],
+           &Guids[0],
+           &Guids[0],
+           &Guids[1],
+           &Guids[1],
+           &Guids[2],
+           &Guids[2],
+           &Guids[3],
+           &Guids[3],
+           &Guids[4],
+           &Guids[4],
+           &Guids[5],
+           &Guids[5],
+           NULL
+           );
+    Handles[Child] = NULL;
+  }
+
+  End = GetPerformanceCounter ();
+  BenchmarkReport (L"UninstallMultipleProtocolInterfaces (6) per child", Count, Start, End);
+
+Done:
+  FreePool (Handles);
+  return Status;
+}
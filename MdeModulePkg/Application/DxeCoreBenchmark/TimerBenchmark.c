@@ -0,0 +1,111 @@
+/** @file
+  Timer event benchmark of the DXE core benchmark application.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "DxeCoreBenchmark.h"
+
+#include <Guid/DxeCoreTimerStatistics.h>
+
+/**
+  Print the timer dispatch statistics published by the DXE core, if any.
+**/
+STATIC
+VOID
+PrintTimerStatistics (
+  VOID
+  )
+{
+  EFI_STATUS                       Status;
+  EDKII_DXE_CORE_TIMER_STATISTICS  *Statistics;
+
+  Status = EfiGetSystemConfigurationTable (&gEdkiiDxeCoreTimerStatisticsGuid, (VOID **)&Statistics);
+  if (EFI_ERROR (Status)) {
+    Print (L"  Timer statistics not available\n");
+    return;
+  }
+
+  Print (L"  Timers armed     %Lu\n", Statistics->ArmedCount);
+  Print (L"  Timers fired     %Lu\n", Statistics->FiredCount);
+  Print (L"  Fired late       %Lu (max %Lu ns)\n", Statistics->LateCount, MultU64x32 (Statistics->MaxLateness, 100));
+  Print (L"  Queued now/peak  %Lu/%Lu\n", Statistics->QueuedTimers, Statistics->PeakQueuedTimers);
+}
+
+/**
+  Measure SetTimer() with many armed timers, as created by network stacks.
+
+  @param[in] Count    Number of timer events to create.
+
+  @retval EFI_SUCCESS           The benchmark completed.
+  @retval others                The benchmark could not be completed.
+**/
+EFI_STATUS
+TimerBenchmark (
+  IN UINTN  Count
+  )
+{
+  EFI_STATUS  Status;
+  EFI_EVENT   *Events;
+  UINTN       Index;
+  UINTN       Created;
+  UINT64      Start;
+  UINT64      End;
+
+  Events = AllocateZeroPool (Count * sizeof (EFI_EVENT));
+  if (Events == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Status = EFI_SUCCESS;
+  Start  = GetPerformanceCounter ();
+  for (Created = 0; Created < Count; Created++) {
+    Status = gBS->CreateEvent (EVT_TIMER, 0, NULL, NULL, &Events[Created]);
+    if (EFI_ERROR (Status)) {
+      break;
+    }
+  }
+
+  End = GetPerformanceCounter ();
+  BenchmarkReport (L"CreateEvent (EVT_TIMER)", Created, Start, End);
+
+  if (!EFI_ERROR (Status)) {
+    //
+    // Spread the trigger times over an hour, far enough not to fire
+    //
+    Start = GetPerformanceCounter ();
+    for (Index = 0; Index < Count; Index++) {
+      gBS->SetTimer (Events[Index], TimerPeriodic, EFI_TIMER_PERIOD_SECONDS (60 + (Index * 7919) % 3600));
+    }
+
+    End = GetPerformanceCounter ();
+    BenchmarkReport (L"SetTimer (TimerPeriodic)", Count, Start, End);
+
+    Start = GetPerformanceCounter ();
+    for (Index = 0; Index < Count; Index++) {
+      gBS->SetTimer (Events[Index], TimerRelative, EFI_TIMER_PERIOD_SECONDS (60 + (Index * 104729) % 3600));
+    }
+
+    End = GetPerformanceCounter ();
+    BenchmarkReport (L"SetTimer (re-arm)", Count, Start, End);
+
+    Start = GetPerformanceCounter ();
+    for (Index = 0; Index < Count; Index++) {
+      gBS->SetTimer (Events[Index], TimerCancel, 0);
+    }
+
+    End = GetPerformanceCounter ();
+    BenchmarkReport (L"SetTimer (TimerCancel)", Count, Start, End);
+  }
+
+  for (Index = 0; Index < Created; Index++) {
+    gBS->CloseEvent (Events[Index]);
+  }
+
+  FreePool (Events);
+
+  PrintTimerStatistics ();
+  return Status;
+}
@@ -0,0 +1,224 @@
+/** @file
+  TPL benchmark of the DXE core benchmark application.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "DxeCoreBenchmark.h"
+
+#include <Guid/DxeCoreTplTrace.h>
+#include <Protocol/LoadedImage.h>
+#include <Library/PeCoffGetEntryPointLib.h>
+
+#define TPL_BENCHMARK_PAIRS_PER_COUNT  100
+#define TPL_TRACE_TOP_CALLERS          16
+
+/**
+  Find the name of the loaded image that contains an address.
+
+  @param[in] Handles      Handles with the Loaded Image protocol.
+  @param[in] HandleCount  Number of handles.
+  @param[in] Address      The address to look up.
+  @param[out] Offset      Offset of Address in the image.
+
+  @return The PDB file name of the image, or NULL if it was not found.
+**/
+STATIC
+CHAR8 *
+FindImageName (
+  IN  EFI_HANDLE  *Handles,
+  IN  UINTN       HandleCount,
+  IN  UINT64      Address,
+  OUT UINT64      *Offset
+  )
+{
+  EFI_STATUS                 Status;
+  EFI_LOADED_IMAGE_PROTOCOL  *LoadedImage;
+  UINTN                      Index;
+  CHAR8                      *PdbPath;
+  CHAR8                      *Name;
+
+  for (Index = 0; Index < HandleCount; Index++) {
+    Status = gBS->HandleProtocol (Handles[Index], &gEfiLoadedImageProtocolGuid, (VOID **)&LoadedImage);
+    if (EFI_ERROR (Status)) {
+      continue;
+    }
+
+    if ((Address < (UINTN)LoadedImage->ImageBase) ||
+        (Address >= (UINTN)LoadedImage->ImageBase + LoadedImage->ImageSize))
+    {
+      continue;
+    }
+
+    *Offset = Address - (UINTN)LoadedImage->ImageBase;
+    PdbPath = PeCoffLoaderGetPdbPointer (LoadedImage->ImageBase);
+    if (PdbPath == NULL) {
+      return NULL;
+    }
+
+    //
+    // Strip the directories from the PDB path
+    //
+    for (Name = PdbPath; *PdbPath != '\0'; PdbPath++) {
+      if ((*PdbPath == '\\') || (*PdbPath == '/')) {
+        Name = PdbPath + 1;
+      }
+    }
+
+    return Name;
+  }
+
+  return NULL;
+}
+
+/**
+  Print the callers that changed the TPL most often, as recorded by the DXE
+  core when PcdDxeCoreTplTraceEnable is TRUE.
+**/
+STATIC
+VOID
+PrintTplTrace (
+  VOID
+  )
+{
+  EFI_STATUS                      Status;
+  EDKII_DXE_CORE_TPL_TRACE        *Trace;
+  EDKII_DXE_CORE_TPL_TRACE_ENTRY  *Top;
+  EFI_HANDLE                      *Handles;
+  UINTN                           HandleCount;
+  UINTN                           Rank;
+  UINTN                           Index;
+  UINT64                          Total;
+  UINT64                          Last;
+  UINTN                           LastIndex;
+  UINTN                           TopIndex;
+  UINT64                          Offset;
+  CHAR8                           *Name;
+
+  Status = EfiGetSystemConfigurationTable (&gEdkiiDxeCoreTplTraceGuid, (VOID **)&Trace);
+  if (EFI_ERROR (Status)) {
+    Print (L"  TPL trace not available\n");
+    return;
+  }
+
+  Print (L"  RaiseTPL         %Lu\n", Trace->RaiseCount);
+  Print (L"  RestoreTPL       %Lu (%Lu dispatched events)\n", Trace->RestoreCount, Trace->DispatchCount);
+  Print (L"  Not recorded     %Lu\n", Trace->DroppedCount);
+
+  Status = gBS->LocateHandleBuffer (ByProtocol, &gEfiLoadedImageProtocolGuid, NULL, &HandleCount, &Handles);
+  if (EFI_ERROR (Status)) {
+    Handles     = NULL;
+    HandleCount = 0;
+  }
+
+  //
+  // Print the callers in descending order of calls, ties in table order. The
+  // table is small, so a selection pass per rank is enough.
+  //
+  Print (L"  %16s %12s %12s  %a\n", L"Caller", L"Raise", L"Restore", "Image");
+  Last      = MAX_UINT64;
+  LastIndex = 0;
+  for (Rank = 0; Rank < TPL_TRACE_TOP_CALLERS; Rank++) {
+    Top      = NULL;
+    TopIndex = 0;
+    for (Index = 0; Index < Trace->MaxCallers; Index++) {
+      Total = Trace->Entry[Index].RaiseCount + Trace->Entry[Index].RestoreCount;
+      if ((Trace->Entry[Index].Caller == 0) || (Total > Last) || ((Total == Last) && (Index <= LastIndex))) {
+        continue;
+      }
+
+      if ((Top == NULL) || (Total > Top->RaiseCount + Top->RestoreCount)) {
+        Top      = &Trace->Entry[Index];
+        TopIndex = Index;
+      }
+    }
+
+    if (Top == NULL) {
+      break;
+    }
+
+    Last      = Top->RaiseCount + Top->RestoreCount;
+    LastIndex = TopIndex;
+    Offset    = 0;
+    Name      = FindImageName (Handles, HandleCount, Top->Caller, &Offset);
+    Print (
+      L"  %16Lx %12Lu %12Lu  %a+0x%Lx\n",
+      Top->Caller,
+      Top->RaiseCount,
+      Top->RestoreCount,
+      (Name == NULL) ? "?" : Name,
+      Offset
+      );
+  }
+
+  if (Handles != NULL) {
+    FreePool (Handles);
+  }
+}
+
+/**
+  Measure RaiseTPL()/RestoreTPL() pairs and SignalEvent() on an event that is
+  already signaled, then print the TPL trace of the DXE core.
+
+  @param[in] Count    Number of operations, in hundreds.
+
+  @retval EFI_SUCCESS           The benchmark completed.
+  @retval others                The benchmark could not be completed.
+**/
+EFI_STATUS
+TplBenchmark (
+  IN UINTN  Count
+  )
+{
+  EFI_STATUS  Status;
+  EFI_EVENT   Event;
+  EFI_TPL     OldTpl;
+  UINTN       Pairs;
+  UINTN       Index;
+  UINT64      Start;
+  UINT64      End;
+
+  Pairs = Count * TPL_BENCHMARK_PAIRS_PER_COUNT;
+
+  Start = GetPerformanceCounter ();
+  for (Index = 0; Index < Pairs; Index++) {
+    OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+    gBS->RestoreTPL (OldTpl);
+  }
+
+  End = GetPerformanceCounter ();
+  BenchmarkReport (L"RaiseTPL/RestoreTPL (NOTIFY)", Pairs, Start, End);
+
+  Start = GetPerformanceCounter ();
+  for (Index = 0; Index < Pairs; Index++) {
+    OldTpl = gBS->RaiseTPL (TPL_HIGH_LEVEL);
+    gBS->RestoreTPL (OldTpl);
+  }
+
+  End = GetPerformanceCounter ();
+  BenchmarkReport (L"RaiseTPL/RestoreTPL (HIGH)", Pairs, Start, End);
+
+  //
+  // A wait event stays signaled until it is checked
+  //
+  Status = gBS->CreateEvent (0, 0, NULL, NULL, &Event);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  gBS->SignalEvent (Event);
+  Start = GetPerformanceCounter ();
+  for (Index = 0; Index < Pairs; Index++) {
+    gBS->SignalEvent (Event);
+  }
+
+  End = GetPerformanceCounter ();
+  BenchmarkReport (L"SignalEvent (already signaled)", Pairs, Start, End);
+
+  gBS->CloseEvent (Event);
+
+  PrintTplTrace ();
+  return EFI_SUCCESS;
+}
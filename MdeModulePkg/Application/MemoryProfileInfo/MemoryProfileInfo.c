@@ -638,6 +638,62 @@ DumpMemoryProfileMemoryRange (
   return (VOID *)Descriptor;
 }
 
+/**
+  Dump memory profile pool slab information.
+
+  @param[in] PoolSlab           Pointer to memory profile pool slab.
+
+  @return Pointer to the end of memory profile pool slab buffer.
+
+**/
+VOID *
+DumpMemoryProfilePoolSlab (
+  IN MEMORY_PROFILE_POOL_SLAB  *PoolSlab
+  )
+{
+  MEMORY_PROFILE_POOL_SLAB_CLASS  *SlabClass;
+  UINTN                           ClassIndex;
+  UINT64                          AllocationRate;
+
+  if (PoolSlab->Header.Signature != MEMORY_PROFILE_POOL_SLAB_SIGNATURE) {
+    return NULL;
+  }
+
+  //
+  // SystemTime is in 100ns units
+  //
+  AllocationRate = 0;
+  if (PoolSlab->SystemTime != 0) {
+    AllocationRate = DivU64x64Remainder (MultU64x32 (PoolSlab->TotalAllocationCount, 10000000), PoolSlab->SystemTime, NULL);
+  }
+
+  Print (L"MEMORY_PROFILE_POOL_SLAB\n");
+  Print (L"  Signature                     - 0x%08x\n", PoolSlab->Header.Signature);
+  Print (L"  Length                        - 0x%04x\n", PoolSlab->Header.Length);
+  Print (L"  Revision                      - 0x%04x\n", PoolSlab->Header.Revision);
+  Print (L"  SlabClassCount                - 0x%08x\n", PoolSlab->SlabClassCount);
+  Print (L"  TotalAllocationCount          - 0x%016lx\n", PoolSlab->TotalAllocationCount);
+  Print (L"  TotalFreeCount                - 0x%016lx\n", PoolSlab->TotalFreeCount);
+  Print (L"  CurrentSlabPages              - 0x%016lx\n", PoolSlab->CurrentSlabPages);
+  Print (L"  PeakSlabPages                 - 0x%016lx\n", PoolSlab->PeakSlabPages);
+  Print (L"  BytesSaved                    - 0x%016lx\n", PoolSlab->BytesSaved);
+  Print (L"  SystemTime                    - 0x%016lx\n", PoolSlab->SystemTime);
+  Print (L"  AllocationsPerSecond          - %Lu\n", AllocationRate);
+
+  SlabClass = (MEMORY_PROFILE_POOL_SLAB_CLASS *)(PoolSlab + 1);
+  for (ClassIndex = 0; ClassIndex < PoolSlab->SlabClassCount; ClassIndex++) {
+    Print (L"  MEMORY_PROFILE_POOL_SLAB_CLASS[%d]\n", ClassIndex);
+    Print (L"    ObjectSize                  - 0x%08x\n", SlabClass[ClassIndex].ObjectSize);
+    Print (L"    AllocationCount             - 0x%016lx\n", SlabClass[ClassIndex].AllocationCount);
+    Print (L"    FreeCount                   - 0x%016lx\n", SlabClass[ClassIndex].FreeCount);
+    Print (L"    CurrentObjects              - 0x%016lx\n", SlabClass[ClassIndex].CurrentObjects);
+    Print (L"    CurrentPages                - 0x%016lx\n", SlabClass[ClassIndex].CurrentPages);
+    Print (L"    BytesSaved                  - 0x%016lx\n", SlabClass[ClassIndex].BytesSaved);
+  }
+
+  return (VOID *)((UINTN)PoolSlab + PoolSlab->Header.Length);
+}
+
 /**
   Scan memory profile by Signature.
 
@@ -698,6 +754,7 @@ DumpMemoryProfile (
   MEMORY_PROFILE_CONTEXT       *Context;
   MEMORY_PROFILE_FREE_MEMORY   *FreeMemory;
   MEMORY_PROFILE_MEMORY_RANGE  *MemoryRange;
+  MEMORY_PROFILE_POOL_SLAB     *PoolSlab;
 
   Context = (MEMORY_PROFILE_CONTEXT *)ScanMemoryProfileBySignature (ProfileBuffer, ProfileSize, MEMORY_PROFILE_CONTEXT_SIGNATURE);
   if (Context != NULL) {
@@ -713,6 +770,11 @@ DumpMemoryProfile (
   if (MemoryRange != NULL) {
     DumpMemoryProfileMemoryRange (MemoryRange);
   }
+
+  PoolSlab = (MEMORY_PROFILE_POOL_SLAB *)ScanMemoryProfileBySignature (ProfileBuffer, ProfileSize, MEMORY_PROFILE_POOL_SLAB_SIGNATURE);
+  if (PoolSlab != NULL) {
+    DumpMemoryProfilePoolSlab (PoolSlab);
+  }
 }
 
 /**
@@ -1009,22 +1009,24 @@ NvmExpressDriverBindingStart (
     // 4th 4kB boundary is the start of I/O completion queue #1.
     // 5th 4kB boundary is the start of I/O submission queue #2.
     // 6th 4kB boundary is the start of I/O completion queue #2.
+    // The submission & completion queues of the read queue pairs follow.
     //
-    // Allocate 6 pages of memory, then map it for bus master read and write.
+    // Allocate the pages of memory, then map it for bus master read and write.
     //
-    Status = PciIo->AllocateBuffer (
-                      PciIo,
-                      AllocateAnyPages,
-                      EfiBootServicesData,
-                      6,
-                      (VOID **)&Private->Buffer,
-                      0
-                      );
+    Private->BufferPages = 6 + NvmeReadQueueBufferPages ();
+    Status               = PciIo->AllocateBuffer (
+                                    PciIo,
+                                    AllocateAnyPages,
+                                    EfiBootServicesData,
+                                    Private->BufferPages,
+                                    (VOID **)&Private->Buffer,
+                                    0
+                                    );
     if (EFI_ERROR (Status)) {
       goto Exit;
     }
 
-    Bytes  = EFI_PAGES_TO_SIZE (6);
+    Bytes  = EFI_PAGES_TO_SIZE (Private->BufferPages);
     Status = PciIo->Map (
                       PciIo,
                       EfiPciIoOperationBusMasterCommonBuffer,
@@ -1034,7 +1036,7 @@ NvmExpressDriverBindingStart (
                       &Private->Mapping
                       );
 
-    if (EFI_ERROR (Status) || (Bytes != EFI_PAGES_TO_SIZE (6))) {
+    if (EFI_ERROR (Status) || (Bytes != EFI_PAGES_TO_SIZE (Private->BufferPages))) {
       goto Exit;
     }
 
@@ -1144,7 +1146,7 @@ Exit:
   }
 
   if ((Private != NULL) && (Private->Buffer != NULL)) {
-    PciIo->FreeBuffer (PciIo, 6, Private->Buffer);
+    PciIo->FreeBuffer (PciIo, Private->BufferPages, Private->Buffer);
   }
 
   if ((Private != NULL) && (Private->ControllerData != NULL)) {
@@ -1156,6 +1158,8 @@ Exit:
       gBS->CloseEvent (Private->TimerEvent);
     }
 
+    NvmeReadQueueFree (Private);
+
     FreePool (Private);
   }
 
@@ -1266,9 +1270,10 @@ NvmExpressDriverBindingStop (
       }
 
       if (Private->Buffer != NULL) {
-        Private->PciIo->FreeBuffer (Private->PciIo, 6, Private->Buffer);
+        Private->PciIo->FreeBuffer (Private->PciIo, Private->BufferPages, Private->Buffer);
       }
 
+      NvmeReadQueueFree (Private);
       FreePool (Private->ControllerData);
       FreePool (Private);
     }
@@ -40,6 +40,9 @@
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/UefiDriverEntryPoint.h>
 #include <Library/ReportStatusCodeLib.h>
+#include <Library/PcdLib.h>
+#include <Library/TimerLib.h>
+#include <Library/PerformanceLib.h>
 
 typedef struct _NVME_CONTROLLER_PRIVATE_DATA  NVME_CONTROLLER_PRIVATE_DATA;
 typedef struct _NVME_DEVICE_PRIVATE_DATA      NVME_DEVICE_PRIVATE_DATA;
@@ -47,6 +50,7 @@ typedef struct _NVME_DEVICE_PRIVATE_DATA      NVME_DEVICE_PRIVATE_DATA;
 #include "NvmExpressBlockIo.h"
 #include "NvmExpressDiskInfo.h"
 #include "NvmExpressHci.h"
+#include "NvmExpressReadQueue.h"
 
 extern EFI_DRIVER_BINDING_PROTOCOL                gNvmExpressDriverBinding;
 extern EFI_COMPONENT_NAME_PROTOCOL                gNvmExpressComponentName;
@@ -73,7 +77,7 @@ extern EFI_DRIVER_SUPPORTED_EFI_VERSION_PROTOCOL  gNvmExpressDriverSupportedEfiV
 //
 #define NVME_ASYNC_CCQ_SIZE  255
 
-#define NVME_MAX_QUEUES  3                              // Number of queues supported by the driver
+#define NVME_MAX_QUEUES  (NVME_READ_QUEUE_ID + NVME_MAX_READ_QUEUES)   // Number of queues supported by the driver
 
 #define NVME_CONTROLLER_ID  0
 
@@ -123,9 +127,11 @@ struct _NVME_CONTROLLER_PRIVATE_DATA {
   // 4th 4kB boundary is the start of I/O completion queue #1.
   // 5th 4kB boundary is the start of I/O submission queue #2.
   // 6th 4kB boundary is the start of I/O completion queue #2.
+  // The submission & completion queues of the read queue pairs follow.
   //
   UINT8          *Buffer;
   UINT8          *BufferPciAddr;
+  UINTN          BufferPages;
 
   //
   // Pointers to 4kB aligned submission & completion queues.
@@ -150,6 +156,14 @@ struct _NVME_CONTROLLER_PRIVATE_DATA {
   UINT8          Pt[NVME_MAX_QUEUES];
   UINT16         Cid[NVME_MAX_QUEUES];
 
+  //
+  // Read queue pairs, created from queue ID NVME_READ_QUEUE_ID on.
+  // ReadQueueSize is the number of entries of each queue, which is 1-based.
+  //
+  UINT16             ReadQueueNum;
+  UINT16             ReadQueueSize;
+  NVME_READ_QUEUE    ReadQueue[NVME_MAX_READ_QUEUES];
+
   //
   // Nvme controller capabilities
   //
@@ -721,6 +735,45 @@ NvmeDumpStatus (
   IN NVME_CQ  *Cq
   );
 
+/**
+  Create PRP lists for data transfer which is larger than 2 memory pages.
+
+  @param[in]     PciIo               A pointer to the EFI_PCI_IO_PROTOCOL instance.
+  @param[in]     PhysicalAddr        The physical base address of data buffer.
+  @param[in]     Pages               The number of pages to be transfered.
+  @param[out]    PrpListHost         The host base address of PRP lists.
+  @param[in,out] PrpListNo           The number of PRP List.
+  @param[out]    Mapping             The mapping value returned from PciIo.Map().
+
+  @retval The pointer to the first PRP List of the PRP lists.
+
+**/
+VOID *
+NvmeCreatePrpList (
+  IN     EFI_PCI_IO_PROTOCOL   *PciIo,
+  IN     EFI_PHYSICAL_ADDRESS  PhysicalAddr,
+  IN     UINTN                 Pages,
+  OUT VOID                     **PrpListHost,
+  IN OUT UINTN                 *PrpListNo,
+  OUT VOID                     **Mapping
+  );
+
+/**
+  Reset the NVMe controller after an NVMe command timed out, to abort the
+  outstanding commands.
+
+  @param[in] Private        The pointer to the NVME_CONTROLLER_PRIVATE_DATA
+                            data structure.
+
+  @retval EFI_TIMEOUT       The controller is reset.
+  @retval Others            Fail to reset the controller.
+
+**/
+EFI_STATUS
+NvmeResetControllerOnTimeout (
+  IN NVME_CONTROLLER_PRIVATE_DATA  *Private
+  );
+
 /**
   Register the shutdown notification through the ResetNotification protocol.
 
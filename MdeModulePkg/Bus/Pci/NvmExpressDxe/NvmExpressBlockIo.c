@@ -166,6 +166,7 @@ NvmeRead (
   NVME_CONTROLLER_PRIVATE_DATA  *Private;
   UINT32                        MaxTransferBlocks;
   UINTN                         OrginalBlocks;
+  UINTN                         BlocksRead;
   BOOLEAN                       IsEmpty;
   EFI_TPL                       OldTpl;
 
@@ -195,7 +196,26 @@ NvmeRead (
     MaxTransferBlocks = 1024;
   }
 
-  while (Blocks > 0) {
+  if ((Private->ReadQueueNum != 0) && (Blocks > MaxTransferBlocks)) {
+    //
+    // Keep the read commands of a large read in flight at the same time.
+    //
+    Status = NvmeReadQueued (Device, Buffer, Lba, Blocks, MaxTransferBlocks, &BlocksRead);
+    if (!EFI_ERROR (Status)) {
+      Blocks = 0;
+    } else if (Status == EFI_OUT_OF_RESOURCES) {
+      //
+      // The buffer could not be mapped for many commands at once, read the
+      // rest of it one command at a time.
+      //
+      Blocks -= BlocksRead;
+      Buffer  = (VOID *)(UINTN)((UINT64)(UINTN)Buffer + MultU64x32 (BlocksRead, BlockSize));
+      Lba    += BlocksRead;
+      Status  = EFI_SUCCESS;
+    }
+  }
+
+  while (!EFI_ERROR (Status) && (Blocks > 0)) {
     if (Blocks > MaxTransferBlocks) {
       Status = ReadSectors (Device, (UINT64)(UINTN)Buffer, Lba, MaxTransferBlocks);
 
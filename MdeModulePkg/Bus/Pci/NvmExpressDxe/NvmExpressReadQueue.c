@@ -0,0 +1,706 @@
+/** @file
+  Queued read path of the NvmExpressDxe driver.
+
+  The blocking I/O queue pair only holds one command, so a large read split into
+  MaxTransferBlocks sized commands waits for every command in turn. The queued
+  read path places those commands on several deep read queue pairs instead, rings
+  each submission queue doorbell once for all the commands placed on it, and
+  reaps the completions of all the read queues in one pass.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "NvmExpress.h"
+
+#define NVME_READ_SQ_PAGES(Size)  EFI_SIZE_TO_PAGES ((Size) * sizeof (NVME_SQ))
+#define NVME_READ_CQ_PAGES(Size)  EFI_SIZE_TO_PAGES ((Size) * sizeof (NVME_CQ))
+
+/**
+  Get the number of read queue pairs and the number of entries of each read
+  queue configured by the platform.
+
+  @param[out] QueueNum        The number of read queue pairs.
+  @param[out] QueueSize       The number of entries of each read queue.
+
+**/
+STATIC
+VOID
+NvmeReadQueueConfig (
+  OUT UINT16  *QueueNum,
+  OUT UINT16  *QueueSize
+  )
+{
+  *QueueNum  = MIN (PcdGet8 (PcdNvmeReadQueuePairs), NVME_MAX_READ_QUEUES);
+  *QueueSize = MIN (PcdGet16 (PcdNvmeReadQueueDepth), NVME_MAX_READ_QUEUE_SIZE);
+
+  //
+  // One entry of a queue is always left empty.
+  //
+  if (*QueueSize < 2) {
+    *QueueNum = 0;
+  }
+}
+
+/**
+  Get the number of pages that the read queues add to the queue buffer of a
+  controller.
+
+  @return The number of pages of the read queues.
+
+**/
+UINTN
+NvmeReadQueueBufferPages (
+  VOID
+  )
+{
+  UINT16  QueueNum;
+  UINT16  QueueSize;
+
+  NvmeReadQueueConfig (&QueueNum, &QueueSize);
+
+  return QueueNum * (NVME_READ_SQ_PAGES (QueueSize) + NVME_READ_CQ_PAGES (QueueSize));
+}
+
+/**
+  Release the resources of a read command.
+
+  @param[in]      PciIo       A pointer to the EFI_PCI_IO_PROTOCOL instance.
+  @param[in, out] Command     The read command.
+
+**/
+STATIC
+VOID
+NvmeReadCommandRelease (
+  IN     EFI_PCI_IO_PROTOCOL  *PciIo,
+  IN OUT NVME_READ_COMMAND    *Command
+  )
+{
+  if (Command->MapData != NULL) {
+    PciIo->Unmap (PciIo, Command->MapData);
+  }
+
+  if (Command->MapPrpList != NULL) {
+    PciIo->Unmap (PciIo, Command->MapPrpList);
+  }
+
+  if (Command->PrpListHost != NULL) {
+    PciIo->FreeBuffer (PciIo, Command->PrpListNo, Command->PrpListHost);
+  }
+
+  ZeroMem (Command, sizeof (NVME_READ_COMMAND));
+}
+
+/**
+  Free the command tables of the read queues of a controller.
+
+  @param[in] Private          The pointer to the NVME_CONTROLLER_PRIVATE_DATA data structure.
+
+**/
+VOID
+NvmeReadQueueFree (
+  IN NVME_CONTROLLER_PRIVATE_DATA  *Private
+  )
+{
+  UINT16  Index;
+
+  for (Index = 0; Index < NVME_MAX_READ_QUEUES; Index++) {
+    if (Private->ReadQueue[Index].Command != NULL) {
+      FreePool (Private->ReadQueue[Index].Command);
+      Private->ReadQueue[Index].Command = NULL;
+    }
+
+    if (Private->ReadQueue[Index].FreeCid != NULL) {
+      FreePool (Private->ReadQueue[Index].FreeCid);
+      Private->ReadQueue[Index].FreeCid = NULL;
+    }
+  }
+
+  Private->ReadQueueNum = 0;
+}
+
+/**
+  Set up the read queues of a controller, before the I/O queues are created.
+
+  The read commands still in flight are released, so the controller must be
+  disabled since they were submitted. The read queues are disabled if the
+  controller does not grant enough I/O queues.
+
+  @param[in] Private          The pointer to the NVME_CONTROLLER_PRIVATE_DATA data structure.
+
+  @retval EFI_SUCCESS          The read queues are set up or disabled.
+  @retval EFI_OUT_OF_RESOURCES The command tables could not be allocated.
+
+**/
+EFI_STATUS
+NvmeReadQueueInit (
+  IN NVME_CONTROLLER_PRIVATE_DATA  *Private
+  )
+{
+  EFI_NVM_EXPRESS_PASS_THRU_COMMAND_PACKET  CommandPacket;
+  EFI_NVM_EXPRESS_COMMAND                   Command;
+  EFI_NVM_EXPRESS_COMPLETION                Completion;
+  NVME_ADMIN_SET_FEATURES                   SetFeatures;
+  EFI_STATUS                                Status;
+  NVME_READ_QUEUE                           *Queue;
+  UINT16                                    QueueNum;
+  UINT16                                    QueueSize;
+  UINT16                                    Index;
+  UINT16                                    Cid;
+  UINTN                                     Offset;
+  UINT32                                    Granted;
+
+  Private->ReadQueueNum = 0;
+
+  NvmeReadQueueConfig (&QueueNum, &QueueSize);
+  if (QueueNum == 0) {
+    return EFI_SUCCESS;
+  }
+
+  Private->ReadQueueSize = (UINT16)MIN (QueueSize, (UINT32)Private->Cap.Mqes + 1);
+  if (Private->ReadQueueSize < 2) {
+    return EFI_SUCCESS;
+  }
+
+  //
+  // The read queues follow the 6 pages of the admin and I/O queues.
+  //
+  Offset = EFI_PAGES_TO_SIZE (6);
+  for (Index = 0; Index < QueueNum; Index++) {
+    Queue = &Private->ReadQueue[Index];
+
+    //
+    // The command tables are allocated once and kept across controller resets.
+    //
+    if (Queue->Command == NULL) {
+      Queue->Command = AllocateZeroPool (QueueSize * sizeof (NVME_READ_COMMAND));
+      Queue->FreeCid = AllocatePool (QueueSize * sizeof (UINT16));
+      if ((Queue->Command == NULL) || (Queue->FreeCid == NULL)) {
+        NvmeReadQueueFree (Private);
+        return EFI_OUT_OF_RESOURCES;
+      }
+    }
+
+    //
+    // Release the commands that were in flight when the controller was reset.
+    //
+    for (Cid = 0; Cid < QueueSize; Cid++) {
+      if (Queue->Command[Cid].InUse) {
+        NvmeReadCommandRelease (Private->PciIo, &Queue->Command[Cid]);
+      }
+    }
+
+    //
+    // At most ReadQueueSize - 1 commands are in flight on a queue, so neither
+    // the submission queue nor the completion queue can overflow.
+    //
+    Queue->FreeNum = 0;
+    for (Cid = Private->ReadQueueSize - 1; Cid > 0; Cid--) {
+      Queue->FreeCid[Queue->FreeNum++] = Cid - 1;
+    }
+
+    Queue->Pending = FALSE;
+
+    Private->SqBuffer[NVME_READ_QUEUE_ID + Index]        = (NVME_SQ *)(UINTN)(Private->Buffer + Offset);
+    Private->SqBufferPciAddr[NVME_READ_QUEUE_ID + Index] = (NVME_SQ *)(UINTN)(Private->BufferPciAddr + Offset);
+    Offset                                              += EFI_PAGES_TO_SIZE (NVME_READ_SQ_PAGES (QueueSize));
+    Private->CqBuffer[NVME_READ_QUEUE_ID + Index]        = (NVME_CQ *)(UINTN)(Private->Buffer + Offset);
+    Private->CqBufferPciAddr[NVME_READ_QUEUE_ID + Index] = (NVME_CQ *)(UINTN)(Private->BufferPciAddr + Offset);
+    Offset                                              += EFI_PAGES_TO_SIZE (NVME_READ_CQ_PAGES (QueueSize));
+  }
+
+  //
+  // Request the read queue pairs on top of the two I/O queue pairs. The counts
+  // of the Number of Queues feature are 0-based.
+  //
+  ZeroMem (&CommandPacket, sizeof (EFI_NVM_EXPRESS_PASS_THRU_COMMAND_PACKET));
+  ZeroMem (&Command, sizeof (EFI_NVM_EXPRESS_COMMAND));
+  ZeroMem (&Completion, sizeof (EFI_NVM_EXPRESS_COMPLETION));
+  ZeroMem (&SetFeatures, sizeof (NVME_ADMIN_SET_FEATURES));
+
+  CommandPacket.NvmeCmd        = &Command;
+  CommandPacket.NvmeCompletion = &Completion;
+  CommandPacket.CommandTimeout = NVME_GENERIC_TIMEOUT;
+  CommandPacket.QueueType      = NVME_ADMIN_QUEUE;
+
+  Command.Cdw0.Opcode = NVME_ADMIN_SET_FEATURES_CMD;
+  SetFeatures.Fid     = NVME_FEATURE_NUMBER_OF_QUEUES;
+  CopyMem (&Command.Cdw10, &SetFeatures, sizeof (NVME_ADMIN_SET_FEATURES));
+  Command.Cdw11 = ((UINT32)(QueueNum + 1) << 16) | (UINT32)(QueueNum + 1);
+  Command.Flags = CDW10_VALID | CDW11_VALID;
+
+  Status = Private->Passthru.PassThru (
+                               &Private->Passthru,
+                               0,
+                               &CommandPacket,
+                               NULL
+                               );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_WARN, "NvmeReadQueueInit: Number of Queues not set (%r), read queues disabled\n", Status));
+    return EFI_SUCCESS;
+  }
+
+  Granted = MIN (Completion.DW0 & 0xFFFF, Completion.DW0 >> 16) + 1;
+  if (Granted > 2) {
+    Private->ReadQueueNum = (UINT16)MIN (QueueNum, Granted - 2);
+  }
+
+  DEBUG ((
+    DEBUG_INFO,
+    "NvmeReadQueueInit: %d read queue pairs of %d entries\n",
+    Private->ReadQueueNum,
+    Private->ReadQueueSize
+    ));
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Place a read command in a read submission queue. The doorbell of the queue is
+  rung by NvmeReadQueueRing().
+
+  @param  Device                 The pointer to the NVME_DEVICE_PRIVATE_DATA data structure.
+  @param  QueueIndex             The index of the read queue pair, which has a free command ID.
+  @param  Buffer                 The buffer used to store the data read from the device.
+  @param  Lba                    The start block number.
+  @param  Blocks                 Total block number to be read.
+
+  @retval EFI_SUCCESS            The read command is placed in the submission queue.
+  @retval EFI_OUT_OF_RESOURCES   The buffer or its PRP list could not be mapped.
+
+**/
+STATIC
+EFI_STATUS
+NvmeReadQueueSubmit (
+  IN  NVME_DEVICE_PRIVATE_DATA  *Device,
+  IN  UINT16                    QueueIndex,
+  OUT VOID                      *Buffer,
+  IN  UINT64                    Lba,
+  IN  UINT32                    Blocks
+  )
+{
+  NVME_CONTROLLER_PRIVATE_DATA  *Private;
+  EFI_PCI_IO_PROTOCOL           *PciIo;
+  NVME_READ_QUEUE               *Queue;
+  NVME_READ_COMMAND             *Command;
+  NVME_SQ                       *Sq;
+  UINT16                        QueueId;
+  UINT16                        Cid;
+  UINT32                        Bytes;
+  UINTN                         Offset;
+  UINTN                         MapLength;
+  EFI_PHYSICAL_ADDRESS          PhyAddr;
+  VOID                          *Prp;
+  EFI_STATUS                    Status;
+
+  Private = Device->Controller;
+  PciIo   = Private->PciIo;
+  QueueId = NVME_READ_QUEUE_ID + QueueIndex;
+  Queue   = &Private->ReadQueue[QueueIndex];
+  Bytes   = Blocks * Device->Media.BlockSize;
+
+  ASSERT (Queue->FreeNum != 0);
+  Cid     = Queue->FreeCid[Queue->FreeNum - 1];
+  Command = &Queue->Command[Cid];
+
+  MapLength = Bytes;
+  Status    = PciIo->Map (
+                       PciIo,
+                       EfiPciIoOperationBusMasterWrite,
+                       Buffer,
+                       &MapLength,
+                       &PhyAddr,
+                       &Command->MapData
+                       );
+  if (EFI_ERROR (Status) || (MapLength != Bytes)) {
+    if (!EFI_ERROR (Status)) {
+      PciIo->Unmap (PciIo, Command->MapData);
+    }
+
+    Command->MapData = NULL;
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Sq = Private->SqBuffer[QueueId] + Private->SqTdbl[QueueId].Sqt;
+  ZeroMem (Sq, sizeof (NVME_SQ));
+  Sq->Opc    = NVME_IO_READ_OPC;
+  Sq->Cid    = Cid;
+  Sq->Nsid   = Device->NamespaceId;
+  Sq->Prp[0] = PhyAddr;
+
+  //
+  // If the buffer size spans more than two memory pages, then build a PRP
+  // list in the second PRP submission queue entry.
+  //
+  Offset = (UINTN)PhyAddr & (EFI_PAGE_SIZE - 1);
+  if ((Offset + Bytes) > (EFI_PAGE_SIZE * 2)) {
+    Prp = NvmeCreatePrpList (
+            PciIo,
+            (PhyAddr + EFI_PAGE_SIZE) & ~(EFI_PAGE_SIZE - 1),
+            EFI_SIZE_TO_PAGES (Offset + Bytes) - 1,
+            &Command->PrpListHost,
+            &Command->PrpListNo,
+            &Command->MapPrpList
+            );
+    if (Prp == NULL) {
+      //
+      // NvmeCreatePrpList() frees the PRP lists on failure.
+      //
+      Command->PrpListHost = NULL;
+      Command->MapPrpList  = NULL;
+      NvmeReadCommandRelease (PciIo, Command);
+      return EFI_OUT_OF_RESOURCES;
+    }
+
+    Sq->Prp[1] = (UINT64)(UINTN)Prp;
+  } else if ((Offset + Bytes) > EFI_PAGE_SIZE) {
+    Sq->Prp[1] = (PhyAddr + EFI_PAGE_SIZE) & ~(EFI_PAGE_SIZE - 1);
+  }
+
+  Sq->Payload.Raw.Cdw10 = (UINT32)Lba;
+  Sq->Payload.Raw.Cdw11 = (UINT32)RShiftU64 (Lba, 32);
+  Sq->Payload.Raw.Cdw12 = (Blocks - 1) & 0xFFFF;
+
+  Command->InUse = TRUE;
+  Queue->FreeNum--;
+  Queue->Pending = TRUE;
+
+  Private->SqTdbl[QueueId].Sqt = (Private->SqTdbl[QueueId].Sqt + 1) % Private->ReadQueueSize;
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Ring the doorbell of every read submission queue that has new commands.
+
+  @param[in] Private          The pointer to the NVME_CONTROLLER_PRIVATE_DATA data structure.
+
+  @retval EFI_SUCCESS          The doorbells are rung.
+  @retval Others               A doorbell could not be written.
+
+**/
+STATIC
+EFI_STATUS
+NvmeReadQueueRing (
+  IN NVME_CONTROLLER_PRIVATE_DATA  *Private
+  )
+{
+  EFI_STATUS  Status;
+  UINT16      Index;
+  UINT16      QueueId;
+  UINT32      Data;
+
+  for (Index = 0; Index < Private->ReadQueueNum; Index++) {
+    if (!Private->ReadQueue[Index].Pending) {
+      continue;
+    }
+
+    Private->ReadQueue[Index].Pending = FALSE;
+
+    QueueId = NVME_READ_QUEUE_ID + Index;
+    Data    = ReadUnaligned32 ((UINT32 *)&Private->SqTdbl[QueueId]);
+    Status  = Private->PciIo->Mem.Write (
+                                    Private->PciIo,
+                                    EfiPciIoWidthUint32,
+                                    NVME_BAR,
+                                    NVME_SQTDBL_OFFSET (QueueId, Private->Cap.Dstrd),
+                                    1,
+                                    &Data
+                                    );
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Reap the completions of all the read queues, and ring the doorbell of every
+  read completion queue once.
+
+  @param[in]      Private     The pointer to the NVME_CONTROLLER_PRIVATE_DATA data structure.
+  @param[in, out] Status      Set to EFI_DEVICE_ERROR if a read command failed
+                              and no error was recorded before.
+
+  @return The number of read commands that completed.
+
+**/
+STATIC
+UINTN
+NvmeReadQueueReap (
+  IN     NVME_CONTROLLER_PRIVATE_DATA  *Private,
+  IN OUT EFI_STATUS                    *Status
+  )
+{
+  NVME_READ_QUEUE  *Queue;
+  NVME_CQ          *Cq;
+  UINT16           Index;
+  UINT16           QueueId;
+  UINT32           Data;
+  BOOLEAN          HasNewItem;
+  UINTN            Reaped;
+  EFI_STATUS       WriteStatus;
+
+  Reaped = 0;
+
+  for (Index = 0; Index < Private->ReadQueueNum; Index++) {
+    Queue      = &Private->ReadQueue[Index];
+    QueueId    = NVME_READ_QUEUE_ID + Index;
+    Cq         = Private->CqBuffer[QueueId] + Private->CqHdbl[QueueId].Cqh;
+    HasNewItem = FALSE;
+
+    while (Cq->Pt != Private->Pt[QueueId]) {
+      ASSERT (Cq->Sqid == QueueId);
+
+      HasNewItem = TRUE;
+
+      if ((Cq->Cid < Private->ReadQueueSize) && Queue->Command[Cq->Cid].InUse) {
+        if ((Cq->Sct != 0) || (Cq->Sc != 0)) {
+          DEBUG_CODE_BEGIN ();
+          NvmeDumpStatus (Cq);
+          DEBUG_CODE_END ();
+          if (!EFI_ERROR (*Status)) {
+            *Status = EFI_DEVICE_ERROR;
+          }
+        }
+
+        NvmeReadCommandRelease (Private->PciIo, &Queue->Command[Cq->Cid]);
+        Queue->FreeCid[Queue->FreeNum++] = Cq->Cid;
+        Reaped++;
+      } else {
+        DEBUG ((DEBUG_ERROR, "NvmeReadQueueReap: unknown command ID 0x%x on queue %d\n", Cq->Cid, QueueId));
+        if (!EFI_ERROR (*Status)) {
+          *Status = EFI_DEVICE_ERROR;
+        }
+      }
+
+      Private->CqHdbl[QueueId].Cqh++;
+      if (Private->CqHdbl[QueueId].Cqh == Private->ReadQueueSize) {
+        Private->CqHdbl[QueueId].Cqh = 0;
+        Private->Pt[QueueId]        ^= 1;
+      }
+
+      Cq = Private->CqBuffer[QueueId] + Private->CqHdbl[QueueId].Cqh;
+    }
+
+    if (HasNewItem) {
+      Data        = ReadUnaligned32 ((UINT32 *)&Private->CqHdbl[QueueId]);
+      WriteStatus = Private->PciIo->Mem.Write (
+                                          Private->PciIo,
+                                          EfiPciIoWidthUint32,
+                                          NVME_BAR,
+                                          NVME_CQHDBL_OFFSET (QueueId, Private->Cap.Dstrd),
+                                          1,
+                                          &Data
+                                          );
+      if (EFI_ERROR (WriteStatus) && !EFI_ERROR (*Status)) {
+        *Status = WriteStatus;
+      }
+    }
+  }
+
+  return Reaped;
+}
+
+/**
+  Read some blocks from the device by keeping many read commands in flight on
+  the read queues.
+
+  @param  Device                 The pointer to the NVME_DEVICE_PRIVATE_DATA data structure.
+  @param  Buffer                 The buffer used to store the data read from the device.
+  @param  Lba                    The start block number.
+  @param  Blocks                 Total block number to be read.
+  @param  MaxTransferBlocks      The maximum block number of a read command.
+  @param  BlocksRead             The number of blocks read from Lba on, when
+                                 EFI_OUT_OF_RESOURCES is returned.
+
+  @retval EFI_SUCCESS            Datum are read from the device.
+  @retval EFI_OUT_OF_RESOURCES   The buffer could not be mapped for the next
+                                 read command with no command in flight. The
+                                 blocks after BlocksRead are not read.
+  @retval Others                 Fail to read all the datum.
+
+**/
+EFI_STATUS
+NvmeReadQueued (
+  IN  NVME_DEVICE_PRIVATE_DATA  *Device,
+  OUT VOID                      *Buffer,
+  IN  UINT64                    Lba,
+  IN  UINTN                     Blocks,
+  IN  UINT32                    MaxTransferBlocks,
+  OUT UINTN                     *BlocksRead
+  )
+{
+  NVME_CONTROLLER_PRIVATE_DATA  *Private;
+  EFI_STATUS                    Status;
+  EFI_STATUS                    RingStatus;
+  EFI_EVENT                     TimerEvent;
+  UINT32                        BlockSize;
+  UINT32                        Count;
+  UINT16                        QueueIndex;
+  UINT16                        Index;
+  UINTN                         Outstanding;
+  UINTN                         Reaped;
+  UINTN                         OriginalBlocks;
+  BOOLEAN                       Progress;
+  BOOLEAN                       Starved;
+  BOOLEAN                       Measure;
+  UINT64                        Bytes;
+  UINT64                        StartTicks;
+  UINT64                        EndTicks;
+  UINT64                        CounterStart;
+  UINT64                        CounterEnd;
+  UINT64                        ElapsedNs;
+
+  Private        = Device->Controller;
+  BlockSize      = Device->Media.BlockSize;
+  Bytes          = MultU64x32 (Blocks, BlockSize);
+  TimerEvent     = NULL;
+  QueueIndex     = 0;
+  Outstanding    = 0;
+  OriginalBlocks = Blocks;
+  Progress       = FALSE;
+  Starved        = FALSE;
+  StartTicks     = 0;
+  *BlocksRead    = 0;
+
+  PERF_INMODULE_BEGIN ("NvmeReadQueued");
+
+  //
+  // Only sample the performance counter when the throughput is printed.
+  //
+  Measure = (BOOLEAN)(DebugPrintEnabled () && DebugPrintLevelEnabled (DEBUG_BLKIO));
+  if (Measure) {
+    StartTicks = GetPerformanceCounter ();
+  }
+
+  Status = gBS->CreateEvent (
+                  EVT_TIMER,
+                  TPL_CALLBACK,
+                  NULL,
+                  NULL,
+                  &TimerEvent
+                  );
+  if (EFI_ERROR (Status)) {
+    goto Exit;
+  }
+
+  Status = gBS->SetTimer (TimerEvent, TimerRelative, NVME_GENERIC_TIMEOUT);
+  if (EFI_ERROR (Status)) {
+    goto Exit;
+  }
+
+  while (TRUE) {
+    //
+    // Fill the read queues round robin, then ring each doorbell once.
+    //
+    while ((Blocks > 0) && !EFI_ERROR (Status) && !Starved) {
+      for (Index = 0; Index < Private->ReadQueueNum; Index++) {
+        if (Private->ReadQueue[QueueIndex].FreeNum != 0) {
+          break;
+        }
+
+        QueueIndex = (QueueIndex + 1) % Private->ReadQueueNum;
+      }
+
+      if (Index == Private->ReadQueueNum) {
+        break;
+      }
+
+      Count = (UINT32)MIN (Blocks, MaxTransferBlocks);
+      if (EFI_ERROR (NvmeReadQueueSubmit (Device, QueueIndex, Buffer, Lba, Count))) {
+        //
+        // The mappings of the commands in flight may be what is missing, try
+        // again once some of them complete.
+        //
+        Starved = TRUE;
+        break;
+      }
+
+      Outstanding++;
+      Blocks    -= Count;
+      Buffer     = (UINT8 *)Buffer + (UINTN)Count * BlockSize;
+      Lba       += Count;
+      QueueIndex = (QueueIndex + 1) % Private->ReadQueueNum;
+    }
+
+    RingStatus = NvmeReadQueueRing (Private);
+    if (EFI_ERROR (RingStatus) && !EFI_ERROR (Status)) {
+      Status = RingStatus;
+    }
+
+    if (Outstanding == 0) {
+      if (Starved && !EFI_ERROR (Status)) {
+        //
+        // Nothing holds a mapping anymore, let the caller read the rest one
+        // command at a time.
+        //
+        *BlocksRead = OriginalBlocks - Blocks;
+        Status      = EFI_OUT_OF_RESOURCES;
+      }
+
+      break;
+    }
+
+    Reaped = NvmeReadQueueReap (Private, &Status);
+    if (Reaped != 0) {
+      Outstanding -= Reaped;
+      Progress     = TRUE;
+      Starved      = FALSE;
+      continue;
+    }
+
+    //
+    // The timeout covers the time in which no read command completes, so it
+    // is restarted when it expires after a completion.
+    //
+    if (!EFI_ERROR (gBS->CheckEvent (TimerEvent))) {
+      if (Progress) {
+        Progress = FALSE;
+        gBS->SetTimer (TimerEvent, TimerRelative, NVME_GENERIC_TIMEOUT);
+        continue;
+      }
+
+      DEBUG ((DEBUG_ERROR, "NvmeReadQueued: Timeout occurs for an NVMe read command.\n"));
+
+      //
+      // The reset releases the read commands in flight.
+      //
+      Status = NvmeResetControllerOnTimeout (Private);
+      if (Status != EFI_TIMEOUT) {
+        Private->ReadQueueNum = 0;
+      }
+
+      break;
+    }
+  }
+
+Exit:
+  if (TimerEvent != NULL) {
+    gBS->CloseEvent (TimerEvent);
+  }
+
+  PERF_INMODULE_END ("NvmeReadQueued");
+
+  if (Measure && !EFI_ERROR (Status)) {
+    EndTicks = GetPerformanceCounter ();
+    GetPerformanceCounterProperties (&CounterStart, &CounterEnd);
+    if (CounterStart < CounterEnd) {
+      ElapsedNs = GetTimeInNanoSecond (EndTicks - StartTicks);
+    } else {
+      ElapsedNs = GetTimeInNanoSecond (StartTicks - EndTicks);
+    }
+
+    DEBUG ((
+      DEBUG_BLKIO,
+      "NvmeReadQueued: 0x%Lx bytes in %Lu us, %Lu MB/s\n",
+      Bytes,
+      DivU64x32 (ElapsedNs, 1000),
+      (ElapsedNs == 0) ? 0 : DivU64x64Remainder (MultU64x32 (Bytes, 1000), ElapsedNs, NULL)
+      ));
+  }
+
+  return Status;
+}
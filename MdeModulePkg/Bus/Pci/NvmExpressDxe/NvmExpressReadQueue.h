@@ -0,0 +1,119 @@
+/** @file
+  Header file for the queued read path of the NvmExpressDxe driver, which keeps
+  many read commands outstanding on several deep I/O queue pairs.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef _NVME_READ_QUEUE_H_
+#define _NVME_READ_QUEUE_H_
+
+#define NVME_READ_QUEUE_ID        3             // Queue ID of the first read queue pair
+#define NVME_MAX_READ_QUEUES      4             // Number of read queue pairs supported by the driver
+#define NVME_MAX_READ_QUEUE_SIZE  1024          // Number of entries of a read queue, which is 1-based
+
+//
+// Feature Identifier of the Number of Queues feature.
+//
+#define NVME_FEATURE_NUMBER_OF_QUEUES  0x07
+
+//
+// Resources of a read command in flight.
+//
+typedef struct {
+  BOOLEAN    InUse;
+  VOID       *MapData;
+  VOID       *MapPrpList;
+  VOID       *PrpListHost;
+  UINTN      PrpListNo;
+} NVME_READ_COMMAND;
+
+//
+// A read queue pair. The command ID of a read command indexes Command.
+//
+typedef struct {
+  NVME_READ_COMMAND    *Command;
+  //
+  // Stack of the command IDs that are not in flight.
+  //
+  UINT16               *FreeCid;
+  UINT16               FreeNum;
+  //
+  // Commands were placed in the submission queue since its doorbell was rung.
+  //
+  BOOLEAN              Pending;
+} NVME_READ_QUEUE;
+
+/**
+  Get the number of pages that the read queues add to the queue buffer of a
+  controller.
+
+  @return The number of pages of the read queues.
+
+**/
+UINTN
+NvmeReadQueueBufferPages (
+  VOID
+  );
+
+/**
+  Set up the read queues of a controller, before the I/O queues are created.
+
+  The read commands still in flight are released, so the controller must be
+  disabled since they were submitted. The read queues are disabled if the
+  controller does not grant enough I/O queues.
+
+  @param[in] Private          The pointer to the NVME_CONTROLLER_PRIVATE_DATA data structure.
+
+  @retval EFI_SUCCESS          The read queues are set up or disabled.
+  @retval EFI_OUT_OF_RESOURCES The command tables could not be allocated.
+
+**/
+EFI_STATUS
+NvmeReadQueueInit (
+  IN NVME_CONTROLLER_PRIVATE_DATA  *Private
+  );
+
+/**
+  Free the command tables of the read queues of a controller.
+
+  @param[in] Private          The pointer to the NVME_CONTROLLER_PRIVATE_DATA data structure.
+
+**/
+VOID
+NvmeReadQueueFree (
+  IN NVME_CONTROLLER_PRIVATE_DATA  *Private
+  );
+
+/**
+  Read some blocks from the device by keeping many read commands in flight on
+  the read queues.
+
+  @param  Device                 The pointer to the NVME_DEVICE_PRIVATE_DATA data structure.
+  @param  Buffer                 The buffer used to store the data read from the device.
+  @param  Lba                    The start block number.
+  @param  Blocks                 Total block number to be read.
+  @param  MaxTransferBlocks      The maximum block number of a read command.
+  @param  BlocksRead             The number of blocks read from Lba on, when
+                                 EFI_OUT_OF_RESOURCES is returned.
+
+  @retval EFI_SUCCESS            Datum are read from the device.
+  @retval EFI_OUT_OF_RESOURCES   The buffer could not be mapped for the next
+                                 read command with no command in flight. The
+                                 blocks after BlocksRead are not read.
+  @retval Others                 Fail to read all the datum.
+
+**/
+EFI_STATUS
+NvmeReadQueued (
+  IN  NVME_DEVICE_PRIVATE_DATA  *Device,
+  OUT VOID                      *Buffer,
+  IN  UINT64                    Lba,
+  IN  UINTN                     Blocks,
+  IN  UINT32                    MaxTransferBlocks,
+  OUT UINTN                     *BlocksRead
+  );
+
+#endif
@@ -431,3 +431,132 @@ CoreIsSchedulable (
 Done:
   return FALSE;
 }
+
+/**
+  Link a driver onto the protocol entries of every GUID its depex pushes, so
+  that it is only evaluated again once one of those protocols is installed.
+  Does nothing if the driver is already registered, or if its depex cannot be
+  indexed this way (no depex, BEFORE or AFTER, or no PUSH opcodes).
+
+  @param  DriverEntry           The driver whose depex is about to be evaluated.
+
+**/
+VOID
+CoreRegisterDepexWaiters (
+  IN EFI_CORE_DRIVER_ENTRY  *DriverEntry
+  )
+{
+  EFI_STATUS  Status;
+  UINT8       *Iterator;
+  UINT8       *End;
+  UINTN       Count;
+  UINTN       Index;
+  EFI_GUID    ProtocolGuid;
+
+  if ((DriverEntry->DepexWaiters != NULL) || (DriverEntry->Depex == NULL) ||
+      DriverEntry->Before || DriverEntry->After)
+  {
+    return;
+  }
+
+  //
+  // Count the GUIDs that are not known to be installed yet. GUIDs that were
+  // found by an earlier evaluation have been replaced by EFI_DEP_REPLACE_TRUE
+  // and stay TRUE, so only protocol installs can turn the depex from FALSE to
+  // TRUE.
+  //
+  End   = (UINT8 *)DriverEntry->Depex + DriverEntry->DepexSize;
+  Count = 0;
+  for (Iterator = DriverEntry->Depex; Iterator < End && *Iterator != EFI_DEP_END; Iterator++) {
+    if ((*Iterator == EFI_DEP_PUSH) || (*Iterator == EFI_DEP_REPLACE_TRUE) ||
+        (*Iterator == EFI_DEP_BEFORE) || (*Iterator == EFI_DEP_AFTER))
+    {
+      if (*Iterator == EFI_DEP_PUSH) {
+        Count++;
+      }
+
+      Iterator += sizeof (EFI_GUID);
+    }
+  }
+
+  if (Count == 0) {
+    return;
+  }
+
+  DriverEntry->DepexWaiters = AllocateZeroPool (Count * sizeof (DEPEX_PROTOCOL_WAITER));
+  if (DriverEntry->DepexWaiters == NULL) {
+    return;
+  }
+
+  Index = 0;
+  for (Iterator = DriverEntry->Depex; Iterator < End && *Iterator != EFI_DEP_END; Iterator++) {
+    if (*Iterator == EFI_DEP_PUSH) {
+      CopyMem (&ProtocolGuid, Iterator + 1, sizeof (EFI_GUID));
+      DriverEntry->DepexWaiters[Index].Signature   = DEPEX_PROTOCOL_WAITER_SIGNATURE;
+      DriverEntry->DepexWaiters[Index].DriverEntry = DriverEntry;
+      Status                                       = CoreRegisterDepexWaiter (&ProtocolGuid, &DriverEntry->DepexWaiters[Index]);
+      if (EFI_ERROR (Status)) {
+        //
+        // Fall back to evaluating the depex on every pass
+        //
+        DriverEntry->DepexWaiterCount = Index;
+        CoreUnregisterDepexWaiters (DriverEntry);
+        return;
+      }
+
+      Index++;
+    }
+
+    if ((*Iterator == EFI_DEP_PUSH) || (*Iterator == EFI_DEP_REPLACE_TRUE) ||
+        (*Iterator == EFI_DEP_BEFORE) || (*Iterator == EFI_DEP_AFTER))
+    {
+      Iterator += sizeof (EFI_GUID);
+    }
+  }
+
+  DriverEntry->DepexWaiterCount = Index;
+}
+
+/**
+  Remove a driver from the protocol entries it waits on and free its waiters.
+
+  @param  DriverEntry           The driver being scheduled.
+
+**/
+VOID
+CoreUnregisterDepexWaiters (
+  IN EFI_CORE_DRIVER_ENTRY  *DriverEntry
+  )
+{
+  UINTN  Index;
+
+  if (DriverEntry->DepexWaiters == NULL) {
+    return;
+  }
+
+  for (Index = 0; Index < DriverEntry->DepexWaiterCount; Index++) {
+    CoreUnregisterDepexWaiter (&DriverEntry->DepexWaiters[Index]);
+  }
+
+  CoreFreePool (DriverEntry->DepexWaiters);
+  DriverEntry->DepexWaiters     = NULL;
+  DriverEntry->DepexWaiterCount = 0;
+  DriverEntry->DepexWaiting     = FALSE;
+}
+
+/**
+  Called with the protocol database locked when a protocol that a driver's
+  depex waits on has been installed. Marks the driver for evaluation on the
+  next pass of the dispatcher.
+
+  @param  Waiter                The waiter linked on the protocol entry.
+
+**/
+VOID
+CoreDepexProtocolInstalled (
+  IN DEPEX_PROTOCOL_WAITER  *Waiter
+  )
+{
+  Waiter->DriverEntry->DepexWaiting = FALSE;
+  Waiter->DriverEntry->DepexWokenBy = gDispatchingDriver;
+}
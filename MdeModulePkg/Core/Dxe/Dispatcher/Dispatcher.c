@@ -60,6 +60,19 @@ EFI_LOCK  mDispatcherLock = EFI_INITIALIZE_LOCK_VARIABLE (TPL_HIGH_LEVEL);
 //
 BOOLEAN  gDispatcherRunning = FALSE;
 
+//
+// The driver whose entry point is running. Protocols installed meanwhile are
+// attributed to it when building the dispatch critical path.
+//
+EFI_CORE_DRIVER_ENTRY  *gDispatchingDriver = NULL;
+
+//
+// Depex evaluation counters. A skipped evaluation is one for a driver that
+// waits on protocols none of which has been installed since it last failed.
+//
+UINTN  mDepexEvaluationCount     = 0;
+UINTN  mDepexEvaluationSkipCount = 0;
+
 //
 // Module globals to manage the FwVol registration notification event
 //
@@ -195,6 +208,18 @@ CoreProcessFvImageFile (
   IN  EFI_GUID                       *FileName
   );
 
+/**
+  Report how many depex evaluations the protocol wait lists saved, and the
+  longest chain of drivers where each one was woken by a protocol installed
+  by the previous one. Nothing is reported unless DEBUG_VERBOSE is enabled,
+  as this runs at the end of every dispatcher pass.
+
+**/
+VOID
+CoreReportDispatchStatistics (
+  VOID
+  );
+
 /**
   Enter critical section by gaining lock on mDispatcherLock.
 
@@ -450,6 +475,13 @@ CoreDispatcher (
       // skip the LoadImage
       //
       if ((DriverEntry->ImageHandle == NULL) && !DriverEntry->IsFvImage) {
+        //
+        // Decode this driver and the ones queued behind it on the APs
+        //
+        if (!DriverEntry->ImagePrefetchAttempted) {
+          CorePrefetchScheduledImages ();
+        }
+
         DEBUG ((DEBUG_INFO, "Loading driver %g\n", &DriverEntry->FileName));
         Status = CoreLoadImage (
                    FALSE,
@@ -459,6 +491,7 @@ CoreDispatcher (
                    0,
                    &DriverEntry->ImageHandle
                    );
+        CoreDiscardPrefetchedImage (DriverEntry);
 
         //
         // Update the driver state to reflect that it's been loaded
@@ -501,6 +534,7 @@ CoreDispatcher (
 
       CoreReleaseDispatcherLock ();
 
+      gDispatchingDriver = DriverEntry;
       if (DriverEntry->IsFvImage) {
         //
         // Produce a firmware volume block protocol for FvImage so it gets dispatched from.
@@ -525,7 +559,8 @@ CoreDispatcher (
           );
       }
 
-      ReturnStatus = EFI_SUCCESS;
+      gDispatchingDriver = NULL;
+      ReturnStatus       = EFI_SUCCESS;
     }
 
     //
@@ -552,6 +587,23 @@ CoreDispatcher (
       }
 
       if (DriverEntry->Dependent) {
+        if (DriverEntry->DepexWaiting) {
+          //
+          // None of the protocols this driver waits on has been installed since
+          // its depex last evaluated to FALSE.
+          //
+          mDepexEvaluationSkipCount++;
+          continue;
+        }
+
+        //
+        // Start waiting before the evaluation, so a protocol installed while
+        // the depex is being evaluated still wakes the driver.
+        //
+        CoreRegisterDepexWaiters (DriverEntry);
+        DriverEntry->DepexWaiting = (BOOLEAN)(DriverEntry->DepexWaiterCount != 0);
+
+        mDepexEvaluationCount++;
         if (CoreIsSchedulable (DriverEntry)) {
           CoreInsertOnScheduledQueueWhileProcessingBeforeAndAfter (DriverEntry);
           ReadyToRun = TRUE;
@@ -566,6 +618,10 @@ CoreDispatcher (
     }
   } while (ReadyToRun);
 
+  DEBUG_CODE_BEGIN ();
+  CoreReportDispatchStatistics ();
+  DEBUG_CODE_END ();
+
   //
   // Close DXE dispatch Event
   //
@@ -578,6 +634,51 @@ CoreDispatcher (
   return ReturnStatus;
 }
 
+/**
+  Report how many depex evaluations the protocol wait lists saved, and the
+  longest chain of drivers where each one was woken by a protocol installed
+  by the previous one. Nothing is reported unless DEBUG_VERBOSE is enabled,
+  as this runs at the end of every dispatcher pass.
+
+**/
+VOID
+CoreReportDispatchStatistics (
+  VOID
+  )
+{
+  LIST_ENTRY             *Link;
+  EFI_CORE_DRIVER_ENTRY  *DriverEntry;
+  EFI_CORE_DRIVER_ENTRY  *Deepest;
+
+  if (!DebugPrintLevelEnabled (DEBUG_VERBOSE)) {
+    return;
+  }
+
+  DEBUG ((
+    DEBUG_VERBOSE,
+    "DXE dispatcher: %Lu depex evaluations, %Lu skipped while waiting on protocols\n",
+    (UINT64)mDepexEvaluationCount,
+    (UINT64)mDepexEvaluationSkipCount
+    ));
+
+  Deepest = NULL;
+  for (Link = mDiscoveredList.ForwardLink; Link != &mDiscoveredList; Link = Link->ForwardLink) {
+    DriverEntry = CR (Link, EFI_CORE_DRIVER_ENTRY, Link, EFI_CORE_DRIVER_ENTRY_SIGNATURE);
+    if ((Deepest == NULL) || (DriverEntry->DispatchDepth > Deepest->DispatchDepth)) {
+      Deepest = DriverEntry;
+    }
+  }
+
+  if ((Deepest == NULL) || (Deepest->DispatchDepth == 0)) {
+    return;
+  }
+
+  DEBUG ((DEBUG_VERBOSE, "DXE dispatcher: critical path is %Lu drivers long\n", (UINT64)Deepest->DispatchDepth));
+  for (DriverEntry = Deepest; DriverEntry != NULL; DriverEntry = DriverEntry->DepexWokenBy) {
+    DEBUG ((DEBUG_DISPATCH, "  [%Lu] FFS(%g)\n", (UINT64)DriverEntry->DispatchDepth, &DriverEntry->FileName));
+  }
+}
+
 /**
   Insert InsertedDriverEntry onto the mScheduledQueue. To do this you
   must add any driver with a before dependency on InsertedDriverEntry first.
@@ -610,6 +711,7 @@ CoreInsertOnScheduledQueueWhileProcessingBeforeAndAfter (
         // Recursively process BEFORE
         //
         DEBUG ((DEBUG_DISPATCH, "TRUE\n  END\n  RESULT = TRUE\n"));
+        DriverEntry->DepexWokenBy = InsertedDriverEntry->DepexWokenBy;
         CoreInsertOnScheduledQueueWhileProcessingBeforeAndAfter (DriverEntry);
       } else {
         DEBUG ((DEBUG_DISPATCH, "FALSE\n  END\n  RESULT = FALSE\n"));
@@ -617,6 +719,16 @@ CoreInsertOnScheduledQueueWhileProcessingBeforeAndAfter (
     }
   }
 
+  //
+  // The driver no longer waits on any protocol. It is dispatched after the
+  // driver whose protocol install woke it.
+  //
+  CoreUnregisterDepexWaiters (InsertedDriverEntry);
+  InsertedDriverEntry->DispatchDepth = 1;
+  if (InsertedDriverEntry->DepexWokenBy != NULL) {
+    InsertedDriverEntry->DispatchDepth += InsertedDriverEntry->DepexWokenBy->DispatchDepth;
+  }
+
   //
   // Convert driver from Dependent to Scheduled state
   //
@@ -641,6 +753,7 @@ CoreInsertOnScheduledQueueWhileProcessingBeforeAndAfter (
         // Recursively process AFTER
         //
         DEBUG ((DEBUG_DISPATCH, "TRUE\n  END\n  RESULT = TRUE\n"));
+        DriverEntry->DepexWokenBy = InsertedDriverEntry;
         CoreInsertOnScheduledQueueWhileProcessingBeforeAndAfter (DriverEntry);
       } else {
         DEBUG ((DEBUG_DISPATCH, "FALSE\n  END\n  RESULT = FALSE\n"));
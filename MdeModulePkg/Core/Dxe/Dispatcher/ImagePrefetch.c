@@ -0,0 +1,468 @@
+/** @file
+  Decode compressed DXE driver images on the application processors.
+
+  Before the dispatcher loads the next batch of scheduled drivers, the raw FFS
+  file of every scheduled driver is read on the BSP. Drivers whose PE32 section
+  is wrapped in a GUIDed section handled by the core's own decompressor (LZMA,
+  LZMA F86 or Brotli) get their output and scratch buffers allocated up front,
+  and the decode itself is spread across the APs through the MP Services
+  protocol. The decoders are pure functions over caller supplied buffers, so
+  they are safe to run on an AP.
+
+  Everything that needs boot services stays on the BSP in dispatch order:
+  FV access, pool allocation, PE/COFF loading and relocation, Security2 file
+  authentication and the driver entry points. CoreLoadImage () simply picks up
+  the already decoded PE32 image instead of calling ReadSection ().
+
+Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "DxeMain.h"
+
+//
+// Maximum number of images decoded per batch. This bounds the amount of pool
+// held by decoded images that are still waiting for their turn in the queue.
+//
+#define IMAGE_PREFETCH_MAX_JOBS  32
+
+typedef struct {
+  EFI_CORE_DRIVER_ENTRY    *DriverEntry;
+  VOID                     *FileBuffer;
+  VOID                     *GuidedSection;
+  UINT16                   GuidedSectionAttributes;
+  UINT32                   FileAuthenticationStatus;
+  VOID                     *OutputBuffer;
+  UINT32                   OutputBufferSize;
+  VOID                     *DecodedBuffer;
+  VOID                     *ScratchBuffer;
+  UINT32                   AuthenticationStatus;
+  EFI_STATUS               Status;
+} IMAGE_PREFETCH_JOB;
+
+extern LIST_ENTRY  mScheduledQueue;
+
+IMAGE_PREFETCH_JOB  mImagePrefetchJobs[IMAGE_PREFETCH_MAX_JOBS];
+UINT32              mImagePrefetchJobCount;
+volatile UINT32     mImagePrefetchNextJob;
+
+/**
+  Check whether a GUIDed section is decoded by one of the decompressors that
+  can safely run on an AP.
+
+  @param  SectionGuid   The section definition GUID.
+
+  @retval TRUE          The section can be decoded on an AP.
+  @retval FALSE         The section must go through the normal section extraction path.
+
+**/
+BOOLEAN
+IsImagePrefetchGuid (
+  IN CONST EFI_GUID  *SectionGuid
+  )
+{
+  return (BOOLEAN)(CompareGuid (SectionGuid, &gLzmaCustomDecompressGuid) ||
+                   CompareGuid (SectionGuid, &gLzmaF86CustomDecompressGuid) ||
+                   CompareGuid (SectionGuid, &gBrotliCustomDecompressGuid));
+}
+
+/**
+  Return the first section of a section stream that is either a PE32 section or
+  an encapsulation section. This matches the depth first order in which
+  ReadSection () looks for the first PE32 instance.
+
+  @param  Buffer        The section stream.
+  @param  BufferSize    The size of the section stream in bytes.
+
+  @return The section found, or NULL if there is none or the stream is malformed.
+
+**/
+EFI_COMMON_SECTION_HEADER *
+FindImagePrefetchSection (
+  IN VOID   *Buffer,
+  IN UINTN  BufferSize
+  )
+{
+  EFI_COMMON_SECTION_HEADER  *Section;
+  UINTN                      Offset;
+  UINTN                      SectionSize;
+
+  Offset = 0;
+  while (Offset + sizeof (EFI_COMMON_SECTION_HEADER) <= BufferSize) {
+    Section = (EFI_COMMON_SECTION_HEADER *)((UINT8 *)Buffer + Offset);
+    if (IS_SECTION2 (Section)) {
+      if (Offset + sizeof (EFI_COMMON_SECTION_HEADER2) > BufferSize) {
+        return NULL;
+      }
+
+      SectionSize = SECTION2_SIZE (Section);
+    } else {
+      SectionSize = SECTION_SIZE (Section);
+    }
+
+    if ((SectionSize < sizeof (EFI_COMMON_SECTION_HEADER)) || (SectionSize > BufferSize - Offset)) {
+      return NULL;
+    }
+
+    if ((Section->Type == EFI_SECTION_PE32) ||
+        (Section->Type == EFI_SECTION_COMPRESSION) ||
+        (Section->Type == EFI_SECTION_GUID_DEFINED))
+    {
+      return Section;
+    }
+
+    Offset = ALIGN_VALUE (Offset + SectionSize, 4);
+  }
+
+  return NULL;
+}
+
+/**
+  Read the FFS file of a scheduled driver and, if its PE32 image sits inside a
+  GUIDed section that can be decoded on an AP, prepare a decode job for it.
+
+  @param  DriverEntry   The scheduled driver.
+  @param  Job           The job to fill in.
+
+  @retval TRUE          The job was prepared.
+  @retval FALSE         The driver is loaded through the normal path.
+
+**/
+BOOLEAN
+CorePrepareImagePrefetchJob (
+  IN  EFI_CORE_DRIVER_ENTRY  *DriverEntry,
+  OUT IMAGE_PREFETCH_JOB     *Job
+  )
+{
+  EFI_STATUS                 Status;
+  VOID                       *FileBuffer;
+  UINTN                      FileSize;
+  EFI_FV_FILETYPE            FileType;
+  EFI_FV_FILE_ATTRIBUTES     FileAttributes;
+  UINT32                     AuthenticationStatus;
+  EFI_COMMON_SECTION_HEADER  *Section;
+  EFI_GUID                   *SectionGuid;
+  UINT16                     GuidedSectionAttributes;
+  UINT32                     OutputBufferSize;
+  UINT32                     ScratchBufferSize;
+  UINT16                     SectionAttribute;
+
+  FileBuffer = NULL;
+  Status     = DriverEntry->Fv->ReadFile (
+                                  DriverEntry->Fv,
+                                  &DriverEntry->FileName,
+                                  &FileBuffer,
+                                  &FileSize,
+                                  &FileType,
+                                  &FileAttributes,
+                                  &AuthenticationStatus
+                                  );
+  if (EFI_ERROR (Status)) {
+    return FALSE;
+  }
+
+  Section = FindImagePrefetchSection (FileBuffer, FileSize);
+  if ((Section == NULL) || (Section->Type != EFI_SECTION_GUID_DEFINED)) {
+    goto Fallback;
+  }
+
+  if (IS_SECTION2 (Section)) {
+    SectionGuid             = &((EFI_GUID_DEFINED_SECTION2 *)Section)->SectionDefinitionGuid;
+    GuidedSectionAttributes = ((EFI_GUID_DEFINED_SECTION2 *)Section)->Attributes;
+  } else {
+    SectionGuid             = &((EFI_GUID_DEFINED_SECTION *)Section)->SectionDefinitionGuid;
+    GuidedSectionAttributes = ((EFI_GUID_DEFINED_SECTION *)Section)->Attributes;
+  }
+
+  //
+  // Only take over sections that the core would hand to its own extraction
+  // protocol instance, so the decoded data and authentication status are the
+  // same as on the normal path.
+  //
+  if (!IsImagePrefetchGuid (SectionGuid) || !IsCoreGuidedSectionExtraction (SectionGuid)) {
+    goto Fallback;
+  }
+
+  Status = ExtractGuidedSectionGetInfo (
+             Section,
+             &OutputBufferSize,
+             &ScratchBufferSize,
+             &SectionAttribute
+             );
+  if (EFI_ERROR (Status) || (OutputBufferSize == 0)) {
+    goto Fallback;
+  }
+
+  ZeroMem (Job, sizeof (IMAGE_PREFETCH_JOB));
+  Job->OutputBuffer = AllocatePool (OutputBufferSize);
+  if (Job->OutputBuffer == NULL) {
+    goto Fallback;
+  }
+
+  if (ScratchBufferSize > 0) {
+    Job->ScratchBuffer = AllocatePool (ScratchBufferSize);
+    if (Job->ScratchBuffer == NULL) {
+      CoreFreePool (Job->OutputBuffer);
+      goto Fallback;
+    }
+  }
+
+  Job->DriverEntry              = DriverEntry;
+  Job->FileBuffer               = FileBuffer;
+  Job->GuidedSection            = Section;
+  Job->GuidedSectionAttributes  = GuidedSectionAttributes;
+  Job->FileAuthenticationStatus = AuthenticationStatus;
+  Job->OutputBufferSize         = OutputBufferSize;
+  Job->DecodedBuffer            = Job->OutputBuffer;
+  Job->Status                   = EFI_NOT_READY;
+  return TRUE;
+
+Fallback:
+  CoreFreePool (FileBuffer);
+  return FALSE;
+}
+
+/**
+  Decode queued images until the job list is exhausted. Runs on the APs, and
+  on the BSP if the APs could not be started.
+
+  @param  Buffer        Unused.
+
+**/
+VOID
+EFIAPI
+CoreImagePrefetchWorker (
+  IN OUT VOID  *Buffer
+  )
+{
+  UINT32              Index;
+  IMAGE_PREFETCH_JOB  *Job;
+
+  for ( ; ;) {
+    Index = InterlockedIncrement (&mImagePrefetchNextJob) - 1;
+    if (Index >= mImagePrefetchJobCount) {
+      break;
+    }
+
+    Job         = &mImagePrefetchJobs[Index];
+    Job->Status = ExtractGuidedSectionDecode (
+                    Job->GuidedSection,
+                    &Job->DecodedBuffer,
+                    Job->ScratchBuffer,
+                    &Job->AuthenticationStatus
+                    );
+  }
+}
+
+/**
+  Locate the PE32 image in the output of a finished decode job and attach it to
+  the driver entry. Frees everything else owned by the job.
+
+  @param  Job           The finished job.
+
+**/
+VOID
+CoreCompleteImagePrefetchJob (
+  IN IMAGE_PREFETCH_JOB  *Job
+  )
+{
+  EFI_CORE_DRIVER_ENTRY      *DriverEntry;
+  EFI_COMMON_SECTION_HEADER  *Section;
+  UINTN                      HeaderSize;
+  UINTN                      ImageSize;
+
+  DriverEntry = Job->DriverEntry;
+
+  if (!EFI_ERROR (Job->Status)) {
+    if (Job->DecodedBuffer != Job->OutputBuffer) {
+      CopyMem (Job->OutputBuffer, Job->DecodedBuffer, Job->OutputBufferSize);
+    }
+
+    Section = FindImagePrefetchSection (Job->OutputBuffer, Job->OutputBufferSize);
+    if ((Section != NULL) && (Section->Type == EFI_SECTION_PE32)) {
+      if (IS_SECTION2 (Section)) {
+        HeaderSize = sizeof (EFI_COMMON_SECTION_HEADER2);
+        ImageSize  = SECTION2_SIZE (Section) - HeaderSize;
+      } else {
+        HeaderSize = sizeof (EFI_COMMON_SECTION_HEADER);
+        ImageSize  = SECTION_SIZE (Section) - HeaderSize;
+      }
+
+      //
+      // Move the image to the start of the pool buffer so CoreLoadImage () can
+      // free it like a buffer returned by ReadSection ().
+      //
+      CopyMem (Job->OutputBuffer, (UINT8 *)Section + HeaderSize, ImageSize);
+
+      //
+      // Same rule as the section extraction code uses for a GUIDed section in
+      // a file stream, plus the authentication status of the firmware volume.
+      //
+      if ((Job->GuidedSectionAttributes & EFI_GUIDED_SECTION_AUTH_STATUS_VALID) == 0) {
+        Job->AuthenticationStatus = 0;
+      }
+
+      DriverEntry->PrefetchedImage                     = Job->OutputBuffer;
+      DriverEntry->PrefetchedImageSize                 = ImageSize;
+      DriverEntry->PrefetchedImageAuthenticationStatus = Job->AuthenticationStatus | Job->FileAuthenticationStatus;
+      Job->OutputBuffer                                = NULL;
+    }
+  }
+
+  if (Job->OutputBuffer != NULL) {
+    CoreFreePool (Job->OutputBuffer);
+  }
+
+  if (Job->ScratchBuffer != NULL) {
+    CoreFreePool (Job->ScratchBuffer);
+  }
+
+  CoreFreePool (Job->FileBuffer);
+}
+
+/**
+  Decode the images of the next batch of scheduled drivers in parallel on the
+  APs. Drivers that cannot be handled are left to the normal load path.
+
+**/
+VOID
+CorePrefetchScheduledImages (
+  VOID
+  )
+{
+  EFI_STATUS                Status;
+  EFI_MP_SERVICES_PROTOCOL  *MpServices;
+  UINTN                     NumberOfProcessors;
+  UINTN                     NumberOfEnabledProcessors;
+  LIST_ENTRY                *Link;
+  EFI_CORE_DRIVER_ENTRY     *DriverEntry;
+  UINT32                    Index;
+
+  if (!FeaturePcdGet (PcdDxeDispatcherParallelImageDecode)) {
+    return;
+  }
+
+  Status = CoreLocateProtocol (&gEfiMpServiceProtocolGuid, NULL, (VOID **)&MpServices);
+  if (EFI_ERROR (Status)) {
+    return;
+  }
+
+  Status = MpServices->GetNumberOfProcessors (MpServices, &NumberOfProcessors, &NumberOfEnabledProcessors);
+  if (EFI_ERROR (Status) || (NumberOfEnabledProcessors < 2)) {
+    return;
+  }
+
+  PERF_FUNCTION_BEGIN ();
+
+  mImagePrefetchJobCount = 0;
+  for (Link = mScheduledQueue.ForwardLink;
+       Link != &mScheduledQueue && mImagePrefetchJobCount < IMAGE_PREFETCH_MAX_JOBS;
+       Link = Link->ForwardLink)
+  {
+    DriverEntry = CR (Link, EFI_CORE_DRIVER_ENTRY, ScheduledLink, EFI_CORE_DRIVER_ENTRY_SIGNATURE);
+    if (DriverEntry->ImagePrefetchAttempted) {
+      continue;
+    }
+
+    DriverEntry->ImagePrefetchAttempted = TRUE;
+    if ((DriverEntry->ImageHandle != NULL) || DriverEntry->IsFvImage) {
+      continue;
+    }
+
+    if (CorePrepareImagePrefetchJob (DriverEntry, &mImagePrefetchJobs[mImagePrefetchJobCount])) {
+      mImagePrefetchJobCount++;
+    }
+  }
+
+  if (mImagePrefetchJobCount == 0) {
+    PERF_FUNCTION_END ();
+    return;
+  }
+
+  DEBUG ((DEBUG_DISPATCH, "Decoding %d driver images on %d processors\n", mImagePrefetchJobCount, NumberOfEnabledProcessors - 1));
+
+  mImagePrefetchNextJob = 0;
+  Status                = MpServices->StartupAllAPs (
+                                        MpServices,
+                                        CoreImagePrefetchWorker,
+                                        FALSE,
+                                        NULL,
+                                        0,
+                                        NULL,
+                                        NULL
+                                        );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_DISPATCH, "StartupAllAPs failed - %r, decoding on the BSP\n", Status));
+  }
+
+  //
+  // Pick up whatever the APs did not get to, or everything if they could not
+  // be started.
+  //
+  CoreImagePrefetchWorker (NULL);
+
+  for (Index = 0; Index < mImagePrefetchJobCount; Index++) {
+    CoreCompleteImagePrefetchJob (&mImagePrefetchJobs[Index]);
+  }
+
+  mImagePrefetchJobCount = 0;
+
+  PERF_FUNCTION_END ();
+}
+
+/**
+  Hand the decoded image of the driver at the head of the scheduled queue to
+  CoreLoadImage (). Ownership of the returned pool buffer passes to the caller.
+
+  @param  FilePath              The device path being loaded.
+  @param  ImageSize             Returns the size of the image.
+  @param  AuthenticationStatus  Returns the authentication status of the image.
+
+  @return The decoded image, or NULL if FilePath was not prefetched.
+
+**/
+VOID *
+CoreGetPrefetchedImage (
+  IN  CONST EFI_DEVICE_PATH_PROTOCOL  *FilePath,
+  OUT UINTN                           *ImageSize,
+  OUT UINT32                          *AuthenticationStatus
+  )
+{
+  EFI_CORE_DRIVER_ENTRY  *DriverEntry;
+  VOID                   *Image;
+
+  if (IsListEmpty (&mScheduledQueue)) {
+    return NULL;
+  }
+
+  DriverEntry = CR (mScheduledQueue.ForwardLink, EFI_CORE_DRIVER_ENTRY, ScheduledLink, EFI_CORE_DRIVER_ENTRY_SIGNATURE);
+  if ((DriverEntry->PrefetchedImage == NULL) || (DriverEntry->FvFileDevicePath != FilePath)) {
+    return NULL;
+  }
+
+  Image                            = DriverEntry->PrefetchedImage;
+  *ImageSize                       = DriverEntry->PrefetchedImageSize;
+  *AuthenticationStatus            = DriverEntry->PrefetchedImageAuthenticationStatus;
+  DriverEntry->PrefetchedImage     = NULL;
+  DriverEntry->PrefetchedImageSize = 0;
+  return Image;
+}
+
+/**
+  Free the decoded image of a driver if CoreLoadImage () did not consume it.
+
+  @param  DriverEntry   The driver entry.
+
+**/
+VOID
+CoreDiscardPrefetchedImage (
+  IN EFI_CORE_DRIVER_ENTRY  *DriverEntry
+  )
+{
+  if (DriverEntry->PrefetchedImage != NULL) {
+    CoreFreePool (DriverEntry->PrefetchedImage);
+    DriverEntry->PrefetchedImage     = NULL;
+    DriverEntry->PrefetchedImageSize = 0;
+  }
+}
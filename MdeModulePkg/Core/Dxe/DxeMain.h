@@ -45,6 +45,8 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Protocol/HiiPackageList.h>
 #include <Protocol/SmmBase2.h>
 #include <Protocol/PeCoffImageEmulator.h>
+#include <Protocol/MpService.h>
+#include <Protocol/MemoryMapChanges.h>
 #include <Guid/MemoryTypeInformation.h>
 #include <Guid/FirmwareFileSystem2.h>
 #include <Guid/FirmwareFileSystem3.h>
@@ -62,6 +64,9 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Guid/VectorHandoffTable.h>
 #include <Ppi/VectorHandoffInfo.h>
 #include <Guid/MemoryProfile.h>
+#include <Guid/DxeCoreTimerStatistics.h>
+#include <Guid/DxeCoreTplTrace.h>
+#include <Guid/LzmaDecompress.h>
 
 #include <Library/DxeCoreEntryPoint.h>
 #include <Library/DebugLib.h>
@@ -84,6 +89,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/DxeServicesLib.h>
 #include <Library/DebugAgentLib.h>
 #include <Library/CpuExceptionHandlerLib.h>
+#include <Library/SynchronizationLib.h>
 
 //
 // attributes for reserved memory before it is promoted to system memory
@@ -132,8 +138,20 @@ typedef struct {
   EFI_GUID      FvNameGuid;
 } KNOWN_HANDLE;
 
-#define EFI_CORE_DRIVER_ENTRY_SIGNATURE  SIGNATURE_32('d','r','v','r')
+///
+/// DEPEX_PROTOCOL_WAITER - links a driver whose depex is not yet satisfied onto
+/// the protocol entry of one GUID its depex pushes. The driver is only evaluated
+/// again after an interface of one of those protocols has been installed.
+///
+#define DEPEX_PROTOCOL_WAITER_SIGNATURE  SIGNATURE_32('d','p','x','w')
 typedef struct {
+  UINTN                           Signature;
+  LIST_ENTRY                      Link;           // PROTOCOL_ENTRY.DepexWaiters
+  struct _EFI_CORE_DRIVER_ENTRY    *DriverEntry;
+} DEPEX_PROTOCOL_WAITER;
+
+#define EFI_CORE_DRIVER_ENTRY_SIGNATURE  SIGNATURE_32('d','r','v','r')
+typedef struct _EFI_CORE_DRIVER_ENTRY {
   UINTN                            Signature;
   LIST_ENTRY                       Link;            // mDriverList
 
@@ -160,6 +178,17 @@ typedef struct {
 
   EFI_HANDLE                       ImageHandle;
   BOOLEAN                          IsFvImage;
+
+  BOOLEAN                          ImagePrefetchAttempted;
+  VOID                             *PrefetchedImage;        // PE32 image decoded ahead of CoreLoadImage ()
+  UINTN                            PrefetchedImageSize;
+  UINT32                           PrefetchedImageAuthenticationStatus;
+
+  DEPEX_PROTOCOL_WAITER            *DepexWaiters;           // One per unresolved PUSH GUID
+  UINTN                            DepexWaiterCount;
+  BOOLEAN                          DepexWaiting;            // Depex is FALSE until a waiter is woken
+  struct _EFI_CORE_DRIVER_ENTRY    *DepexWokenBy;           // Driver that installed the last protocol waited on
+  UINTN                            DispatchDepth;           // Length of the DepexWokenBy chain
 } EFI_CORE_DRIVER_ENTRY;
 
 //
@@ -278,6 +307,7 @@ extern EFI_LOADED_IMAGE_PROTOCOL  *gDxeCoreLoadedImage;
 extern EFI_MEMORY_TYPE_INFORMATION  gMemoryTypeInformation[EfiMaxMemoryType + 1];
 
 extern BOOLEAN                    gDispatcherRunning;
+extern EFI_CORE_DRIVER_ENTRY      *gDispatchingDriver;
 extern EFI_RUNTIME_ARCH_PROTOCOL  gRuntimeTemplate;
 
 extern EFI_LOAD_FIXED_ADDRESS_CONFIGURATION_TABLE  gLoadModuleAtFixAddressConfigurationTable;
@@ -450,6 +480,17 @@ CoreTimerTick (
   IN UINT64  Duration
   );
 
+/**
+  Returns the current system time.
+
+  @return The current system time
+
+**/
+UINT64
+CoreCurrentSystemTime (
+  VOID
+  );
+
 /**
   Initialize the dispatcher. Initialize the notification function that runs when
   an FV2 protocol is added to the system.
@@ -1239,6 +1280,59 @@ CoreGetMemoryMap (
   OUT UINT32                    *DescriptorVersion
   );
 
+/**
+  Return the descriptors of the memory map that changed since a generation.
+
+  @param  Generation             On input, the generation of the memory map
+                                 known by the caller, or 0 to get the whole map.
+                                 On output, the generation of the returned
+                                 descriptors.
+  @param  MemoryMapSize          On input, the size of MemoryMap in bytes. On
+                                 output, the size of the returned descriptors,
+                                 or the size needed if the buffer is too small.
+  @param  MemoryMap              The buffer that receives the descriptors.
+  @param  MapKey                 The key of the memory map of Generation.
+  @param  DescriptorSize         The size of one EFI_MEMORY_DESCRIPTOR.
+  @param  DescriptorVersion      The version of EFI_MEMORY_DESCRIPTOR.
+  @param  FullMap                TRUE if the whole memory map was returned.
+
+  @retval EFI_SUCCESS            The changed descriptors were returned.
+  @retval EFI_BUFFER_TOO_SMALL   MemoryMap is too small. The size needed is
+                                 returned in MemoryMapSize.
+  @retval EFI_INVALID_PARAMETER  One of the parameters has an invalid value.
+  @retval EFI_OUT_OF_RESOURCES   The memory map could not be captured.
+
+**/
+EFI_STATUS
+EFIAPI
+CoreGetMemoryMapChanges (
+  IN OUT UINT64                 *Generation,
+  IN OUT UINTN                  *MemoryMapSize,
+  OUT    EFI_MEMORY_DESCRIPTOR  *MemoryMap,
+  OUT    UINTN                  *MapKey OPTIONAL,
+  OUT    UINTN                  *DescriptorSize OPTIONAL,
+  OUT    UINT32                 *DescriptorVersion OPTIONAL,
+  OUT    BOOLEAN                *FullMap
+  );
+
+/**
+  Record a change to the memory map returned by CoreGetMemoryMap(), and move
+  the memory map to the next generation.
+
+  The caller must hold the memory lock or the GCD memory lock.
+
+  @param  Start                  The first address of the changed range
+  @param  End                    The last address of the changed range. A
+                                 range from 0 to MAX_UINT64 records a change to
+                                 the whole map.
+
+**/
+VOID
+CoreLogMemoryMapChange (
+  IN EFI_PHYSICAL_ADDRESS  Start,
+  IN EFI_PHYSICAL_ADDRESS  End
+  );
+
 /**
   Allocate pool of a particular type.
 
@@ -1928,6 +2022,111 @@ CoreDispatcher (
   VOID
   );
 
+/**
+  Decode the images of the next batch of scheduled drivers in parallel on the
+  APs. Drivers that cannot be handled are left to the normal load path.
+
+**/
+VOID
+CorePrefetchScheduledImages (
+  VOID
+  );
+
+/**
+  Link a driver onto the protocol entries of every GUID its depex pushes, so
+  that it is only evaluated again once one of those protocols is installed.
+  Does nothing if the driver is already registered, or if its depex cannot be
+  indexed this way (no depex, BEFORE or AFTER, or no PUSH opcodes).
+
+  @param  DriverEntry           The driver whose depex is about to be evaluated.
+
+**/
+VOID
+CoreRegisterDepexWaiters (
+  IN EFI_CORE_DRIVER_ENTRY  *DriverEntry
+  );
+
+/**
+  Remove a driver from the protocol entries it waits on and free its waiters.
+
+  @param  DriverEntry           The driver being scheduled.
+
+**/
+VOID
+CoreUnregisterDepexWaiters (
+  IN EFI_CORE_DRIVER_ENTRY  *DriverEntry
+  );
+
+/**
+  Called with the protocol database locked when a protocol that a driver's
+  depex waits on has been installed. Marks the driver for evaluation on the
+  next pass of the dispatcher.
+
+  @param  Waiter                The waiter linked on the protocol entry.
+
+**/
+VOID
+CoreDepexProtocolInstalled (
+  IN DEPEX_PROTOCOL_WAITER  *Waiter
+  );
+
+/**
+  Link a depex waiter onto the protocol entry of Protocol, creating the entry
+  if the protocol has not been installed yet.
+
+  @param  Protocol              The protocol GUID pushed by the depex.
+  @param  Waiter                The waiter to link.
+
+  @retval EFI_SUCCESS           The waiter was linked.
+  @retval EFI_OUT_OF_RESOURCES  The protocol entry could not be created.
+
+**/
+EFI_STATUS
+CoreRegisterDepexWaiter (
+  IN EFI_GUID               *Protocol,
+  IN DEPEX_PROTOCOL_WAITER  *Waiter
+  );
+
+/**
+  Unlink a depex waiter from its protocol entry.
+
+  @param  Waiter                The waiter to unlink.
+
+**/
+VOID
+CoreUnregisterDepexWaiter (
+  IN DEPEX_PROTOCOL_WAITER  *Waiter
+  );
+
+/**
+  Hand the decoded image of the driver at the head of the scheduled queue to
+  CoreLoadImage (). Ownership of the returned pool buffer passes to the caller.
+
+  @param  FilePath              The device path being loaded.
+  @param  ImageSize             Returns the size of the image.
+  @param  AuthenticationStatus  Returns the authentication status of the image.
+
+  @return The decoded image, or NULL if FilePath was not prefetched.
+
+**/
+VOID *
+CoreGetPrefetchedImage (
+  IN  CONST EFI_DEVICE_PATH_PROTOCOL  *FilePath,
+  OUT UINTN                           *ImageSize,
+  OUT UINT32                          *AuthenticationStatus
+  );
+
+/**
+  Free the decoded image of a driver if CoreLoadImage () did not consume it.
+
+  @param  DriverEntry   The driver entry.
+
+**/
+VOID
+CoreDiscardPrefetchedImage (
+  IN EFI_CORE_DRIVER_ENTRY  *DriverEntry
+  );
+
 /**
   Check every driver and locate a matching one. If the driver is found, the Unrequested
   state flag is cleared.
@@ -2353,6 +2552,22 @@ CloseSectionStream (
   IN  BOOLEAN  FreeStreamBuffer
   );
 
+/**
+  Check whether GUIDed sections of the given type are extracted by the
+  instance of the GUIDed section extraction protocol that the DXE core
+  installs for its ExtractGuidedSectionLib handlers.
+
+  @param  SectionGuid           The section definition GUID.
+
+  @retval TRUE                  The core's own extraction protocol handles the GUID.
+  @retval FALSE                 The GUID is not supported, or is handled by another driver.
+
+**/
+BOOLEAN
+IsCoreGuidedSectionExtraction (
+  IN EFI_GUID  *SectionGuid
+  );
+
 /**
   Creates and initializes the DebugImageInfo Table.  Also creates the configuration
   table and registers it into the system table.
@@ -11,7 +11,8 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 //
 // DXE Core Global Variables for Protocols from PEI
 //
-EFI_HANDLE  mDecompressHandle = NULL;
+EFI_HANDLE  mDecompressHandle       = NULL;
+EFI_HANDLE  mMemoryMapChangesHandle = NULL;
 
 //
 // DXE Core globals for Architecture Protocols
@@ -211,6 +212,14 @@ EFI_DECOMPRESS_PROTOCOL  gEfiDecompress = {
   DxeMainUefiDecompress
 };
 
+//
+// EDKII Memory Map Changes Protocol
+//
+EDKII_MEMORY_MAP_CHANGES_PROTOCOL  mMemoryMapChanges = {
+  EDKII_MEMORY_MAP_CHANGES_PROTOCOL_REVISION,
+  CoreGetMemoryMapChanges
+};
+
 //
 // For Loading modules at fixed address feature, the configuration table is to cache the top address below which to load
 // Runtime code&boot time code
@@ -498,6 +507,17 @@ DxeMain (
              );
   ASSERT_EFI_ERROR (Status);
 
+  //
+  // Publish the protocol that returns the changes to the memory map
+  //
+  Status = CoreInstallMultipleProtocolInterfaces (
+             &mMemoryMapChangesHandle,
+             &gEdkiiMemoryMapChangesProtocolGuid,
+             &mMemoryMapChanges,
+             NULL
+             );
+  ASSERT_EFI_ERROR (Status);
+
   //
   // Register for the GUIDs of the Architectural Protocols, so the rest of the
   // EFI Boot Services and EFI Runtime Services tables can be filled in.
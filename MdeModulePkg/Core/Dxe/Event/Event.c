@@ -128,6 +128,7 @@ CoreInitializeEventServices (
   }
 
   CoreInitializeTimer ();
+  CoreInitializeTplTrace ();
 
   CoreCreateEventEx (
     EVT_NOTIFY_SIGNAL,
@@ -450,6 +451,17 @@ CoreCreateEventInternal (
     return EFI_OUT_OF_RESOURCES;
   }
 
+  //
+  // Make sure the timer can be armed without allocating memory later
+  //
+  if ((Type & EVT_TIMER) != 0) {
+    Status = CoreReserveTimerSlot ();
+    if (EFI_ERROR (Status)) {
+      CoreFreePool (IEvent);
+      return Status;
+    }
+  }
+
   IEvent->Signature = EVENT_SIGNATURE;
   IEvent->Type      = Type;
 
@@ -527,6 +539,16 @@ CoreSignalEvent (
     return EFI_INVALID_PARAMETER;
   }
 
+  //
+  // Signalling an event that is still signalled does nothing, so skip the
+  // lock. SignalCount is only cleared under the lock when the notification is
+  // dispatched or the event is checked, and either of those happening right
+  // after this test is the same as this signal coming first.
+  //
+  if (Event->SignalCount != 0) {
+    return EFI_SUCCESS;
+  }
+
   CoreAcquireEventLock ();
 
   //
@@ -719,6 +741,7 @@ CoreCloseEvent (
   //
   if ((Event->Type & EVT_TIMER) != 0) {
     CoreSetTimer (Event, TimerCancel, 0);
+    CoreReturnTimerSlot ();
   }
 
   CoreAcquireEventLock ();
@@ -30,9 +30,16 @@ extern  UINTN  gEventPending;
 /// Timer event information
 ///
 typedef struct {
-  LIST_ENTRY    Link;
-  UINT64        TriggerTime;
-  UINT64        Period;
+  ///
+  /// One-based position in the timer heap, 0 if the timer is not queued
+  ///
+  UINTN     HeapIndex;
+  ///
+  /// Arming order, keeps timers with the same TriggerTime first in first out
+  ///
+  UINT64    Sequence;
+  UINT64    TriggerTime;
+  UINT64    Period;
 } TIMER_EVENT_INFO;
 
 #define EVENT_SIGNATURE  SIGNATURE_32('e','v','n','t')
@@ -85,4 +92,35 @@ CoreInitializeTimer (
   VOID
   );
 
+/**
+  Publish the TPL trace table if tracing is enabled.
+
+**/
+VOID
+CoreInitializeTplTrace (
+  VOID
+  );
+
+/**
+  Reserves a slot in the timer heap for a new timer event, so that arming
+  the timer later never has to allocate memory.
+
+  @retval EFI_SUCCESS            A slot is reserved.
+  @retval EFI_OUT_OF_RESOURCES   The timer heap could not be grown.
+
+**/
+EFI_STATUS
+CoreReserveTimerSlot (
+  VOID
+  );
+
+/**
+  Returns the timer heap slot of a timer event that is being closed.
+
+**/
+VOID
+CoreReturnTimerSlot (
+  VOID
+  );
+
 #endif
@@ -13,17 +13,179 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 // Internal data
 //
 
-LIST_ENTRY  mEfiTimerList       = INITIALIZE_LIST_HEAD_VARIABLE (mEfiTimerList);
-EFI_LOCK    mEfiTimerLock       = EFI_INITIALIZE_LOCK_VARIABLE (TPL_HIGH_LEVEL - 1);
-EFI_EVENT   mEfiCheckTimerEvent = NULL;
-
-EFI_LOCK  mEfiSystemTimeLock = EFI_INITIALIZE_LOCK_VARIABLE (TPL_HIGH_LEVEL);
-UINT64    mEfiSystemTime     = 0;
+///
+/// Queued timer events, kept as a binary min-heap on (TriggerTime, Sequence).
+/// The heap always has a slot for every open timer event, see
+/// CoreReserveTimerSlot(), so arming a timer never allocates memory.
+///
+IEVENT  **mEfiTimerHeap      = NULL;
+UINTN   mEfiTimerHeapCount   = 0;
+UINTN   mEfiTimerHeapSize    = 0;
+UINTN   mEfiTimerEventCount  = 0;
+UINT64  mEfiTimerSequence    = 0;
+UINT64  mEfiTimerNextTrigger = MAX_UINT64;
+
+EFI_LOCK   mEfiTimerLock       = EFI_INITIALIZE_LOCK_VARIABLE (TPL_HIGH_LEVEL - 1);
+EFI_EVENT  mEfiCheckTimerEvent = NULL;
+
+EFI_LOCK  mEfiSystemTimeLock    = EFI_INITIALIZE_LOCK_VARIABLE (TPL_HIGH_LEVEL);
+UINT64    mEfiSystemTime        = 0;
+UINT64    mEfiTimerTickDuration = 0;
+
+EDKII_DXE_CORE_TIMER_STATISTICS  mEfiTimerStatistics = {
+  EDKII_DXE_CORE_TIMER_STATISTICS_REVISION
+};
 
 //
 // Timer functions
 //
 
+/**
+  Checks whether a timer event expires before another one.
+
+  @param  Event1                 The first timer event
+  @param  Event2                 The second timer event
+
+  @retval TRUE                   Event1 is due before Event2
+  @retval FALSE                  Event2 is due before Event1
+
+**/
+STATIC
+BOOLEAN
+CoreIsTimerBefore (
+  IN IEVENT  *Event1,
+  IN IEVENT  *Event2
+  )
+{
+  if (Event1->Timer.TriggerTime != Event2->Timer.TriggerTime) {
+    return (BOOLEAN)(Event1->Timer.TriggerTime < Event2->Timer.TriggerTime);
+  }
+
+  return (BOOLEAN)(Event1->Timer.Sequence < Event2->Timer.Sequence);
+}
+
+/**
+  Stores a timer event at a position of the timer heap.
+
+  @param  Index                  The zero-based heap position
+  @param  Event                  The timer event
+
+**/
+STATIC
+VOID
+CoreSetTimerHeapEntry (
+  IN UINTN   Index,
+  IN IEVENT  *Event
+  )
+{
+  mEfiTimerHeap[Index]   = Event;
+  Event->Timer.HeapIndex = Index + 1;
+}
+
+/**
+  Moves a timer event toward the root of the timer heap until its parent is
+  due before it.
+
+  @param  Index                  The zero-based heap position of the event
+
+**/
+STATIC
+VOID
+CoreSiftTimerUp (
+  IN UINTN  Index
+  )
+{
+  IEVENT  *Event;
+  UINTN   Parent;
+
+  Event = mEfiTimerHeap[Index];
+  while (Index > 0) {
+    Parent = (Index - 1) / 2;
+    if (!CoreIsTimerBefore (Event, mEfiTimerHeap[Parent])) {
+      break;
+    }
+
+    CoreSetTimerHeapEntry (Index, mEfiTimerHeap[Parent]);
+    Index = Parent;
+  }
+
+  CoreSetTimerHeapEntry (Index, Event);
+}
+
+/**
+  Moves a timer event away from the root of the timer heap until its
+  children are due after it.
+
+  @param  Index                  The zero-based heap position of the event
+
+**/
+STATIC
+VOID
+CoreSiftTimerDown (
+  IN UINTN  Index
+  )
+{
+  IEVENT  *Event;
+  UINTN   Child;
+
+  Event = mEfiTimerHeap[Index];
+  for ( ; ;) {
+    Child = Index * 2 + 1;
+    if (Child >= mEfiTimerHeapCount) {
+      break;
+    }
+
+    if ((Child + 1 < mEfiTimerHeapCount) &&
+        CoreIsTimerBefore (mEfiTimerHeap[Child + 1], mEfiTimerHeap[Child]))
+    {
+      Child++;
+    }
+
+    if (!CoreIsTimerBefore (mEfiTimerHeap[Child], Event)) {
+      break;
+    }
+
+    CoreSetTimerHeapEntry (Index, mEfiTimerHeap[Child]);
+    Index = Child;
+  }
+
+  CoreSetTimerHeapEntry (Index, Event);
+}
+
+/**
+  Publishes the trigger time of the first queued timer for CoreTimerTick().
+
+  The trigger time is written under mEfiSystemTimeLock, which CoreTimerTick()
+  holds while it reads it, so the timer interrupt never sees a torn UINT64
+  on processors that write it in two halves.
+
+**/
+STATIC
+VOID
+CoreUpdateNextTrigger (
+  VOID
+  )
+{
+  UINT64  NextTrigger;
+
+  ASSERT_LOCKED (&mEfiTimerLock);
+
+  if (mEfiTimerHeapCount == 0) {
+    NextTrigger = MAX_UINT64;
+  } else {
+    NextTrigger = mEfiTimerHeap[0]->Timer.TriggerTime;
+  }
+
+  CoreAcquireLock (&mEfiSystemTimeLock);
+  mEfiTimerNextTrigger = NextTrigger;
+  CoreReleaseLock (&mEfiSystemTimeLock);
+
+  mEfiTimerStatistics.QueuedTimers = mEfiTimerHeapCount;
+  if (mEfiTimerHeapCount > mEfiTimerStatistics.PeakQueuedTimers) {
+    mEfiTimerStatistics.PeakQueuedTimers = mEfiTimerHeapCount;
+  }
+}
+
 /**
   Inserts the timer event.
 
@@ -36,29 +198,126 @@ CoreInsertEventTimer (
   IN IEVENT  *Event
   )
 {
-  UINT64      TriggerTime;
-  LIST_ENTRY  *Link;
-  IEVENT      *Event2;
-
   ASSERT_LOCKED (&mEfiTimerLock);
+  ASSERT (Event->Timer.HeapIndex == 0);
+  ASSERT (mEfiTimerHeapCount < mEfiTimerHeapSize);
 
   //
-  // Get the timer's trigger time
+  // Insert the timer into the timer heap, after any timer with the same
+  // trigger time
   //
-  TriggerTime = Event->Timer.TriggerTime;
+  Event->Timer.Sequence = mEfiTimerSequence++;
+  CoreSetTimerHeapEntry (mEfiTimerHeapCount, Event);
+  mEfiTimerHeapCount++;
+  CoreSiftTimerUp (mEfiTimerHeapCount - 1);
+
+  CoreUpdateNextTrigger ();
+}
+
+/**
+  Removes a queued timer event.
+
+  @param  Event                  Points to the internal structure of the timer
+                                 event to be removed
+
+**/
+STATIC
+VOID
+CoreRemoveEventTimer (
+  IN IEVENT  *Event
+  )
+{
+  UINTN   Index;
+  IEVENT  *Last;
+
+  ASSERT_LOCKED (&mEfiTimerLock);
+  ASSERT (Event->Timer.HeapIndex != 0);
+
+  Index                  = Event->Timer.HeapIndex - 1;
+  Event->Timer.HeapIndex = 0;
+  mEfiTimerHeapCount--;
 
   //
-  // Insert the timer into the timer database in assending sorted order
+  // Move the last timer into the hole and restore the heap order around it
   //
-  for (Link = mEfiTimerList.ForwardLink; Link != &mEfiTimerList; Link = Link->ForwardLink) {
-    Event2 = CR (Link, IEVENT, Timer.Link, EVENT_SIGNATURE);
+  if (Index != mEfiTimerHeapCount) {
+    Last = mEfiTimerHeap[mEfiTimerHeapCount];
+    CoreSetTimerHeapEntry (Index, Last);
+    CoreSiftTimerDown (Index);
+    CoreSiftTimerUp (Last->Timer.HeapIndex - 1);
+  }
 
-    if (Event2->Timer.TriggerTime > TriggerTime) {
-      break;
+  CoreUpdateNextTrigger ();
+}
+
+/**
+  Reserves a slot in the timer heap for a new timer event, so that arming
+  the timer later never has to allocate memory.
+
+  @retval EFI_SUCCESS            A slot is reserved.
+  @retval EFI_OUT_OF_RESOURCES   The timer heap could not be grown.
+
+**/
+EFI_STATUS
+CoreReserveTimerSlot (
+  VOID
+  )
+{
+  IEVENT  **NewHeap;
+  IEVENT  **OldHeap;
+  UINTN   NewSize;
+
+  for ( ; ;) {
+    CoreAcquireLock (&mEfiTimerLock);
+    if (mEfiTimerEventCount < mEfiTimerHeapSize) {
+      mEfiTimerEventCount++;
+      CoreReleaseLock (&mEfiTimerLock);
+      return EFI_SUCCESS;
+    }
+
+    NewSize = (mEfiTimerHeapSize == 0) ? 64 : mEfiTimerHeapSize * 2;
+    CoreReleaseLock (&mEfiTimerLock);
+
+    //
+    // The heap is grown outside of the timer lock, CreateEvent() runs at
+    // TPL_NOTIFY or below where pool can be allocated
+    //
+    NewHeap = AllocatePool (NewSize * sizeof (IEVENT *));
+    if (NewHeap == NULL) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+
+    CoreAcquireLock (&mEfiTimerLock);
+    if (NewSize > mEfiTimerHeapSize) {
+      CopyMem (NewHeap, mEfiTimerHeap, mEfiTimerHeapCount * sizeof (IEVENT *));
+      OldHeap           = mEfiTimerHeap;
+      mEfiTimerHeap     = NewHeap;
+      mEfiTimerHeapSize = NewSize;
+    } else {
+      OldHeap = NewHeap;
+    }
+
+    CoreReleaseLock (&mEfiTimerLock);
+
+    if (OldHeap != NULL) {
+      FreePool (OldHeap);
     }
   }
+}
 
-  InsertTailList (Link, &Event->Timer.Link);
+/**
+  Returns the timer heap slot of a timer event that is being closed.
+
+**/
+VOID
+CoreReturnTimerSlot (
+  VOID
+  )
+{
+  CoreAcquireLock (&mEfiTimerLock);
+  ASSERT (mEfiTimerEventCount > 0);
+  mEfiTimerEventCount--;
+  CoreReleaseLock (&mEfiTimerLock);
 }
 
 /**
@@ -82,7 +341,7 @@ CoreCurrentSystemTime (
 }
 
 /**
-  Checks the sorted timer list against the current system time.
+  Checks the timer heap against the current system time.
   Signals any expired event timer.
 
   @param  CheckEvent             Not used
@@ -97,6 +356,7 @@ CoreCheckTimers (
   )
 {
   UINT64  SystemTime;
+  UINT64  Lateness;
   IEVENT  *Event;
 
   //
@@ -105,8 +365,8 @@ CoreCheckTimers (
   CoreAcquireLock (&mEfiTimerLock);
   SystemTime = CoreCurrentSystemTime ();
 
-  while (!IsListEmpty (&mEfiTimerList)) {
-    Event = CR (mEfiTimerList.ForwardLink, IEVENT, Timer.Link, EVENT_SIGNATURE);
+  while (mEfiTimerHeapCount != 0) {
+    Event = mEfiTimerHeap[0];
 
     //
     // If this timer is not expired, then we're done
@@ -115,12 +375,15 @@ CoreCheckTimers (
       break;
     }
 
-    //
-    // Remove this timer from the timer queue
-    //
+    Lateness = SystemTime - Event->Timer.TriggerTime;
+    mEfiTimerStatistics.FiredCount++;
+    if (Lateness > mEfiTimerTickDuration) {
+      mEfiTimerStatistics.LateCount++;
+    }
 
-    RemoveEntryList (&Event->Timer.Link);
-    Event->Timer.Link.ForwardLink = NULL;
+    if (Lateness > mEfiTimerStatistics.MaxLateness) {
+      mEfiTimerStatistics.MaxLateness = Lateness;
+    }
 
     //
     // Signal it
@@ -145,9 +408,16 @@ CoreCheckTimers (
       }
 
       //
-      // Add the timer
+      // Re-arm the timer in place at the root of the heap
+      //
+      Event->Timer.Sequence = mEfiTimerSequence++;
+      CoreSiftTimerDown (0);
+      CoreUpdateNextTrigger ();
+    } else {
       //
-      CoreInsertEventTimer (Event);
+      // Remove this timer from the timer queue
+      //
+      CoreRemoveEventTimer (Event);
     }
   }
 
@@ -174,6 +444,12 @@ CoreInitializeTimer (
              &mEfiCheckTimerEvent
              );
   ASSERT_EFI_ERROR (Status);
+
+  //
+  // Publish the timer dispatch statistics
+  //
+  Status = CoreInstallConfigurationTable (&gEdkiiDxeCoreTimerStatisticsGuid, &mEfiTimerStatistics);
+  ASSERT_EFI_ERROR (Status);
 }
 
 /**
@@ -189,8 +465,6 @@ CoreTimerTick (
   IN UINT64  Duration
   )
 {
-  IEVENT  *Event;
-
   //
   // Check runtiem flag in case there are ticks while exiting boot services
   //
@@ -199,18 +473,15 @@ CoreTimerTick (
   //
   // Update the system time
   //
-  mEfiSystemTime += Duration;
+  mEfiSystemTime       += Duration;
+  mEfiTimerTickDuration = Duration;
 
   //
-  // If the head of the list is expired, fire the timer event
+  // If the first timer in the heap is expired, fire the timer event
   // to process it
   //
-  if (!IsListEmpty (&mEfiTimerList)) {
-    Event = CR (mEfiTimerList.ForwardLink, IEVENT, Timer.Link, EVENT_SIGNATURE);
-
-    if (Event->Timer.TriggerTime <= mEfiSystemTime) {
-      CoreSignalEvent (mEfiCheckTimerEvent);
-    }
+  if (mEfiTimerNextTrigger <= mEfiSystemTime) {
+    CoreSignalEvent (mEfiCheckTimerEvent);
   }
 
   CoreReleaseLock (&mEfiSystemTimeLock);
@@ -260,9 +531,8 @@ CoreSetTimer (
   //
   // If the timer is queued to the timer database, remove it
   //
-  if (Event->Timer.Link.ForwardLink != NULL) {
-    RemoveEntryList (&Event->Timer.Link);
-    Event->Timer.Link.ForwardLink = NULL;
+  if (Event->Timer.HeapIndex != 0) {
+    CoreRemoveEventTimer (Event);
   }
 
   Event->Timer.TriggerTime = 0;
@@ -279,6 +549,7 @@ CoreSetTimer (
 
     Event->Timer.TriggerTime = CoreCurrentSystemTime () + TriggerTime;
     CoreInsertEventTimer (Event);
+    mEfiTimerStatistics.ArmedCount++;
 
     if (TriggerTime == 0) {
       CoreSignalEvent (mEfiCheckTimerEvent);
@@ -9,6 +9,89 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include "DxeMain.h"
 #include "Event.h"
 
+///
+/// mTplTrace - Per caller RaiseTPL() and RestoreTPL() counts, published as a
+/// configuration table when PcdDxeCoreTplTraceEnable is TRUE
+///
+EDKII_DXE_CORE_TPL_TRACE  mTplTrace = {
+  EDKII_DXE_CORE_TPL_TRACE_REVISION,
+  EDKII_DXE_CORE_TPL_TRACE_MAX_CALLERS
+};
+
+/**
+  Count one RaiseTPL() or RestoreTPL() call against its caller.
+
+  The table is updated without a lock, since taking one would itself change
+  the TPL. A timer interrupt that raises the TPL in the middle of an update
+  can cost a count, which is fine for a diagnostic.
+
+  @param  Caller  Return address of the call
+  @param  Raise   TRUE for RaiseTPL(), FALSE for RestoreTPL()
+
+**/
+VOID
+CoreTraceTpl (
+  IN UINTN    Caller,
+  IN BOOLEAN  Raise
+  )
+{
+  EDKII_DXE_CORE_TPL_TRACE_ENTRY  *Entry;
+  UINTN                           Index;
+  UINTN                           Probe;
+
+  if (Raise) {
+    mTplTrace.RaiseCount++;
+  } else {
+    mTplTrace.RestoreCount++;
+  }
+
+  Index = (UINTN)((UINT32)(Caller >> 2) * 0x9E3779B1);
+  for (Probe = 0; Probe < EDKII_DXE_CORE_TPL_TRACE_MAX_CALLERS; Probe++) {
+    Entry = &mTplTrace.Entry[(Index + Probe) & (EDKII_DXE_CORE_TPL_TRACE_MAX_CALLERS - 1)];
+    if (Entry->Caller == Caller) {
+      break;
+    }
+
+    //
+    // Claim a free entry. Losing the race to an interrupt handler just moves
+    // on to the next entry.
+    //
+    if ((Entry->Caller == 0) &&
+        (InterlockedCompareExchange64 (&Entry->Caller, 0, Caller) == 0))
+    {
+      break;
+    }
+  }
+
+  if (Probe == EDKII_DXE_CORE_TPL_TRACE_MAX_CALLERS) {
+    mTplTrace.DroppedCount++;
+    return;
+  }
+
+  if (Raise) {
+    Entry->RaiseCount++;
+  } else {
+    Entry->RestoreCount++;
+  }
+}
+
+/**
+  Publish the TPL trace table if tracing is enabled.
+
+**/
+VOID
+CoreInitializeTplTrace (
+  VOID
+  )
+{
+  EFI_STATUS  Status;
+
+  if (FeaturePcdGet (PcdDxeCoreTplTraceEnable)) {
+    Status = CoreInstallConfigurationTable (&gEdkiiDxeCoreTplTraceGuid, &mTplTrace);
+    ASSERT_EFI_ERROR (Status);
+  }
+}
+
 /**
   Set Interrupt State.
 
@@ -60,6 +143,10 @@ CoreRaiseTpl (
 {
   EFI_TPL  OldTpl;
 
+  if (FeaturePcdGet (PcdDxeCoreTplTraceEnable)) {
+    CoreTraceTpl ((UINTN)RETURN_ADDRESS (0), TRUE);
+  }
+
   OldTpl = gEfiCurrentTpl;
   if (OldTpl > NewTpl) {
     DEBUG ((DEBUG_ERROR, "FATAL ERROR - RaiseTpl with OldTpl(0x%x) > NewTpl(0x%x)\n", OldTpl, NewTpl));
@@ -99,6 +186,10 @@ CoreRestoreTpl (
   EFI_TPL  OldTpl;
   EFI_TPL  PendingTpl;
 
+  if (FeaturePcdGet (PcdDxeCoreTplTraceEnable)) {
+    CoreTraceTpl ((UINTN)RETURN_ADDRESS (0), FALSE);
+  }
+
   OldTpl = gEfiCurrentTpl;
   if (NewTpl > OldTpl) {
     DEBUG ((DEBUG_ERROR, "FATAL ERROR - RestoreTpl with NewTpl(0x%x) > OldTpl(0x%x)\n", NewTpl, OldTpl));
@@ -107,6 +198,21 @@ CoreRestoreTpl (
 
   ASSERT (VALID_TPL (NewTpl));
 
+  //
+  // Fast path for the common raise/restore pair below TPL_HIGH_LEVEL. If
+  // interrupts are already enabled and no notification above NewTpl is
+  // pending, there is nothing left to do but set the new value. A restore
+  // from TPL_HIGH_LEVEL, or one with interrupts disabled below it (in an
+  // interrupt handler, or before the CPU arch protocol first enabled them),
+  // takes the path below that enables interrupts.
+  //
+  if ((OldTpl < TPL_HIGH_LEVEL) && GetInterruptState () &&
+      ((gEventPending == 0) || ((EFI_TPL)HighBitSet64 (gEventPending) <= NewTpl)))
+  {
+    gEfiCurrentTpl = NewTpl;
+    return;
+  }
+
   //
   // If lowering below HIGH_LEVEL, make sure
   // interrupts are enabled
@@ -125,6 +231,10 @@ CoreRestoreTpl (
       break;
     }
 
+    if (FeaturePcdGet (PcdDxeCoreTplTraceEnable)) {
+      mTplTrace.DispatchCount++;
+    }
+
     gEfiCurrentTpl = PendingTpl;
     if (gEfiCurrentTpl < TPL_HIGH_LEVEL) {
       CoreSetInterruptState (TRUE);
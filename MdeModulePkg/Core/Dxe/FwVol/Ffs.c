@@ -214,3 +214,28 @@ IsValidFfsFile (
       return FALSE;
   }
 }
+
+/**
+  Hash an FFS file name.
+
+  @param  Name           The file name GUID
+
+  @return The hash of the file name
+
+**/
+UINTN
+FvFileNameHash (
+  IN CONST EFI_GUID  *Name
+  )
+{
+  UINT32  Hash;
+
+  //
+  // File names are random GUIDs, so folding their words is enough
+  //
+  Hash = ReadUnaligned32 ((CONST UINT32 *)Name) ^
+         ReadUnaligned32 ((CONST UINT32 *)Name + 1) ^
+         ReadUnaligned32 ((CONST UINT32 *)Name + 2) ^
+         ReadUnaligned32 ((CONST UINT32 *)Name + 3);
+  return (UINTN)(Hash ^ (Hash >> 16));
+}
@@ -38,6 +38,8 @@ FV_DEVICE  mFvDevice = {
   NULL,
   NULL,
   { NULL,                 NULL},
+  NULL,
+  0,
   0,
   0,
   FALSE,
@@ -281,6 +283,11 @@ FreeFvDeviceResource (
     FfsFileEntry = (FFS_FILE_LIST_ENTRY *)NextEntry;
   }
 
+  if (FvDevice->FileNameHash != NULL) {
+    CoreFreePool (FvDevice->FileNameHash);
+    FvDevice->FileNameHash = NULL;
+  }
+
   if (!FvDevice->IsMemoryMapped) {
     //
     // Free the cached FV buffer.
@@ -296,6 +303,67 @@ FreeFvDeviceResource (
   return;
 }
 
+/**
+  Hash the non-pad files of the FFS file list by file name, so that ReadFile()
+  does not have to walk the whole list. The files of a bucket stay in FV order,
+  so a duplicated file name resolves to the same file as a walk of the list.
+
+  If the hash cannot be allocated, FileNameHash is left NULL and ReadFile()
+  walks the list.
+
+  @param  FvDevice              A pointer to the FvDevice with the FFS file list.
+
+**/
+VOID
+FvBuildFileNameHash (
+  IN OUT FV_DEVICE  *FvDevice
+  )
+{
+  LIST_ENTRY           *Link;
+  FFS_FILE_LIST_ENTRY  *FfsFileEntry;
+  UINTN                FileCount;
+  UINTN                BucketCount;
+  UINTN                Bucket;
+
+  FileCount = 0;
+  for (Link = GetFirstNode (&FvDevice->FfsFileListHeader);
+       !IsNull (&FvDevice->FfsFileListHeader, Link);
+       Link = GetNextNode (&FvDevice->FfsFileListHeader, Link))
+  {
+    FileCount++;
+  }
+
+  BucketCount = 1;
+  while (BucketCount < FileCount) {
+    BucketCount <<= 1;
+  }
+
+  FvDevice->FileNameHash = AllocateZeroPool (BucketCount * sizeof (FFS_FILE_LIST_ENTRY *));
+  if (FvDevice->FileNameHash == NULL) {
+    return;
+  }
+
+  FvDevice->FileNameHashMask = BucketCount - 1;
+
+  //
+  // Walk the list backward, so that inserting at the head of a bucket keeps
+  // the bucket in FV order
+  //
+  for (Link = GetPreviousNode (&FvDevice->FfsFileListHeader, &FvDevice->FfsFileListHeader);
+       !IsNull (&FvDevice->FfsFileListHeader, Link);
+       Link = GetPreviousNode (&FvDevice->FfsFileListHeader, Link))
+  {
+    FfsFileEntry = (FFS_FILE_LIST_ENTRY *)Link;
+    if (FfsFileEntry->FfsHeader->Type == EFI_FV_FILETYPE_FFS_PAD) {
+      continue;
+    }
+
+    Bucket                         = FvFileNameHash (&FfsFileEntry->FfsHeader->Name) & FvDevice->FileNameHashMask;
+    FfsFileEntry->HashNext         = FvDevice->FileNameHash[Bucket];
+    FvDevice->FileNameHash[Bucket] = FfsFileEntry;
+  }
+}
+
 /**
   Check if an FV is consistent and allocate cache for it.
 
@@ -559,6 +627,8 @@ Done:
     }
 
     FreeFvDeviceResource (FvDevice);
+  } else {
+    FvBuildFileNameHash (FvDevice);
   }
 
   return Status;
@@ -15,12 +15,18 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 //
 // Used to track all non-deleted files
 //
-typedef struct {
+typedef struct _FFS_FILE_LIST_ENTRY FFS_FILE_LIST_ENTRY;
+
+struct _FFS_FILE_LIST_ENTRY {
   LIST_ENTRY             Link;
   EFI_FFS_FILE_HEADER    *FfsHeader;
   UINTN                  StreamHandle;
   BOOLEAN                FileCached;
-} FFS_FILE_LIST_ENTRY;
+  //
+  // Next file in the same bucket of the file name hash
+  //
+  FFS_FILE_LIST_ENTRY    *HashNext;
+};
 
 typedef struct {
   UINTN                                 Signature;
@@ -36,6 +42,12 @@ typedef struct {
 
   LIST_ENTRY                            FfsFileListHeader;
 
+  //
+  // Non-pad files hashed by file name, NULL if the hash could not be built
+  //
+  FFS_FILE_LIST_ENTRY                   **FileNameHash;
+  UINTN                                 FileNameHashMask;
+
   UINT32                                AuthenticationStatus;
   UINT8                                 ErasePolarity;
   BOOLEAN                               IsFfs3Fv;
@@ -384,4 +396,17 @@ IsValidFfsFile (
   IN EFI_FFS_FILE_HEADER  *FfsHeader
   );
 
+/**
+  Hash an FFS file name.
+
+  @param  Name           The file name GUID
+
+  @return The hash of the file name
+
+**/
+UINTN
+FvFileNameHash (
+  IN CONST EFI_GUID  *Name
+  );
+
 #endif
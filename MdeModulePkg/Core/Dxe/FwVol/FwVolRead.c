@@ -285,6 +285,7 @@ FvReadFile (
   EFI_FFS_FILE_HEADER     *FfsHeader;
   UINTN                   InputBufferSize;
   UINTN                   WholeFileSize;
+  EFI_FV_ATTRIBUTES       FvAttributes;
 
   if (NameGuid == NULL) {
     return EFI_INVALID_PARAMETER;
@@ -292,25 +293,55 @@ FvReadFile (
 
   FvDevice = FV_DEVICE_FROM_THIS (This);
 
-  //
-  // Keep looking until we find the matching NameGuid.
-  // The Key is really a FfsFileEntry
-  //
-  FvDevice->LastKey = 0;
-  do {
-    LocalFoundType = 0;
-    Status         = FvGetNextFile (
-                       This,
-                       &FvDevice->LastKey,
-                       &LocalFoundType,
-                       &SearchNameGuid,
-                       &LocalAttributes,
-                       &FileSize
-                       );
-    if (EFI_ERROR (Status)) {
+  if (FvDevice->FileNameHash != NULL) {
+    Status = FvGetVolumeAttributes (This, &FvAttributes);
+    if (EFI_ERROR (Status) || ((FvAttributes & EFI_FV2_READ_STATUS) == 0)) {
+      return EFI_NOT_FOUND;
+    }
+
+    //
+    // Look the file up in the file name hash
+    //
+    FvDevice->LastKey = FvDevice->FileNameHash[FvFileNameHash (NameGuid) & FvDevice->FileNameHashMask];
+    while (FvDevice->LastKey != NULL) {
+      if (CompareGuid (&FvDevice->LastKey->FfsHeader->Name, NameGuid)) {
+        break;
+      }
+
+      FvDevice->LastKey = FvDevice->LastKey->HashNext;
+    }
+
+    if (FvDevice->LastKey == NULL) {
       return EFI_NOT_FOUND;
     }
-  } while (!CompareGuid (&SearchNameGuid, NameGuid));
+
+    FfsHeader = FvDevice->LastKey->FfsHeader;
+    if (IS_FFS_FILE2 (FfsHeader)) {
+      FileSize = FFS_FILE2_SIZE (FfsHeader) - sizeof (EFI_FFS_FILE_HEADER2);
+    } else {
+      FileSize = FFS_FILE_SIZE (FfsHeader) - sizeof (EFI_FFS_FILE_HEADER);
+    }
+  } else {
+    //
+    // Keep looking until we find the matching NameGuid.
+    // The Key is really a FfsFileEntry
+    //
+    FvDevice->LastKey = 0;
+    do {
+      LocalFoundType = 0;
+      Status         = FvGetNextFile (
+                         This,
+                         &FvDevice->LastKey,
+                         &LocalFoundType,
+                         &SearchNameGuid,
+                         &LocalAttributes,
+                         &FileSize
+                         );
+      if (EFI_ERROR (Status)) {
+        return EFI_NOT_FOUND;
+      }
+    } while (!CompareGuid (&SearchNameGuid, NameGuid));
+  }
 
   //
   // Get a pointer to the header
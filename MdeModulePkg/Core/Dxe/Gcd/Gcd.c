@@ -996,6 +996,19 @@ CoreConvertSpace (
   //
   Status = CoreCleanupGcdMapEntry (TopEntry, BottomEntry, StartLink, EndLink, Map);
 
+  //
+  // Reserved, MMIO and persistent memory space is part of the UEFI memory map.
+  // Removed memory space leaves no descriptor behind to report, so it counts
+  // as a change to the whole map.
+  //
+  if (!EFI_ERROR (Status) && ((Operation & GCD_MEMORY_SPACE_OPERATION) != 0)) {
+    if (Operation == GCD_REMOVE_MEMORY_OPERATION) {
+      CoreLogMemoryMapChange (0, MAX_UINT64);
+    } else {
+      CoreLogMemoryMapChange (BaseAddress, BaseAddress + Length - 1);
+    }
+  }
+
 Done:
   DEBUG ((DEBUG_GCD, "  Status = %r\n", Status));
 
@@ -10,7 +10,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include "Handle.h"
 
 //
-// mProtocolDatabase     - A list of all protocols in the system.  (simple list for now)
+// mProtocolDatabase     - A list of all protocols in the system.
 // gHandleList           - A list of all the handles in the system
 // gProtocolDatabaseLock - Lock to protect the mProtocolDatabase
 // gHandleDatabaseKey    -  The Key to show that the handle has been created/modified
@@ -20,6 +20,485 @@ LIST_ENTRY  gHandleList           = INITIALIZE_LIST_HEAD_VARIABLE (gHandleList);
 EFI_LOCK    gProtocolDatabaseLock = EFI_INITIALIZE_LOCK_VARIABLE (TPL_NOTIFY);
 UINT64      gHandleDatabaseKey    = 0;
 
+///
+/// CORE_HASH_TABLE - growable chained hash table of LIST_ENTRY links. A NULL
+/// Buckets array means the table could not be allocated and the caller must
+/// fall back to a linear search.
+///
+typedef struct {
+  LIST_ENTRY    *Buckets;
+  UINTN         Bits;
+  UINTN         Count;
+  BOOLEAN       Failed;
+} CORE_HASH_TABLE;
+
+/**
+  Get the 32-bit hash key of an element linked on a CORE_HASH_TABLE.
+
+  @param  Link                   The link of the element in its bucket
+
+  @return 32-bit key
+
+**/
+typedef
+UINT32
+(*CORE_HASH_KEY) (
+  IN LIST_ENTRY  *Link
+  );
+
+//
+// mProtocolEntryHash      - Open addressing index of mProtocolDatabase keyed on
+//                           the protocol GUID. Protocol entries are never freed,
+//                           so no deletion markers are needed. NULL means the
+//                           index could not be allocated and mProtocolDatabase
+//                           is searched linearly instead.
+// mProtocolInterfaceHash  - Index of all PROTOCOL_INTERFACE structures keyed on
+//                           the (IHANDLE, PROTOCOL_ENTRY) pair.
+// mHandleHash             - Index of all IHANDLE structures keyed on their
+//                           address, used to validate EFI_HANDLE values.
+// gHandleCount            - Number of handles on gHandleList
+//
+PROTOCOL_ENTRY   **mProtocolEntryHash   = NULL;
+UINTN            mProtocolEntryHashBits = 0;
+UINTN            mProtocolEntryCount    = 0;
+CORE_HASH_TABLE  mProtocolInterfaceHash = { NULL, 0, 0, FALSE };
+CORE_HASH_TABLE  mHandleHash            = { NULL, 0, 0, FALSE };
+UINTN            gHandleCount           = 0;
+
+#define PROTOCOL_ENTRY_HASH_INITIAL_BITS      8
+#define PROTOCOL_INTERFACE_HASH_INITIAL_BITS  9
+#define HANDLE_HASH_INITIAL_BITS              8
+#define PROTOCOL_HASH_MULTIPLIER              0x9E3779B1
+
+//
+// Largest number of protocols that InstallMultipleProtocolInterfaces()
+// installs as a single batch
+//
+#define INSTALL_PROTOCOL_BATCH_MAX  16
+
+/**
+  Reduce a 32-bit key to an index of a power of two sized hash table.
+
+  @param  Key                    The key to hash
+  @param  Bits                   Log2 of the number of slots in the table
+
+  @return Index in the range [0, 2^Bits)
+
+**/
+STATIC
+UINTN
+CoreHashIndex (
+  IN UINT32  Key,
+  IN UINTN   Bits
+  )
+{
+  //
+  // Fibonacci hashing: the high bits of the product depend on all bits of Key.
+  //
+  return (UINTN)((UINT32)(Key * PROTOCOL_HASH_MULTIPLIER) >> (32 - Bits));
+}
+
+/**
+  Fold a protocol GUID into a 32-bit hash key.
+
+  @param  Protocol               The GUID to fold
+
+  @return 32-bit key
+
+**/
+STATIC
+UINT32
+CoreProtocolGuidKey (
+  IN EFI_GUID  *Protocol
+  )
+{
+  UINT32  *Words;
+
+  Words = (UINT32 *)Protocol;
+  return ReadUnaligned32 (&Words[0]) ^ ReadUnaligned32 (&Words[1]) ^
+         ReadUnaligned32 (&Words[2]) ^ ReadUnaligned32 (&Words[3]);
+}
+
+/**
+  Fold a (handle, protocol entry) pair into a 32-bit hash key.
+
+  @param  Handle                 The handle
+  @param  ProtEntry              The protocol entry
+
+  @return 32-bit key
+
+**/
+STATIC
+UINT32
+CoreProtocolInterfaceKey (
+  IN IHANDLE         *Handle,
+  IN PROTOCOL_ENTRY  *ProtEntry
+  )
+{
+  //
+  // Both structures are pool allocations, so the low 3 bits carry no information.
+  //
+  return (UINT32)((UINTN)Handle >> 3) ^ ((UINT32)((UINTN)ProtEntry >> 3) * PROTOCOL_HASH_MULTIPLIER);
+}
+
+/**
+  Inserts a protocol entry into an open addressing table that is known to
+  have a free slot and not to contain the entry yet.
+
+  @param  Table                  The table to insert into
+  @param  Bits                   Log2 of the number of slots in Table
+  @param  ProtEntry              The protocol entry to insert
+
+**/
+STATIC
+VOID
+CoreInsertProtocolEntryHashSlot (
+  IN PROTOCOL_ENTRY  **Table,
+  IN UINTN           Bits,
+  IN PROTOCOL_ENTRY  *ProtEntry
+  )
+{
+  UINTN  Index;
+  UINTN  Mask;
+
+  Mask  = ((UINTN)1 << Bits) - 1;
+  Index = CoreHashIndex (CoreProtocolGuidKey (&ProtEntry->ProtocolID), Bits);
+  while (Table[Index] != NULL) {
+    Index = (Index + 1) & Mask;
+  }
+
+  Table[Index] = ProtEntry;
+}
+
+/**
+  Adds a newly created protocol entry to mProtocolEntryHash, growing the table
+  when the load factor exceeds 3/4. If the table cannot be (re)allocated the
+  index is dropped and CoreFindProtocolEntry() falls back to the linear search.
+  The gProtocolDatabaseLock must be owned
+
+  @param  ProtEntry              The protocol entry to add
+
+**/
+STATIC
+VOID
+CoreInsertProtocolEntryHash (
+  IN PROTOCOL_ENTRY  *ProtEntry
+  )
+{
+  PROTOCOL_ENTRY  **NewTable;
+  UINTN           NewBits;
+  UINTN           Index;
+  LIST_ENTRY      *Link;
+
+  mProtocolEntryCount++;
+
+  if ((mProtocolEntryHash != NULL) &&
+      (mProtocolEntryCount * 4 <= ((UINTN)3 << mProtocolEntryHashBits)))
+  {
+    CoreInsertProtocolEntryHashSlot (mProtocolEntryHash, mProtocolEntryHashBits, ProtEntry);
+    return;
+  }
+
+  if ((mProtocolEntryHash == NULL) && (mProtocolEntryCount > 1)) {
+    //
+    // A previous allocation failed, stay on the linear search.
+    //
+    return;
+  }
+
+  NewBits = (mProtocolEntryHash == NULL) ? PROTOCOL_ENTRY_HASH_INITIAL_BITS : mProtocolEntryHashBits + 1;
+  if (NewBits >= 32) {
+    NewTable = NULL;
+  } else {
+    NewTable = AllocateZeroPool (((UINTN)1 << NewBits) * sizeof (PROTOCOL_ENTRY *));
+  }
+
+  if (mProtocolEntryHash != NULL) {
+    CoreFreePool (mProtocolEntryHash);
+    mProtocolEntryHash = NULL;
+  }
+
+  if (NewTable == NULL) {
+    DEBUG ((DEBUG_WARN, "Protocol database: GUID index disabled, out of resources\n"));
+    return;
+  }
+
+  //
+  // Rehash every protocol entry. ProtEntry is already linked on mProtocolDatabase.
+  //
+  for (Link = mProtocolDatabase.ForwardLink, Index = 0; Link != &mProtocolDatabase; Link = Link->ForwardLink, Index++) {
+    CoreInsertProtocolEntryHashSlot (
+      NewTable,
+      NewBits,
+      CR (Link, PROTOCOL_ENTRY, AllEntries, PROTOCOL_ENTRY_SIGNATURE)
+      );
+  }
+
+  ASSERT (Index == mProtocolEntryCount);
+  mProtocolEntryHash     = NewTable;
+  mProtocolEntryHashBits = NewBits;
+}
+
+/**
+  Get the hash key of a PROTOCOL_INTERFACE linked on mProtocolInterfaceHash.
+
+  @param  Link                   The HashLink of the protocol interface
+
+  @return 32-bit key
+
+**/
+STATIC
+UINT32
+CoreProtocolInterfaceLinkKey (
+  IN LIST_ENTRY  *Link
+  )
+{
+  PROTOCOL_INTERFACE  *Prot;
+
+  Prot = CR (Link, PROTOCOL_INTERFACE, HashLink, PROTOCOL_INTERFACE_SIGNATURE);
+  return CoreProtocolInterfaceKey (Prot->Handle, Prot->Protocol);
+}
+
+/**
+  Get the hash key of a handle address.
+
+  @param  Handle                 The handle
+
+  @return 32-bit key
+
+**/
+STATIC
+UINT32
+CoreHandleKey (
+  IN EFI_HANDLE  Handle
+  )
+{
+  return (UINT32)((UINTN)Handle >> 3);
+}
+
+/**
+  Get the hash key of an IHANDLE linked on mHandleHash.
+
+  @param  Link                   The HashLink of the handle
+
+  @return 32-bit key
+
+**/
+STATIC
+UINT32
+CoreHandleLinkKey (
+  IN LIST_ENTRY  *Link
+  )
+{
+  return CoreHandleKey (CR (Link, IHANDLE, HashLink, EFI_HANDLE_SIGNATURE));
+}
+
+/**
+  Grows a hash table so that the average chain stays shorter than two entries.
+  If the new bucket array cannot be allocated the current one is kept, so
+  lookups stay correct and only get slower.
+  The gProtocolDatabaseLock must be owned
+
+  @param  Table                  The hash table to grow
+  @param  InitialBits            Log2 of the bucket count of a new table
+  @param  GetKey                 Returns the hash key of a linked element
+
+  @retval TRUE                   The table is usable.
+  @retval FALSE                  The table has never been allocated.
+
+**/
+STATIC
+BOOLEAN
+CoreGrowHashTable (
+  IN OUT CORE_HASH_TABLE  *Table,
+  IN     UINTN            InitialBits,
+  IN     CORE_HASH_KEY    GetKey
+  )
+{
+  LIST_ENTRY  *NewBuckets;
+  UINTN       NewBits;
+  UINTN       Index;
+  UINTN       BucketCount;
+  LIST_ENTRY  *Link;
+
+  if (Table->Failed) {
+    return (BOOLEAN)(Table->Buckets != NULL);
+  }
+
+  NewBits     = (Table->Buckets == NULL) ? InitialBits : Table->Bits + 1;
+  BucketCount = ((UINTN)1 << NewBits);
+  NewBuckets  = (NewBits < 32) ? AllocatePool (BucketCount * sizeof (LIST_ENTRY)) : NULL;
+  if (NewBuckets == NULL) {
+    Table->Failed = TRUE;
+    return (BOOLEAN)(Table->Buckets != NULL);
+  }
+
+  for (Index = 0; Index < BucketCount; Index++) {
+    InitializeListHead (&NewBuckets[Index]);
+  }
+
+  if (Table->Buckets != NULL) {
+    for (Index = 0; Index < ((UINTN)1 << Table->Bits); Index++) {
+      while (!IsListEmpty (&Table->Buckets[Index])) {
+        Link = Table->Buckets[Index].ForwardLink;
+        RemoveEntryList (Link);
+        InsertTailList (&NewBuckets[CoreHashIndex (GetKey (Link), NewBits)], Link);
+      }
+    }
+
+    CoreFreePool (Table->Buckets);
+  }
+
+  Table->Buckets = NewBuckets;
+  Table->Bits    = NewBits;
+  return TRUE;
+}
+
+/**
+  Adds an element to a hash table.
+  The gProtocolDatabaseLock must be owned
+
+  @param  Table                  The hash table
+  @param  InitialBits            Log2 of the bucket count of a new table
+  @param  GetKey                 Returns the hash key of a linked element
+  @param  Link                   The link of the element to add
+
+**/
+STATIC
+VOID
+CoreInsertHashTable (
+  IN OUT CORE_HASH_TABLE  *Table,
+  IN     UINTN            InitialBits,
+  IN     CORE_HASH_KEY    GetKey,
+  IN     LIST_ENTRY       *Link
+  )
+{
+  Table->Count++;
+  if ((Table->Buckets == NULL) || (Table->Count > ((UINTN)2 << Table->Bits))) {
+    if (!CoreGrowHashTable (Table, InitialBits, GetKey)) {
+      //
+      // Keep Link a valid empty list so that removal is always safe.
+      //
+      InitializeListHead (Link);
+      return;
+    }
+  }
+
+  InsertHeadList (&Table->Buckets[CoreHashIndex (GetKey (Link), Table->Bits)], Link);
+}
+
+/**
+  Removes an element from a hash table.
+  The gProtocolDatabaseLock must be owned
+
+  @param  Table                  The hash table
+  @param  Link                   The link of the element to remove
+
+**/
+STATIC
+VOID
+CoreRemoveHashTable (
+  IN OUT CORE_HASH_TABLE  *Table,
+  IN     LIST_ENTRY       *Link
+  )
+{
+  //
+  // Without buckets every link is an empty list of its own
+  //
+  if (Table->Buckets != NULL) {
+    RemoveEntryList (Link);
+  }
+
+  Table->Count--;
+}
+
+/**
+  Adds a protocol interface to the (Handle, Protocol) lookup index.
+  The gProtocolDatabaseLock must be owned
+
+  @param  Prot                   The protocol interface to add. Prot->Handle
+                                 and Prot->Protocol must already be set.
+
+**/
+VOID
+CoreInsertProtocolInterfaceHash (
+  IN PROTOCOL_INTERFACE  *Prot
+  )
+{
+  ASSERT_LOCKED (&gProtocolDatabaseLock);
+
+  CoreInsertHashTable (
+    &mProtocolInterfaceHash,
+    PROTOCOL_INTERFACE_HASH_INITIAL_BITS,
+    CoreProtocolInterfaceLinkKey,
+    &Prot->HashLink
+    );
+}
+
+/**
+  Removes a protocol interface from the (Handle, Protocol) lookup index.
+  The gProtocolDatabaseLock must be owned
+
+  @param  Prot                   The protocol interface to remove.
+
+**/
+VOID
+CoreRemoveProtocolInterfaceHash (
+  IN PROTOCOL_INTERFACE  *Prot
+  )
+{
+  ASSERT_LOCKED (&gProtocolDatabaseLock);
+
+  CoreRemoveHashTable (&mProtocolInterfaceHash, &Prot->HashLink);
+}
+
+/**
+  Finds the protocol interface installed on a handle for a protocol entry.
+  The gProtocolDatabaseLock must be owned
+
+  @param  Handle                 The handle to search the protocol on
+  @param  ProtEntry              The protocol entry to search for
+
+  @return Protocol instance (NULL: Not found)
+
+**/
+PROTOCOL_INTERFACE *
+CoreFindHandleProtocolInterface (
+  IN IHANDLE         *Handle,
+  IN PROTOCOL_ENTRY  *ProtEntry
+  )
+{
+  LIST_ENTRY          *Bucket;
+  LIST_ENTRY          *Link;
+  PROTOCOL_INTERFACE  *Prot;
+
+  ASSERT_LOCKED (&gProtocolDatabaseLock);
+
+  if (mProtocolInterfaceHash.Buckets == NULL) {
+    //
+    // No index, look at each protocol interface on the handle
+    //
+    for (Link = Handle->Protocols.ForwardLink; Link != &Handle->Protocols; Link = Link->ForwardLink) {
+      Prot = CR (Link, PROTOCOL_INTERFACE, Link, PROTOCOL_INTERFACE_SIGNATURE);
+      if (Prot->Protocol == ProtEntry) {
+        return Prot;
+      }
+    }
+
+    return NULL;
+  }
+
+  Bucket = &mProtocolInterfaceHash.Buckets[CoreHashIndex (CoreProtocolInterfaceKey (Handle, ProtEntry), mProtocolInterfaceHash.Bits)];
+  for (Link = Bucket->ForwardLink; Link != Bucket; Link = Link->ForwardLink) {
+    Prot = CR (Link, PROTOCOL_INTERFACE, HashLink, PROTOCOL_INTERFACE_SIGNATURE);
+    if ((Prot->Handle == Handle) && (Prot->Protocol == ProtEntry)) {
+      return Prot;
+    }
+  }
+
+  return NULL;
+}
+
 /**
   Acquire lock on gProtocolDatabaseLock.
 
@@ -60,6 +539,7 @@ CoreValidateHandle (
   )
 {
   IHANDLE     *Handle;
+  LIST_ENTRY  *Bucket;
   LIST_ENTRY  *Link;
 
   if (UserHandle == NULL) {
@@ -68,6 +548,22 @@ CoreValidateHandle (
 
   ASSERT_LOCKED (&gProtocolDatabaseLock);
 
+  if (mHandleHash.Buckets != NULL) {
+    //
+    // Only the handles linked on the bucket are dereferenced, UserHandle itself
+    // is just compared by address.
+    //
+    Bucket = &mHandleHash.Buckets[CoreHashIndex (CoreHandleKey (UserHandle), mHandleHash.Bits)];
+    for (Link = Bucket->ForwardLink; Link != Bucket; Link = Link->ForwardLink) {
+      Handle = CR (Link, IHANDLE, HashLink, EFI_HANDLE_SIGNATURE);
+      if (Handle == (IHANDLE *)UserHandle) {
+        return EFI_SUCCESS;
+      }
+    }
+
+    return EFI_INVALID_PARAMETER;
+  }
+
   for (Link = gHandleList.BackLink; Link != &gHandleList; Link = Link->BackLink) {
     Handle = CR (Link, IHANDLE, AllHandles, EFI_HANDLE_SIGNATURE);
     if (Handle == (IHANDLE *)UserHandle) {
@@ -97,6 +593,8 @@ CoreFindProtocolEntry (
   LIST_ENTRY      *Link;
   PROTOCOL_ENTRY  *Item;
   PROTOCOL_ENTRY  *ProtEntry;
+  UINTN           Index;
+  UINTN           Mask;
 
   ASSERT_LOCKED (&gProtocolDatabaseLock);
 
@@ -105,18 +603,32 @@ CoreFindProtocolEntry (
   //
 
   ProtEntry = NULL;
-  for (Link = mProtocolDatabase.ForwardLink;
-       Link != &mProtocolDatabase;
-       Link = Link->ForwardLink)
-  {
-    Item = CR (Link, PROTOCOL_ENTRY, AllEntries, PROTOCOL_ENTRY_SIGNATURE);
-    if (CompareGuid (&Item->ProtocolID, Protocol)) {
-      //
-      // This is the protocol entry
-      //
+  if (mProtocolEntryHash != NULL) {
+    Mask = ((UINTN)1 << mProtocolEntryHashBits) - 1;
+    for (Index = CoreHashIndex (CoreProtocolGuidKey (Protocol), mProtocolEntryHashBits);
+         mProtocolEntryHash[Index] != NULL;
+         Index = (Index + 1) & Mask)
+    {
+      Item = mProtocolEntryHash[Index];
+      if (CompareGuid (&Item->ProtocolID, Protocol)) {
+        ProtEntry = Item;
+        break;
+      }
+    }
+  } else {
+    for (Link = mProtocolDatabase.ForwardLink;
+         Link != &mProtocolDatabase;
+         Link = Link->ForwardLink)
+    {
+      Item = CR (Link, PROTOCOL_ENTRY, AllEntries, PROTOCOL_ENTRY_SIGNATURE);
+      if (CompareGuid (&Item->ProtocolID, Protocol)) {
+        //
+        // This is the protocol entry
+        //
 
-      ProtEntry = Item;
-      break;
+        ProtEntry = Item;
+        break;
+      }
     }
   }
 
@@ -135,11 +647,13 @@ CoreFindProtocolEntry (
       CopyGuid ((VOID *)&ProtEntry->ProtocolID, Protocol);
       InitializeListHead (&ProtEntry->Protocols);
       InitializeListHead (&ProtEntry->Notify);
+      InitializeListHead (&ProtEntry->DepexWaiters);
 
       //
       // Add it to protocol database
       //
       InsertTailList (&mProtocolDatabase, &ProtEntry->AllEntries);
+      CoreInsertProtocolEntryHash (ProtEntry);
     }
   }
 
@@ -167,7 +681,6 @@ CoreFindProtocolInterface (
 {
   PROTOCOL_INTERFACE  *Prot;
   PROTOCOL_ENTRY      *ProtEntry;
-  LIST_ENTRY          *Link;
 
   ASSERT_LOCKED (&gProtocolDatabaseLock);
   Prot = NULL;
@@ -179,17 +692,11 @@ CoreFindProtocolInterface (
   ProtEntry = CoreFindProtocolEntry (Protocol, FALSE);
   if (ProtEntry != NULL) {
     //
-    // Look at each protocol interface for any matches
+    // A protocol can only be installed once on a handle, so the
+    // (Handle, Protocol) index yields the only candidate.
     //
-    for (Link = Handle->Protocols.ForwardLink; Link != &Handle->Protocols; Link = Link->ForwardLink) {
-      //
-      // If this protocol interface matches, remove it
-      //
-      Prot = CR (Link, PROTOCOL_INTERFACE, Link, PROTOCOL_INTERFACE_SIGNATURE);
-      if ((Prot->Interface == Interface) && (Prot->Protocol == ProtEntry)) {
-        break;
-      }
-
+    Prot = CoreFindHandleProtocolInterface (Handle, ProtEntry);
+    if ((Prot != NULL) && (Prot->Interface != Interface)) {
       Prot = NULL;
     }
   }
@@ -267,6 +774,77 @@ CoreUnregisterProtocolNotify (
   return EFI_SUCCESS;
 }
 
+/**
+  Allocates a new handle and adds it to the handle database.
+  The gProtocolDatabaseLock must be owned
+
+  @return The new handle, or NULL if it could not be allocated
+
+**/
+STATIC
+IHANDLE *
+CoreCreateHandle (
+  VOID
+  )
+{
+  IHANDLE  *Handle;
+
+  Handle = AllocateZeroPool (sizeof (IHANDLE));
+  if (Handle == NULL) {
+    return NULL;
+  }
+
+  //
+  // Initialize new handler structure
+  //
+  Handle->Signature = EFI_HANDLE_SIGNATURE;
+  InitializeListHead (&Handle->Protocols);
+
+  //
+  // Initialize the Key to show that the handle has been created/modified
+  //
+  gHandleDatabaseKey++;
+  Handle->Key = gHandleDatabaseKey;
+
+  //
+  // Add this handle to the list global list of all handles
+  // in the system
+  //
+  InsertTailList (&gHandleList, &Handle->AllHandles);
+  CoreInsertHashTable (&mHandleHash, HANDLE_HASH_INITIAL_BITS, CoreHandleLinkKey, &Handle->HashLink);
+  gHandleCount++;
+
+  return Handle;
+}
+
+/**
+  Frees a protocol interface structure that was removed from the database.
+
+  @param  Prot                   The protocol interface to free
+
+**/
+STATIC
+VOID
+CoreFreeProtocolInterface (
+  IN PROTOCOL_INTERFACE  *Prot
+  )
+{
+  PROTOCOL_INTERFACE_BLOCK  *Block;
+
+  Prot->Signature = 0;
+  Block           = Prot->Block;
+  if (Block == NULL) {
+    CoreFreePool (Prot);
+    return;
+  }
+
+  ASSERT (Block->ReferenceCount > 0);
+  Block->ReferenceCount--;
+  if (Block->ReferenceCount == 0) {
+    CoreFreePool (Block);
+  }
+}
+
 /**
   Wrapper function to CoreInstallProtocolInterfaceNotify.  This is the public API which
   Calls the private one which contains a BOOLEAN parameter for notifications
@@ -386,29 +964,11 @@ CoreInstallProtocolInterfaceNotify (
   //
   Handle = (IHANDLE *)*UserHandle;
   if (Handle == NULL) {
-    Handle = AllocateZeroPool (sizeof (IHANDLE));
+    Handle = CoreCreateHandle ();
     if (Handle == NULL) {
       Status = EFI_OUT_OF_RESOURCES;
       goto Done;
     }
-
-    //
-    // Initialize new handler structure
-    //
-    Handle->Signature = EFI_HANDLE_SIGNATURE;
-    InitializeListHead (&Handle->Protocols);
-
-    //
-    // Initialize the Key to show that the handle has been created/modified
-    //
-    gHandleDatabaseKey++;
-    Handle->Key = gHandleDatabaseKey;
-
-    //
-    // Add this handle to the list global list of all handles
-    // in the system
-    //
-    InsertTailList (&gHandleList, &Handle->AllHandles);
   } else {
     Status = CoreValidateHandle (Handle);
     if (EFI_ERROR (Status)) {
@@ -448,6 +1008,11 @@ CoreInstallProtocolInterfaceNotify (
   //
   InsertTailList (&ProtEntry->Protocols, &Prot->ByProtocol);
 
+  //
+  // Add this protocol interface to the (Handle, Protocol) index
+  //
+  CoreInsertProtocolInterfaceHash (Prot);
+
   //
   // Notify the notification list for this protocol
   //
@@ -455,6 +1020,11 @@ CoreInstallProtocolInterfaceNotify (
     CoreNotifyProtocolEntry (ProtEntry);
   }
 
+  //
+  // The protocol can now be located, so wake the drivers whose depex waits on it
+  //
+  CoreNotifyDepexWaiters (ProtEntry);
+
   Status = EFI_SUCCESS;
 
 Done:
@@ -481,11 +1051,181 @@ Done:
   return Status;
 }
 
+/**
+  Installs several protocol interfaces on one handle under a single hold of
+  the protocol database lock. The PROTOCOL_INTERFACE structures share one
+  allocation, and the registered notifies of the protocols are signaled in one
+  pass once all the interfaces are linked. Either all the interfaces are
+  installed, or none of them.
+
+  @param  UserHandle             The handle to install the protocol interfaces
+                                 on, or NULL if a new handle is to be allocated
+  @param  Count                  The number of protocol interfaces, from 1 to
+                                 INSTALL_PROTOCOL_BATCH_MAX
+  @param  Protocols              The protocols to add to the handle
+  @param  Interfaces             The interfaces of the protocols
+
+  @retval EFI_INVALID_PARAMETER  The handle is invalid, or a protocol is
+                                 already on the handle or twice in the list
+  @retval EFI_OUT_OF_RESOURCES   No enough buffer to allocate
+  @retval EFI_SUCCESS            Protocol interfaces successfully installed
+
+**/
+STATIC
+EFI_STATUS
+CoreInstallProtocolInterfaceBatch (
+  IN OUT EFI_HANDLE  *UserHandle,
+  IN UINTN           Count,
+  IN EFI_GUID        **Protocols,
+  IN VOID            **Interfaces
+  )
+{
+  PROTOCOL_ENTRY            *ProtEntries[INSTALL_PROTOCOL_BATCH_MAX];
+  PROTOCOL_INTERFACE_BLOCK  *Block;
+  PROTOCOL_INTERFACE        *Prot;
+  IHANDLE                   *Handle;
+  EFI_STATUS                Status;
+  UINTN                     Index;
+  UINTN                     Other;
+
+  ASSERT (Count > 0 && Count <= INSTALL_PROTOCOL_BATCH_MAX);
+
+  for (Index = 0; Index < Count; Index++) {
+    DEBUG ((DEBUG_INFO, "InstallProtocolInterface: %g %p\n", Protocols[Index], Interfaces[Index]));
+  }
+
+  //
+  // Allocate all the protocol interface structures at once
+  //
+  Block = AllocateZeroPool (sizeof (PROTOCOL_INTERFACE_BLOCK) + Count * sizeof (PROTOCOL_INTERFACE));
+  if (Block == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  //
+  // Lock the protocol database
+  //
+  CoreAcquireProtocolLock ();
+
+  Handle = (IHANDLE *)*UserHandle;
+  if (Handle != NULL) {
+    Status = CoreValidateHandle (Handle);
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_ERROR, "InstallProtocolInterface: input handle at 0x%x is invalid\n", Handle));
+      goto Done;
+    }
+  }
+
+  //
+  // Lookup the Protocol Entries, and make sure that no protocol is already on
+  // the handle or twice in the list
+  //
+  for (Index = 0; Index < Count; Index++) {
+    ProtEntries[Index] = CoreFindProtocolEntry (Protocols[Index], TRUE);
+    if (ProtEntries[Index] == NULL) {
+      Status = EFI_OUT_OF_RESOURCES;
+      goto Done;
+    }
+
+    if ((Handle != NULL) && (CoreFindHandleProtocolInterface (Handle, ProtEntries[Index]) != NULL)) {
+      Status = EFI_INVALID_PARAMETER;
+      goto Done;
+    }
+
+    for (Other = 0; Other < Index; Other++) {
+      if (ProtEntries[Other] == ProtEntries[Index]) {
+        Status = EFI_INVALID_PARAMETER;
+        goto Done;
+      }
+    }
+  }
+
+  //
+  // If caller didn't supply a handle, allocate a new one
+  //
+  if (Handle == NULL) {
+    Handle = CoreCreateHandle ();
+    if (Handle == NULL) {
+      Status = EFI_OUT_OF_RESOURCES;
+      goto Done;
+    }
+  }
+
+  //
+  // Initialize the protocol interface structures and add them to the handle,
+  // to the protocol entries and to the (Handle, Protocol) index
+  //
+  Block->ReferenceCount = Count;
+  Prot                  = (PROTOCOL_INTERFACE *)(Block + 1);
+  for (Index = 0; Index < Count; Index++, Prot++) {
+    Prot->Signature = PROTOCOL_INTERFACE_SIGNATURE;
+    Prot->Handle    = Handle;
+    Prot->Protocol  = ProtEntries[Index];
+    Prot->Interface = Interfaces[Index];
+    Prot->Block     = Block;
+    InitializeListHead (&Prot->OpenList);
+    Prot->OpenListCount = 0;
+
+    InsertHeadList (&Handle->Protocols, &Prot->Link);
+    InsertTailList (&ProtEntries[Index]->Protocols, &Prot->ByProtocol);
+    CoreInsertProtocolInterfaceHash (Prot);
+  }
+
+  //
+  // All the interfaces can now be located, so notify the registered events
+  // and wake the drivers whose depex waits on the protocols
+  //
+  for (Index = 0; Index < Count; Index++) {
+    CoreNotifyProtocolEntry (ProtEntries[Index]);
+    CoreNotifyDepexWaiters (ProtEntries[Index]);
+  }
+
+  Status = EFI_SUCCESS;
+
+Done:
+  //
+  // Done, unlock the database and return
+  //
+  CoreReleaseProtocolLock ();
+  if (!EFI_ERROR (Status)) {
+    *UserHandle = Handle;
+  } else {
+    CoreFreePool (Block);
+    DEBUG ((DEBUG_ERROR, "InstallMultipleProtocolInterfaces: %Lu protocols failed with %r\n", (UINT64)Count, Status));
+  }
+
+  return Status;
+}
+
+/**
+  Checks whether a device path is already installed on a handle, as the
+  device path passed to InstallMultipleProtocolInterfaces() must be unique.
+
+  @param  DevicePath             The device path to check
+
+  @retval TRUE                   The device path is already installed.
+  @retval FALSE                  The device path is not installed.
+
+**/
+STATIC
+BOOLEAN
+CoreIsDevicePathInstalled (
+  IN EFI_DEVICE_PATH_PROTOCOL  *DevicePath
+  )
+{
+  EFI_STATUS  Status;
+  EFI_HANDLE  DeviceHandle;
+
+  DeviceHandle = NULL;
+  Status       = CoreLocateDevicePath (&gEfiDevicePathProtocolGuid, &DevicePath, &DeviceHandle);
+  return (BOOLEAN)(!EFI_ERROR (Status) && (DeviceHandle != NULL) && IsDevicePathEnd (DevicePath));
+}
+
 /**
   Installs a list of protocol interface into the boot services environment.
-  This function calls InstallProtocolInterface() in a loop. If any error
-  occures all the protocols added by this function are removed. This is
-  basically a lib function to save space.
+  Up to INSTALL_PROTOCOL_BATCH_MAX protocols are installed as a single batch.
+  Longer lists are installed by calling InstallProtocolInterface() in a loop.
+  If any error occures all the protocols added by this function are removed.
 
   @param  Handle                 The pointer to a handle to install the new
                                  protocol interfaces on, or a pointer to NULL
@@ -510,15 +1250,16 @@ CoreInstallMultipleProtocolInterfaces (
   ...
   )
 {
-  VA_LIST                   Args;
-  EFI_STATUS                Status;
-  EFI_GUID                  *Protocol;
-  VOID                      *Interface;
-  EFI_TPL                   OldTpl;
-  UINTN                     Index;
-  EFI_HANDLE                OldHandle;
-  EFI_HANDLE                DeviceHandle;
-  EFI_DEVICE_PATH_PROTOCOL  *DevicePath;
+  VA_LIST     Args;
+  EFI_STATUS  Status;
+  EFI_GUID    *Protocol;
+  VOID        *Interface;
+  EFI_TPL     OldTpl;
+  UINTN       Index;
+  UINTN       Count;
+  EFI_HANDLE  OldHandle;
+  EFI_GUID    *Protocols[INSTALL_PROTOCOL_BATCH_MAX];
+  VOID        *Interfaces[INSTALL_PROTOCOL_BATCH_MAX];
 
   if (Handle == NULL) {
     return EFI_INVALID_PARAMETER;
@@ -530,6 +1271,45 @@ CoreInstallMultipleProtocolInterfaces (
   OldTpl    = CoreRaiseTpl (TPL_NOTIFY);
   OldHandle = *Handle;
 
+  //
+  // Collect the protocol interfaces. Short lists, as installed by bus drivers
+  // on every child handle, are installed as one batch.
+  //
+  VA_START (Args, Handle);
+  for (Count = 0, Status = EFI_SUCCESS; Count <= INSTALL_PROTOCOL_BATCH_MAX; Count++) {
+    Protocol = VA_ARG (Args, EFI_GUID *);
+    if (Protocol == NULL) {
+      break;
+    }
+
+    Interface = VA_ARG (Args, VOID *);
+    if (Count == INSTALL_PROTOCOL_BATCH_MAX) {
+      continue;
+    }
+
+    //
+    // Make sure you are installing on top a device path that has already been added.
+    //
+    if (CompareGuid (Protocol, &gEfiDevicePathProtocolGuid) && CoreIsDevicePathInstalled (Interface)) {
+      Status = EFI_ALREADY_STARTED;
+      break;
+    }
+
+    Protocols[Count]  = Protocol;
+    Interfaces[Count] = Interface;
+  }
+
+  VA_END (Args);
+
+  if (EFI_ERROR (Status) || (Count <= INSTALL_PROTOCOL_BATCH_MAX)) {
+    if (!EFI_ERROR (Status) && (Count > 0)) {
+      Status = CoreInstallProtocolInterfaceBatch (Handle, Count, Protocols, Interfaces);
+    }
+
+    CoreRestoreTpl (OldTpl);
+    return Status;
+  }
+
   //
   // Check for duplicate device path and install the protocol interfaces
   //
@@ -548,14 +1328,9 @@ CoreInstallMultipleProtocolInterfaces (
     //
     // Make sure you are installing on top a device path that has already been added.
     //
-    if (CompareGuid (Protocol, &gEfiDevicePathProtocolGuid)) {
-      DeviceHandle = NULL;
-      DevicePath   = Interface;
-      Status       = CoreLocateDevicePath (&gEfiDevicePathProtocolGuid, &DevicePath, &DeviceHandle);
-      if (!EFI_ERROR (Status) && (DeviceHandle != NULL) && IsDevicePathEnd (DevicePath)) {
-        Status = EFI_ALREADY_STARTED;
-        continue;
-      }
+    if (CompareGuid (Protocol, &gEfiDevicePathProtocolGuid) && CoreIsDevicePathInstalled (Interface)) {
+      Status = EFI_ALREADY_STARTED;
+      continue;
     }
 
     //
@@ -756,12 +1531,12 @@ CoreUninstallProtocolInterface (
     // Remove the protocol interface from the handle
     //
     RemoveEntryList (&Prot->Link);
+    CoreRemoveProtocolInterfaceHash (Prot);
 
     //
     // Free the memory
     //
-    Prot->Signature = 0;
-    CoreFreePool (Prot);
+    CoreFreeProtocolInterface (Prot);
     Status = EFI_SUCCESS;
   }
 
@@ -771,6 +1546,8 @@ CoreUninstallProtocolInterface (
   if (IsListEmpty (&Handle->Protocols)) {
     Handle->Signature = 0;
     RemoveEntryList (&Handle->AllHandles);
+    CoreRemoveHashTable (&mHandleHash, &Handle->HashLink);
+    gHandleCount--;
     CoreFreePool (Handle);
   }
 
@@ -874,28 +1651,20 @@ CoreGetProtocolInterface (
   IN  EFI_GUID    *Protocol
   )
 {
-  EFI_STATUS          Status;
-  PROTOCOL_ENTRY      *ProtEntry;
-  PROTOCOL_INTERFACE  *Prot;
-  IHANDLE             *Handle;
-  LIST_ENTRY          *Link;
+  EFI_STATUS      Status;
+  PROTOCOL_ENTRY  *ProtEntry;
 
   Status = CoreValidateHandle (UserHandle);
   if (EFI_ERROR (Status)) {
     return NULL;
   }
 
-  Handle = (IHANDLE *)UserHandle;
-
   //
-  // Look at each protocol interface for a match
+  // A protocol that has no entry in the database cannot be on any handle
   //
-  for (Link = Handle->Protocols.ForwardLink; Link != &Handle->Protocols; Link = Link->ForwardLink) {
-    Prot      = CR (Link, PROTOCOL_INTERFACE, Link, PROTOCOL_INTERFACE_SIGNATURE);
-    ProtEntry = Prot->Protocol;
-    if (CompareGuid (&ProtEntry->ProtocolID, Protocol)) {
-      return Prot;
-    }
+  ProtEntry = CoreFindProtocolEntry (Protocol, FALSE);
+  if (ProtEntry != NULL) {
+    return CoreFindHandleProtocolInterface ((IHANDLE *)UserHandle, ProtEntry);
   }
 
   return NULL;
@@ -1527,14 +2296,10 @@ CoreConnectHandlesByKey (
   //
   CoreAcquireProtocolLock ();
 
-  for (Link = gHandleList.ForwardLink, Count = 0; Link != &gHandleList; Link = Link->ForwardLink) {
-    Handle = CR (Link, IHANDLE, AllHandles, EFI_HANDLE_SIGNATURE);
-    if (Handle->Key > Key) {
-      Count++;
-    }
-  }
-
-  HandleBuffer = AllocatePool (Count * sizeof (EFI_HANDLE));
+  //
+  // Size the buffer for the worst case so the handle list is walked once
+  //
+  HandleBuffer = AllocatePool (gHandleCount * sizeof (EFI_HANDLE));
   if (HandleBuffer == NULL) {
     CoreReleaseProtocolLock ();
     return;
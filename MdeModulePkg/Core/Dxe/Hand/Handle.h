@@ -23,6 +23,8 @@ typedef struct {
   UINTN         LocateRequest;
   /// The Handle Database Key value when this handle was last created or modified
   UINT64        Key;
+  /// Link on the mHandleHash bucket for the handle address
+  LIST_ENTRY    HashLink;
 } IHANDLE;
 
 #define ASSERT_IS_HANDLE(a)  ASSERT((a)->Signature == EFI_HANDLE_SIGNATURE)
@@ -44,29 +46,45 @@ typedef struct {
   LIST_ENTRY    Protocols;
   /// Registerd notification handlers
   LIST_ENTRY    Notify;
+  /// Dispatcher drivers whose depex waits on this protocol
+  LIST_ENTRY    DepexWaiters;
 } PROTOCOL_ENTRY;
 
 #define PROTOCOL_INTERFACE_SIGNATURE  SIGNATURE_32('p','i','f','c')
 
+///
+/// PROTOCOL_INTERFACE_BLOCK - header of the single allocation that holds the
+/// PROTOCOL_INTERFACE structures installed together by
+/// InstallMultipleProtocolInterfaces(). The structures follow the header, and
+/// the block is freed when the last of them is uninstalled.
+///
+typedef struct {
+  UINTN    ReferenceCount;
+} PROTOCOL_INTERFACE_BLOCK;
+
 ///
 /// PROTOCOL_INTERFACE - each protocol installed on a handle is tracked
 /// with a protocol interface structure
 ///
 typedef struct {
-  UINTN             Signature;
+  UINTN                       Signature;
   /// Link on IHANDLE.Protocols
-  LIST_ENTRY        Link;
+  LIST_ENTRY                  Link;
   /// Back pointer
-  IHANDLE           *Handle;
+  IHANDLE                     *Handle;
   /// Link on PROTOCOL_ENTRY.Protocols
-  LIST_ENTRY        ByProtocol;
+  LIST_ENTRY                  ByProtocol;
   /// The protocol ID
-  PROTOCOL_ENTRY    *Protocol;
+  PROTOCOL_ENTRY              *Protocol;
   /// The interface value
-  VOID              *Interface;
+  VOID                        *Interface;
   /// OPEN_PROTOCOL_DATA list
-  LIST_ENTRY        OpenList;
-  UINTN             OpenListCount;
+  LIST_ENTRY                  OpenList;
+  UINTN                       OpenListCount;
+  /// Link on the mProtocolInterfaceHash bucket for (Handle, Protocol)
+  LIST_ENTRY                  HashLink;
+  /// Block the structure was allocated from, or NULL if it was allocated alone
+  PROTOCOL_INTERFACE_BLOCK    *Block;
 } PROTOCOL_INTERFACE;
 
 #define OPEN_PROTOCOL_DATA_SIGNATURE  SIGNATURE_32('p','o','d','l')
@@ -114,6 +132,47 @@ CoreFindProtocolEntry (
   IN BOOLEAN   Create
   );
 
+/**
+  Adds a protocol interface to the (Handle, Protocol) lookup index.
+  The gProtocolDatabaseLock must be owned
+
+  @param  Prot                   The protocol interface to add. Prot->Handle
+                                 and Prot->Protocol must already be set.
+
+**/
+VOID
+CoreInsertProtocolInterfaceHash (
+  IN PROTOCOL_INTERFACE  *Prot
+  );
+
+/**
+  Removes a protocol interface from the (Handle, Protocol) lookup index.
+  The gProtocolDatabaseLock must be owned
+
+  @param  Prot                   The protocol interface to remove.
+
+**/
+VOID
+CoreRemoveProtocolInterfaceHash (
+  IN PROTOCOL_INTERFACE  *Prot
+  );
+
+/**
+  Finds the protocol interface installed on a handle for a protocol entry.
+  The gProtocolDatabaseLock must be owned
+
+  @param  Handle                 The handle to search the protocol on
+  @param  ProtEntry              The protocol entry to search for
+
+  @return Protocol instance (NULL: Not found)
+
+**/
+PROTOCOL_INTERFACE *
+CoreFindHandleProtocolInterface (
+  IN IHANDLE         *Handle,
+  IN PROTOCOL_ENTRY  *ProtEntry
+  );
+
 /**
   Signal event for every protocol in protocol entry.
 
@@ -125,6 +184,17 @@ CoreNotifyProtocolEntry (
   IN PROTOCOL_ENTRY  *ProtEntry
   );
 
+/**
+  Wake every dispatcher driver whose depex waits on the protocol entry.
+
+  @param  ProtEntry              Protocol entry
+
+**/
+VOID
+CoreNotifyDepexWaiters (
+  IN PROTOCOL_ENTRY  *ProtEntry
+  );
+
 /**
   Finds the protocol instance for the requested handle and protocol.
   Note: This function doesn't do parameters checking, it's caller's responsibility
@@ -247,6 +317,7 @@ CoreValidateHandle (
 //
 extern EFI_LOCK    gProtocolDatabaseLock;
 extern LIST_ENTRY  gHandleList;
+extern UINTN       gHandleCount;
 extern UINT64      gHandleDatabaseKey;
 
 #endif
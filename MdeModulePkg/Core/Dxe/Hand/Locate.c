@@ -147,6 +147,22 @@ InternalCoreLocateHandle (
   //
   switch (SearchType) {
     case AllHandles:
+      //
+      // The number of handles is known, so a size query or a buffer that is
+      // too small can be answered without walking the handle list. The
+      // request is counted as if the list had been walked.
+      //
+      if (gHandleCount == 0) {
+        mEfiLocateHandleRequest += 1;
+        return EFI_NOT_FOUND;
+      }
+
+      if (*BufferSize < gHandleCount * sizeof (EFI_HANDLE)) {
+        mEfiLocateHandleRequest += 1;
+        *BufferSize = gHandleCount * sizeof (EFI_HANDLE);
+        return EFI_BUFFER_TOO_SMALL;
+      }
+
       GetNext = CoreGetNextLocateAllHandles;
       break;
 
@@ -33,6 +33,75 @@ CoreNotifyProtocolEntry (
   }
 }
 
+/**
+  Wake every dispatcher driver whose depex waits on the protocol entry.
+
+  @param  ProtEntry              Protocol entry
+
+**/
+VOID
+CoreNotifyDepexWaiters (
+  IN PROTOCOL_ENTRY  *ProtEntry
+  )
+{
+  DEPEX_PROTOCOL_WAITER  *Waiter;
+  LIST_ENTRY             *Link;
+
+  ASSERT_LOCKED (&gProtocolDatabaseLock);
+
+  for (Link = ProtEntry->DepexWaiters.ForwardLink; Link != &ProtEntry->DepexWaiters; Link = Link->ForwardLink) {
+    Waiter = CR (Link, DEPEX_PROTOCOL_WAITER, Link, DEPEX_PROTOCOL_WAITER_SIGNATURE);
+    CoreDepexProtocolInstalled (Waiter);
+  }
+}
+
+/**
+  Link a depex waiter onto the protocol entry of Protocol, creating the entry
+  if the protocol has not been installed yet.
+
+  @param  Protocol              The protocol GUID pushed by the depex.
+  @param  Waiter                The waiter to link.
+
+  @retval EFI_SUCCESS           The waiter was linked.
+  @retval EFI_OUT_OF_RESOURCES  The protocol entry could not be created.
+
+**/
+EFI_STATUS
+CoreRegisterDepexWaiter (
+  IN EFI_GUID               *Protocol,
+  IN DEPEX_PROTOCOL_WAITER  *Waiter
+  )
+{
+  PROTOCOL_ENTRY  *ProtEntry;
+
+  CoreAcquireProtocolLock ();
+
+  ProtEntry = CoreFindProtocolEntry (Protocol, TRUE);
+  if (ProtEntry != NULL) {
+    InsertTailList (&ProtEntry->DepexWaiters, &Waiter->Link);
+  }
+
+  CoreReleaseProtocolLock ();
+
+  return (ProtEntry != NULL) ? EFI_SUCCESS : EFI_OUT_OF_RESOURCES;
+}
+
+/**
+  Unlink a depex waiter from its protocol entry.
+
+  @param  Waiter                The waiter to unlink.
+
+**/
+VOID
+CoreUnregisterDepexWaiter (
+  IN DEPEX_PROTOCOL_WAITER  *Waiter
+  )
+{
+  CoreAcquireProtocolLock ();
+  RemoveEntryList (&Waiter->Link);
+  CoreReleaseProtocolLock ();
+}
+
 /**
   Removes Protocol from the protocol list (but not the handle list).
 
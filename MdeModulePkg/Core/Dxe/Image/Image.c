@@ -1240,14 +1240,21 @@ CoreLoadImageCommon (
     }
 
     //
-    // Get the source file buffer by its device path.
+    // Use the image the dispatcher already decoded, if any. Otherwise get the
+    // source file buffer by its device path.
     //
-    FHand.Source = GetFileBufferByFilePath (
-                     BootPolicy,
-                     FilePath,
-                     &FHand.SourceSize,
-                     &AuthenticationStatus
-                     );
+    if (ImageIsFromFv) {
+      FHand.Source = CoreGetPrefetchedImage (FilePath, &FHand.SourceSize, &AuthenticationStatus);
+    }
+
+    if (FHand.Source == NULL) {
+      FHand.Source = GetFileBufferByFilePath (
+                       BootPolicy,
+                       FilePath,
+                       &FHand.SourceSize,
+                       &AuthenticationStatus
+                       );
+    }
     if (FHand.Source == NULL) {
       Status = EFI_NOT_FOUND;
     } else {
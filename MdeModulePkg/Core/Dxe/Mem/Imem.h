@@ -30,17 +30,27 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 //
 
 #define MEMORY_MAP_SIGNATURE  SIGNATURE_32('m','m','a','p')
-typedef struct {
-  UINTN              Signature;
-  LIST_ENTRY         Link;
-  BOOLEAN            FromPages;
-
-  EFI_MEMORY_TYPE    Type;
-  UINT64             Start;
-  UINT64             End;
-
-  UINT64             VirtualStart;
-  UINT64             Attribute;
+typedef struct _MEMORY_MAP {
+  UINTN                 Signature;
+  LIST_ENTRY            Link;
+  BOOLEAN               FromPages;
+
+  EFI_MEMORY_TYPE       Type;
+  UINT64                Start;
+  UINT64                End;
+
+  UINT64                VirtualStart;
+  UINT64                Attribute;
+
+  ///
+  /// Node of the address ordered AVL index over gMemoryMap. IndexMaxFreeBytes
+  /// is the largest EfiConventionalMemory entry in the subtree.
+  ///
+  struct _MEMORY_MAP    *IndexParent;
+  struct _MEMORY_MAP    *IndexLeft;
+  struct _MEMORY_MAP    *IndexRight;
+  UINTN                 IndexHeight;
+  UINT64                IndexMaxFreeBytes;
 } MEMORY_MAP;
 
 //
@@ -115,6 +125,22 @@ CoreFreePoolI (
   OUT EFI_MEMORY_TYPE  *PoolType OPTIONAL
   );
 
+/**
+  Get the slab allocator statistics for the memory profile.
+
+  @param  SlabInfo      Buffer to receive a MEMORY_PROFILE_POOL_SLAB record
+                        followed by one MEMORY_PROFILE_POOL_SLAB_CLASS per
+                        class, or NULL to query the size only.
+
+  @return               The size of the statistics, or 0 if the slab
+                        allocator is disabled.
+
+**/
+UINTN
+CoreGetPoolSlabStatistics (
+  OUT MEMORY_PROFILE_POOL_SLAB  *SlabInfo OPTIONAL
+  );
+
 /**
   Enter critical section by gaining lock on gMemoryLock.
 
@@ -1483,6 +1483,8 @@ MemoryProfileGetDataSize (
     }
   }
 
+  TotalSize += CoreGetPoolSlabStatistics (NULL);
+
   return TotalSize;
 }
 
@@ -1560,6 +1562,8 @@ MemoryProfileCopyData (
 
     DriverInfo = (MEMORY_PROFILE_DRIVER_INFO *)AllocInfo;
   }
+
+  CoreGetPoolSlabStatistics ((MEMORY_PROFILE_POOL_SLAB *)DriverInfo);
 }
 
 /**
@@ -23,6 +23,23 @@ typedef struct {
   BOOLEAN                 Runtime;
 } EFI_MEMORY_TYPE_STATISTICS;
 
+//
+// Range of the memory map changed by a generation of the memory map
+//
+typedef struct {
+  UINT64                  Generation;
+  EFI_PHYSICAL_ADDRESS    Start;
+  EFI_PHYSICAL_ADDRESS    End;
+} MEMORY_MAP_CHANGE;
+
+#define MEMORY_MAP_CHANGE_LOG_SIZE  64
+
+//
+// Number of descriptors the copy of the memory map can grow by before it has
+// to be reallocated
+//
+#define MEMORY_MAP_CACHE_SLACK  16
+
 //
 // MemoryMap - The current memory map
 //
@@ -44,6 +61,44 @@ UINTN       mFreeMapStack = 0;
 ///
 LIST_ENTRY  mFreeMemoryMapEntryList           = INITIALIZE_LIST_HEAD_VARIABLE (mFreeMemoryMapEntryList);
 BOOLEAN     mMemoryTypeInformationInitialized = FALSE;
+///
+/// Root of the address ordered index over the entries of gMemoryMap. It is
+/// kept next to the list so that lookups, merges and free page searches do
+/// not walk the whole map. The list order itself is unchanged.
+///
+MEMORY_MAP  *mMemoryMapIndexRoot = NULL;
+
+///
+/// mMemoryMapGeneration - generation of the memory map returned by
+/// CoreGetMemoryMap(). Unlike mMemoryMapKey it also changes when only the GCD
+/// memory space map changes.
+///
+UINT64  mMemoryMapGeneration = 0;
+///
+/// mMemoryMapChangeLog - ring of the ranges changed by the latest generations.
+/// The changes of the generations up to mMemoryMapChangeLogFloor are no longer
+/// in the log. It is updated with the memory lock or the GCD memory lock held,
+/// so always at TPL_NOTIFY.
+///
+MEMORY_MAP_CHANGE  mMemoryMapChangeLog[MEMORY_MAP_CHANGE_LOG_SIZE];
+UINTN              mMemoryMapChangeLogCount = 0;
+UINTN              mMemoryMapChangeLogNext  = 0;
+UINT64             mMemoryMapChangeLogFloor = 0;
+///
+/// mMemoryMapCache - copy of the last memory map built by CoreGetMemoryMap(),
+/// returned again as long as mMemoryMapGeneration does not change.
+///
+BOOLEAN                mMemoryMapCacheValid        = FALSE;
+EFI_MEMORY_DESCRIPTOR  *mMemoryMapCache            = NULL;
+UINTN                  mMemoryMapCacheBufferSize   = 0;
+UINTN                  mMemoryMapCacheSize         = 0;
+UINTN                  mMemoryMapCacheRequiredSize = 0;
+UINTN                  mMemoryMapCacheKey          = 0;
+UINT64                 mMemoryMapCacheGeneration   = 0;
+///
+/// mMemoryMapRequiredSize - buffer size last required by CoreGetMemoryMap()
+///
+UINTN  mMemoryMapRequiredSize = 0;
 
 EFI_MEMORY_TYPE_STATISTICS  mMemoryTypeStatistics[EfiMaxMemoryType + 1] = {
   { 0, MAX_ALLOC_ADDRESS, 0, 0, EfiMaxMemoryType, TRUE,  FALSE },  // EfiReservedMemoryType
@@ -116,6 +171,458 @@ CoreReleaseMemoryLock (
   CoreReleaseLock (&gMemoryLock);
 }
 
+/**
+  Record a change to the memory map returned by CoreGetMemoryMap(), and move
+  the memory map to the next generation.
+
+  The caller must hold the memory lock or the GCD memory lock.
+
+  @param  Start                  The first address of the changed range
+  @param  End                    The last address of the changed range. A
+                                 range from 0 to MAX_UINT64 records a change to
+                                 the whole map.
+
+**/
+VOID
+CoreLogMemoryMapChange (
+  IN EFI_PHYSICAL_ADDRESS  Start,
+  IN EFI_PHYSICAL_ADDRESS  End
+  )
+{
+  MEMORY_MAP_CHANGE  *Change;
+
+  mMemoryMapGeneration++;
+
+  if ((Start == 0) && (End == MAX_UINT64)) {
+    //
+    // Every range changed, so the older changes no longer matter
+    //
+    mMemoryMapChangeLogFloor = mMemoryMapGeneration;
+    mMemoryMapChangeLogCount = 0;
+    mMemoryMapChangeLogNext  = 0;
+    return;
+  }
+
+  //
+  // A page conversion changes adjacent ranges one after the other, so extend
+  // the latest change if the ranges overlap or touch
+  //
+  if (mMemoryMapChangeLogCount > 0) {
+    Change = &mMemoryMapChangeLog[(mMemoryMapChangeLogNext + MEMORY_MAP_CHANGE_LOG_SIZE - 1) % MEMORY_MAP_CHANGE_LOG_SIZE];
+    if (((Start <= Change->End) || (Start - 1 == Change->End)) &&
+        ((End >= Change->Start) || (End + 1 == Change->Start)))
+    {
+      Change->Start      = MIN (Start, Change->Start);
+      Change->End        = MAX (End, Change->End);
+      Change->Generation = mMemoryMapGeneration;
+      return;
+    }
+  }
+
+  Change = &mMemoryMapChangeLog[mMemoryMapChangeLogNext];
+  if (mMemoryMapChangeLogCount == MEMORY_MAP_CHANGE_LOG_SIZE) {
+    //
+    // The oldest change is dropped. The generations only grow along the ring,
+    // so it is also the one with the lowest generation.
+    //
+    mMemoryMapChangeLogFloor = Change->Generation;
+  } else {
+    mMemoryMapChangeLogCount++;
+  }
+
+  Change->Generation      = mMemoryMapGeneration;
+  Change->Start           = Start;
+  Change->End             = End;
+  mMemoryMapChangeLogNext = (mMemoryMapChangeLogNext + 1) % MEMORY_MAP_CHANGE_LOG_SIZE;
+}
+
+/**
+  Internal function.  Gets the number of free bytes described by an entry.
+
+  @param  Entry                  The memory map entry
+
+  @return The size of the entry if it is EfiConventionalMemory, otherwise 0
+
+**/
+STATIC
+UINT64
+GetMemoryMapEntryFreeBytes (
+  IN MEMORY_MAP  *Entry
+  )
+{
+  if ((Entry->Type != EfiConventionalMemory) || (Entry->End < Entry->Start)) {
+    return 0;
+  }
+
+  return Entry->End - Entry->Start + 1;
+}
+
+/**
+  Internal function.  Recomputes the height and the largest free range of an
+  index node from the node and its children.
+
+  @param  Entry                  The memory map entry
+
+**/
+STATIC
+VOID
+UpdateMemoryMapIndexNode (
+  IN OUT MEMORY_MAP  *Entry
+  )
+{
+  UINTN   LeftHeight;
+  UINTN   RightHeight;
+  UINT64  MaxFreeBytes;
+
+  LeftHeight   = 0;
+  RightHeight  = 0;
+  MaxFreeBytes = GetMemoryMapEntryFreeBytes (Entry);
+
+  if (Entry->IndexLeft != NULL) {
+    LeftHeight   = Entry->IndexLeft->IndexHeight;
+    MaxFreeBytes = MAX (MaxFreeBytes, Entry->IndexLeft->IndexMaxFreeBytes);
+  }
+
+  if (Entry->IndexRight != NULL) {
+    RightHeight  = Entry->IndexRight->IndexHeight;
+    MaxFreeBytes = MAX (MaxFreeBytes, Entry->IndexRight->IndexMaxFreeBytes);
+  }
+
+  Entry->IndexHeight       = MAX (LeftHeight, RightHeight) + 1;
+  Entry->IndexMaxFreeBytes = MaxFreeBytes;
+}
+
+/**
+  Internal function.  Gets the height of an index subtree.
+
+  @param  Entry                  The root of the subtree, or NULL
+
+  @return The height of the subtree
+
+**/
+STATIC
+UINTN
+GetMemoryMapIndexHeight (
+  IN MEMORY_MAP  *Entry
+  )
+{
+  return (Entry == NULL) ? 0 : Entry->IndexHeight;
+}
+
+/**
+  Internal function.  Makes NewChild take the place of OldChild below Parent.
+
+  @param  Parent                 The parent node, or NULL if OldChild is the root
+  @param  OldChild               The child to replace
+  @param  NewChild               The new child, or NULL
+
+**/
+STATIC
+VOID
+ReplaceMemoryMapIndexChild (
+  IN MEMORY_MAP  *Parent,
+  IN MEMORY_MAP  *OldChild,
+  IN MEMORY_MAP  *NewChild
+  )
+{
+  if (Parent == NULL) {
+    mMemoryMapIndexRoot = NewChild;
+  } else if (Parent->IndexLeft == OldChild) {
+    Parent->IndexLeft = NewChild;
+  } else {
+    ASSERT (Parent->IndexRight == OldChild);
+    Parent->IndexRight = NewChild;
+  }
+
+  if (NewChild != NULL) {
+    NewChild->IndexParent = Parent;
+  }
+}
+
+/**
+  Internal function.  Rotates an index subtree to the left.
+
+  @param  Entry                  The root of the subtree
+
+  @return The new root of the subtree
+
+**/
+STATIC
+MEMORY_MAP *
+RotateMemoryMapIndexLeft (
+  IN MEMORY_MAP  *Entry
+  )
+{
+  MEMORY_MAP  *Pivot;
+
+  Pivot             = Entry->IndexRight;
+  Entry->IndexRight = Pivot->IndexLeft;
+  if (Pivot->IndexLeft != NULL) {
+    Pivot->IndexLeft->IndexParent = Entry;
+  }
+
+  ReplaceMemoryMapIndexChild (Entry->IndexParent, Entry, Pivot);
+  Pivot->IndexLeft   = Entry;
+  Entry->IndexParent = Pivot;
+
+  UpdateMemoryMapIndexNode (Entry);
+  UpdateMemoryMapIndexNode (Pivot);
+  return Pivot;
+}
+
+/**
+  Internal function.  Rotates an index subtree to the right.
+
+  @param  Entry                  The root of the subtree
+
+  @return The new root of the subtree
+
+**/
+STATIC
+MEMORY_MAP *
+RotateMemoryMapIndexRight (
+  IN MEMORY_MAP  *Entry
+  )
+{
+  MEMORY_MAP  *Pivot;
+
+  Pivot            = Entry->IndexLeft;
+  Entry->IndexLeft = Pivot->IndexRight;
+  if (Pivot->IndexRight != NULL) {
+    Pivot->IndexRight->IndexParent = Entry;
+  }
+
+  ReplaceMemoryMapIndexChild (Entry->IndexParent, Entry, Pivot);
+  Pivot->IndexRight  = Entry;
+  Entry->IndexParent = Pivot;
+
+  UpdateMemoryMapIndexNode (Entry);
+  UpdateMemoryMapIndexNode (Pivot);
+  return Pivot;
+}
+
+/**
+  Internal function.  Walks from an index node up to the root, restoring the
+  AVL balance and the largest free range of every node on the way.
+
+  @param  Entry                  The lowest node that changed, or NULL
+
+**/
+STATIC
+VOID
+RebalanceMemoryMapIndex (
+  IN MEMORY_MAP  *Entry
+  )
+{
+  UINTN  LeftHeight;
+  UINTN  RightHeight;
+
+  while (Entry != NULL) {
+    UpdateMemoryMapIndexNode (Entry);
+    LeftHeight  = GetMemoryMapIndexHeight (Entry->IndexLeft);
+    RightHeight = GetMemoryMapIndexHeight (Entry->IndexRight);
+
+    if (LeftHeight > RightHeight + 1) {
+      if (GetMemoryMapIndexHeight (Entry->IndexLeft->IndexLeft) <
+          GetMemoryMapIndexHeight (Entry->IndexLeft->IndexRight))
+      {
+        RotateMemoryMapIndexLeft (Entry->IndexLeft);
+      }
+
+      Entry = RotateMemoryMapIndexRight (Entry);
+    } else if (RightHeight > LeftHeight + 1) {
+      if (GetMemoryMapIndexHeight (Entry->IndexRight->IndexRight) <
+          GetMemoryMapIndexHeight (Entry->IndexRight->IndexLeft))
+      {
+        RotateMemoryMapIndexRight (Entry->IndexRight);
+      }
+
+      Entry = RotateMemoryMapIndexLeft (Entry);
+    }
+
+    Entry = Entry->IndexParent;
+  }
+}
+
+/**
+  Internal function.  Adds an entry of gMemoryMap to the address ordered index.
+
+  @param  Entry                  The entry to add
+
+**/
+STATIC
+VOID
+InsertMemoryMapIndex (
+  IN OUT MEMORY_MAP  *Entry
+  )
+{
+  MEMORY_MAP  *Parent;
+  MEMORY_MAP  *Node;
+
+  Parent = NULL;
+  Node   = mMemoryMapIndexRoot;
+  while (Node != NULL) {
+    Parent = Node;
+    Node   = (Entry->Start < Node->Start) ? Node->IndexLeft : Node->IndexRight;
+  }
+
+  Entry->IndexLeft   = NULL;
+  Entry->IndexRight  = NULL;
+  Entry->IndexParent = Parent;
+  if (Parent == NULL) {
+    mMemoryMapIndexRoot = Entry;
+  } else if (Entry->Start < Parent->Start) {
+    Parent->IndexLeft = Entry;
+  } else {
+    Parent->IndexRight = Entry;
+  }
+
+  RebalanceMemoryMapIndex (Entry);
+}
+
+/**
+  Internal function.  Removes an entry of gMemoryMap from the address ordered
+  index.  The entry is unlinked by address of the node rather than by key, so
+  an entry that was clipped to an empty range can be removed as well.
+
+  @param  Entry                  The entry to remove
+
+**/
+STATIC
+VOID
+RemoveMemoryMapIndex (
+  IN OUT MEMORY_MAP  *Entry
+  )
+{
+  MEMORY_MAP  *Successor;
+  MEMORY_MAP  *Rebalance;
+
+  if ((Entry->IndexLeft != NULL) && (Entry->IndexRight != NULL)) {
+    //
+    // Move the in-order successor into the place of the entry
+    //
+    Successor = Entry->IndexRight;
+    while (Successor->IndexLeft != NULL) {
+      Successor = Successor->IndexLeft;
+    }
+
+    if (Successor->IndexParent != Entry) {
+      Rebalance = Successor->IndexParent;
+      ReplaceMemoryMapIndexChild (Rebalance, Successor, Successor->IndexRight);
+      Successor->IndexRight                = Entry->IndexRight;
+      Successor->IndexRight->IndexParent   = Successor;
+    } else {
+      Rebalance = Successor;
+    }
+
+    ReplaceMemoryMapIndexChild (Entry->IndexParent, Entry, Successor);
+    Successor->IndexLeft              = Entry->IndexLeft;
+    Successor->IndexLeft->IndexParent = Successor;
+  } else {
+    Rebalance = Entry->IndexParent;
+    ReplaceMemoryMapIndexChild (
+      Rebalance,
+      Entry,
+      (Entry->IndexLeft != NULL) ? Entry->IndexLeft : Entry->IndexRight
+      );
+  }
+
+  Entry->IndexParent = NULL;
+  Entry->IndexLeft   = NULL;
+  Entry->IndexRight  = NULL;
+
+  RebalanceMemoryMapIndex (Rebalance);
+}
+
+/**
+  Internal function.  Moves the index node of an entry to a copy of the entry.
+
+  @param  OldEntry               The entry in the index
+  @param  NewEntry               The copy of OldEntry that replaces it
+
+**/
+STATIC
+VOID
+ReplaceMemoryMapIndex (
+  IN MEMORY_MAP      *OldEntry,
+  IN OUT MEMORY_MAP  *NewEntry
+  )
+{
+  ReplaceMemoryMapIndexChild (OldEntry->IndexParent, OldEntry, NewEntry);
+  if (NewEntry->IndexLeft != NULL) {
+    NewEntry->IndexLeft->IndexParent = NewEntry;
+  }
+
+  if (NewEntry->IndexRight != NULL) {
+    NewEntry->IndexRight->IndexParent = NewEntry;
+  }
+}
+
+/**
+  Internal function.  Gets the next entry of the index in address order.
+
+  @param  Entry                  The current entry
+
+  @return The entry with the next higher address, or NULL
+
+**/
+STATIC
+MEMORY_MAP *
+GetNextMemoryMapIndex (
+  IN MEMORY_MAP  *Entry
+  )
+{
+  if (Entry->IndexRight != NULL) {
+    Entry = Entry->IndexRight;
+    while (Entry->IndexLeft != NULL) {
+      Entry = Entry->IndexLeft;
+    }
+
+    return Entry;
+  }
+
+  while ((Entry->IndexParent != NULL) && (Entry->IndexParent->IndexRight == Entry)) {
+    Entry = Entry->IndexParent;
+  }
+
+  return Entry->IndexParent;
+}
+
+/**
+  Internal function.  Finds the entry of gMemoryMap that covers an address.
+
+  @param  Address                The address to look up
+
+  @return The entry covering Address, or NULL if no entry does
+
+**/
+STATIC
+MEMORY_MAP *
+LookupMemoryMapIndex (
+  IN UINT64  Address
+  )
+{
+  MEMORY_MAP  *Node;
+  MEMORY_MAP  *Found;
+
+  Found = NULL;
+  Node  = mMemoryMapIndexRoot;
+  while (Node != NULL) {
+    if (Node->Start <= Address) {
+      Found = Node;
+      Node  = Node->IndexRight;
+    } else {
+      Node = Node->IndexLeft;
+    }
+  }
+
+  if ((Found == NULL) || (Found->End < Address)) {
+    return NULL;
+  }
+
+  return Found;
+}
+
 /**
   Internal function.  Removes a descriptor entry.
 
@@ -129,6 +636,7 @@ RemoveMemoryMapEntry (
 {
   RemoveEntryList (&Entry->Link);
   Entry->Link.ForwardLink = NULL;
+  RemoveMemoryMapIndex (Entry);
 
   if (Entry->FromPages) {
     //
@@ -158,7 +666,6 @@ CoreAddRange (
   IN UINT64                Attribute
   )
 {
-  LIST_ENTRY  *Link;
   MEMORY_MAP  *Entry;
 
   ASSERT ((Start & EFI_PAGE_MASK) == 0);
@@ -187,6 +694,7 @@ CoreAddRange (
   // Memory map being altered so updated key
   //
   mMemoryMapKey += 1;
+  CoreLogMemoryMapChange (Start, End);
 
   //
   // UEFI 2.0 added an event group for notificaiton on memory map changes.
@@ -207,23 +715,19 @@ CoreAddRange (
   // and the same Attribute
   //
 
-  Link = gMemoryMap.ForwardLink;
-  while (Link != &gMemoryMap) {
-    Entry = CR (Link, MEMORY_MAP, Link, MEMORY_MAP_SIGNATURE);
-    Link  = Link->ForwardLink;
-
-    if (Entry->Type != Type) {
-      continue;
-    }
-
-    if (Entry->Attribute != Attribute) {
-      continue;
-    }
-
-    if (Entry->End + 1 == Start) {
+  if (Start != 0) {
+    Entry = LookupMemoryMapIndex (Start - 1);
+    if ((Entry != NULL) && (Entry->Type == Type) && (Entry->Attribute == Attribute)) {
+      ASSERT (Entry->End + 1 == Start);
       Start = Entry->Start;
       RemoveMemoryMapEntry (Entry);
-    } else if (Entry->Start == End + 1) {
+    }
+  }
+
+  if (End != MAX_UINT64) {
+    Entry = LookupMemoryMapIndex (End + 1);
+    if ((Entry != NULL) && (Entry->Type == Type) && (Entry->Attribute == Attribute)) {
+      ASSERT (Entry->Start == End + 1);
       End = Entry->End;
       RemoveMemoryMapEntry (Entry);
     }
@@ -241,6 +745,7 @@ CoreAddRange (
   mMapStack[mMapDepth].VirtualStart = 0;
   mMapStack[mMapDepth].Attribute    = Attribute;
   InsertTailList (&gMemoryMap, &mMapStack[mMapDepth].Link);
+  InsertMemoryMapIndex (&mMapStack[mMapDepth]);
 
   mMapDepth += 1;
   ASSERT (mMapDepth < MAX_MAP_DEPTH);
@@ -352,13 +857,17 @@ CoreFreeMemoryMapStack (
 
       CopyMem (Entry, &mMapStack[mMapDepth], sizeof (MEMORY_MAP));
       Entry->FromPages = TRUE;
+      ReplaceMemoryMapIndex (&mMapStack[mMapDepth], Entry);
 
       //
-      // Find insertion location
+      // Find insertion location. The entries from pages are kept in address
+      // order in the list, so insert in front of the next one in the index.
+      // Only the few entries still on the map stack have to be skipped.
       //
-      for (Link2 = gMemoryMap.ForwardLink; Link2 != &gMemoryMap; Link2 = Link2->ForwardLink) {
-        Entry2 = CR (Link2, MEMORY_MAP, Link, MEMORY_MAP_SIGNATURE);
-        if (Entry2->FromPages && (Entry2->Start > Entry->Start)) {
+      Link2 = &gMemoryMap;
+      for (Entry2 = GetNextMemoryMapIndex (Entry); Entry2 != NULL; Entry2 = GetNextMemoryMapIndex (Entry2)) {
+        if (Entry2->FromPages) {
+          Link2 = &Entry2->Link;
           break;
         }
       }
@@ -699,6 +1208,13 @@ CoreAddMemoryDescriptor (
     }
   }
 
+  //
+  // The memory type bins decide the type of free memory in the memory map
+  //
+  CoreAcquireMemoryLock ();
+  CoreLogMemoryMapChange (0, MAX_UINT64);
+  CoreReleaseMemoryLock ();
+
   mMemoryTypeInformationInitialized = TRUE;
 }
 
@@ -737,7 +1253,6 @@ CoreConvertPagesEx (
   UINT64           RangeEnd;
   UINT64           Attribute;
   EFI_MEMORY_TYPE  MemType;
-  LIST_ENTRY       *Link;
   MEMORY_MAP       *Entry;
 
   Entry         = NULL;
@@ -762,15 +1277,8 @@ CoreConvertPagesEx (
     //
     // Find the entry that the covers the range
     //
-    for (Link = gMemoryMap.ForwardLink; Link != &gMemoryMap; Link = Link->ForwardLink) {
-      Entry = CR (Link, MEMORY_MAP, Link, MEMORY_MAP_SIGNATURE);
-
-      if ((Entry->Start <= Start) && (Entry->End > Start)) {
-        break;
-      }
-    }
-
-    if (Link == &gMemoryMap) {
+    Entry = LookupMemoryMapIndex (Start);
+    if (Entry == NULL) {
       DEBUG ((DEBUG_ERROR | DEBUG_PAGE, "ConvertPages: failed to find range %lx - %lx\n", Start, End));
       return EFI_NOT_FOUND;
     }
@@ -856,11 +1364,13 @@ CoreConvertPagesEx (
       // Clip start
       //
       Entry->Start = RangeEnd + 1;
+      RebalanceMemoryMapIndex (Entry);
     } else if (Entry->End == RangeEnd) {
       //
       // Clip end
       //
       Entry->End = Start - 1;
+      RebalanceMemoryMapIndex (Entry);
     } else {
       //
       // Pull it out of the center, clip current
@@ -882,9 +1392,11 @@ CoreConvertPagesEx (
 
       Entry->End = Start - 1;
       ASSERT (Entry->Start < Entry->End);
+      RebalanceMemoryMapIndex (Entry);
 
       Entry = &mMapStack[mMapDepth];
       InsertTailList (&gMemoryMap, &Entry->Link);
+      InsertMemoryMapIndex (Entry);
 
       mMapDepth += 1;
       ASSERT (mMapDepth < MAX_MAP_DEPTH);
@@ -919,6 +1431,12 @@ CoreConvertPagesEx (
         (MemType != EfiConventionalMemory))
     {
       CoreAddRange (MemType, Start, RangeEnd, Attribute);
+    } else {
+      //
+      // The range was still cut out of the map, so the cached memory map
+      // and the change log have to see it as CoreAddRange() would record it.
+      //
+      CoreLogMemoryMapChange (Start, RangeEnd);
     }
 
     if (ChangingType && (MemType == EfiConventionalMemory)) {
@@ -981,29 +1499,174 @@ CoreConvertPages (
 }
 
 /**
-  Internal function.  Converts a memory range to use new attributes.
+  Internal function.  Converts a memory range to use new attributes.
+
+  @param  Start                  The first address of the range Must be page
+                                 aligned
+  @param  NumberOfPages          The number of pages to convert
+  @param  NewAttributes          The new attributes value for the range.
+
+**/
+VOID
+CoreUpdateMemoryAttributes (
+  IN EFI_PHYSICAL_ADDRESS  Start,
+  IN UINT64                NumberOfPages,
+  IN UINT64                NewAttributes
+  )
+{
+  CoreAcquireMemoryLock ();
+
+  //
+  // Update the attributes to the new value
+  //
+  CoreConvertPagesEx (Start, NumberOfPages, FALSE, (EFI_MEMORY_TYPE)0, TRUE, NewAttributes);
+
+  CoreReleaseMemoryLock ();
+}
+
+/**
+  Internal function.  Checks whether a free entry can hold a range of pages
+  within the requested address window.
+
+  @param  Entry                  The memory map entry
+  @param  MaxAddress             The address that the range must be below
+  @param  MinAddress             The address that the range must be above
+  @param  NumberOfBytes          Number of bytes needed
+  @param  Alignment              Bits to align with
+  @param  NeedGuard              Flag to indicate Guard page is needed or not
+
+  @return The highest end address of the range in Entry, or 0 if it does not fit
+
+**/
+STATIC
+UINT64
+CoreCheckFreePagesEntry (
+  IN MEMORY_MAP  *Entry,
+  IN UINT64      MaxAddress,
+  IN UINT64      MinAddress,
+  IN UINT64      NumberOfBytes,
+  IN UINTN       Alignment,
+  IN BOOLEAN     NeedGuard
+  )
+{
+  UINT64  DescStart;
+  UINT64  DescEnd;
+  UINT64  DescNumberOfBytes;
+
+  //
+  // If it's not a free entry, don't bother with it
+  //
+  if (Entry->Type != EfiConventionalMemory) {
+    return 0;
+  }
+
+  DescStart = Entry->Start;
+  DescEnd   = Entry->End;
+
+  //
+  // If desc is past max allowed address or below min allowed address, skip it
+  //
+  if ((DescStart >= MaxAddress) || (DescEnd < MinAddress)) {
+    return 0;
+  }
+
+  //
+  // If desc ends past max allowed address, clip the end
+  //
+  if (DescEnd >= MaxAddress) {
+    DescEnd = MaxAddress;
+  }
+
+  DescEnd = ((DescEnd + 1) & (~(Alignment - 1))) - 1;
+
+  // Skip if DescEnd is less than DescStart after alignment clipping
+  if (DescEnd < DescStart) {
+    return 0;
+  }
+
+  //
+  // Compute the number of bytes we can used from this
+  // descriptor, and see it's enough to satisfy the request
+  //
+  DescNumberOfBytes = DescEnd - DescStart + 1;
+
+  if (DescNumberOfBytes < NumberOfBytes) {
+    return 0;
+  }
+
+  //
+  // If the start of the allocated range is below the min address allowed, skip it
+  //
+  if ((DescEnd - NumberOfBytes + 1) < MinAddress) {
+    return 0;
+  }
+
+  if (NeedGuard) {
+    DescEnd = AdjustMemoryS (
+                DescEnd + 1 - DescNumberOfBytes,
+                DescNumberOfBytes,
+                NumberOfBytes
+                );
+  }
+
+  return DescEnd;
+}
+
+/**
+  Internal function.  Finds the highest free range in an index subtree that
+  satisfies a page allocation.  Subtrees without a large enough free entry,
+  or entirely outside of the address window, are not visited.
 
-  @param  Start                  The first address of the range Must be page
-                                 aligned
-  @param  NumberOfPages          The number of pages to convert
-  @param  NewAttributes          The new attributes value for the range.
+  @param  Entry                  The root of the subtree, or NULL
+  @param  MaxAddress             The address that the range must be below
+  @param  MinAddress             The address that the range must be above
+  @param  NumberOfBytes          Number of bytes needed
+  @param  Alignment              Bits to align with
+  @param  NeedGuard              Flag to indicate Guard page is needed or not
+
+  @return The end address of the range, or 0 if the range was not found
 
 **/
-VOID
-CoreUpdateMemoryAttributes (
-  IN EFI_PHYSICAL_ADDRESS  Start,
-  IN UINT64                NumberOfPages,
-  IN UINT64                NewAttributes
+STATIC
+UINT64
+CoreFindFreePagesInIndex (
+  IN MEMORY_MAP  *Entry,
+  IN UINT64      MaxAddress,
+  IN UINT64      MinAddress,
+  IN UINT64      NumberOfBytes,
+  IN UINTN       Alignment,
+  IN BOOLEAN     NeedGuard
   )
 {
-  CoreAcquireMemoryLock ();
+  UINT64  Target;
+
+  if ((Entry == NULL) || (Entry->IndexMaxFreeBytes < NumberOfBytes)) {
+    return 0;
+  }
 
   //
-  // Update the attributes to the new value
+  // Higher addresses first, the first fit is the best one
   //
-  CoreConvertPagesEx (Start, NumberOfPages, FALSE, (EFI_MEMORY_TYPE)0, TRUE, NewAttributes);
+  if (Entry->Start < MaxAddress) {
+    Target = CoreFindFreePagesInIndex (Entry->IndexRight, MaxAddress, MinAddress, NumberOfBytes, Alignment, NeedGuard);
+    if (Target != 0) {
+      return Target;
+    }
 
-  CoreReleaseMemoryLock ();
+    Target = CoreCheckFreePagesEntry (Entry, MaxAddress, MinAddress, NumberOfBytes, Alignment, NeedGuard);
+    if (Target != 0) {
+      return Target;
+    }
+  }
+
+  //
+  // Everything on the left ends below Entry->Start
+  //
+  if (Entry->Start <= MinAddress) {
+    return 0;
+  }
+
+  return CoreFindFreePagesInIndex (Entry->IndexLeft, MaxAddress, MinAddress, NumberOfBytes, Alignment, NeedGuard);
 }
 
 /**
@@ -1031,13 +1694,8 @@ CoreFindFreePagesI (
   IN BOOLEAN          NeedGuard
   )
 {
-  UINT64      NumberOfBytes;
-  UINT64      Target;
-  UINT64      DescStart;
-  UINT64      DescEnd;
-  UINT64      DescNumberOfBytes;
-  LIST_ENTRY  *Link;
-  MEMORY_MAP  *Entry;
+  UINT64  NumberOfBytes;
+  UINT64  Target;
 
   if ((MaxAddress < EFI_PAGE_MASK) || (NumberOfPages == 0)) {
     return 0;
@@ -1065,75 +1723,14 @@ CoreFindFreePagesI (
   }
 
   NumberOfBytes = LShiftU64 (NumberOfPages, EFI_PAGE_SHIFT);
-  Target        = 0;
-
-  for (Link = gMemoryMap.ForwardLink; Link != &gMemoryMap; Link = Link->ForwardLink) {
-    Entry = CR (Link, MEMORY_MAP, Link, MEMORY_MAP_SIGNATURE);
-
-    //
-    // If it's not a free entry, don't bother with it
-    //
-    if (Entry->Type != EfiConventionalMemory) {
-      continue;
-    }
-
-    DescStart = Entry->Start;
-    DescEnd   = Entry->End;
-
-    //
-    // If desc is past max allowed address or below min allowed address, skip it
-    //
-    if ((DescStart >= MaxAddress) || (DescEnd < MinAddress)) {
-      continue;
-    }
-
-    //
-    // If desc ends past max allowed address, clip the end
-    //
-    if (DescEnd >= MaxAddress) {
-      DescEnd = MaxAddress;
-    }
-
-    DescEnd = ((DescEnd + 1) & (~(Alignment - 1))) - 1;
-
-    // Skip if DescEnd is less than DescStart after alignment clipping
-    if (DescEnd < DescStart) {
-      continue;
-    }
-
-    //
-    // Compute the number of bytes we can used from this
-    // descriptor, and see it's enough to satisfy the request
-    //
-    DescNumberOfBytes = DescEnd - DescStart + 1;
-
-    if (DescNumberOfBytes >= NumberOfBytes) {
-      //
-      // If the start of the allocated range is below the min address allowed, skip it
-      //
-      if ((DescEnd - NumberOfBytes + 1) < MinAddress) {
-        continue;
-      }
-
-      //
-      // If this is the best match so far remember it
-      //
-      if (DescEnd > Target) {
-        if (NeedGuard) {
-          DescEnd = AdjustMemoryS (
-                      DescEnd + 1 - DescNumberOfBytes,
-                      DescNumberOfBytes,
-                      NumberOfBytes
-                      );
-          if (DescEnd == 0) {
-            continue;
-          }
-        }
-
-        Target = DescEnd;
-      }
-    }
-  }
+  Target        = CoreFindFreePagesInIndex (
+                    mMemoryMapIndexRoot,
+                    MaxAddress,
+                    MinAddress,
+                    NumberOfBytes,
+                    Alignment,
+                    NeedGuard
+                    );
 
   //
   // If this is a grow down, adjust target to be the allocation base
@@ -1511,7 +2108,6 @@ CoreInternalFreePages (
   )
 {
   EFI_STATUS  Status;
-  LIST_ENTRY  *Link;
   MEMORY_MAP  *Entry;
   UINTN       Alignment;
   BOOLEAN     IsGuarded;
@@ -1525,15 +2121,8 @@ CoreInternalFreePages (
   // Find the entry that the covers the range
   //
   IsGuarded = FALSE;
-  Entry     = NULL;
-  for (Link = gMemoryMap.ForwardLink; Link != &gMemoryMap; Link = Link->ForwardLink) {
-    Entry = CR (Link, MEMORY_MAP, Link, MEMORY_MAP_SIGNATURE);
-    if ((Entry->Start <= Memory) && (Entry->End > Memory)) {
-      break;
-    }
-  }
-
-  if (Link == &gMemoryMap) {
+  Entry     = LookupMemoryMapIndex (Memory);
+  if (Entry == NULL) {
     Status = EFI_NOT_FOUND;
     goto Done;
   }
@@ -1703,6 +2292,80 @@ MergeMemoryMapDescriptor (
   return NEXT_MEMORY_DESCRIPTOR (MemoryMapDescriptor, DescriptorSize);
 }
 
+/**
+  Internal function.  Makes the copy of the memory map large enough for a
+  memory map of a given size.  It must be called before the memory map is
+  built, so that allocating the copy does not change the map key returned to
+  the caller.
+
+  @param  Size                   The size of the memory map in bytes
+
+**/
+STATIC
+VOID
+CoreGrowMemoryMapCache (
+  IN UINTN  Size
+  )
+{
+  EFI_STATUS  Status;
+  VOID        *NewCache;
+  VOID        *OldCache;
+
+  Status = CoreAllocatePool (EfiBootServicesData, Size, &NewCache);
+  if (EFI_ERROR (Status)) {
+    return;
+  }
+
+  CoreAcquireMemoryLock ();
+  if (Size > mMemoryMapCacheBufferSize) {
+    OldCache                  = mMemoryMapCache;
+    mMemoryMapCache           = NewCache;
+    mMemoryMapCacheBufferSize = Size;
+    mMemoryMapCacheValid      = FALSE;
+  } else {
+    OldCache = NewCache;
+  }
+
+  CoreReleaseMemoryLock ();
+
+  if (OldCache != NULL) {
+    CoreFreePool (OldCache);
+  }
+}
+
+/**
+  Internal function.  Checks whether a range changed after a generation of the
+  memory map.  Caller must hold the memory lock.
+
+  @param  Start                  The first address of the range
+  @param  End                    The last address of the range
+  @param  Generation             The generation of the memory map
+
+  @retval TRUE                   The range may have changed.
+  @retval FALSE                  The range did not change.
+
+**/
+STATIC
+BOOLEAN
+IsMemoryMapRangeChanged (
+  IN EFI_PHYSICAL_ADDRESS  Start,
+  IN EFI_PHYSICAL_ADDRESS  End,
+  IN UINT64                Generation
+  )
+{
+  UINTN              Index;
+  MEMORY_MAP_CHANGE  *Change;
+
+  for (Index = 0; Index < mMemoryMapChangeLogCount; Index++) {
+    Change = &mMemoryMapChangeLog[Index];
+    if ((Change->Generation > Generation) && (Change->Start <= End) && (Change->End >= Start)) {
+      return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
 /**
   This function returns a copy of the current memory map. The map is an array of
   memory descriptors, each of which describes a contiguous block of memory.
@@ -1754,6 +2417,7 @@ CoreGetMemoryMap (
   EFI_MEMORY_TYPE        Type;
   EFI_MEMORY_DESCRIPTOR  *MemoryMapStart;
   EFI_MEMORY_DESCRIPTOR  *MemoryMapEnd;
+  UINTN                  CacheSize;
 
   //
   // Make sure the parameters are valid
@@ -1762,24 +2426,22 @@ CoreGetMemoryMap (
     return EFI_INVALID_PARAMETER;
   }
 
-  CoreAcquireGcdMemoryLock ();
-
   //
-  // Count the number of Reserved and runtime MMIO entries
-  // And, count the number of Persistent entries.
+  // Make room to keep a copy of the map that is about to be built, unless the
+  // copy already holds the current map
   //
-  NumberOfEntries = 0;
-  for (Link = mGcdMemorySpaceMap.ForwardLink; Link != &mGcdMemorySpaceMap; Link = Link->ForwardLink) {
-    GcdMapEntry = CR (Link, EFI_GCD_MAP_ENTRY, Link, EFI_GCD_MAP_SIGNATURE);
-    if ((GcdMapEntry->GcdMemoryType == EfiGcdMemoryTypePersistent) ||
-        (GcdMapEntry->GcdMemoryType == EfiGcdMemoryTypeReserved) ||
-        ((GcdMapEntry->GcdMemoryType == EfiGcdMemoryTypeMemoryMappedIo) &&
-         ((GcdMapEntry->Attributes & EFI_MEMORY_RUNTIME) == EFI_MEMORY_RUNTIME)))
-    {
-      NumberOfEntries++;
+  if (!gMemoryMapTerminated && (MemoryMap != NULL) && (mMemoryMapRequiredSize != 0) &&
+      !(mMemoryMapCacheValid && (mMemoryMapCacheGeneration == mMemoryMapGeneration)))
+  {
+    CacheSize = MIN (*MemoryMapSize, mMemoryMapRequiredSize + MEMORY_MAP_CACHE_SLACK * sizeof (EFI_MEMORY_DESCRIPTOR));
+    if (CacheSize > mMemoryMapCacheBufferSize) {
+      CoreGrowMemoryMapCache (CacheSize);
     }
   }
 
+  CoreAcquireGcdMemoryLock ();
+  CoreAcquireMemoryLock ();
+
   Size = sizeof (EFI_MEMORY_DESCRIPTOR);
 
   //
@@ -1797,7 +2459,43 @@ CoreGetMemoryMap (
     *DescriptorVersion = EFI_MEMORY_DESCRIPTOR_VERSION;
   }
 
-  CoreAcquireMemoryLock ();
+  //
+  // Nothing changed since the map was last built, so return the same map
+  //
+  if (mMemoryMapCacheValid && (mMemoryMapCacheGeneration == mMemoryMapGeneration)) {
+    BufferSize = mMemoryMapCacheRequiredSize;
+    if (*MemoryMapSize < BufferSize) {
+      Status = EFI_BUFFER_TOO_SMALL;
+      goto Done;
+    }
+
+    if (MemoryMap == NULL) {
+      Status = EFI_INVALID_PARAMETER;
+      goto Done;
+    }
+
+    ZeroMem ((UINT8 *)MemoryMap + mMemoryMapCacheSize, BufferSize - mMemoryMapCacheSize);
+    CopyMem (MemoryMap, mMemoryMapCache, mMemoryMapCacheSize);
+    BufferSize = mMemoryMapCacheSize;
+    Status     = EFI_SUCCESS;
+    goto Done;
+  }
+
+  //
+  // Count the number of Reserved and runtime MMIO entries
+  // And, count the number of Persistent entries.
+  //
+  NumberOfEntries = 0;
+  for (Link = mGcdMemorySpaceMap.ForwardLink; Link != &mGcdMemorySpaceMap; Link = Link->ForwardLink) {
+    GcdMapEntry = CR (Link, EFI_GCD_MAP_ENTRY, Link, EFI_GCD_MAP_SIGNATURE);
+    if ((GcdMapEntry->GcdMemoryType == EfiGcdMemoryTypePersistent) ||
+        (GcdMapEntry->GcdMemoryType == EfiGcdMemoryTypeReserved) ||
+        ((GcdMapEntry->GcdMemoryType == EfiGcdMemoryTypeMemoryMappedIo) &&
+         ((GcdMapEntry->Attributes & EFI_MEMORY_RUNTIME) == EFI_MEMORY_RUNTIME)))
+    {
+      NumberOfEntries++;
+    }
+  }
 
   //
   // Compute the buffer size needed to fit the entire map
@@ -1807,6 +2505,8 @@ CoreGetMemoryMap (
     BufferSize += Size;
   }
 
+  mMemoryMapRequiredSize = BufferSize;
+
   if (*MemoryMapSize < BufferSize) {
     Status = EFI_BUFFER_TOO_SMALL;
     goto Done;
@@ -1988,6 +2688,18 @@ CoreGetMemoryMap (
   MergeMemoryMap (MemoryMapStart, &BufferSize, Size);
   MemoryMapEnd = (EFI_MEMORY_DESCRIPTOR *)((UINT8 *)MemoryMapStart + BufferSize);
 
+  //
+  // Keep a copy of the map for the next calls
+  //
+  if (BufferSize <= mMemoryMapCacheBufferSize) {
+    CopyMem (mMemoryMapCache, MemoryMapStart, BufferSize);
+    mMemoryMapCacheSize         = BufferSize;
+    mMemoryMapCacheRequiredSize = mMemoryMapRequiredSize;
+    mMemoryMapCacheKey          = mMemoryMapKey;
+    mMemoryMapCacheGeneration   = mMemoryMapGeneration;
+    mMemoryMapCacheValid        = TRUE;
+  }
+
   Status = EFI_SUCCESS;
 
 Done:
@@ -2011,6 +2723,171 @@ Done:
   return Status;
 }
 
+/**
+  Return the descriptors of the memory map that changed since a generation.
+
+  @param  Generation             On input, the generation of the memory map
+                                 known by the caller, or 0 to get the whole map.
+                                 On output, the generation of the returned
+                                 descriptors.
+  @param  MemoryMapSize          On input, the size of MemoryMap in bytes. On
+                                 output, the size of the returned descriptors,
+                                 or the size needed if the buffer is too small.
+  @param  MemoryMap              The buffer that receives the descriptors.
+  @param  MapKey                 The key of the memory map of Generation.
+  @param  DescriptorSize         The size of one EFI_MEMORY_DESCRIPTOR.
+  @param  DescriptorVersion      The version of EFI_MEMORY_DESCRIPTOR.
+  @param  FullMap                TRUE if the whole memory map was returned.
+
+  @retval EFI_SUCCESS            The changed descriptors were returned.
+  @retval EFI_BUFFER_TOO_SMALL   MemoryMap is too small. The size needed is
+                                 returned in MemoryMapSize.
+  @retval EFI_INVALID_PARAMETER  One of the parameters has an invalid value.
+  @retval EFI_OUT_OF_RESOURCES   The memory map could not be captured.
+
+**/
+EFI_STATUS
+EFIAPI
+CoreGetMemoryMapChanges (
+  IN OUT UINT64                 *Generation,
+  IN OUT UINTN                  *MemoryMapSize,
+  OUT    EFI_MEMORY_DESCRIPTOR  *MemoryMap,
+  OUT    UINTN                  *MapKey OPTIONAL,
+  OUT    UINTN                  *DescriptorSize OPTIONAL,
+  OUT    UINT32                 *DescriptorVersion OPTIONAL,
+  OUT    BOOLEAN                *FullMap
+  )
+{
+  EFI_STATUS             Status;
+  VOID                   *Buffer;
+  UINTN                  BufferSize;
+  UINTN                  Size;
+  UINTN                  ChangedSize;
+  BOOLEAN                Full;
+  EFI_MEMORY_DESCRIPTOR  *Descriptor;
+  EFI_MEMORY_DESCRIPTOR  *DescriptorEnd;
+
+  if ((Generation == NULL) || (MemoryMapSize == NULL) || (FullMap == NULL)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  //
+  // Build the current memory map, which leaves a copy of it in the cache
+  //
+  if (!mMemoryMapCacheValid || (mMemoryMapCacheGeneration != mMemoryMapGeneration)) {
+    Buffer     = NULL;
+    BufferSize = 0;
+    while (TRUE) {
+      Status = CoreGetMemoryMap (&BufferSize, Buffer, NULL, NULL, NULL);
+      if (Status != EFI_BUFFER_TOO_SMALL) {
+        break;
+      }
+
+      if (Buffer != NULL) {
+        CoreFreePool (Buffer);
+      }
+
+      BufferSize += MEMORY_MAP_CACHE_SLACK * sizeof (EFI_MEMORY_DESCRIPTOR);
+      Status      = CoreAllocatePool (EfiBootServicesData, BufferSize, &Buffer);
+      if (EFI_ERROR (Status)) {
+        Buffer = NULL;
+        break;
+      }
+    }
+
+    if (Buffer != NULL) {
+      CoreFreePool (Buffer);
+    }
+
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+  }
+
+  Size  = sizeof (EFI_MEMORY_DESCRIPTOR);
+  Size += sizeof (UINT64) - (Size % sizeof (UINT64));
+
+  CoreAcquireMemoryLock ();
+
+  //
+  // The copy could not be allocated
+  //
+  if (!mMemoryMapCacheValid) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto Done;
+  }
+
+  if (*Generation > mMemoryMapCacheGeneration) {
+    Status = EFI_INVALID_PARAMETER;
+    goto Done;
+  }
+
+  //
+  // The copy may already be older than the current map, as freeing the buffer
+  // above changes the map. It is still a consistent map of its generation,
+  // and the caller gets the newer changes from the next call.
+  //
+  Full          = (BOOLEAN)((*Generation == 0) || (*Generation < mMemoryMapChangeLogFloor));
+  DescriptorEnd = (EFI_MEMORY_DESCRIPTOR *)((UINT8 *)mMemoryMapCache + mMemoryMapCacheSize);
+  ChangedSize   = 0;
+  for (Descriptor = mMemoryMapCache; Descriptor < DescriptorEnd; Descriptor = NEXT_MEMORY_DESCRIPTOR (Descriptor, Size)) {
+    if (Full ||
+        IsMemoryMapRangeChanged (
+          Descriptor->PhysicalStart,
+          Descriptor->PhysicalStart + LShiftU64 (Descriptor->NumberOfPages, EFI_PAGE_SHIFT) - 1,
+          *Generation
+          ))
+    {
+      ChangedSize += Size;
+    }
+  }
+
+  if (*MemoryMapSize < ChangedSize) {
+    *MemoryMapSize = ChangedSize;
+    Status         = EFI_BUFFER_TOO_SMALL;
+    goto Done;
+  }
+
+  if ((MemoryMap == NULL) && (ChangedSize != 0)) {
+    Status = EFI_INVALID_PARAMETER;
+    goto Done;
+  }
+
+  for (Descriptor = mMemoryMapCache; Descriptor < DescriptorEnd; Descriptor = NEXT_MEMORY_DESCRIPTOR (Descriptor, Size)) {
+    if (Full ||
+        IsMemoryMapRangeChanged (
+          Descriptor->PhysicalStart,
+          Descriptor->PhysicalStart + LShiftU64 (Descriptor->NumberOfPages, EFI_PAGE_SHIFT) - 1,
+          *Generation
+          ))
+    {
+      CopyMem (MemoryMap, Descriptor, Size);
+      MemoryMap = NEXT_MEMORY_DESCRIPTOR (MemoryMap, Size);
+    }
+  }
+
+  *MemoryMapSize = ChangedSize;
+  *Generation    = mMemoryMapCacheGeneration;
+  *FullMap       = Full;
+  if (MapKey != NULL) {
+    *MapKey = mMemoryMapCacheKey;
+  }
+
+  if (DescriptorSize != NULL) {
+    *DescriptorSize = Size;
+  }
+
+  if (DescriptorVersion != NULL) {
+    *DescriptorVersion = EFI_MEMORY_DESCRIPTOR_VERSION;
+  }
+
+  Status = EFI_SUCCESS;
+
+Done:
+  CoreReleaseMemoryLock ();
+  return Status;
+}
+
 /**
   Internal function.  Used by the pool functions to allocate pages
   to back pool allocation requests.
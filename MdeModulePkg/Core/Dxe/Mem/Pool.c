@@ -63,15 +63,69 @@ STATIC CONST UINT16  mPoolSizeTable[] = {
 // Globals
 //
 
+//
+// Small allocations are served from slab pages when PcdDxeCorePoolSlabEnable
+// is set and the allocation is not guarded. A slab page holds the objects of
+// one size class behind a POOL_SLAB header with a bitmap of free slots. Each
+// object is preceded by a POOL_SLAB_OBJECT instead of POOL_HEAD and POOL_TAIL.
+//
+STATIC CONST UINT16  mPoolSlabSizeTable[] = {
+  16, 32, 48, 64, 96, 128, 192, 256
+};
+
+#define POOL_SLAB_CLASS_COUNT  (ARRAY_SIZE (mPoolSlabSizeTable))
+#define POOL_SLAB_MAX_SIZE     256
+
+#define POOL_SLAB_SIGNATURE  SIGNATURE_32('p','s','l','b')
+typedef struct {
+  UINT32             Signature;
+  UINT16             Class;
+  UINT16             FreeCount;
+  UINT16             ObjectCount;
+  UINT16             HeaderSize;
+  EFI_MEMORY_TYPE    Type;
+  ///
+  /// Address of this header. A stale signature left in a page that was a
+  /// slab page once does not match its own address.
+  ///
+  UINTN              Self;
+  ///
+  /// Link on POOL.SlabList[Class] while the page has free slots
+  ///
+  LIST_ENTRY         Link;
+  UINT32             FreeBitmap[1];
+} POOL_SLAB;
+
+#define POOL_SLAB_OBJECT_SIGNATURE  SIGNATURE_32('p','s','o','0')
+typedef struct {
+  UINT32    PageOffset;
+  UINT32    Signature;
+} POOL_SLAB_OBJECT;
+
 #define POOL_SIGNATURE  SIGNATURE_32('p','l','s','t')
 typedef struct {
   INTN               Signature;
   UINTN              Used;
   EFI_MEMORY_TYPE    MemoryType;
   LIST_ENTRY         FreeList[MAX_POOL_LIST];
+  LIST_ENTRY         SlabList[POOL_SLAB_CLASS_COUNT];
   LIST_ENTRY         Link;
 } POOL;
 
+//
+// Slab usage counters, reported through the memory profile.
+//
+typedef struct {
+  UINT64    AllocationCount;
+  UINT64    FreeCount;
+  UINT64    CurrentObjects;
+  UINT64    CurrentPages;
+} POOL_SLAB_STATISTICS;
+
+POOL_SLAB_STATISTICS  mPoolSlabStatistics[POOL_SLAB_CLASS_COUNT];
+UINT64                mPoolSlabCurrentPages = 0;
+UINT64                mPoolSlabPeakPages    = 0;
+
 //
 // Pool header for each memory type.
 //
@@ -126,6 +180,10 @@ CoreInitializePool (
     for (Index = 0; Index < MAX_POOL_LIST; Index++) {
       InitializeListHead (&mPoolHead[Type].FreeList[Index]);
     }
+
+    for (Index = 0; Index < POOL_SLAB_CLASS_COUNT; Index++) {
+      InitializeListHead (&mPoolHead[Type].SlabList[Index]);
+    }
   }
 }
 
@@ -175,6 +233,10 @@ LookupPoolHead (
       InitializeListHead (&Pool->FreeList[Index]);
     }
 
+    for (Index = 0; Index < POOL_SLAB_CLASS_COUNT; Index++) {
+      InitializeListHead (&Pool->SlabList[Index]);
+    }
+
     InsertHeadList (&mPoolHeadList, &Pool->Link);
 
     return Pool;
@@ -336,6 +398,201 @@ CoreAllocatePoolPagesI (
   return Buffer;
 }
 
+/**
+  Get the slab size class that serves an allocation of the specified size.
+
+  @param  Size          The aligned size of the allocation, without overhead.
+
+  @return               The slab class index, or POOL_SLAB_CLASS_COUNT if the
+                        size is too large for the slab allocator.
+
+**/
+STATIC
+UINTN
+GetPoolSlabClassFromSize (
+  IN UINTN  Size
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < POOL_SLAB_CLASS_COUNT; Index++) {
+    if (mPoolSlabSizeTable[Index] >= Size) {
+      return Index;
+    }
+  }
+
+  return POOL_SLAB_CLASS_COUNT;
+}
+
+/**
+  Get the distance between two objects in a slab page of the specified class.
+
+  @param  Class         The slab class index.
+
+  @return               The stride in bytes.
+
+**/
+STATIC
+UINTN
+GetPoolSlabStride (
+  IN UINTN  Class
+  )
+{
+  return sizeof (POOL_SLAB_OBJECT) + mPoolSlabSizeTable[Class];
+}
+
+/**
+  Get the object at the specified slot of a slab page.
+
+  @param  Slab          The slab page.
+  @param  Slot          The slot index.
+
+  @return               The object header of the slot.
+
+**/
+STATIC
+POOL_SLAB_OBJECT *
+GetPoolSlabObject (
+  IN POOL_SLAB  *Slab,
+  IN UINTN      Slot
+  )
+{
+  return (POOL_SLAB_OBJECT *)((UINTN)Slab + Slab->HeaderSize + Slot * GetPoolSlabStride (Slab->Class));
+}
+
+/**
+  Allocate and format a new slab page.
+
+  @param  Pool          The pool the page belongs to.
+  @param  Class         The slab class index.
+  @param  Granularity   The size and alignment of the page.
+
+  @return               The new slab page, or NULL.
+
+**/
+STATIC
+POOL_SLAB *
+CoreAllocatePoolSlab (
+  IN POOL   *Pool,
+  IN UINTN  Class,
+  IN UINTN  Granularity
+  )
+{
+  POOL_SLAB  *Slab;
+  UINTN      Stride;
+  UINTN      ObjectCount;
+  UINTN      HeaderSize;
+
+  Slab = CoreAllocatePoolPagesI (
+           Pool->MemoryType,
+           EFI_SIZE_TO_PAGES (Granularity),
+           Granularity,
+           FALSE
+           );
+  if (Slab == NULL) {
+    return NULL;
+  }
+
+  //
+  // Every object needs its stride plus one bit in the free bitmap. Start from
+  // that estimate and drop objects until the header and bitmap fit in front.
+  //
+  Stride      = GetPoolSlabStride (Class);
+  ObjectCount = ((Granularity - OFFSET_OF (POOL_SLAB, FreeBitmap)) * 8) / (Stride * 8 + 1);
+  for ( ; ;) {
+    HeaderSize = ALIGN_VARIABLE (OFFSET_OF (POOL_SLAB, FreeBitmap) + ((ObjectCount + 31) / 32) * sizeof (UINT32));
+    if (HeaderSize + ObjectCount * Stride <= Granularity) {
+      break;
+    }
+
+    ObjectCount--;
+  }
+
+  ASSERT (ObjectCount > 0 && ObjectCount <= MAX_UINT16);
+
+  Slab->Signature   = POOL_SLAB_SIGNATURE;
+  Slab->Class       = (UINT16)Class;
+  Slab->FreeCount   = (UINT16)ObjectCount;
+  Slab->ObjectCount = (UINT16)ObjectCount;
+  Slab->HeaderSize  = (UINT16)HeaderSize;
+  Slab->Type        = Pool->MemoryType;
+  Slab->Self        = (UINTN)Slab;
+
+  SetMem (Slab->FreeBitmap, (ObjectCount / 32) * sizeof (UINT32), 0xFF);
+  if ((ObjectCount % 32) != 0) {
+    Slab->FreeBitmap[ObjectCount / 32] = ((UINT32)1 << (ObjectCount % 32)) - 1;
+  }
+
+  InsertHeadList (&Pool->SlabList[Class], &Slab->Link);
+
+  mPoolSlabStatistics[Class].CurrentPages++;
+  mPoolSlabCurrentPages++;
+  if (mPoolSlabCurrentPages > mPoolSlabPeakPages) {
+    mPoolSlabPeakPages = mPoolSlabCurrentPages;
+  }
+
+  return Slab;
+}
+
+/**
+  Allocate an object from the slab pages of a pool.
+  Caller must have the memory lock held
+
+  @param  Pool          The pool to allocate from.
+  @param  Class         The slab class index.
+  @param  Granularity   The size and alignment of new slab pages.
+
+  @return               The allocated buffer, or NULL.
+
+**/
+STATIC
+VOID *
+CoreAllocatePoolSlabObject (
+  IN POOL   *Pool,
+  IN UINTN  Class,
+  IN UINTN  Granularity
+  )
+{
+  POOL_SLAB         *Slab;
+  POOL_SLAB_OBJECT  *Object;
+  UINTN             Word;
+  UINTN             Slot;
+
+  if (IsListEmpty (&Pool->SlabList[Class])) {
+    Slab = CoreAllocatePoolSlab (Pool, Class, Granularity);
+    if (Slab == NULL) {
+      return NULL;
+    }
+  } else {
+    Slab = CR (Pool->SlabList[Class].ForwardLink, POOL_SLAB, Link, POOL_SLAB_SIGNATURE);
+  }
+
+  ASSERT (Slab->FreeCount > 0);
+
+  //
+  // Take the lowest free slot, a page on the list has at least one
+  //
+  for (Word = 0; Slab->FreeBitmap[Word] == 0; Word++) {
+  }
+
+  Slot                    = Word * 32 + (UINTN)LowBitSet32 (Slab->FreeBitmap[Word]);
+  Slab->FreeBitmap[Word] &= ~((UINT32)1 << (Slot % 32));
+  Slab->FreeCount--;
+  if (Slab->FreeCount == 0) {
+    RemoveEntryList (&Slab->Link);
+  }
+
+  Object             = GetPoolSlabObject (Slab, Slot);
+  Object->PageOffset = (UINT32)((UINTN)Object - (UINTN)Slab);
+  Object->Signature  = POOL_SLAB_OBJECT_SIGNATURE;
+
+  Pool->Used += mPoolSlabSizeTable[Class];
+  mPoolSlabStatistics[Class].AllocationCount++;
+  mPoolSlabStatistics[Class].CurrentObjects++;
+
+  return Object + 1;
+}
+
 /**
   Internal function to allocate pool of a particular type.
   Caller must have the memory lock held
@@ -395,13 +652,39 @@ CoreAllocatePoolI (
   //
   Size = ALIGN_VARIABLE (Size);
 
-  Size += POOL_OVERHEAD;
-  Index = SIZE_TO_LIST (Size);
-  Pool  = LookupPoolHead (PoolType);
+  Pool = LookupPoolHead (PoolType);
   if (Pool == NULL) {
     return NULL;
   }
 
+  //
+  // Small allocations without guard go to the slab pages
+  //
+  if (FeaturePcdGet (PcdDxeCorePoolSlabEnable) &&
+      (Size <= POOL_SLAB_MAX_SIZE) && !NeedGuard && !PageAsPool)
+  {
+    Index  = GetPoolSlabClassFromSize (Size);
+    Buffer = CoreAllocatePoolSlabObject (Pool, Index, Granularity);
+    if (Buffer == NULL) {
+      DEBUG ((DEBUG_ERROR | DEBUG_POOL, "AllocatePool: failed to allocate %ld bytes\n", (UINT64)Size));
+      return NULL;
+    }
+
+    DEBUG_CLEAR_MEMORY (Buffer, mPoolSlabSizeTable[Index]);
+    DEBUG ((
+      DEBUG_POOL,
+      "AllocatePoolI: Type %x, Addr %p (slab %d) %,ld\n",
+      PoolType,
+      Buffer,
+      (UINT32)mPoolSlabSizeTable[Index],
+      (UINT64)Pool->Used
+      ));
+    return Buffer;
+  }
+
+  Size += POOL_OVERHEAD;
+  Index = SIZE_TO_LIST (Size);
+
   Head = NULL;
 
   //
@@ -665,6 +948,204 @@ CoreFreePoolPagesWithGuard (
   }
 }
 
+/**
+  Get the slab page that holds a pool buffer.
+
+  @param  Buffer        The pool buffer.
+
+  @return               The slab page, or NULL if Buffer was not allocated
+                        from a slab page.
+
+**/
+STATIC
+POOL_SLAB *
+GetPoolSlabFromBuffer (
+  IN VOID  *Buffer
+  )
+{
+  POOL_SLAB_OBJECT  *Object;
+  POOL_SLAB         *Slab;
+
+  //
+  // In front of a buffer with a POOL_HEAD sits (part of) its Size, which
+  // never holds the object signature for a real pool allocation.
+  //
+  Object = (POOL_SLAB_OBJECT *)Buffer - 1;
+  if ((Object->Signature != POOL_SLAB_OBJECT_SIGNATURE) ||
+      (Object->PageOffset < OFFSET_OF (POOL_SLAB, FreeBitmap)) ||
+      (Object->PageOffset >= RUNTIME_PAGE_ALLOCATION_GRANULARITY))
+  {
+    return NULL;
+  }
+
+  Slab = (POOL_SLAB *)((UINTN)Object - Object->PageOffset);
+  if ((Slab->Signature != POOL_SLAB_SIGNATURE) || (Slab->Self != (UINTN)Slab)) {
+    return NULL;
+  }
+
+  return Slab;
+}
+
+/**
+  Free an object to its slab page, releasing the page when it is empty.
+  Caller must have the memory lock held
+
+  @param  Slab          The slab page holding the object.
+  @param  Buffer        The buffer to free.
+
+  @retval EFI_INVALID_PARAMETER  Buffer is not an allocated slab object.
+  @retval EFI_SUCCESS            Buffer successfully freed.
+
+**/
+STATIC
+EFI_STATUS
+CoreFreePoolSlabObject (
+  IN POOL_SLAB  *Slab,
+  IN VOID       *Buffer
+  )
+{
+  POOL_SLAB_OBJECT  *Object;
+  POOL              *Pool;
+  UINTN             Class;
+  UINTN             Slot;
+  UINTN             Granularity;
+
+  Object = (POOL_SLAB_OBJECT *)Buffer - 1;
+  Class  = Slab->Class;
+  Slot   = (Object->PageOffset - Slab->HeaderSize) / GetPoolSlabStride (Class);
+  if ((Slot >= Slab->ObjectCount) || (GetPoolSlabObject (Slab, Slot) != Object) ||
+      ((Slab->FreeBitmap[Slot / 32] & ((UINT32)1 << (Slot % 32))) != 0))
+  {
+    ASSERT (FALSE);
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Pool = LookupPoolHead (Slab->Type);
+  if (Pool == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  DEBUG_CLEAR_MEMORY (Buffer, mPoolSlabSizeTable[Class]);
+  Object->Signature = 0;
+
+  Slab->FreeBitmap[Slot / 32] |= (UINT32)1 << (Slot % 32);
+  Slab->FreeCount++;
+  if (Slab->FreeCount == 1) {
+    InsertHeadList (&Pool->SlabList[Class], &Slab->Link);
+  }
+
+  Pool->Used -= mPoolSlabSizeTable[Class];
+  mPoolSlabStatistics[Class].FreeCount++;
+  mPoolSlabStatistics[Class].CurrentObjects--;
+  DEBUG ((DEBUG_POOL, "FreePool: %p (slab %d) %,ld\n", Buffer, (UINT32)mPoolSlabSizeTable[Class], (UINT64)Pool->Used));
+
+  //
+  // Keep one empty page per class to absorb alloc/free churn, except for
+  // OS/OEM types whose POOL is released once it is unused.
+  //
+  if ((Slab->FreeCount == Slab->ObjectCount) &&
+      (((UINT32)Pool->MemoryType >= MEMORY_TYPE_OEM_RESERVED_MIN) ||
+       (Pool->SlabList[Class].ForwardLink != Pool->SlabList[Class].BackLink)))
+  {
+    RemoveEntryList (&Slab->Link);
+    Slab->Signature = 0;
+    Slab->Self      = 0;
+    mPoolSlabStatistics[Class].CurrentPages--;
+    mPoolSlabCurrentPages--;
+
+    if ((Pool->MemoryType == EfiACPIReclaimMemory) ||
+        (Pool->MemoryType == EfiACPIMemoryNVS) ||
+        (Pool->MemoryType == EfiRuntimeServicesCode) ||
+        (Pool->MemoryType == EfiRuntimeServicesData))
+    {
+      Granularity = RUNTIME_PAGE_ALLOCATION_GRANULARITY;
+    } else {
+      Granularity = DEFAULT_PAGE_ALLOCATION_GRANULARITY;
+    }
+
+    CoreFreePoolPagesI (
+      Pool->MemoryType,
+      (EFI_PHYSICAL_ADDRESS)(UINTN)Slab,
+      EFI_SIZE_TO_PAGES (Granularity)
+      );
+  }
+
+  //
+  // Same as for the Fibonacci bins, release an unused OS/OEM pool head
+  //
+  if (((UINT32)Pool->MemoryType >= MEMORY_TYPE_OEM_RESERVED_MIN) && (Pool->Used == 0)) {
+    RemoveEntryList (&Pool->Link);
+    CoreFreePoolI (Pool, NULL);
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Get the slab allocator statistics for the memory profile.
+
+  @param  SlabInfo      Buffer to receive a MEMORY_PROFILE_POOL_SLAB record
+                        followed by one MEMORY_PROFILE_POOL_SLAB_CLASS per
+                        class, or NULL to query the size only.
+
+  @return               The size of the statistics, or 0 if the slab
+                        allocator is disabled.
+
+**/
+UINTN
+CoreGetPoolSlabStatistics (
+  OUT MEMORY_PROFILE_POOL_SLAB  *SlabInfo OPTIONAL
+  )
+{
+  MEMORY_PROFILE_POOL_SLAB_CLASS  *SlabClass;
+  UINTN                           Size;
+  UINTN                           Index;
+  UINTN                           PoolBinSize;
+
+  if (!FeaturePcdGet (PcdDxeCorePoolSlabEnable)) {
+    return 0;
+  }
+
+  Size = sizeof (MEMORY_PROFILE_POOL_SLAB) + POOL_SLAB_CLASS_COUNT * sizeof (MEMORY_PROFILE_POOL_SLAB_CLASS);
+  if (SlabInfo == NULL) {
+    return Size;
+  }
+
+  ZeroMem (SlabInfo, Size);
+  SlabInfo->Header.Signature = MEMORY_PROFILE_POOL_SLAB_SIGNATURE;
+  SlabInfo->Header.Length    = (UINT16)Size;
+  SlabInfo->Header.Revision  = MEMORY_PROFILE_POOL_SLAB_REVISION;
+  SlabInfo->SlabClassCount   = (UINT32)POOL_SLAB_CLASS_COUNT;
+  SlabInfo->CurrentSlabPages = mPoolSlabCurrentPages;
+  SlabInfo->PeakSlabPages    = mPoolSlabPeakPages;
+  SlabInfo->SystemTime       = CoreCurrentSystemTime ();
+
+  SlabClass = (MEMORY_PROFILE_POOL_SLAB_CLASS *)(SlabInfo + 1);
+  for (Index = 0; Index < POOL_SLAB_CLASS_COUNT; Index++) {
+    SlabClass[Index].ObjectSize      = mPoolSlabSizeTable[Index];
+    SlabClass[Index].AllocationCount = mPoolSlabStatistics[Index].AllocationCount;
+    SlabClass[Index].FreeCount       = mPoolSlabStatistics[Index].FreeCount;
+    SlabClass[Index].CurrentObjects  = mPoolSlabStatistics[Index].CurrentObjects;
+    SlabClass[Index].CurrentPages    = mPoolSlabStatistics[Index].CurrentPages;
+
+    //
+    // Without the slab pages the same object needs POOL_HEAD, POOL_TAIL and
+    // the rounding up to a Fibonacci bin.
+    //
+    PoolBinSize                 = LIST_TO_SIZE (SIZE_TO_LIST (mPoolSlabSizeTable[Index] + POOL_OVERHEAD));
+    SlabClass[Index].BytesSaved = MultU64x32 (
+                                    mPoolSlabStatistics[Index].CurrentObjects,
+                                    (UINT32)(PoolBinSize - GetPoolSlabStride (Index))
+                                    );
+
+    SlabInfo->TotalAllocationCount += SlabClass[Index].AllocationCount;
+    SlabInfo->TotalFreeCount       += SlabClass[Index].FreeCount;
+    SlabInfo->BytesSaved           += SlabClass[Index].BytesSaved;
+  }
+
+  return Size;
+}
+
 /**
   Internal function to free a pool entry.
   Caller must have the memory lock held
@@ -696,8 +1177,22 @@ CoreFreePoolI (
   BOOLEAN    IsGuarded;
   BOOLEAN    HasPoolTail;
   BOOLEAN    PageAsPool;
+  POOL_SLAB  *Slab;
 
   ASSERT (Buffer != NULL);
+
+  if (FeaturePcdGet (PcdDxeCorePoolSlabEnable)) {
+    Slab = GetPoolSlabFromBuffer (Buffer);
+    if (Slab != NULL) {
+      ASSERT_LOCKED (&mPoolMemoryLock);
+      if (PoolType != NULL) {
+        *PoolType = Slab->Type;
+      }
+
+      return CoreFreePoolSlabObject (Slab, Buffer);
+    }
+  }
+
   //
   // Get the head & tail of the pool entry
   //
@@ -532,6 +532,31 @@ VerifyGuidedSectionGuid (
   return FALSE;
 }
 
+/**
+  Check whether GUIDed sections of the given type are extracted by the
+  instance of the GUIDed section extraction protocol that the DXE core
+  installs for its ExtractGuidedSectionLib handlers.
+
+  @param  SectionGuid           The section definition GUID.
+
+  @retval TRUE                  The core's own extraction protocol handles the GUID.
+  @retval FALSE                 The GUID is not supported, or is handled by another driver.
+
+**/
+BOOLEAN
+IsCoreGuidedSectionExtraction (
+  IN EFI_GUID  *SectionGuid
+  )
+{
+  EFI_GUIDED_SECTION_EXTRACTION_PROTOCOL  *GuidedExtraction;
+
+  if (!VerifyGuidedSectionGuid (SectionGuid, &GuidedExtraction)) {
+    return FALSE;
+  }
+
+  return (BOOLEAN)(GuidedExtraction == &mCustomGuidedSectionExtractionProtocol);
+}
+
 /**
   RPN callback function. Initializes the section stream
   when GUIDED_SECTION_EXTRACTION_PROTOCOL is installed.
@@ -1332,6 +1332,11 @@ EvacuateTempRam (
 
   RemoveFvHobsInTemporaryMemory (Private);
 
+  //
+  // The cached section lookups may point into the FVs that were migrated
+  //
+  ZeroMem (&Private->CacheSectionLookup, sizeof (Private->CacheSectionLookup));
+
   return Status;
 }
 
@@ -1693,6 +1693,167 @@ PeiFfsFvPpiFindFileByType (
   return FindFileEx (FvHandle, NULL, SearchType, FileHandle, NULL);
 }
 
+/**
+  Hash an FFS file name.
+
+  @param FileName   The file name GUID.
+
+  @return The hash of the file name.
+**/
+STATIC
+UINTN
+FvFileNameHash (
+  IN CONST EFI_GUID  *FileName
+  )
+{
+  UINT32  Hash;
+
+  //
+  // File names are random GUIDs, so folding their words is enough
+  //
+  Hash = ReadUnaligned32 ((CONST UINT32 *)FileName) ^
+         ReadUnaligned32 ((CONST UINT32 *)FileName + 1) ^
+         ReadUnaligned32 ((CONST UINT32 *)FileName + 2) ^
+         ReadUnaligned32 ((CONST UINT32 *)FileName + 3);
+  return (UINTN)(Hash ^ (Hash >> 16));
+}
+
+/**
+  Build the file name index of a firmware volume.
+
+  The index holds the files that FindFileEx() returns for EFI_FV_FILETYPE_ALL.
+  The files of a bucket are kept in FV order, so a duplicated file name
+  resolves to the same file as a walk of the FV.
+
+  @param CoreFvHandle   The firmware volume to index.
+
+  @return The file name index, or NULL if it could not be built.
+**/
+STATIC
+PEI_FV_FILE_NAME_INDEX *
+BuildFvFileNameIndex (
+  IN PEI_CORE_FV_HANDLE  *CoreFvHandle
+  )
+{
+  PEI_FV_FILE_NAME_INDEX  *NameIndex;
+  EFI_PEI_FILE_HANDLE     FileHandle;
+  UINT32                  *Offset;
+  UINT16                  *Bucket;
+  UINT16                  *Next;
+  UINTN                   FileCount;
+  UINTN                   BucketCount;
+  UINTN                   Index;
+  UINTN                   Hash;
+
+  FileCount  = 0;
+  FileHandle = NULL;
+  while (!EFI_ERROR (FindFileEx (CoreFvHandle->FvHandle, NULL, EFI_FV_FILETYPE_ALL, &FileHandle, NULL))) {
+    FileCount++;
+  }
+
+  if (FileCount >= MAX_UINT16) {
+    return NULL;
+  }
+
+  BucketCount = 1;
+  while (BucketCount < FileCount) {
+    BucketCount <<= 1;
+  }
+
+  NameIndex = AllocatePool (
+                sizeof (PEI_FV_FILE_NAME_INDEX) +
+                FileCount * (sizeof (UINT32) + sizeof (UINT16)) +
+                BucketCount * sizeof (UINT16)
+                );
+  if (NameIndex == NULL) {
+    return NULL;
+  }
+
+  NameIndex->FileCount  = (UINT32)FileCount;
+  NameIndex->BucketMask = (UINT32)(BucketCount - 1);
+  Offset                = (UINT32 *)(NameIndex + 1);
+  Bucket                = (UINT16 *)(Offset + FileCount);
+  Next                  = Bucket + BucketCount;
+  ZeroMem (Bucket, BucketCount * sizeof (UINT16));
+
+  FileHandle = NULL;
+  for (Index = 0; Index < FileCount; Index++) {
+    FindFileEx (CoreFvHandle->FvHandle, NULL, EFI_FV_FILETYPE_ALL, &FileHandle, NULL);
+    Offset[Index] = (UINT32)((UINTN)FileHandle - (UINTN)CoreFvHandle->FvHandle);
+  }
+
+  //
+  // Insert the files backward at the head of their bucket to keep FV order
+  //
+  for (Index = FileCount; Index > 0; Index--) {
+    FileHandle      = (EFI_PEI_FILE_HANDLE)((UINT8 *)CoreFvHandle->FvHandle + Offset[Index - 1]);
+    Hash            = FvFileNameHash (&((EFI_FFS_FILE_HEADER *)FileHandle)->Name) & NameIndex->BucketMask;
+    Next[Index - 1] = Bucket[Hash];
+    Bucket[Hash]    = (UINT16)Index;
+  }
+
+  return NameIndex;
+}
+
+/**
+  Find a file by name in a firmware volume known to the PEI Core, through the
+  file name index of the firmware volume.
+
+  @param CoreFvHandle   The firmware volume to search.
+  @param FileName       The name of the file to find.
+  @param FileHandle     Upon exit, points to the found file's handle or NULL
+                        if it could not be found.
+
+  @retval EFI_SUCCESS   File was found.
+  @retval EFI_NOT_FOUND File was not found.
+**/
+STATIC
+EFI_STATUS
+FindFileByNameIndex (
+  IN  PEI_CORE_FV_HANDLE   *CoreFvHandle,
+  IN  CONST EFI_GUID       *FileName,
+  OUT EFI_PEI_FILE_HANDLE  *FileHandle
+  )
+{
+  PEI_FV_FILE_NAME_INDEX  *NameIndex;
+  EFI_FFS_FILE_HEADER     *FfsFileHeader;
+  UINT32                  *Offset;
+  UINT16                  *Bucket;
+  UINT16                  *Next;
+  UINT16                  Link;
+
+  if (CoreFvHandle->FileNameIndex == NULL) {
+    //
+    // Do not count the files of the FV again on every lookup once the index
+    // could not be built
+    //
+    if (!CoreFvHandle->FileNameIndexFailed) {
+      CoreFvHandle->FileNameIndex       = BuildFvFileNameIndex (CoreFvHandle);
+      CoreFvHandle->FileNameIndexFailed = (BOOLEAN)(CoreFvHandle->FileNameIndex == NULL);
+    }
+
+    if (CoreFvHandle->FileNameIndex == NULL) {
+      return FindFileEx (CoreFvHandle->FvHandle, FileName, 0, FileHandle, NULL);
+    }
+  }
+
+  NameIndex = CoreFvHandle->FileNameIndex;
+  Offset    = (UINT32 *)(NameIndex + 1);
+  Bucket    = (UINT16 *)(Offset + NameIndex->FileCount);
+  Next      = Bucket + NameIndex->BucketMask + 1;
+
+  for (Link = Bucket[FvFileNameHash (FileName) & NameIndex->BucketMask]; Link != 0; Link = Next[Link - 1]) {
+    FfsFileHeader = (EFI_FFS_FILE_HEADER *)((UINT8 *)CoreFvHandle->FvHandle + Offset[Link - 1]);
+    if (CompareGuid (&FfsFileHeader->Name, FileName)) {
+      *FileHandle = (EFI_PEI_FILE_HANDLE)FfsFileHeader;
+      return EFI_SUCCESS;
+    }
+  }
+
+  *FileHandle = NULL;
+  return EFI_NOT_FOUND;
+}
+
 /**
   Find a file within a volume by its name.
 
@@ -1727,16 +1888,26 @@ PeiFfsFvPpiFindFileByName (
   OUT EFI_PEI_FILE_HANDLE                 *FileHandle
   )
 {
-  EFI_STATUS         Status;
-  PEI_CORE_INSTANCE  *PrivateData;
-  UINTN              Index;
+  EFI_STATUS          Status;
+  PEI_CORE_INSTANCE   *PrivateData;
+  PEI_CORE_FV_HANDLE  *CoreFvHandle;
+  UINTN               Index;
 
   if ((FvHandle == NULL) || (FileName == NULL) || (FileHandle == NULL)) {
     return EFI_INVALID_PARAMETER;
   }
 
   if (*FvHandle != NULL) {
-    Status = FindFileEx (*FvHandle, FileName, 0, FileHandle, NULL);
+    //
+    // Only the FVs known to the PEI Core are indexed
+    //
+    CoreFvHandle = FvHandleToCoreHandle (*FvHandle);
+    if (CoreFvHandle != NULL) {
+      Status = FindFileByNameIndex (CoreFvHandle, FileName, FileHandle);
+    } else {
+      Status = FindFileEx (*FvHandle, FileName, 0, FileHandle, NULL);
+    }
+
     if (Status == EFI_NOT_FOUND) {
       *FileHandle = NULL;
     }
@@ -1752,7 +1923,7 @@ PeiFfsFvPpiFindFileByName (
       // Only search the FV which is associated with a EFI_PEI_FIRMWARE_VOLUME_PPI instance.
       //
       if (PrivateData->Fv[Index].FvPpi != NULL) {
-        Status = FindFileEx (PrivateData->Fv[Index].FvHandle, FileName, 0, FileHandle, NULL);
+        Status = FindFileByNameIndex (&PrivateData->Fv[Index], FileName, FileHandle);
         if (!EFI_ERROR (Status)) {
           *FvHandle = PrivateData->Fv[Index].FvHandle;
           break;
@@ -2037,6 +2208,9 @@ PeiFfsFvPpiFindSectionByType2 (
   PEI_CORE_FV_HANDLE         *CoreFvHandle;
   UINTN                      Instance;
   UINT32                     ExtractedAuthenticationStatus;
+  PEI_CORE_INSTANCE          *PrivateData;
+  CACHE_SECTION_LOOKUP       *Cache;
+  UINTN                      Index;
 
   if (SectionData == NULL) {
     return EFI_NOT_FOUND;
@@ -2052,6 +2226,22 @@ PeiFfsFvPpiFindSectionByType2 (
     return EFI_NOT_FOUND;
   }
 
+  //
+  // Reuse the result of an earlier lookup of the same section in the file.
+  //
+  PrivateData = PEI_CORE_INSTANCE_FROM_PS_THIS (GetPeiServicesTablePointer ());
+  Cache       = &PrivateData->CacheSectionLookup;
+  for (Index = 0; Index < Cache->AllLookupCount; Index++) {
+    if ((Cache->FileHandle[Index] == FileHandle) &&
+        (Cache->SectionType[Index] == SearchType) &&
+        (Cache->SectionInstance[Index] == SearchInstance))
+    {
+      *SectionData          = Cache->SectionData[Index];
+      *AuthenticationStatus = Cache->AuthenticationStatus[Index] | CoreFvHandle->AuthenticationStatus;
+      return EFI_SUCCESS;
+    }
+  }
+
   FfsFileHeader = (EFI_FFS_FILE_HEADER *)(FileHandle);
 
   if (IS_FFS_FILE2 (FfsFileHeader)) {
@@ -2085,6 +2275,17 @@ PeiFfsFvPpiFindSectionByType2 (
     // Inherit the authentication status.
     //
     *AuthenticationStatus = ExtractedAuthenticationStatus | CoreFvHandle->AuthenticationStatus;
+
+    if (Cache->AllLookupCount < CACHE_SECTION_LOOKUP_MAX_NUMBER) {
+      Cache->AllLookupCount++;
+    }
+
+    Cache->FileHandle[Cache->LookupIndex]           = FileHandle;
+    Cache->SectionType[Cache->LookupIndex]          = SearchType;
+    Cache->SectionInstance[Cache->LookupIndex]      = SearchInstance;
+    Cache->SectionData[Cache->LookupIndex]          = *SectionData;
+    Cache->AuthenticationStatus[Cache->LookupIndex] = ExtractedAuthenticationStatus;
+    Cache->LookupIndex                              = (Cache->LookupIndex + 1) % CACHE_SECTION_LOOKUP_MAX_NUMBER;
   }
 
   return Status;
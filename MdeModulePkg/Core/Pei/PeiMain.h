@@ -68,6 +68,22 @@ typedef union {
 #define CALLBACK_NOTIFY_GROWTH_STEP  32
 #define DISPATCH_NOTIFY_GROWTH_STEP  8
 
+///
+/// Number of GUID hash buckets of the PPI list and of each notify list. Must be
+/// powers of two.
+///
+#define PPI_HASH_BUCKETS     64
+#define NOTIFY_HASH_BUCKETS  32
+
+///
+/// The entries of the PPI and notify lists are chained by GUID hash through an
+/// array of MaxCount UINT16 that follows the MaxCount entries of the list in the
+/// same allocation, so it moves with the list when the heap is migrated. A link
+/// is the index of the next entry + 1, 0 ends the chain, and the entries of a
+/// chain are in ascending index order.
+///
+#define PPI_HASH_NEXT(Ptrs, MaxCount)  ((UINT16 *)&(Ptrs)[MaxCount])
+
 typedef struct {
   UINTN                    CurrentCount;
   UINTN                    MaxCount;
@@ -76,6 +92,10 @@ typedef struct {
   /// MaxCount number of entries.
   ///
   PEI_PPI_LIST_POINTERS    *PpiPtrs;
+  ///
+  /// Link to the first entry of each GUID hash bucket.
+  ///
+  UINT16                   HashHeads[PPI_HASH_BUCKETS];
 } PEI_PPI_LIST;
 
 typedef struct {
@@ -85,6 +105,10 @@ typedef struct {
   /// MaxCount number of entries.
   ///
   PEI_PPI_LIST_POINTERS    *NotifyPtrs;
+  ///
+  /// Link to the first entry of each GUID hash bucket.
+  ///
+  UINT16                   HashHeads[NOTIFY_HASH_BUCKETS];
 } PEI_CALLBACK_NOTIFY_LIST;
 
 typedef struct {
@@ -95,6 +119,10 @@ typedef struct {
   /// MaxCount number of entries.
   ///
   PEI_PPI_LIST_POINTERS    *NotifyPtrs;
+  ///
+  /// Link to the first entry of each GUID hash bucket.
+  ///
+  UINT16                   HashHeads[NOTIFY_HASH_BUCKETS];
 } PEI_DISPATCH_NOTIFY_LIST;
 
 ///
@@ -131,6 +159,20 @@ typedef struct {
 //
 #define FV_GROWTH_STEP  8
 
+//
+// Index of the files of a firmware volume by file name. The files are recorded
+// by their offset from the FV header, so the index stays valid when the FV is
+// migrated. The header is followed by:
+//   UINT32  Offset[FileCount];
+//   UINT16  Bucket[BucketMask + 1];
+//   UINT16  Next[FileCount];
+// Bucket and Next hold a file index plus one, 0 ends a chain.
+//
+typedef struct {
+  UINT32    FileCount;
+  UINT32    BucketMask;
+} PEI_FV_FILE_NAME_INDEX;
+
 typedef struct {
   EFI_FIRMWARE_VOLUME_HEADER     *FvHeader;
   EFI_PEI_FIRMWARE_VOLUME_PPI    *FvPpi;
@@ -146,6 +188,12 @@ typedef struct {
   EFI_PEI_FILE_HANDLE            *FvFileHandles;
   BOOLEAN                        ScanFv;
   UINT32                         AuthenticationStatus;
+  //
+  // Built on the first lookup of a file by name in the FV. If it could not
+  // be built, FileNameIndexFailed is set and the FV is walked instead.
+  //
+  PEI_FV_FILE_NAME_INDEX         *FileNameIndex;
+  BOOLEAN                        FileNameIndexFailed;
 } PEI_CORE_FV_HANDLE;
 
 typedef struct {
@@ -166,6 +214,20 @@ typedef struct {
   UINTN                        SectionIndex;
 } CACHE_SECTION_DATA;
 
+//
+// Results of the latest section lookups by file, section type and instance
+//
+#define CACHE_SECTION_LOOKUP_MAX_NUMBER  0x8
+typedef struct {
+  EFI_PEI_FILE_HANDLE    FileHandle[CACHE_SECTION_LOOKUP_MAX_NUMBER];
+  EFI_SECTION_TYPE       SectionType[CACHE_SECTION_LOOKUP_MAX_NUMBER];
+  UINTN                  SectionInstance[CACHE_SECTION_LOOKUP_MAX_NUMBER];
+  VOID                   *SectionData[CACHE_SECTION_LOOKUP_MAX_NUMBER];
+  UINT32                 AuthenticationStatus[CACHE_SECTION_LOOKUP_MAX_NUMBER];
+  UINTN                  AllLookupCount;
+  UINTN                  LookupIndex;
+} CACHE_SECTION_LOOKUP;
+
 #define HOLE_MAX_NUMBER  0x3
 typedef struct {
   EFI_PHYSICAL_ADDRESS    Base;
@@ -274,6 +336,7 @@ struct _PEI_CORE_INSTANCE {
   HOLE_MEMORY_DATA                  MemoryPages;
   PEICORE_FUNCTION_POINTER          ShadowedPeiCore;
   CACHE_SECTION_DATA                CacheSection;
+  CACHE_SECTION_LOOKUP              CacheSectionLookup;
   //
   // For Loading modules at fixed address feature to cache the top address below which the
   // Runtime code, boot time code and PEI memory will be placed. Please note that the offset between this field
@@ -236,6 +236,10 @@ PeiCore (
           if (OldCoreData->Fv[Index].FvFileHandles != NULL) {
             OldCoreData->Fv[Index].FvFileHandles = (EFI_PEI_FILE_HANDLE *)((UINT8 *)OldCoreData->Fv[Index].FvFileHandles + OldCoreData->HeapOffset);
           }
+
+          if (OldCoreData->Fv[Index].FileNameIndex != NULL) {
+            OldCoreData->Fv[Index].FileNameIndex = (PEI_FV_FILE_NAME_INDEX *)((UINT8 *)OldCoreData->Fv[Index].FileNameIndex + OldCoreData->HeapOffset);
+          }
         }
 
         OldCoreData->TempFileGuid    = (EFI_GUID *)((UINT8 *)OldCoreData->TempFileGuid + OldCoreData->HeapOffset);
@@ -271,12 +275,21 @@ PeiCore (
           if (OldCoreData->Fv[Index].FvFileHandles != NULL) {
             OldCoreData->Fv[Index].FvFileHandles = (EFI_PEI_FILE_HANDLE *)((UINT8 *)OldCoreData->Fv[Index].FvFileHandles - OldCoreData->HeapOffset);
           }
+
+          if (OldCoreData->Fv[Index].FileNameIndex != NULL) {
+            OldCoreData->Fv[Index].FileNameIndex = (PEI_FV_FILE_NAME_INDEX *)((UINT8 *)OldCoreData->Fv[Index].FileNameIndex - OldCoreData->HeapOffset);
+          }
         }
 
         OldCoreData->TempFileGuid    = (EFI_GUID *)((UINT8 *)OldCoreData->TempFileGuid - OldCoreData->HeapOffset);
         OldCoreData->TempFileHandles = (EFI_PEI_FILE_HANDLE *)((UINT8 *)OldCoreData->TempFileHandles - OldCoreData->HeapOffset);
       }
 
+      //
+      // The cached section lookups may point into temporary memory
+      //
+      ZeroMem (&OldCoreData->CacheSectionLookup, sizeof (OldCoreData->CacheSectionLookup));
+
       //
       // Fixup for PeiService's address
       //
@@ -8,6 +8,13 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #include "PeiMain.h"
 
+//
+// Largest range of newly installed PPIs that ProcessNotify() matches through
+// the GUID hash chains of the notify list, larger ranges go through the GUID
+// hash chains of the PPI list.
+//
+#define PPI_NOTIFY_MERGE_MAX  8
+
 /**
 
   Migrate Pointer from the temporary memory to PEI installed memory.
@@ -354,6 +361,166 @@ ConvertPpiPointersFv (
   }
 }
 
+/**
+  Hash the GUID of a PPI or notify descriptor.
+
+  @param Guid            The GUID to hash.
+
+  @return The hash of the GUID, to be masked with the number of buckets - 1.
+
+**/
+STATIC
+UINTN
+PpiGuidHash (
+  IN CONST EFI_GUID  *Guid
+  )
+{
+  UINT32  Hash;
+
+  Hash = ((UINT32 *)Guid)[0] ^ ((UINT32 *)Guid)[1] ^ ((UINT32 *)Guid)[2] ^ ((UINT32 *)Guid)[3];
+  return (UINTN)(Hash ^ (Hash >> 16));
+}
+
+/**
+  Grow a PPI or notify list, together with its GUID hash links.
+
+  @param Ptrs            The entries of the list.
+  @param MaxCount        The number of entries of the list.
+  @param GrowthStep      The number of entries to add.
+
+  @return The new entries of the list.
+
+**/
+STATIC
+PEI_PPI_LIST_POINTERS *
+GrowPpiList (
+  IN PEI_PPI_LIST_POINTERS  *Ptrs,
+  IN UINTN                  MaxCount,
+  IN UINTN                  GrowthStep
+  )
+{
+  PEI_PPI_LIST_POINTERS  *NewPtrs;
+
+  //
+  // A link is an UINT16 index + 1
+  //
+  ASSERT (MaxCount + GrowthStep < MAX_UINT16);
+
+  NewPtrs = AllocateZeroPool ((sizeof (PEI_PPI_LIST_POINTERS) + sizeof (UINT16)) * (MaxCount + GrowthStep));
+  ASSERT (NewPtrs != NULL);
+  CopyMem (NewPtrs, Ptrs, sizeof (PEI_PPI_LIST_POINTERS) * MaxCount);
+  CopyMem (
+    PPI_HASH_NEXT (NewPtrs, MaxCount + GrowthStep),
+    PPI_HASH_NEXT (Ptrs, MaxCount),
+    sizeof (UINT16) * MaxCount
+    );
+  return NewPtrs;
+}
+
+/**
+  Link an entry of a PPI or notify list into the GUID hash chains of the list.
+
+  @param Ptrs            The entries of the list.
+  @param MaxCount        The number of entries of the list.
+  @param HashHeads       The GUID hash buckets of the list.
+  @param BucketCount     The number of GUID hash buckets.
+  @param Index           The index of the entry.
+
+**/
+STATIC
+VOID
+PpiHashInsert (
+  IN PEI_PPI_LIST_POINTERS  *Ptrs,
+  IN UINTN                  MaxCount,
+  IN UINT16                 *HashHeads,
+  IN UINTN                  BucketCount,
+  IN UINTN                  Index
+  )
+{
+  UINT16  *Next;
+  UINT16  *Link;
+
+  Next = PPI_HASH_NEXT (Ptrs, MaxCount);
+  Link = &HashHeads[PpiGuidHash (Ptrs[Index].Ppi->Guid) & (BucketCount - 1)];
+  while ((*Link != 0) && ((UINTN)(*Link - 1) < Index)) {
+    Link = &Next[*Link - 1];
+  }
+
+  Next[Index] = *Link;
+  *Link       = (UINT16)(Index + 1);
+}
+
+/**
+  Unlink an entry of a PPI or notify list from the GUID hash chains of the list.
+
+  The entry is looked for in the bucket of the GUID its descriptor points to.
+  If the GUID was changed after the entry was linked, the entry is still in
+  the bucket of the old GUID, so every bucket is searched.
+
+  @param Ptrs            The entries of the list.
+  @param MaxCount        The number of entries of the list.
+  @param HashHeads       The GUID hash buckets of the list.
+  @param BucketCount     The number of GUID hash buckets.
+  @param Index           The index of the entry.
+
+**/
+STATIC
+VOID
+PpiHashRemove (
+  IN PEI_PPI_LIST_POINTERS  *Ptrs,
+  IN UINTN                  MaxCount,
+  IN UINT16                 *HashHeads,
+  IN UINTN                  BucketCount,
+  IN UINTN                  Index
+  )
+{
+  UINT16  *Next;
+  UINT16  *Link;
+  UINTN   Bucket;
+  UINTN   Probe;
+
+  Next   = PPI_HASH_NEXT (Ptrs, MaxCount);
+  Bucket = PpiGuidHash (Ptrs[Index].Ppi->Guid) & (BucketCount - 1);
+  for (Probe = 0; Probe < BucketCount; Probe++) {
+    Link = &HashHeads[(Bucket + Probe) & (BucketCount - 1)];
+    while (*Link != 0) {
+      if ((UINTN)(*Link - 1) == Index) {
+        *Link = Next[Index];
+        return;
+      }
+
+      Link = &Next[*Link - 1];
+    }
+  }
+}
+
+/**
+  Compare two GUIDs.
+
+  Don't use CompareGuid function here for performance reasons.
+  Instead we compare the GUID as INT32 at a time and branch
+  on the first failed comparison.
+
+  @param Guid1           A GUID.
+  @param Guid2           A GUID.
+
+  @retval TRUE           The GUIDs are the same.
+  @retval FALSE          The GUIDs are different.
+
+**/
+STATIC
+BOOLEAN
+PpiGuidMatch (
+  IN CONST EFI_GUID  *Guid1,
+  IN CONST EFI_GUID  *Guid2
+  )
+{
+  return (BOOLEAN)((((INT32 *)Guid1)[0] == ((INT32 *)Guid2)[0]) &&
+                   (((INT32 *)Guid1)[1] == ((INT32 *)Guid2)[1]) &&
+                   (((INT32 *)Guid1)[2] == ((INT32 *)Guid2)[2]) &&
+                   (((INT32 *)Guid1)[3] == ((INT32 *)Guid2)[3]));
+}
+
 /**
 
   Dumps the PPI lists to debug output.
@@ -456,7 +623,6 @@ InternalPeiInstallPpi (
   PEI_PPI_LIST       *PpiListPointer;
   UINTN              Index;
   UINTN              LastCount;
-  VOID               *TempPtr;
 
   if (PpiList == NULL) {
     return EFI_INVALID_PARAMETER;
@@ -490,16 +656,7 @@ InternalPeiInstallPpi (
       //
       // Run out of room, grow the buffer.
       //
-      TempPtr = AllocateZeroPool (
-                  sizeof (PEI_PPI_LIST_POINTERS) * (PpiListPointer->MaxCount + PPI_GROWTH_STEP)
-                  );
-      ASSERT (TempPtr != NULL);
-      CopyMem (
-        TempPtr,
-        PpiListPointer->PpiPtrs,
-        sizeof (PEI_PPI_LIST_POINTERS) * PpiListPointer->MaxCount
-        );
-      PpiListPointer->PpiPtrs  = TempPtr;
+      PpiListPointer->PpiPtrs  = GrowPpiList (PpiListPointer->PpiPtrs, PpiListPointer->MaxCount, PPI_GROWTH_STEP);
       PpiListPointer->MaxCount = PpiListPointer->MaxCount + PPI_GROWTH_STEP;
     }
 
@@ -528,6 +685,13 @@ InternalPeiInstallPpi (
     PpiList++;
   }
 
+  //
+  // Index the PPIs once the whole list is known to be valid.
+  //
+  for (Index = LastCount; Index < PpiListPointer->CurrentCount; Index++) {
+    PpiHashInsert (PpiListPointer->PpiPtrs, PpiListPointer->MaxCount, PpiListPointer->HashHeads, PPI_HASH_BUCKETS, Index);
+  }
+
   //
   // Process any callback level notifies for newly installed PPIs.
   //
@@ -594,7 +758,9 @@ PeiReInstallPpi (
   )
 {
   PEI_CORE_INSTANCE  *PrivateData;
+  PEI_PPI_LIST       *PpiListPointer;
   UINTN              Index;
+  UINT16             Link;
 
   if ((OldPpi == NULL) || (NewPpi == NULL)) {
     return EFI_INVALID_PARAMETER;
@@ -604,19 +770,34 @@ PeiReInstallPpi (
     return EFI_INVALID_PARAMETER;
   }
 
-  PrivateData = PEI_CORE_INSTANCE_FROM_PS_THIS (PeiServices);
+  PrivateData    = PEI_CORE_INSTANCE_FROM_PS_THIS (PeiServices);
+  PpiListPointer = &PrivateData->PpiData.PpiList;
 
   //
-  // Find the old PPI instance in the database.  If we can not find it,
-  // return the EFI_NOT_FOUND error.
+  // Find the old PPI instance in the database through the hash chain of its
+  // GUID, or by a full scan if the caller changed the GUID of the installed
+  // descriptor.  If we can not find it, return the EFI_NOT_FOUND error.
   //
-  for (Index = 0; Index < PrivateData->PpiData.PpiList.CurrentCount; Index++) {
-    if (OldPpi == PrivateData->PpiData.PpiList.PpiPtrs[Index].Ppi) {
+  Index = PpiListPointer->CurrentCount;
+  for (Link = PpiListPointer->HashHeads[PpiGuidHash (OldPpi->Guid) & (PPI_HASH_BUCKETS - 1)];
+       Link != 0;
+       Link = PPI_HASH_NEXT (PpiListPointer->PpiPtrs, PpiListPointer->MaxCount)[Link - 1])
+  {
+    if (OldPpi == PpiListPointer->PpiPtrs[Link - 1].Ppi) {
+      Index = Link - 1;
       break;
     }
   }
 
-  if (Index == PrivateData->PpiData.PpiList.CurrentCount) {
+  if (Index == PpiListPointer->CurrentCount) {
+    for (Index = 0; Index < PpiListPointer->CurrentCount; Index++) {
+      if (OldPpi == PpiListPointer->PpiPtrs[Index].Ppi) {
+        break;
+      }
+    }
+  }
+
+  if (Index == PpiListPointer->CurrentCount) {
     return EFI_NOT_FOUND;
   }
 
@@ -624,7 +805,9 @@ PeiReInstallPpi (
   // Replace the old PPI with the new one.
   //
   DEBUG ((DEBUG_INFO, "Reinstall PPI: %g\n", NewPpi->Guid));
-  PrivateData->PpiData.PpiList.PpiPtrs[Index].Ppi = (EFI_PEI_PPI_DESCRIPTOR *)NewPpi;
+  PpiHashRemove (PpiListPointer->PpiPtrs, PpiListPointer->MaxCount, PpiListPointer->HashHeads, PPI_HASH_BUCKETS, Index);
+  PpiListPointer->PpiPtrs[Index].Ppi = (EFI_PEI_PPI_DESCRIPTOR *)NewPpi;
+  PpiHashInsert (PpiListPointer->PpiPtrs, PpiListPointer->MaxCount, PpiListPointer->HashHeads, PPI_HASH_BUCKETS, Index);
 
   //
   // Process any callback level notifies for the newly installed PPI.
@@ -668,29 +851,23 @@ PeiLocatePpi (
   )
 {
   PEI_CORE_INSTANCE       *PrivateData;
-  UINTN                   Index;
-  EFI_GUID                *CheckGuid;
+  PEI_PPI_LIST            *PpiListPointer;
+  UINT16                  *Next;
+  UINT16                  Link;
   EFI_PEI_PPI_DESCRIPTOR  *TempPtr;
 
-  PrivateData = PEI_CORE_INSTANCE_FROM_PS_THIS (PeiServices);
+  PrivateData    = PEI_CORE_INSTANCE_FROM_PS_THIS (PeiServices);
+  PpiListPointer = &PrivateData->PpiData.PpiList;
+  Next           = PPI_HASH_NEXT (PpiListPointer->PpiPtrs, PpiListPointer->MaxCount);
 
   //
-  // Search the data base for the matching instance of the GUIDed PPI.
+  // Search the hash chain of the GUID for the matching instance of the GUIDed
+  // PPI. The chain is in PPI list order.
   //
-  for (Index = 0; Index < PrivateData->PpiData.PpiList.CurrentCount; Index++) {
-    TempPtr   = PrivateData->PpiData.PpiList.PpiPtrs[Index].Ppi;
-    CheckGuid = TempPtr->Guid;
+  for (Link = PpiListPointer->HashHeads[PpiGuidHash (Guid) & (PPI_HASH_BUCKETS - 1)]; Link != 0; Link = Next[Link - 1]) {
+    TempPtr = PpiListPointer->PpiPtrs[Link - 1].Ppi;
 
-    //
-    // Don't use CompareGuid function here for performance reasons.
-    // Instead we compare the GUID as INT32 at a time and branch
-    // on the first failed comparison.
-    //
-    if ((((INT32 *)Guid)[0] == ((INT32 *)CheckGuid)[0]) &&
-        (((INT32 *)Guid)[1] == ((INT32 *)CheckGuid)[1]) &&
-        (((INT32 *)Guid)[2] == ((INT32 *)CheckGuid)[2]) &&
-        (((INT32 *)Guid)[3] == ((INT32 *)CheckGuid)[3]))
-    {
+    if (PpiGuidMatch (Guid, TempPtr->Guid)) {
       if (Instance == 0) {
         if (PpiDescriptor != NULL) {
           *PpiDescriptor = TempPtr;
@@ -741,7 +918,7 @@ InternalPeiNotifyPpi (
   PEI_DISPATCH_NOTIFY_LIST  *DispatchNotifyListPointer;
   UINTN                     DispatchNotifyIndex;
   UINTN                     LastDispatchNotifyCount;
-  VOID                      *TempPtr;
+  UINTN                     Index;
 
   if (NotifyList == NULL) {
     return EFI_INVALID_PARAMETER;
@@ -779,17 +956,12 @@ InternalPeiNotifyPpi (
         //
         // Run out of room, grow the buffer.
         //
-        TempPtr = AllocateZeroPool (
-                    sizeof (PEI_PPI_LIST_POINTERS) * (CallbackNotifyListPointer->MaxCount + CALLBACK_NOTIFY_GROWTH_STEP)
-                    );
-        ASSERT (TempPtr != NULL);
-        CopyMem (
-          TempPtr,
-          CallbackNotifyListPointer->NotifyPtrs,
-          sizeof (PEI_PPI_LIST_POINTERS) * CallbackNotifyListPointer->MaxCount
-          );
-        CallbackNotifyListPointer->NotifyPtrs = TempPtr;
-        CallbackNotifyListPointer->MaxCount   = CallbackNotifyListPointer->MaxCount + CALLBACK_NOTIFY_GROWTH_STEP;
+        CallbackNotifyListPointer->NotifyPtrs = GrowPpiList (
+                                                  CallbackNotifyListPointer->NotifyPtrs,
+                                                  CallbackNotifyListPointer->MaxCount,
+                                                  CALLBACK_NOTIFY_GROWTH_STEP
+                                                  );
+        CallbackNotifyListPointer->MaxCount = CallbackNotifyListPointer->MaxCount + CALLBACK_NOTIFY_GROWTH_STEP;
       }
 
       CallbackNotifyListPointer->NotifyPtrs[CallbackNotifyIndex].Notify = (EFI_PEI_NOTIFY_DESCRIPTOR *)NotifyList;
@@ -800,17 +972,12 @@ InternalPeiNotifyPpi (
         //
         // Run out of room, grow the buffer.
         //
-        TempPtr = AllocateZeroPool (
-                    sizeof (PEI_PPI_LIST_POINTERS) * (DispatchNotifyListPointer->MaxCount + DISPATCH_NOTIFY_GROWTH_STEP)
-                    );
-        ASSERT (TempPtr != NULL);
-        CopyMem (
-          TempPtr,
-          DispatchNotifyListPointer->NotifyPtrs,
-          sizeof (PEI_PPI_LIST_POINTERS) * DispatchNotifyListPointer->MaxCount
-          );
-        DispatchNotifyListPointer->NotifyPtrs = TempPtr;
-        DispatchNotifyListPointer->MaxCount   = DispatchNotifyListPointer->MaxCount + DISPATCH_NOTIFY_GROWTH_STEP;
+        DispatchNotifyListPointer->NotifyPtrs = GrowPpiList (
+                                                  DispatchNotifyListPointer->NotifyPtrs,
+                                                  DispatchNotifyListPointer->MaxCount,
+                                                  DISPATCH_NOTIFY_GROWTH_STEP
+                                                  );
+        DispatchNotifyListPointer->MaxCount = DispatchNotifyListPointer->MaxCount + DISPATCH_NOTIFY_GROWTH_STEP;
       }
 
       DispatchNotifyListPointer->NotifyPtrs[DispatchNotifyIndex].Notify = (EFI_PEI_NOTIFY_DESCRIPTOR *)NotifyList;
@@ -840,6 +1007,29 @@ InternalPeiNotifyPpi (
     NotifyList++;
   }
 
+  //
+  // Index the notifies once the whole list is known to be valid.
+  //
+  for (Index = LastCallbackNotifyCount; Index < CallbackNotifyListPointer->CurrentCount; Index++) {
+    PpiHashInsert (
+      CallbackNotifyListPointer->NotifyPtrs,
+      CallbackNotifyListPointer->MaxCount,
+      CallbackNotifyListPointer->HashHeads,
+      NOTIFY_HASH_BUCKETS,
+      Index
+      );
+  }
+
+  for (Index = LastDispatchNotifyCount; Index < DispatchNotifyListPointer->CurrentCount; Index++) {
+    PpiHashInsert (
+      DispatchNotifyListPointer->NotifyPtrs,
+      DispatchNotifyListPointer->MaxCount,
+      DispatchNotifyListPointer->HashHeads,
+      NOTIFY_HASH_BUCKETS,
+      Index
+      );
+  }
+
   //
   // Process any callback level notifies for all previously installed PPIs.
   //
@@ -944,10 +1134,85 @@ ProcessDispatchNotifyList (
   return;
 }
 
+/**
+
+  Return a notify descriptor of the callback or dispatch notify list.
+
+  @param PrivateData        PeiCore's private data structure
+  @param NotifyType         Type of the notify list.
+  @param Index              Index of the notify in the list.
+  @param NextLink           Returns the GUID hash link to the next notify of
+                            the same bucket.
+
+  @return The notify descriptor.
+
+**/
+STATIC
+EFI_PEI_NOTIFY_DESCRIPTOR *
+GetNotifyDescriptor (
+  IN  PEI_CORE_INSTANCE  *PrivateData,
+  IN  UINTN              NotifyType,
+  IN  UINTN              Index,
+  OUT UINT16             *NextLink OPTIONAL
+  )
+{
+  PEI_PPI_LIST_POINTERS  *NotifyPtrs;
+  UINTN                  MaxCount;
+
+  if (NotifyType == EFI_PEI_PPI_DESCRIPTOR_NOTIFY_CALLBACK) {
+    NotifyPtrs = PrivateData->PpiData.CallbackNotifyList.NotifyPtrs;
+    MaxCount   = PrivateData->PpiData.CallbackNotifyList.MaxCount;
+  } else {
+    NotifyPtrs = PrivateData->PpiData.DispatchNotifyList.NotifyPtrs;
+    MaxCount   = PrivateData->PpiData.DispatchNotifyList.MaxCount;
+  }
+
+  if (NextLink != NULL) {
+    *NextLink = PPI_HASH_NEXT (NotifyPtrs, MaxCount)[Index];
+  }
+
+  return NotifyPtrs[Index].Notify;
+}
+
+/**
+
+  Call a notify for an installed PPI.
+
+  @param PrivateData        PeiCore's private data structure
+  @param NotifyDescriptor   The notify descriptor.
+  @param PpiIndex           Index of the PPI in the PPI list.
+
+**/
+STATIC
+VOID
+CallNotify (
+  IN PEI_CORE_INSTANCE          *PrivateData,
+  IN EFI_PEI_NOTIFY_DESCRIPTOR  *NotifyDescriptor,
+  IN UINTN                      PpiIndex
+  )
+{
+  DEBUG ((
+    DEBUG_INFO,
+    "Notify: PPI Guid: %g, Peim notify entry point: %p\n",
+    PrivateData->PpiData.PpiList.PpiPtrs[PpiIndex].Ppi->Guid,
+    NotifyDescriptor->Notify
+    ));
+  NotifyDescriptor->Notify (
+                      (EFI_PEI_SERVICES **)GetPeiServicesTablePointer (),
+                      NotifyDescriptor,
+                      (PrivateData->PpiData.PpiList.PpiPtrs[PpiIndex].Ppi)->Ppi
+                      );
+}
+
 /**
 
   Process notifications.
 
+  The notifies are called in notify order, and for each notify in PPI order.
+  The matching pairs are found through the GUID hash chains: the chains of the
+  PPI list for each notify, or, when only a few PPIs were installed, a merge of
+  the chains of the notify list for each PPI.
+
   @param PrivateData        PeiCore's private data structure
   @param NotifyType         Type of notify to fire.
   @param InstallStartIndex  Install Beginning index.
@@ -968,43 +1233,91 @@ ProcessNotify (
 {
   INTN                       Index1;
   INTN                       Index2;
-  EFI_GUID                   *SearchGuid;
+  INTN                       Best;
+  INTN                       PpiCount;
+  UINT16                     Link;
+  UINT16                     NextLink;
+  UINT16                     *HashHeads;
+  UINT16                     Cursor[PPI_NOTIFY_MERGE_MAX];
   EFI_GUID                   *CheckGuid;
   EFI_PEI_NOTIFY_DESCRIPTOR  *NotifyDescriptor;
 
-  for (Index1 = NotifyStartIndex; Index1 < NotifyStopIndex; Index1++) {
+  PpiCount = InstallStopIndex - InstallStartIndex;
+  if ((PpiCount <= 0) || (NotifyStopIndex <= NotifyStartIndex)) {
+    return;
+  }
+
+  if ((PpiCount <= PPI_NOTIFY_MERGE_MAX) && (PpiCount < NotifyStopIndex - NotifyStartIndex)) {
     if (NotifyType == EFI_PEI_PPI_DESCRIPTOR_NOTIFY_CALLBACK) {
-      NotifyDescriptor = PrivateData->PpiData.CallbackNotifyList.NotifyPtrs[Index1].Notify;
+      HashHeads = PrivateData->PpiData.CallbackNotifyList.HashHeads;
     } else {
-      NotifyDescriptor = PrivateData->PpiData.DispatchNotifyList.NotifyPtrs[Index1].Notify;
+      HashHeads = PrivateData->PpiData.DispatchNotifyList.HashHeads;
     }
 
-    CheckGuid = NotifyDescriptor->Guid;
+    //
+    // Start a cursor on the notify chain of the GUID of each PPI, and skip
+    // the notifies before the range.
+    //
+    for (Index2 = 0; Index2 < PpiCount; Index2++) {
+      CheckGuid      = PrivateData->PpiData.PpiList.PpiPtrs[InstallStartIndex + Index2].Ppi->Guid;
+      Cursor[Index2] = HashHeads[PpiGuidHash (CheckGuid) & (NOTIFY_HASH_BUCKETS - 1)];
+      while ((Cursor[Index2] != 0) && (Cursor[Index2] - 1 < NotifyStartIndex)) {
+        GetNotifyDescriptor (PrivateData, NotifyType, Cursor[Index2] - 1, &Cursor[Index2]);
+      }
+    }
 
-    for (Index2 = InstallStartIndex; Index2 < InstallStopIndex; Index2++) {
-      SearchGuid = PrivateData->PpiData.PpiList.PpiPtrs[Index2].Ppi->Guid;
-      //
-      // Don't use CompareGuid function here for performance reasons.
-      // Instead we compare the GUID as INT32 at a time and branch
-      // on the first failed comparison.
-      //
-      if ((((INT32 *)SearchGuid)[0] == ((INT32 *)CheckGuid)[0]) &&
-          (((INT32 *)SearchGuid)[1] == ((INT32 *)CheckGuid)[1]) &&
-          (((INT32 *)SearchGuid)[2] == ((INT32 *)CheckGuid)[2]) &&
-          (((INT32 *)SearchGuid)[3] == ((INT32 *)CheckGuid)[3]))
+    //
+    // Repeatedly take the lowest notify of all cursors, the lowest PPI first
+    // on a tie. The lists are read again after every notify, as a notify can
+    // install PPIs and notifies.
+    //
+    while (TRUE) {
+      Best = -1;
+      for (Index2 = 0; Index2 < PpiCount; Index2++) {
+        if ((Cursor[Index2] != 0) && (Cursor[Index2] - 1 < NotifyStopIndex) &&
+            ((Best < 0) || (Cursor[Index2] < Cursor[Best])))
+        {
+          Best = Index2;
+        }
+      }
+
+      if (Best < 0) {
+        break;
+      }
+
+      Index1           = Cursor[Best] - 1;
+      NotifyDescriptor = GetNotifyDescriptor (PrivateData, NotifyType, Index1, &Cursor[Best]);
+      CheckGuid        = PrivateData->PpiData.PpiList.PpiPtrs[InstallStartIndex + Best].Ppi->Guid;
+      if (PpiGuidMatch (CheckGuid, NotifyDescriptor->Guid)) {
+        CallNotify (PrivateData, NotifyDescriptor, InstallStartIndex + Best);
+      }
+    }
+
+    return;
+  }
+
+  for (Index1 = NotifyStartIndex; Index1 < NotifyStopIndex; Index1++) {
+    NotifyDescriptor = GetNotifyDescriptor (PrivateData, NotifyType, Index1, NULL);
+    CheckGuid        = NotifyDescriptor->Guid;
+
+    //
+    // Walk the PPI chain of the GUID, which is in PPI order.
+    //
+    Link = PrivateData->PpiData.PpiList.HashHeads[PpiGuidHash (CheckGuid) & (PPI_HASH_BUCKETS - 1)];
+    while (Link != 0) {
+      Index2 = Link - 1;
+      if (Index2 >= InstallStopIndex) {
+        break;
+      }
+
+      NextLink = PPI_HASH_NEXT (PrivateData->PpiData.PpiList.PpiPtrs, PrivateData->PpiData.PpiList.MaxCount)[Index2];
+      if ((Index2 >= InstallStartIndex) &&
+          PpiGuidMatch (PrivateData->PpiData.PpiList.PpiPtrs[Index2].Ppi->Guid, CheckGuid))
       {
-        DEBUG ((
-          DEBUG_INFO,
-          "Notify: PPI Guid: %g, Peim notify entry point: %p\n",
-          SearchGuid,
-          NotifyDescriptor->Notify
-          ));
-        NotifyDescriptor->Notify (
-                            (EFI_PEI_SERVICES **)GetPeiServicesTablePointer (),
-                            NotifyDescriptor,
-                            (PrivateData->PpiData.PpiList.PpiPtrs[Index2].Ppi)->Ppi
-                            );
+        CallNotify (PrivateData, NotifyDescriptor, Index2);
       }
+
+      Link = NextLink;
     }
   }
 }
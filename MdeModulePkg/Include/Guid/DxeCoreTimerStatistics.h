@@ -0,0 +1,53 @@
+/** @file
+  Timer dispatch statistics published by the DXE core.
+
+  The DXE core installs a configuration table with this GUID that points to
+  an EDKII_DXE_CORE_TIMER_STATISTICS structure. The counters are updated in
+  place while timers are armed and dispatched.
+
+Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __EDKII_DXE_CORE_TIMER_STATISTICS_GUID_H__
+#define __EDKII_DXE_CORE_TIMER_STATISTICS_GUID_H__
+
+#define EDKII_DXE_CORE_TIMER_STATISTICS_GUID \
+  { \
+    0xc3594d8f, 0x56cc, 0x42e1, { 0x90, 0x75, 0xf7, 0x24, 0x8f, 0x67, 0xb1, 0x49 } \
+  }
+
+#define EDKII_DXE_CORE_TIMER_STATISTICS_REVISION  0x0001
+
+typedef struct {
+  UINT32    Revision;
+  UINT32    Reserved;
+  ///
+  /// Number of SetTimer() calls that armed a timer.
+  ///
+  UINT64    ArmedCount;
+  ///
+  /// Number of times a timer expired and its event was signaled, including
+  /// every period of a periodic timer.
+  ///
+  UINT64    FiredCount;
+  ///
+  /// Number of expirations that were dispatched more than one timer tick
+  /// after their trigger time.
+  ///
+  UINT64    LateCount;
+  ///
+  /// Largest dispatch delay seen, in 100ns units.
+  ///
+  UINT64    MaxLateness;
+  ///
+  /// Timers currently queued, and the largest number queued at once.
+  ///
+  UINT64    QueuedTimers;
+  UINT64    PeakQueuedTimers;
+} EDKII_DXE_CORE_TIMER_STATISTICS;
+
+extern EFI_GUID  gEdkiiDxeCoreTimerStatisticsGuid;
+
+#endif
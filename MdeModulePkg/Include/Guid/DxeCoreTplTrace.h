@@ -0,0 +1,60 @@
+/** @file
+  Per caller RaiseTPL() and RestoreTPL() counts recorded by the DXE core.
+
+  When PcdDxeCoreTplTraceEnable is TRUE, the DXE core installs a configuration
+  table with this GUID that points to an EDKII_DXE_CORE_TPL_TRACE structure.
+  Every RaiseTPL() and RestoreTPL() call is counted against the return address
+  of the call, so the callers can be mapped back to the loaded images.
+
+Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __EDKII_DXE_CORE_TPL_TRACE_GUID_H__
+#define __EDKII_DXE_CORE_TPL_TRACE_GUID_H__
+
+#define EDKII_DXE_CORE_TPL_TRACE_GUID \
+  { \
+    0x98edef20, 0x82d2, 0x4a07, { 0xab, 0xee, 0x86, 0x9b, 0xed, 0xf0, 0x8b, 0xc8 } \
+  }
+
+#define EDKII_DXE_CORE_TPL_TRACE_REVISION  0x0001
+
+///
+/// Number of distinct callers that can be recorded. Must be a power of two.
+///
+#define EDKII_DXE_CORE_TPL_TRACE_MAX_CALLERS  256
+
+typedef struct {
+  ///
+  /// Return address of the call, 0 if the entry is unused.
+  ///
+  UINT64    Caller;
+  UINT64    RaiseCount;
+  UINT64    RestoreCount;
+} EDKII_DXE_CORE_TPL_TRACE_ENTRY;
+
+typedef struct {
+  UINT32                            Revision;
+  UINT32                            MaxCallers;
+  ///
+  /// Total number of RaiseTPL() and RestoreTPL() calls.
+  ///
+  UINT64                            RaiseCount;
+  UINT64                            RestoreCount;
+  ///
+  /// Number of RestoreTPL() calls that found pending event notifications to
+  /// dispatch, and so could not take the fast path.
+  ///
+  UINT64                            DispatchCount;
+  ///
+  /// Number of calls that were not recorded because the caller table was full.
+  ///
+  UINT64                            DroppedCount;
+  EDKII_DXE_CORE_TPL_TRACE_ENTRY    Entry[EDKII_DXE_CORE_TPL_TRACE_MAX_CALLERS];
+} EDKII_DXE_CORE_TPL_TRACE;
+
+extern EFI_GUID  gEdkiiDxeCoreTplTraceGuid;
+
+#endif
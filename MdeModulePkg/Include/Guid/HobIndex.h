@@ -0,0 +1,63 @@
+/** @file
+  Index of the GUID extension HOBs of the HOB list.
+
+  The HOB list is read-only once the DXE phase starts. DxeHobIndexLib builds
+  this index of its GUID extension HOBs by GUID the first time a module linked
+  against it runs, and installs it as a configuration table with this GUID so
+  that the other modules do not have to build it again.
+
+Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __EDKII_HOB_INDEX_GUID_H__
+#define __EDKII_HOB_INDEX_GUID_H__
+
+#define EDKII_HOB_INDEX_GUID \
+  { \
+    0xfef831c3, 0xce96, 0x4a12, { 0x86, 0x5a, 0xba, 0xb2, 0x62, 0xd4, 0x9a, 0xe4 } \
+  }
+
+#define EDKII_HOB_INDEX_REVISION  0x0001
+
+typedef struct {
+  EFI_GUID    Name;
+  ///
+  /// Index in Guid[] of the next GUID of the same bucket, plus one. 0 ends
+  /// the chain.
+  ///
+  UINT32      Next;
+  ///
+  /// The HOBs with this GUID are Hob[First] to Hob[First + Count - 1], in HOB
+  /// list order.
+  ///
+  UINT32      First;
+  UINT32      Count;
+  UINT32      Reserved;
+} EDKII_HOB_INDEX_GUID_ENTRY;
+
+///
+/// The header is followed by:
+///   UINT32                      Bucket[BucketCount];
+///   EDKII_HOB_INDEX_GUID_ENTRY  Guid[GuidCount];
+///   EFI_PHYSICAL_ADDRESS        Hob[HobCount];
+/// Bucket holds an index in Guid[] plus one, 0 for an empty bucket.
+/// BucketCount is a power of two and at least 2.
+///
+typedef struct {
+  UINT32                  Revision;
+  UINT32                  BucketCount;
+  UINT32                  GuidCount;
+  UINT32                  HobCount;
+  ///
+  /// The HOB list that is indexed, from its first HOB to the end of its end
+  /// of list HOB.
+  ///
+  EFI_PHYSICAL_ADDRESS    HobList;
+  EFI_PHYSICAL_ADDRESS    HobListEnd;
+} EDKII_HOB_INDEX;
+
+extern EFI_GUID  gEdkiiHobIndexGuid;
+
+#endif
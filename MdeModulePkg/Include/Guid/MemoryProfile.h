@@ -179,6 +179,32 @@ typedef struct {
   // MEMORY_PROFILE_DESCRIPTOR     MemoryDescriptor[MemoryRangeCount];
 } MEMORY_PROFILE_MEMORY_RANGE;
 
+#define MEMORY_PROFILE_POOL_SLAB_SIGNATURE  SIGNATURE_32 ('M','P','P','S')
+#define MEMORY_PROFILE_POOL_SLAB_REVISION   0x0001
+
+typedef struct {
+  UINT32    ObjectSize;
+  UINT8     Reserved[4];
+  UINT64    AllocationCount;
+  UINT64    FreeCount;
+  UINT64    CurrentObjects;
+  UINT64    CurrentPages;
+  UINT64    BytesSaved;
+} MEMORY_PROFILE_POOL_SLAB_CLASS;
+
+typedef struct {
+  MEMORY_PROFILE_COMMON_HEADER    Header;
+  UINT32                          SlabClassCount;
+  UINT8                           Reserved[4];
+  UINT64                          TotalAllocationCount;
+  UINT64                          TotalFreeCount;
+  UINT64                          CurrentSlabPages;
+  UINT64                          PeakSlabPages;
+  UINT64                          BytesSaved;
+  UINT64                          SystemTime; // In 100ns units, to derive allocation rates
+  // MEMORY_PROFILE_POOL_SLAB_CLASS  SlabClass[SlabClassCount];
+} MEMORY_PROFILE_POOL_SLAB;
+
 //
 // UEFI memory profile layout:
 // +--------------------------------+
@@ -196,6 +222,8 @@ typedef struct {
 // +--------------------------------+
 // | ALLOC_INFO(n, mn)              |
 // +--------------------------------+
+// | POOL_SLAB (optional)           |
+// +--------------------------------+
 //
 
 typedef struct _EDKII_MEMORY_PROFILE_PROTOCOL EDKII_MEMORY_PROFILE_PROTOCOL;
@@ -54,6 +54,25 @@ typedef struct  {
   UINT16    ExGuidIndex;        // Index of GuidTable in units of GUID.
 } DYNAMICEX_MAPPING;
 
+//
+// First PCD database version that has the ExMap hash table.
+//
+#define PCD_DATABASE_EX_MAP_HASH_VERSION  8
+
+//
+// The ExMap hash table is a minimal perfect hash of the {token space guid:
+// token number} pairs of the ExMap table, generated by the build tool:
+//
+// UINT16 BucketSeed[ExMapHashBucketCount];
+// UINT16 ExMapIndex[ExTokenCount];
+//
+// A pair is in bucket PcdExMapHash (Pair, 0) % ExMapHashBucketCount, and its
+// ExMap table entry is ExMapIndex[PcdExMapHash (Pair, BucketSeed[Bucket]) %
+// ExTokenCount]. The entry must still be compared with the pair, as pairs that
+// are not in the ExMap table also land on an entry.
+//
+typedef UINT16 EX_MAP_HASH_ENTRY;
+
 typedef struct {
   UINT32    StringIndex;        // Offset in String Table in units of UINT8.
   UINT32    DefaultValueOffset; // Offset of the Default Value.
@@ -96,7 +115,8 @@ typedef struct {
   UINT16          LocalTokenCount;              // LOCAL_TOKEN_NUMBER for all.
   UINT16          ExTokenCount;                 // EX_TOKEN_NUMBER for DynamicEx.
   UINT16          GuidTableCount;               // The Number of Guid in GuidTable.
-  UINT8           Pad[6];                       // Pad bytes to satisfy the alignment.
+  UINT16          ExMapHashBucketCount;         // The Number of buckets of the ExMap hash table, 0 if there is none.
+  TABLE_OFFSET    ExMapHashTableOffset;
 
   //
   // Default initialized external PCD database binary structure
@@ -108,6 +128,7 @@ typedef struct {
   // UINT32                         ValueUint32[];
   // VPD_HEAD                       VpdHead[];               // VPD Offset
   // DYNAMICEX_MAPPING              ExMapTable[];            // DynamicEx PCD mapped to LocalIndex in LocalTokenNumberTable. It can be accessed by the ExMapTableOffset.
+  // EX_MAP_HASH_ENTRY              ExMapHashTable[];        // Perfect hash of ExMapTable. It can be accessed by the ExMapHashTableOffset.
   // UINT32                         LocalTokenNumberTable[]; // Offset | DataType | PCD Type. It can be accessed by LocalTokenNumberTableOffset.
   // GUID                           GuidTable[];             // GUID for DynamicEx and HII PCD variable Guid. It can be accessed by the GuidTableOffset.
   // STRING_HEAD                    StringHead[];            // String PCD
@@ -77,6 +77,10 @@ typedef struct {
 // The payload for this function is SMM_VARIABLE_COMMUNICATE_GET_RUNTIME_CACHE_INFO
 //
 #define SMM_VARIABLE_FUNCTION_GET_RUNTIME_CACHE_INFO  14
+//
+// The payload for this function is SMM_VARIABLE_COMMUNICATE_SET_VARIABLE_BATCH
+//
+#define SMM_VARIABLE_FUNCTION_SET_VARIABLE_BATCH  15
 
 ///
 /// Size of SMM communicate header, without including the payload.
@@ -138,6 +142,18 @@ typedef struct {
   VARIABLE_STORE_HEADER    *RuntimeHobCache;
   VARIABLE_STORE_HEADER    *RuntimeNvCache;
   VARIABLE_STORE_HEADER    *RuntimeVolatileCache;
+  ///
+  /// Sequence counter of the runtime caches. SMM makes it odd while it updates
+  /// the caches and even again when the update is complete, so readers can
+  /// detect and retry a read that raced with an update instead of locking.
+  ///
+  volatile UINT32          *Sequence;
+  ///
+  /// Generation of the layout of the runtime caches. SMM increments it, while
+  /// the sequence counter is odd, when a reclaim moves variables within the
+  /// caches, so readers drop any index of the variables they keep.
+  ///
+  volatile UINT32          *Generation;
 } SMM_VARIABLE_COMMUNICATE_RUNTIME_VARIABLE_CACHE_CONTEXT;
 
 typedef struct {
@@ -147,4 +163,19 @@ typedef struct {
   BOOLEAN    AuthenticatedVariableUsage;
 } SMM_VARIABLE_COMMUNICATE_GET_RUNTIME_CACHE_INFO;
 
+///
+/// This structure is used to communicate with SMI handler by the batch SetVariable.
+/// A batch is sent in chunks that fit in the variable communicate buffer, and is
+/// set when its last chunk is sent. Each chunk is followed by EntryCount
+/// SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE entries, each of them aligned on a
+/// UINTN boundary.
+///
+typedef struct {
+  UINTN      EntryCount;
+  UINTN      FailedEntry;   // Return index of the entry of the batch that failed
+  UINTN      BatchSize;     // Size of the entries of all the chunks of the batch
+  BOOLEAN    FirstChunk;
+  BOOLEAN    LastChunk;
+} SMM_VARIABLE_COMMUNICATE_SET_VARIABLE_BATCH;
+
 #endif // _SMM_VARIABLE_COMMON_H_
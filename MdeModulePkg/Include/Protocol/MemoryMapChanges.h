@@ -0,0 +1,77 @@
+/** @file
+  EDKII Memory Map Changes Protocol.
+
+  The DXE core produces this protocol to let callers that keep their own copy
+  of the UEFI memory map, such as OS loaders and boot managers, fetch only the
+  memory descriptors that changed since the copy was taken instead of the whole
+  map returned by GetMemoryMap().
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __EDKII_MEMORY_MAP_CHANGES_PROTOCOL_H__
+#define __EDKII_MEMORY_MAP_CHANGES_PROTOCOL_H__
+
+#define EDKII_MEMORY_MAP_CHANGES_PROTOCOL_GUID \
+  { \
+    0x285af574, 0x6252, 0x4b78, { 0xbf, 0xa8, 0xdf, 0x2f, 0x84, 0x84, 0xc1, 0xd3 } \
+  }
+
+#define EDKII_MEMORY_MAP_CHANGES_PROTOCOL_REVISION  0x00000001
+
+typedef struct _EDKII_MEMORY_MAP_CHANGES_PROTOCOL EDKII_MEMORY_MAP_CHANGES_PROTOCOL;
+
+/**
+  Return the descriptors of the memory map that changed since a generation.
+
+  Every change to the memory map advances its generation. The descriptors are
+  the same as the ones returned by GetMemoryMap() for the generation returned
+  in Generation, but only the descriptors that overlap a range changed after
+  the input generation are returned. If the changes since the input generation
+  are no longer known, or memory was removed from the map, the whole map is
+  returned and FullMap is set to TRUE.
+
+  @param[in, out] Generation     On input, the generation of the memory map
+                                 known by the caller, or 0 to get the whole
+                                 map. On output, the generation of the returned
+                                 descriptors.
+  @param[in, out] MemoryMapSize  On input, the size of MemoryMap in bytes. On
+                                 output, the size of the returned descriptors,
+                                 or the size needed if the buffer is too small.
+  @param[out]     MemoryMap      The buffer that receives the descriptors.
+  @param[out]     MapKey         The key of the memory map of Generation.
+  @param[out]     DescriptorSize The size of one EFI_MEMORY_DESCRIPTOR.
+  @param[out]     DescriptorVersion  The version of EFI_MEMORY_DESCRIPTOR.
+  @param[out]     FullMap        TRUE if the whole memory map was returned.
+
+  @retval EFI_SUCCESS            The changed descriptors were returned.
+  @retval EFI_BUFFER_TOO_SMALL   MemoryMap is too small. The size needed is
+                                 returned in MemoryMapSize.
+  @retval EFI_INVALID_PARAMETER  Generation, MemoryMapSize or FullMap is NULL,
+                                 or Generation is a generation that does not
+                                 exist yet.
+  @retval EFI_OUT_OF_RESOURCES   The memory map could not be captured.
+
+**/
+typedef
+EFI_STATUS
+(EFIAPI *EDKII_GET_MEMORY_MAP_CHANGES)(
+  IN OUT UINT64                 *Generation,
+  IN OUT UINTN                  *MemoryMapSize,
+  OUT    EFI_MEMORY_DESCRIPTOR  *MemoryMap,
+  OUT    UINTN                  *MapKey OPTIONAL,
+  OUT    UINTN                  *DescriptorSize OPTIONAL,
+  OUT    UINT32                 *DescriptorVersion OPTIONAL,
+  OUT    BOOLEAN                *FullMap
+  );
+
+struct _EDKII_MEMORY_MAP_CHANGES_PROTOCOL {
+  UINT32                          Revision;
+  EDKII_GET_MEMORY_MAP_CHANGES    GetMemoryMapChanges;
+};
+
+extern EFI_GUID  gEdkiiMemoryMapChangesProtocolGuid;
+
+#endif
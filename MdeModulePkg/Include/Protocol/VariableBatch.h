@@ -0,0 +1,78 @@
+/** @file
+  Variable Batch Protocol is related to EDK II-specific implementation of variables
+  and intended for use as a means to set many non-volatile variables at once. The
+  variables of a batch are set atomically, either all of them or none of them are
+  written to the variable store.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __VARIABLE_BATCH_H__
+#define __VARIABLE_BATCH_H__
+
+#define EDKII_VARIABLE_BATCH_PROTOCOL_GUID \
+  { \
+    0x90ae2cb9, 0x3ef0, 0x405f, { 0x8e, 0x13, 0x57, 0x4a, 0x3b, 0xac, 0xa9, 0x51 } \
+  }
+
+typedef struct _EDKII_VARIABLE_BATCH_PROTOCOL EDKII_VARIABLE_BATCH_PROTOCOL;
+
+///
+/// One variable of a batch, with the parameters of SetVariable().
+///
+typedef struct {
+  CHAR16      *VariableName;
+  EFI_GUID    *VendorGuid;
+  UINT32      Attributes;
+  UINTN       DataSize;
+  VOID        *Data;
+} EDKII_VARIABLE_BATCH_ENTRY;
+
+/**
+  Set a batch of non-volatile variables.
+
+  Each entry is set as SetVariable() would set it, in the order of the entries,
+  so a later entry sees the variables set by the earlier ones. If any entry
+  fails, none of the entries are written to the variable store.
+
+  Every entry must have the EFI_VARIABLE_NON_VOLATILE attribute, including the
+  entries that delete a variable, and authenticated variables cannot be set in
+  a batch.
+
+  @param[in]  This              The EDKII_VARIABLE_BATCH_PROTOCOL instance.
+  @param[in]  EntryCount        The number of entries in Entries.
+  @param[in]  Entries           The variables to set.
+  @param[out] FailedEntry       The index of the entry that failed, if the
+                                returned status is the status of an entry.
+
+  @retval EFI_SUCCESS           All the variables were set.
+  @retval EFI_INVALID_PARAMETER Entries is NULL and EntryCount is not 0, or an
+                                entry is not valid.
+  @retval EFI_BAD_BUFFER_SIZE   The batch is too large to be set at once.
+  @retval EFI_UNSUPPORTED       The variable store cannot be updated atomically.
+  @retval EFI_OUT_OF_RESOURCES  There is not enough memory to send the batch.
+  @retval Others                The status of the entry that failed, no variable
+                                was set.
+**/
+typedef
+EFI_STATUS
+(EFIAPI *EDKII_VARIABLE_BATCH_SET_VARIABLES)(
+  IN CONST EDKII_VARIABLE_BATCH_PROTOCOL  *This,
+  IN       UINTN                          EntryCount,
+  IN       EDKII_VARIABLE_BATCH_ENTRY     *Entries,
+  OUT      UINTN                          *FailedEntry OPTIONAL
+  );
+
+///
+/// Variable Batch Protocol is related to EDK II-specific implementation of variables
+/// and intended for use as a means to set many non-volatile variables at once.
+///
+struct _EDKII_VARIABLE_BATCH_PROTOCOL {
+  EDKII_VARIABLE_BATCH_SET_VARIABLES    SetVariables;
+};
+
+extern EFI_GUID  gEdkiiVariableBatchProtocolGuid;
+
+#endif
@@ -9,6 +9,9 @@
     Aligned  - A read of N contiguous sectors.
     OverRun  - The last byte is not on a sector boundary.
 
+  Small reads of a whole disk may be served from an optional block cache, see
+  DiskIoCache.c.
+
 Copyright (c) 2006 - 2018, Intel Corporation. All rights reserved.<BR>
 SPDX-License-Identifier: BSD-2-Clause-Patent
 
@@ -186,6 +189,8 @@ DiskIoDriverBindingStart (
     goto ErrorExit;
   }
 
+  DiskIoCacheInit (Instance);
+
   //
   // Install protocol interfaces for the Disk IO device.
   //
@@ -217,6 +222,7 @@ ErrorExit:
     }
 
     if (Instance != NULL) {
+      DiskIoCacheFree (Instance);
       FreePool (Instance);
     }
 
@@ -329,6 +335,7 @@ DiskIoDriverBindingStop (
       Instance->SharedWorkingBuffer,
       EFI_SIZE_TO_PAGES (PcdGet32 (PcdDiskIoDataBufferBlockNum) * Instance->BlockIo->Media->BlockSize)
       );
+    DiskIoCacheFree (Instance);
 
     Status = gBS->CloseProtocol (
                     ControllerHandle,
@@ -432,6 +439,17 @@ DiskIo2OnReadWriteComplete (
     CopyMem (Subtask->Buffer, Subtask->WorkingBuffer + Subtask->Offset, Subtask->Length);
   }
 
+  if (Subtask->Write) {
+    //
+    // Drop the blocks that may have been cached while the write was in progress.
+    //
+    DiskIoCacheInvalidate (
+      Instance,
+      MultU64x32 (Subtask->Lba, Instance->BlockIo->Media->BlockSize) + Subtask->Offset,
+      Subtask->Length
+      );
+  }
+
   DiskIoDestroySubtask (Instance, Subtask);
 
   if (EFI_ERROR (TransactionStatus) || IsListEmpty (&Task->Subtasks)) {
@@ -864,10 +882,24 @@ DiskIo2ReadWriteDisk (
     //
     while (!DiskIo2RemoveCompletedTask (Instance)) {
     }
+  } else {
+    DiskIo2RemoveCompletedTask (Instance);
+  }
 
+  if (Write) {
+    DiskIoCacheInvalidate (Instance, Offset, BufferSize);
+  } else if (DiskIoCacheRead (Instance, MediaId, Offset, BufferSize, Buffer, Blocking, &Status)) {
+    if (!Blocking) {
+      Token->TransactionStatus = Status;
+      gBS->SignalEvent (Token->Event);
+    }
+
+    return Status;
+  }
+
+  if (Blocking) {
     SubtasksPtr = &Subtasks;
   } else {
-    DiskIo2RemoveCompletedTask (Instance);
     Task = AllocatePool (sizeof (DISK_IO2_TASK));
     if (Task == NULL) {
       return EFI_OUT_OF_RESOURCES;
@@ -1012,6 +1044,14 @@ DiskIo2ReadWriteDisk (
     FreePool (Task);
   }
 
+  if (Write) {
+    //
+    // Drop the blocks that may have been cached while the blocking subtasks
+    // were in progress. The non-blocking ones do it when they complete.
+    //
+    DiskIoCacheInvalidate (Instance, Offset, BufferSize);
+  }
+
   gBS->RestoreTPL (OldTpl);
 
   return Status;
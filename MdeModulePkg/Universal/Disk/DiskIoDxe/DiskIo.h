@@ -24,6 +24,48 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/MemoryAllocationLib.h>
 #include <Library/UefiBootServicesTableLib.h>
 
+//
+// Smallest number of blocks the block cache reads from the device in one request.
+//
+#define DISK_IO_CACHE_MIN_READ_BLOCK_NUM  8
+
+typedef struct {
+  LIST_ENTRY    Link;                   /// < link in the LRU list or the free list
+  LIST_ENTRY    HashLink;               /// < link in the hash bucket
+  EFI_LBA       Lba;
+  UINT8         *Data;
+} DISK_IO_CACHE_ENTRY;
+
+//
+// Write-through LRU cache of the blocks of a whole disk.
+// Entries == NULL indicates the cache is disabled.
+//
+typedef struct {
+  EFI_LOCK               Lock;
+  UINT32                 MediaId;
+  UINT32                 BlockSize;
+  UINTN                  BlockNum;
+  UINTN                  ReadBlockNum;  /// < size in block of ReadBuffer
+  DISK_IO_CACHE_ENTRY    *Entries;
+  UINT8                  *Data;
+  UINT8                  *ReadBuffer;
+  BOOLEAN                ReadBufferBusy;
+  LIST_ENTRY             *Buckets;
+  UINTN                  BucketMask;
+  LIST_ENTRY             LruList;       /// < most recently used entry first
+  LIST_ENTRY             FreeList;
+  //
+  // Generation changes on every invalidation, so that the data read from the
+  // device while a write was in progress is not put into the cache.
+  //
+  UINT64                 Generation;
+  EFI_LBA                NextLba;       /// < block following the last cached read
+  UINT64                 Hits;
+  UINT64                 Misses;
+  UINT64                 ReadAheads;
+  EFI_EVENT              ReadyToBootEvent;  /// < reports the counters
+} DISK_IO_CACHE;
+
 #define DISK_IO_PRIVATE_DATA_SIGNATURE  SIGNATURE_32 ('d', 's', 'k', 'I')
 typedef struct {
   UINT32                    Signature;
@@ -37,6 +79,8 @@ typedef struct {
 
   EFI_LOCK                  TaskQueueLock;
   LIST_ENTRY                TaskQueue;
+
+  DISK_IO_CACHE             Cache;
 } DISK_IO_PRIVATE_DATA;
 #define DISK_IO_PRIVATE_DATA_FROM_DISK_IO(a)   CR (a, DISK_IO_PRIVATE_DATA, DiskIo,  DISK_IO_PRIVATE_DATA_SIGNATURE)
 #define DISK_IO_PRIVATE_DATA_FROM_DISK_IO2(a)  CR (a, DISK_IO_PRIVATE_DATA, DiskIo2, DISK_IO_PRIVATE_DATA_SIGNATURE)
@@ -335,6 +379,76 @@ DiskIo2FlushDiskEx (
   IN OUT EFI_DISK_IO2_TOKEN  *Token
   );
 
+//
+// Block cache
+//
+
+/**
+  Create the block cache of a disk when PcdDiskIoCacheBlockNum is not 0.
+  The cache is left disabled for logical partitions, because their reads go
+  through the Disk I/O of the whole disk and are cached there. It is also left
+  disabled for removable media, because a hit does not reach the Block I/O of
+  the device, which is where a media change is detected.
+
+  @param Instance    Pointer to the DISK_IO_PRIVATE_DATA.
+**/
+VOID
+DiskIoCacheInit (
+  IN DISK_IO_PRIVATE_DATA  *Instance
+  );
+
+/**
+  Free the block cache of a disk and report its counters.
+
+  @param Instance    Pointer to the DISK_IO_PRIVATE_DATA.
+**/
+VOID
+DiskIoCacheFree (
+  IN DISK_IO_PRIVATE_DATA  *Instance
+  );
+
+/**
+  Read from the block cache, filling it from the device on a miss.
+
+  A blocking read may read the missing blocks from the device. A non-blocking
+  read is only served when all of its blocks are in the cache.
+
+  @param Instance    Pointer to the DISK_IO_PRIVATE_DATA.
+  @param MediaId     ID of the medium to be read.
+  @param Offset      The starting byte offset on the device to read from.
+  @param BufferSize  The size in bytes of Buffer.
+  @param Buffer      A pointer to the destination buffer for the data.
+  @param Blocking    TRUE: Blocking request; FALSE: Non-blocking request.
+  @param Status      Return the status of the read when it is served.
+
+  @retval TRUE       The read is served and Status is returned.
+  @retval FALSE      The read is not served and must be sent to the device.
+**/
+BOOLEAN
+DiskIoCacheRead (
+  IN  DISK_IO_PRIVATE_DATA  *Instance,
+  IN  UINT32                MediaId,
+  IN  UINT64                Offset,
+  IN  UINTN                 BufferSize,
+  OUT UINT8                 *Buffer,
+  IN  BOOLEAN               Blocking,
+  OUT EFI_STATUS            *Status
+  );
+
+/**
+  Drop the cached blocks that overlap a range of the device.
+
+  @param Instance    Pointer to the DISK_IO_PRIVATE_DATA.
+  @param Offset      The starting byte offset of the range.
+  @param Length      The length in bytes of the range.
+**/
+VOID
+DiskIoCacheInvalidate (
+  IN DISK_IO_PRIVATE_DATA  *Instance,
+  IN UINT64                Offset,
+  IN UINTN                 Length
+  );
+
 //
 // EFI Component Name Functions
 //
@@ -0,0 +1,517 @@
+/** @file
+  Block cache of the DiskIo driver.
+
+  Small reads of a whole disk are served from a write-through LRU cache of
+  blocks, which is filled from the device on a miss. A miss that continues the
+  previous read also reads the following blocks, so that a scan made of small
+  reads turns into a few large reads of the device. Writes drop the cached
+  blocks they overlap both before they are sent to the device and after they
+  complete, and the whole cache is dropped when the media ID of the device
+  changes or the media is removed. Removable media are not cached, because
+  their media can change without any read reaching the device to notice it.
+
+  The hit, miss and read-ahead counters of a disk are reported with DEBUG_INFO
+  at ReadyToBoot, and when the driver stops.
+
+Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "DiskIo.h"
+
+/**
+  Drop all the cached blocks.
+
+  @param Cache       Pointer to the DISK_IO_CACHE.
+**/
+VOID
+DiskIoCacheReset (
+  IN DISK_IO_CACHE  *Cache
+  )
+{
+  UINTN  Index;
+
+  InitializeListHead (&Cache->LruList);
+  InitializeListHead (&Cache->FreeList);
+  for (Index = 0; Index <= Cache->BucketMask; Index++) {
+    InitializeListHead (&Cache->Buckets[Index]);
+  }
+
+  for (Index = 0; Index < Cache->BlockNum; Index++) {
+    InsertTailList (&Cache->FreeList, &Cache->Entries[Index].Link);
+  }
+
+  Cache->NextLba = 0;
+  Cache->Generation++;
+}
+
+/**
+  Drop all the cached blocks when the media of the device has changed.
+  The caller must hold the cache lock.
+
+  @param Instance    Pointer to the DISK_IO_PRIVATE_DATA.
+**/
+VOID
+DiskIoCacheCheckMedia (
+  IN DISK_IO_PRIVATE_DATA  *Instance
+  )
+{
+  DISK_IO_CACHE       *Cache;
+  EFI_BLOCK_IO_MEDIA  *Media;
+
+  Cache = &Instance->Cache;
+  Media = Instance->BlockIo->Media;
+  if (Media->MediaPresent && (Media->MediaId == Cache->MediaId)) {
+    return;
+  }
+
+  DEBUG ((DEBUG_BLKIO, "DiskIo: Media changed, drop the block cache\n"));
+  Cache->MediaId = Media->MediaId;
+  DiskIoCacheReset (Cache);
+}
+
+/**
+  Find a block in the cache.
+
+  @param Cache       Pointer to the DISK_IO_CACHE.
+  @param Lba         The logical block address of the block.
+
+  @return The cache entry of the block, or NULL when the block is not cached.
+**/
+DISK_IO_CACHE_ENTRY *
+DiskIoCacheLookup (
+  IN DISK_IO_CACHE  *Cache,
+  IN EFI_LBA        Lba
+  )
+{
+  LIST_ENTRY           *Bucket;
+  LIST_ENTRY           *Link;
+  DISK_IO_CACHE_ENTRY  *Entry;
+
+  Bucket = &Cache->Buckets[(UINTN)Lba & Cache->BucketMask];
+  for (Link = GetFirstNode (Bucket); !IsNull (Bucket, Link); Link = GetNextNode (Bucket, Link)) {
+    Entry = BASE_CR (Link, DISK_IO_CACHE_ENTRY, HashLink);
+    if (Entry->Lba == Lba) {
+      return Entry;
+    }
+  }
+
+  return NULL;
+}
+
+/**
+  Put a block into the cache, replacing the least recently used block when
+  the cache is full.
+
+  @param Cache       Pointer to the DISK_IO_CACHE.
+  @param Lba         The logical block address of the block.
+  @param Data        The data of the block.
+**/
+VOID
+DiskIoCacheInsert (
+  IN DISK_IO_CACHE  *Cache,
+  IN EFI_LBA        Lba,
+  IN UINT8          *Data
+  )
+{
+  DISK_IO_CACHE_ENTRY  *Entry;
+
+  if (DiskIoCacheLookup (Cache, Lba) != NULL) {
+    return;
+  }
+
+  if (!IsListEmpty (&Cache->FreeList)) {
+    Entry = BASE_CR (GetFirstNode (&Cache->FreeList), DISK_IO_CACHE_ENTRY, Link);
+  } else {
+    Entry = BASE_CR (GetPreviousNode (&Cache->LruList, &Cache->LruList), DISK_IO_CACHE_ENTRY, Link);
+    RemoveEntryList (&Entry->HashLink);
+  }
+
+  RemoveEntryList (&Entry->Link);
+  Entry->Lba = Lba;
+  CopyMem (Entry->Data, Data, Cache->BlockSize);
+  InsertHeadList (&Cache->LruList, &Entry->Link);
+  InsertHeadList (&Cache->Buckets[(UINTN)Lba & Cache->BucketMask], &Entry->HashLink);
+}
+
+/**
+  Drop a block from the cache.
+
+  @param Cache       Pointer to the DISK_IO_CACHE.
+  @param Entry       The cache entry of the block.
+**/
+VOID
+DiskIoCacheRemove (
+  IN DISK_IO_CACHE        *Cache,
+  IN DISK_IO_CACHE_ENTRY  *Entry
+  )
+{
+  RemoveEntryList (&Entry->HashLink);
+  RemoveEntryList (&Entry->Link);
+  InsertTailList (&Cache->FreeList, &Entry->Link);
+}
+
+/**
+  Report the counters of the block cache of a disk.
+
+  @param Cache       Pointer to the DISK_IO_CACHE.
+**/
+STATIC
+VOID
+DiskIoCacheReport (
+  IN DISK_IO_CACHE  *Cache
+  )
+{
+  if ((Cache->Hits != 0) || (Cache->Misses != 0)) {
+    DEBUG ((
+      DEBUG_INFO,
+      "DiskIo: Block cache hits/misses/read-ahead blocks = %Lu/%Lu/%Lu\n",
+      Cache->Hits,
+      Cache->Misses,
+      Cache->ReadAheads
+      ));
+  }
+}
+
+/**
+  Report the counters of the block cache of a disk at ReadyToBoot, as the
+  cache of a boot disk is rarely freed.
+
+  @param Event       The ReadyToBoot event.
+  @param Context     Pointer to the DISK_IO_PRIVATE_DATA.
+**/
+STATIC
+VOID
+EFIAPI
+DiskIoCacheOnReadyToBoot (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  DISK_IO_CACHE  *Cache;
+
+  Cache = &((DISK_IO_PRIVATE_DATA *)Context)->Cache;
+  EfiAcquireLock (&Cache->Lock);
+  DiskIoCacheReport (Cache);
+  EfiReleaseLock (&Cache->Lock);
+}
+
+/**
+  Create the block cache of a disk when PcdDiskIoCacheBlockNum is not 0.
+  The cache is left disabled for logical partitions, because their reads go
+  through the Disk I/O of the whole disk and are cached there. It is also left
+  disabled for removable media, because a hit does not reach the Block I/O of
+  the device, which is where a media change is detected.
+
+  @param Instance    Pointer to the DISK_IO_PRIVATE_DATA.
+**/
+VOID
+DiskIoCacheInit (
+  IN DISK_IO_PRIVATE_DATA  *Instance
+  )
+{
+  DISK_IO_CACHE       *Cache;
+  EFI_BLOCK_IO_MEDIA  *Media;
+  UINT32              BlockNum;
+  UINTN               Index;
+
+  Cache    = &Instance->Cache;
+  Media    = Instance->BlockIo->Media;
+  BlockNum = PcdGet32 (PcdDiskIoCacheBlockNum);
+  if ((BlockNum == 0) || Media->LogicalPartition || Media->RemovableMedia || (Media->BlockSize == 0)) {
+    return;
+  }
+
+  Cache->BlockSize    = Media->BlockSize;
+  Cache->BlockNum     = BlockNum;
+  Cache->ReadBlockNum = MIN (MAX (PcdGet32 (PcdDiskIoCacheReadAheadBlockNum), DISK_IO_CACHE_MIN_READ_BLOCK_NUM), BlockNum);
+  Cache->BucketMask   = GetPowerOfTwo32 (BlockNum) - 1;
+
+  Cache->Entries    = AllocateZeroPool (Cache->BlockNum * sizeof (DISK_IO_CACHE_ENTRY));
+  Cache->Buckets    = AllocatePool ((Cache->BucketMask + 1) * sizeof (LIST_ENTRY));
+  Cache->Data       = AllocateAlignedPages (EFI_SIZE_TO_PAGES (Cache->BlockNum * Cache->BlockSize), Media->IoAlign);
+  Cache->ReadBuffer = AllocateAlignedPages (EFI_SIZE_TO_PAGES (Cache->ReadBlockNum * Cache->BlockSize), Media->IoAlign);
+  if ((Cache->Entries == NULL) || (Cache->Buckets == NULL) || (Cache->Data == NULL) || (Cache->ReadBuffer == NULL)) {
+    DEBUG ((DEBUG_WARN, "DiskIo: No enough memory for the block cache\n"));
+    DiskIoCacheFree (Instance);
+    return;
+  }
+
+  for (Index = 0; Index < Cache->BlockNum; Index++) {
+    Cache->Entries[Index].Data = Cache->Data + Index * Cache->BlockSize;
+  }
+
+  EfiInitializeLock (&Cache->Lock, TPL_NOTIFY);
+  Cache->MediaId = Media->MediaId;
+  DiskIoCacheReset (Cache);
+
+  //
+  // The counters are only a diagnostic, the cache works without the event.
+  //
+  EfiCreateEventReadyToBootEx (TPL_CALLBACK, DiskIoCacheOnReadyToBoot, Instance, &Cache->ReadyToBootEvent);
+
+  DEBUG ((
+    DEBUG_INFO,
+    "DiskIo: Block cache of %d blocks, reading %d blocks ahead\n",
+    BlockNum,
+    (UINT32)Cache->ReadBlockNum
+    ));
+}
+
+/**
+  Free the block cache of a disk and report its counters.
+
+  @param Instance    Pointer to the DISK_IO_PRIVATE_DATA.
+**/
+VOID
+DiskIoCacheFree (
+  IN DISK_IO_PRIVATE_DATA  *Instance
+  )
+{
+  DISK_IO_CACHE  *Cache;
+
+  Cache = &Instance->Cache;
+  if (Cache->ReadyToBootEvent != NULL) {
+    gBS->CloseEvent (Cache->ReadyToBootEvent);
+  }
+
+  DiskIoCacheReport (Cache);
+
+  if (Cache->ReadBuffer != NULL) {
+    FreeAlignedPages (Cache->ReadBuffer, EFI_SIZE_TO_PAGES (Cache->ReadBlockNum * Cache->BlockSize));
+  }
+
+  if (Cache->Data != NULL) {
+    FreeAlignedPages (Cache->Data, EFI_SIZE_TO_PAGES (Cache->BlockNum * Cache->BlockSize));
+  }
+
+  if (Cache->Buckets != NULL) {
+    FreePool (Cache->Buckets);
+  }
+
+  if (Cache->Entries != NULL) {
+    FreePool (Cache->Entries);
+  }
+
+  ZeroMem (Cache, sizeof (DISK_IO_CACHE));
+}
+
+/**
+  Read from the block cache, filling it from the device on a miss.
+
+  A blocking read may read the missing blocks from the device. A non-blocking
+  read is only served when all of its blocks are in the cache.
+
+  @param Instance    Pointer to the DISK_IO_PRIVATE_DATA.
+  @param MediaId     ID of the medium to be read.
+  @param Offset      The starting byte offset on the device to read from.
+  @param BufferSize  The size in bytes of Buffer.
+  @param Buffer      A pointer to the destination buffer for the data.
+  @param Blocking    TRUE: Blocking request; FALSE: Non-blocking request.
+  @param Status      Return the status of the read when it is served.
+
+  @retval TRUE       The read is served and Status is returned.
+  @retval FALSE      The read is not served and must be sent to the device.
+**/
+BOOLEAN
+DiskIoCacheRead (
+  IN  DISK_IO_PRIVATE_DATA  *Instance,
+  IN  UINT32                MediaId,
+  IN  UINT64                Offset,
+  IN  UINTN                 BufferSize,
+  OUT UINT8                 *Buffer,
+  IN  BOOLEAN               Blocking,
+  OUT EFI_STATUS            *Status
+  )
+{
+  DISK_IO_CACHE        *Cache;
+  EFI_BLOCK_IO_MEDIA   *Media;
+  DISK_IO_CACHE_ENTRY  *Entry;
+  EFI_LBA              Lba;
+  EFI_LBA              LastLba;
+  UINT32               BlockSize;
+  UINT32               BlockOffset;
+  UINTN                Length;
+  UINTN                Count;
+  UINTN                Misses;
+  UINTN                Index;
+  UINT64               Generation;
+  BOOLEAN              Sequential;
+
+  Cache = &Instance->Cache;
+  Media = Instance->BlockIo->Media;
+  if ((Cache->Entries == NULL) || (BufferSize == 0) || (Offset > MAX_UINT64 - BufferSize) ||
+      !Media->MediaPresent || (MediaId != Media->MediaId) || (Media->BlockSize != Cache->BlockSize)
+      )
+  {
+    return FALSE;
+  }
+
+  BlockSize = Cache->BlockSize;
+  Lba       = DivU64x32Remainder (Offset, BlockSize, &BlockOffset);
+  LastLba   = DivU64x32 (Offset + BufferSize - 1, BlockSize);
+  if ((LastLba > Media->LastBlock) || (LastLba - Lba >= Cache->ReadBlockNum)) {
+    //
+    // Leave the invalid requests to the device, and let the large ones bypass
+    // the cache so that they do not evict the small blocks read again and again.
+    //
+    return FALSE;
+  }
+
+  EfiAcquireLock (&Cache->Lock);
+  DiskIoCacheCheckMedia (Instance);
+
+  if (!Blocking) {
+    for (Index = 0; Lba + Index <= LastLba; Index++) {
+      if (DiskIoCacheLookup (Cache, Lba + Index) == NULL) {
+        Cache->Misses += LastLba - Lba + 1;
+        EfiReleaseLock (&Cache->Lock);
+        return FALSE;
+      }
+    }
+  }
+
+  Sequential     = (BOOLEAN)(Lba == Cache->NextLba);
+  Cache->NextLba = LastLba + 1;
+
+  while (Lba <= LastLba) {
+    Entry = DiskIoCacheLookup (Cache, Lba);
+    if (Entry != NULL) {
+      Length = MIN (BlockSize - BlockOffset, BufferSize);
+      CopyMem (Buffer, Entry->Data + BlockOffset, Length);
+      RemoveEntryList (&Entry->Link);
+      InsertHeadList (&Cache->LruList, &Entry->Link);
+      Cache->Hits++;
+
+      Buffer     += Length;
+      BufferSize -= Length;
+      BlockOffset = 0;
+      Lba++;
+      continue;
+    }
+
+    //
+    // The read buffer is in use by the read this one interrupted.
+    //
+    if (Cache->ReadBufferBusy) {
+      EfiReleaseLock (&Cache->Lock);
+      return FALSE;
+    }
+
+    //
+    // Read the missing blocks up to the next cached one. When the read
+    // continues the previous one, also read the blocks following it.
+    //
+    for (Misses = 1; (Lba + Misses <= LastLba) && (DiskIoCacheLookup (Cache, Lba + Misses) == NULL); Misses++) {
+    }
+
+    Count = Misses;
+    if (Sequential && (Lba + Count > LastLba)) {
+      Count = (UINTN)MIN ((UINT64)Cache->ReadBlockNum, Media->LastBlock - Lba + 1);
+    }
+
+    Cache->Misses        += Misses;
+    Cache->ReadAheads    += Count - Misses;
+    Cache->ReadBufferBusy = TRUE;
+    Generation            = Cache->Generation;
+    EfiReleaseLock (&Cache->Lock);
+
+    *Status = Instance->BlockIo->ReadBlocks (
+                                   Instance->BlockIo,
+                                   MediaId,
+                                   Lba,
+                                   Count * BlockSize,
+                                   Cache->ReadBuffer
+                                   );
+
+    EfiAcquireLock (&Cache->Lock);
+    if (EFI_ERROR (*Status)) {
+      //
+      // Let the caller send the request to the device without the read-ahead
+      // blocks, so that it gets the status of the requested blocks only.
+      //
+      Cache->ReadBufferBusy = FALSE;
+      EfiReleaseLock (&Cache->Lock);
+      return FALSE;
+    }
+
+    //
+    // The blocks may have been written or the media changed during the read,
+    // in which case the data is returned but not cached.
+    //
+    DiskIoCacheCheckMedia (Instance);
+    if (Generation == Cache->Generation) {
+      for (Index = 0; Index < Count; Index++) {
+        DiskIoCacheInsert (Cache, Lba + Index, Cache->ReadBuffer + Index * BlockSize);
+      }
+    }
+
+    Length = MIN (Misses * BlockSize - BlockOffset, BufferSize);
+    CopyMem (Buffer, Cache->ReadBuffer + BlockOffset, Length);
+    Cache->ReadBufferBusy = FALSE;
+
+    Buffer     += Length;
+    BufferSize -= Length;
+    BlockOffset = 0;
+    Lba        += Misses;
+  }
+
+  EfiReleaseLock (&Cache->Lock);
+
+  ASSERT (BufferSize == 0);
+  *Status = EFI_SUCCESS;
+  return TRUE;
+}
+
+/**
+  Drop the cached blocks that overlap a range of the device.
+
+  @param Instance    Pointer to the DISK_IO_PRIVATE_DATA.
+  @param Offset      The starting byte offset of the range.
+  @param Length      The length in bytes of the range.
+**/
+VOID
+DiskIoCacheInvalidate (
+  IN DISK_IO_PRIVATE_DATA  *Instance,
+  IN UINT64                Offset,
+  IN UINTN                 Length
+  )
+{
+  DISK_IO_CACHE        *Cache;
+  DISK_IO_CACHE_ENTRY  *Entry;
+  LIST_ENTRY           *Link;
+  EFI_LBA              Lba;
+  EFI_LBA              LastLba;
+
+  Cache = &Instance->Cache;
+  if ((Cache->Entries == NULL) || (Length == 0) || (Offset > MAX_UINT64 - Length)) {
+    return;
+  }
+
+  Lba     = DivU64x32 (Offset, Cache->BlockSize);
+  LastLba = DivU64x32 (Offset + Length - 1, Cache->BlockSize);
+
+  EfiAcquireLock (&Cache->Lock);
+  DiskIoCacheCheckMedia (Instance);
+  Cache->Generation++;
+
+  if (LastLba - Lba >= Cache->BlockNum) {
+    for (Link = GetFirstNode (&Cache->LruList); !IsNull (&Cache->LruList, Link); ) {
+      Entry = BASE_CR (Link, DISK_IO_CACHE_ENTRY, Link);
+      Link  = GetNextNode (&Cache->LruList, Link);
+      if ((Entry->Lba >= Lba) && (Entry->Lba <= LastLba)) {
+        DiskIoCacheRemove (Cache, Entry);
+      }
+    }
+  } else {
+    for ( ; Lba <= LastLba; Lba++) {
+      Entry = DiskIoCacheLookup (Cache, Lba);
+      if (Entry != NULL) {
+        DiskIoCacheRemove (Cache, Entry);
+      }
+    }
+  }
+
+  EfiReleaseLock (&Cache->Lock);
+}
@@ -756,7 +756,8 @@ LocateExPcdBinary (
   // Check the first bytes (Header Signature Guid) and build version.
   //
   if (!CompareGuid ((VOID *)mDxePcdDbBinary, &gPcdDataBaseSignatureGuid) ||
-      (mDxePcdDbBinary->BuildVersion != PCD_SERVICE_DXE_VERSION))
+      (mDxePcdDbBinary->BuildVersion < PCD_SERVICE_DXE_MIN_VERSION) ||
+      (mDxePcdDbBinary->BuildVersion > PCD_SERVICE_DXE_VERSION))
   {
     ASSERT (FALSE);
   }
@@ -1569,69 +1570,145 @@ SetHiiVariable (
 }
 
 /**
-  Get Token Number according to dynamic-ex PCD's {token space guid:token number}
-
-  A dynamic-ex type PCD, developer must provide pair of token space guid: token number
-  in DEC file. PCD database maintain a mapping table that translate pair of {token
-  space guid: token number} to Token Number.
+  Hash a dynamic-ex PCD {token space guid:token number} pair for the ExMap hash
+  table of the PCD database. The build tool uses the same hash.
 
   @param Guid            Token space guid for dynamic-ex PCD entry.
   @param ExTokenNumber   Dynamic-ex PCD token number.
+  @param Seed            Seed of the hash.
 
-  @return Token Number for dynamic-ex PCD.
+  @return The 32-bit hash of the pair.
 
 **/
-UINTN
-GetExPcdTokenNumber (
+UINT32
+PcdExMapHash (
   IN CONST EFI_GUID  *Guid,
-  IN UINT32          ExTokenNumber
+  IN UINT32          ExTokenNumber,
+  IN UINT32          Seed
+  )
+{
+  UINT32  Words[5];
+  UINT32  Hash;
+  UINTN   Index;
+
+  CopyMem (Words, Guid, sizeof (EFI_GUID));
+  Words[4] = ExTokenNumber;
+
+  Hash = Seed;
+  for (Index = 0; Index < ARRAY_SIZE (Words); Index++) {
+    Hash  = (Hash ^ Words[Index]) * 0x9E3779B1;
+    Hash ^= Hash >> 16;
+  }
+
+  Hash ^= Hash >> 13;
+  Hash *= 0x85EBCA6B;
+  Hash ^= Hash >> 16;
+  return Hash;
+}
+
+/**
+  Find the ExMap table entry of a dynamic-ex PCD in a PCD database.
+
+  The ExMap hash table generated by the build tool is used if the database has
+  one, databases of older versions are scanned.
+
+  @param Database        PCD database.
+  @param Guid            Token space guid for dynamic-ex PCD entry.
+  @param ExTokenNumber   Dynamic-ex PCD token number.
+
+  @return The ExMap table entry, or NULL if the PCD is not in the database.
+
+**/
+DYNAMICEX_MAPPING *
+FindExMapEntry (
+  IN PCD_DATABASE_INIT  *Database,
+  IN CONST EFI_GUID     *Guid,
+  IN UINT32             ExTokenNumber
   )
 {
-  UINT32             Index;
   DYNAMICEX_MAPPING  *ExMap;
   EFI_GUID           *GuidTable;
   EFI_GUID           *MatchGuid;
+  EX_MAP_HASH_ENTRY  *HashTable;
   UINTN              MatchGuidIdx;
+  UINT32             Bucket;
+  UINT32             Index;
 
-  if (!mPeiDatabaseEmpty) {
-    ExMap     = (DYNAMICEX_MAPPING *)((UINT8 *)mPcdDatabase.PeiDb + mPcdDatabase.PeiDb->ExMapTableOffset);
-    GuidTable = (EFI_GUID *)((UINT8 *)mPcdDatabase.PeiDb + mPcdDatabase.PeiDb->GuidTableOffset);
-
-    MatchGuid = ScanGuid (GuidTable, mPeiGuidTableSize, Guid);
-
-    if (MatchGuid != NULL) {
-      MatchGuidIdx = MatchGuid - GuidTable;
+  ExMap     = (DYNAMICEX_MAPPING *)((UINT8 *)Database + Database->ExMapTableOffset);
+  GuidTable = (EFI_GUID *)((UINT8 *)Database + Database->GuidTableOffset);
 
-      for (Index = 0; Index < mPcdDatabase.PeiDb->ExTokenCount; Index++) {
-        if ((ExTokenNumber == ExMap[Index].ExTokenNumber) &&
-            (MatchGuidIdx == ExMap[Index].ExGuidIndex))
-        {
-          return ExMap[Index].TokenNumber;
-        }
-      }
+  if ((Database->BuildVersion >= PCD_DATABASE_EX_MAP_HASH_VERSION) &&
+      (Database->ExMapHashBucketCount != 0) &&
+      (Database->ExTokenCount != 0))
+  {
+    HashTable = (EX_MAP_HASH_ENTRY *)((UINT8 *)Database + Database->ExMapHashTableOffset);
+    Bucket    = PcdExMapHash (Guid, ExTokenNumber, 0) % Database->ExMapHashBucketCount;
+    Index     = PcdExMapHash (Guid, ExTokenNumber, HashTable[Bucket]) % Database->ExTokenCount;
+    ExMap    += HashTable[Database->ExMapHashBucketCount + Index];
+    if ((ExTokenNumber == ExMap->ExTokenNumber) &&
+        CompareGuid (&GuidTable[ExMap->ExGuidIndex], Guid))
+    {
+      return ExMap;
     }
-  }
 
-  ExMap     = (DYNAMICEX_MAPPING *)((UINT8 *)mPcdDatabase.DxeDb + mPcdDatabase.DxeDb->ExMapTableOffset);
-  GuidTable = (EFI_GUID *)((UINT8 *)mPcdDatabase.DxeDb + mPcdDatabase.DxeDb->GuidTableOffset);
+    return NULL;
+  }
 
-  MatchGuid = ScanGuid (GuidTable, mDxeGuidTableSize, Guid);
-  //
-  // We need to ASSERT here. If GUID can't be found in GuidTable, this is a
-  // error in the BUILD system.
-  //
-  ASSERT (MatchGuid != NULL);
+  MatchGuid = ScanGuid (GuidTable, Database->GuidTableCount * sizeof (EFI_GUID), Guid);
+  if (MatchGuid == NULL) {
+    return NULL;
+  }
 
   MatchGuidIdx = MatchGuid - GuidTable;
 
-  for (Index = 0; Index < mPcdDatabase.DxeDb->ExTokenCount; Index++) {
+  for (Index = 0; Index < Database->ExTokenCount; Index++) {
     if ((ExTokenNumber == ExMap[Index].ExTokenNumber) &&
         (MatchGuidIdx == ExMap[Index].ExGuidIndex))
     {
-      return ExMap[Index].TokenNumber;
+      return &ExMap[Index];
+    }
+  }
+
+  return NULL;
+}
+
+/**
+  Get Token Number according to dynamic-ex PCD's {token space guid:token number}
+
+  A dynamic-ex type PCD, developer must provide pair of token space guid: token number
+  in DEC file. PCD database maintain a mapping table that translate pair of {token
+  space guid: token number} to Token Number.
+
+  @param Guid            Token space guid for dynamic-ex PCD entry.
+  @param ExTokenNumber   Dynamic-ex PCD token number.
+
+  @return Token Number for dynamic-ex PCD.
+
+**/
+UINTN
+GetExPcdTokenNumber (
+  IN CONST EFI_GUID  *Guid,
+  IN UINT32          ExTokenNumber
+  )
+{
+  DYNAMICEX_MAPPING  *ExMap;
+
+  if (!mPeiDatabaseEmpty) {
+    ExMap = FindExMapEntry (mPcdDatabase.PeiDb, Guid, ExTokenNumber);
+    if (ExMap != NULL) {
+      return ExMap->TokenNumber;
     }
   }
 
+  ExMap = FindExMapEntry (mPcdDatabase.DxeDb, Guid, ExTokenNumber);
+  if (ExMap != NULL) {
+    return ExMap->TokenNumber;
+  }
+
+  //
+  // We need to ASSERT here. If the PCD can't be found in the ExMap table, this
+  // is an error in the BUILD system.
+  //
   DEBUG ((DEBUG_ERROR, "%a: Failed to find PCD with GUID: %g and token number: %d\n", __FUNCTION__, Guid, ExTokenNumber));
   ASSERT (FALSE);
 
@@ -31,7 +31,13 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 // Please make sure the PCD Serivce PEIM Version is consistent with
 // the version of the generated PEIM PCD Database by build tool.
 //
-#define PCD_SERVICE_PEIM_VERSION  7
+#define PCD_SERVICE_PEIM_VERSION  8
+
+//
+// The oldest PCD database version that is still accepted. Version 7 only
+// lacks the ExMap hash table, so its DynamicEx PCDs are found by a scan.
+//
+#define PCD_SERVICE_PEIM_MIN_VERSION  7
 
 //
 // PCD_PEI_SERVICE_DRIVER_VERSION is defined in Autogen.h.
@@ -969,6 +975,41 @@ typedef struct {
   UINT32    LocalTokenNumberAlias;
 } EX_PCD_ENTRY_ATTRIBUTE;
 
+/**
+  Hash a dynamic-ex PCD {token space guid:token number} pair for the ExMap hash
+  table of the PCD database. The build tool uses the same hash.
+
+  @param Guid            Token space guid for dynamic-ex PCD entry.
+  @param ExTokenNumber   Dynamic-ex PCD token number.
+  @param Seed            Seed of the hash.
+
+  @return The 32-bit hash of the pair.
+
+**/
+UINT32
+PcdExMapHash (
+  IN CONST EFI_GUID  *Guid,
+  IN UINT32          ExTokenNumber,
+  IN UINT32          Seed
+  );
+
+/**
+  Find the ExMap table entry of a dynamic-ex PCD in a PCD database.
+
+  @param Database        PCD database.
+  @param Guid            Token space guid for dynamic-ex PCD entry.
+  @param ExTokenNumber   Dynamic-ex PCD token number.
+
+  @return The ExMap table entry, or NULL if the PCD is not in the database.
+
+**/
+DYNAMICEX_MAPPING *
+FindExMapEntry (
+  IN PEI_PCD_DATABASE  *Database,
+  IN CONST EFI_GUID    *Guid,
+  IN UINT32            ExTokenNumber
+  );
+
 /**
   Get Token Number according to dynamic-ex PCD's {token space guid:token number}
 
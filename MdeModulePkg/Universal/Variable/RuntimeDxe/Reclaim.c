@@ -105,12 +105,41 @@ FtwVariableSpace (
   IN EFI_PHYSICAL_ADDRESS   VariableBase,
   IN VARIABLE_STORE_HEADER  *VariableBuffer
   )
+{
+  UINTN  FtwBufferSize;
+
+  FtwBufferSize = ((VARIABLE_STORE_HEADER *)((UINTN)VariableBase))->Size;
+  ASSERT (FtwBufferSize == VariableBuffer->Size);
+
+  return FtwVariableRegion (VariableBase, FtwBufferSize, VariableBuffer);
+}
+
+/**
+  Writes a buffer to a range of the variable storage space.
+
+  Fault Tolerant Write protocol is used for writing, so an interrupted write
+  leaves either the old or the new content in the whole range.
+
+  @param  Address        Address of the range to write.
+  @param  Length         Length of the range in bytes.
+  @param  Buffer         Point to the data to write.
+
+  @retval EFI_SUCCESS    The function completed successfully.
+  @retval EFI_NOT_FOUND  Fail to locate Fault Tolerant Write protocol.
+  @retval EFI_ABORTED    The function could not complete successfully.
+
+**/
+EFI_STATUS
+FtwVariableRegion (
+  IN EFI_PHYSICAL_ADDRESS  Address,
+  IN UINTN                 Length,
+  IN VOID                  *Buffer
+  )
 {
   EFI_STATUS                         Status;
   EFI_HANDLE                         FvbHandle;
   EFI_LBA                            VarLba;
   UINTN                              VarOffset;
-  UINTN                              FtwBufferSize;
   EFI_FAULT_TOLERANT_WRITE_PROTOCOL  *FtwProtocol;
 
   //
@@ -124,7 +153,7 @@ FtwVariableSpace (
   //
   // Locate Fvb handle by address.
   //
-  Status = GetFvbInfoByAddress (VariableBase, &FvbHandle, NULL);
+  Status = GetFvbInfoByAddress (Address, &FvbHandle, NULL);
   if (EFI_ERROR (Status)) {
     return Status;
   }
@@ -132,25 +161,22 @@ FtwVariableSpace (
   //
   // Get LBA and Offset by address.
   //
-  Status = GetLbaAndOffsetByAddress (VariableBase, &VarLba, &VarOffset);
+  Status = GetLbaAndOffsetByAddress (Address, &VarLba, &VarOffset);
   if (EFI_ERROR (Status)) {
     return EFI_ABORTED;
   }
 
-  FtwBufferSize = ((VARIABLE_STORE_HEADER *)((UINTN)VariableBase))->Size;
-  ASSERT (FtwBufferSize == VariableBuffer->Size);
-
   //
   // FTW write record.
   //
   Status = FtwProtocol->Write (
                           FtwProtocol,
-                          VarLba,                // LBA
-                          VarOffset,             // Offset
-                          FtwBufferSize,         // NumBytes
-                          NULL,                  // PrivateData NULL
-                          FvbHandle,             // Fvb Handle
-                          (VOID *)VariableBuffer // write buffer
+                          VarLba,    // LBA
+                          VarOffset, // Offset
+                          Length,    // NumBytes
+                          NULL,      // PrivateData NULL
+                          FvbHandle, // Fvb Handle
+                          Buffer     // write buffer
                           );
 
   return Status;
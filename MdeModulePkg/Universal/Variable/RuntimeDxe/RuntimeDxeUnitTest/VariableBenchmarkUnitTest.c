@@ -0,0 +1,1080 @@
+/** @file
+  This is a host-based benchmark of the variable services of the variable
+  driver.
+
+  VariableServiceSetVariable(), VariableServiceGetVariable() and
+  VariableServiceGetNextVariableName() run against a non-volatile variable
+  store in an emulated firmware volume block, with the Fault Tolerant Write
+  protocol that reclaim uses emulated on top of it. Every benchmark reports the
+  operations per second, the worst case latency of an operation and the number
+  of reclaims, and fails if an operation fails or the store needs more reclaims
+  than expected, so it can be used as a regression gate.
+
+  The benchmark runs the scenarios in mBenchmarkConfig. A throughput gate can
+  be given on the command line:
+
+    VariableBenchmarkUnitTest [MinOpsPerSecond]
+
+  which fails any benchmark that runs fewer operations per second than given.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <time.h>
+#include <cmocka.h>
+
+#include <Library/UnitTestLib.h>
+
+#include "../Variable.h"
+#include "../VariableParsing.h"
+
+#define UNIT_TEST_NAME     "Variable Service Benchmark"
+#define UNIT_TEST_VERSION  "1.0"
+
+/// === TEST DATA ==================================================================================
+
+//
+// Test GUID {0E3A4F52-6C8D-4B1E-A7D2-39F1C05B8E64}
+//
+EFI_GUID  mBenchmarkGuid = {
+  0x0e3a4f52, 0x6c8d, 0x4b1e, { 0xa7, 0xd2, 0x39, 0xf1, 0xc0, 0x5b, 0x8e, 0x64 }
+};
+
+#define BENCHMARK_BLOCK_SIZE           SIZE_4KB
+#define BENCHMARK_MAX_NAME_LENGTH      64
+#define BENCHMARK_MAX_DATA_SIZE        SIZE_1KB
+#define BENCHMARK_READ_PASSES          8
+#define BENCHMARK_FV_HEADER_LENGTH     (sizeof (EFI_FIRMWARE_VOLUME_HEADER) + sizeof (EFI_FV_BLOCK_MAP_ENTRY))
+#define BENCHMARK_VARIABLE_ATTRIBUTES  VARIABLE_ATTRIBUTE_NV_BS_RT
+
+typedef struct {
+  CHAR8      *Name;
+  //
+  // Size of the whole variable region of the emulated flash in bytes
+  //
+  UINT32     StoreSize;
+  UINTN      VariableCount;
+  //
+  // Length of the variable names in characters, without the terminator
+  //
+  UINTN      NameLength;
+  UINTN      DataSize;
+  //
+  // Percentage of the variables that are deleted in the store when the
+  // benchmark starts
+  //
+  UINTN      Fragmentation;
+  BOOLEAN    AuthFormat;
+  //
+  // Most reclaims that the benchmark may need
+  //
+  UINTN      MaxReclaimCount;
+} VARIABLE_BENCHMARK_CONFIG;
+
+typedef struct {
+  UINTN     Count;
+  UINT64    TotalTime;
+  UINT64    MaxTime;
+  UINTN     ReclaimCount;
+} VARIABLE_BENCHMARK_RESULT;
+
+VARIABLE_BENCHMARK_CONFIG  mBenchmarkConfig[] = {
+  { "Small",      SIZE_64KB,  64,   8,  32,  0,  FALSE, 0 },
+  { "Fragmented", SIZE_16KB,  96,   8,  32,  50, FALSE, 1 },
+  { "Auth",       SIZE_16KB,  96,   8,  32,  50, TRUE,  2 },
+  { "LongNames",  SIZE_64KB,  128,  48, 64,  25, FALSE, 0 },
+  { "Large",      SIZE_256KB, 1024, 12, 128, 75, TRUE,  9 },
+};
+
+UINTN  mMinOpsPerSecond = 0;
+
+//
+// The emulated flash that holds the non-volatile variable store
+//
+UINT8    *mFlash    = NULL;
+UINTN    mFlashSize = 0;
+UINTN    mFtwWrites = 0;
+
+/// === EMULATED FIRMWARE ==========================================================================
+
+/**
+  Return a monotonic time stamp.
+
+  @return The time in nanoseconds.
+**/
+STATIC
+UINT64
+GetTimeInNanoSecond (
+  VOID
+  )
+{
+  struct timespec  Time;
+
+  timespec_get (&Time, TIME_UTC);
+  return (UINT64)Time.tv_sec * 1000000000 + (UINT64)Time.tv_nsec;
+}
+
+/**
+  Return the attributes of the emulated flash, which is always writable.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+BenchmarkFvbGetAttributes (
+  IN CONST  EFI_FIRMWARE_VOLUME_BLOCK2_PROTOCOL  *This,
+  OUT       EFI_FVB_ATTRIBUTES_2                 *Attributes
+  )
+{
+  *Attributes = EFI_FVB2_READ_STATUS | EFI_FVB2_WRITE_STATUS | EFI_FVB2_ERASE_POLARITY;
+  return EFI_SUCCESS;
+}
+
+/**
+  The attributes of the emulated flash cannot be changed.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+BenchmarkFvbSetAttributes (
+  IN CONST  EFI_FIRMWARE_VOLUME_BLOCK2_PROTOCOL  *This,
+  IN OUT    EFI_FVB_ATTRIBUTES_2                 *Attributes
+  )
+{
+  return EFI_UNSUPPORTED;
+}
+
+/**
+  Return the base address of the emulated flash.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+BenchmarkFvbGetPhysicalAddress (
+  IN CONST  EFI_FIRMWARE_VOLUME_BLOCK2_PROTOCOL  *This,
+  OUT       EFI_PHYSICAL_ADDRESS                 *Address
+  )
+{
+  *Address = (EFI_PHYSICAL_ADDRESS)(UINTN)mFlash;
+  return EFI_SUCCESS;
+}
+
+/**
+  Return the block size of the emulated flash and the number of blocks from Lba
+  to its end.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+BenchmarkFvbGetBlockSize (
+  IN CONST  EFI_FIRMWARE_VOLUME_BLOCK2_PROTOCOL  *This,
+  IN        EFI_LBA                              Lba,
+  OUT       UINTN                                *BlockSize,
+  OUT       UINTN                                *NumberOfBlocks
+  )
+{
+  if (Lba >= mFlashSize / BENCHMARK_BLOCK_SIZE) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  *BlockSize      = BENCHMARK_BLOCK_SIZE;
+  *NumberOfBlocks = mFlashSize / BENCHMARK_BLOCK_SIZE - (UINTN)Lba;
+  return EFI_SUCCESS;
+}
+
+/**
+  Read from the emulated flash.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+BenchmarkFvbRead (
+  IN CONST  EFI_FIRMWARE_VOLUME_BLOCK2_PROTOCOL  *This,
+  IN        EFI_LBA                              Lba,
+  IN        UINTN                                Offset,
+  IN OUT    UINTN                                *NumBytes,
+  IN OUT    UINT8                                *Buffer
+  )
+{
+  UINTN  Address;
+
+  Address = (UINTN)Lba * BENCHMARK_BLOCK_SIZE + Offset;
+  if ((Address > mFlashSize) || (*NumBytes > mFlashSize - Address)) {
+    return EFI_BAD_BUFFER_SIZE;
+  }
+
+  CopyMem (Buffer, mFlash + Address, *NumBytes);
+  return EFI_SUCCESS;
+}
+
+/**
+  Write to the emulated flash. The flash is byte writable, so no erase is needed
+  before a write.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+BenchmarkFvbWrite (
+  IN CONST  EFI_FIRMWARE_VOLUME_BLOCK2_PROTOCOL  *This,
+  IN        EFI_LBA                              Lba,
+  IN        UINTN                                Offset,
+  IN OUT    UINTN                                *NumBytes,
+  IN        UINT8                                *Buffer
+  )
+{
+  UINTN  Address;
+
+  Address = (UINTN)Lba * BENCHMARK_BLOCK_SIZE + Offset;
+  if ((Address > mFlashSize) || (*NumBytes > mFlashSize - Address)) {
+    return EFI_BAD_BUFFER_SIZE;
+  }
+
+  CopyMem (mFlash + Address, Buffer, *NumBytes);
+  return EFI_SUCCESS;
+}
+
+/**
+  The variable driver never erases the flash directly.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+BenchmarkFvbEraseBlocks (
+  IN CONST  EFI_FIRMWARE_VOLUME_BLOCK2_PROTOCOL  *This,
+  ...
+  )
+{
+  return EFI_UNSUPPORTED;
+}
+
+EFI_FIRMWARE_VOLUME_BLOCK2_PROTOCOL  mBenchmarkFvb = {
+  BenchmarkFvbGetAttributes,
+  BenchmarkFvbSetAttributes,
+  BenchmarkFvbGetPhysicalAddress,
+  BenchmarkFvbGetBlockSize,
+  BenchmarkFvbRead,
+  BenchmarkFvbWrite,
+  BenchmarkFvbEraseBlocks,
+  NULL
+};
+
+/**
+  Return the largest fault tolerant write, which covers the whole emulated
+  flash.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+BenchmarkFtwGetMaxBlockSize (
+  IN EFI_FAULT_TOLERANT_WRITE_PROTOCOL  *This,
+  OUT UINTN                             *BlockSize
+  )
+{
+  *BlockSize = mFlashSize;
+  return EFI_SUCCESS;
+}
+
+/**
+  Emulate a fault tolerant write to the emulated flash.
+
+  The variable driver writes through FTW only when it reclaims the store, so
+  every write is counted as a reclaim.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+BenchmarkFtwWrite (
+  IN EFI_FAULT_TOLERANT_WRITE_PROTOCOL  *This,
+  IN EFI_LBA                            Lba,
+  IN UINTN                              Offset,
+  IN UINTN                              Length,
+  IN VOID                               *PrivateData,
+  IN EFI_HANDLE                         FvBlockHandle,
+  IN VOID                               *Buffer
+  )
+{
+  mFtwWrites++;
+  return BenchmarkFvbWrite (&mBenchmarkFvb, Lba, Offset, &Length, Buffer);
+}
+
+EFI_FAULT_TOLERANT_WRITE_PROTOCOL  mBenchmarkFtw = {
+  BenchmarkFtwGetMaxBlockSize,
+  NULL,
+  BenchmarkFtwWrite,
+  NULL,
+  NULL,
+  NULL
+};
+
+/// === VARIABLE DRIVER ENVIRONMENT ================================================================
+
+//
+// The variable driver always runs at boot time here, without locking, Fault
+// Tolerant Write data HOBs, measurement, MOR lock or variable check handlers.
+//
+
+BOOLEAN
+AtRuntime (
+  VOID
+  )
+{
+  return FALSE;
+}
+
+EFI_LOCK *
+InitializeLock (
+  IN OUT EFI_LOCK  *Lock,
+  IN EFI_TPL       Priority
+  )
+{
+  return Lock;
+}
+
+VOID
+AcquireLockOnlyAtBootTime (
+  IN EFI_LOCK  *Lock
+  )
+{
+}
+
+VOID
+ReleaseLockOnlyAtBootTime (
+  IN EFI_LOCK  *Lock
+  )
+{
+}
+
+EFI_STATUS
+GetFtwProtocol (
+  OUT VOID  **FtwProtocol
+  )
+{
+  *FtwProtocol = &mBenchmarkFtw;
+  return EFI_SUCCESS;
+}
+
+EFI_STATUS
+GetFvbByHandle (
+  IN  EFI_HANDLE                          FvBlockHandle,
+  OUT EFI_FIRMWARE_VOLUME_BLOCK_PROTOCOL  **FvBlock
+  )
+{
+  *FvBlock = &mBenchmarkFvb;
+  return EFI_SUCCESS;
+}
+
+EFI_STATUS
+GetFvbCountAndBuffer (
+  OUT UINTN       *NumberHandles,
+  OUT EFI_HANDLE  **Buffer
+  )
+{
+  *Buffer = AllocatePool (sizeof (EFI_HANDLE));
+  if (*Buffer == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  (*Buffer)[0]   = (EFI_HANDLE)&mBenchmarkFvb;
+  *NumberHandles = 1;
+  return EFI_SUCCESS;
+}
+
+EFI_STATUS
+EFIAPI
+GetVariableFlashNvStorageInfo (
+  OUT EFI_PHYSICAL_ADDRESS  *BaseAddress,
+  OUT UINT64                *Length
+  )
+{
+  *BaseAddress = (EFI_PHYSICAL_ADDRESS)(UINTN)mFlash;
+  *Length      = mFlashSize;
+  return EFI_SUCCESS;
+}
+
+VOID *
+EFIAPI
+GetFirstGuidHob (
+  IN CONST EFI_GUID  *Guid
+  )
+{
+  return NULL;
+}
+
+VOID *
+EFIAPI
+GetNextGuidHob (
+  IN CONST EFI_GUID  *Guid,
+  IN CONST VOID      *HobStart
+  )
+{
+  return NULL;
+}
+
+VOID
+EFIAPI
+SecureBootHook (
+  IN CHAR16    *VariableName,
+  IN EFI_GUID  *VendorGuid
+  )
+{
+}
+
+EFI_STATUS
+MorLockInit (
+  VOID
+  )
+{
+  return EFI_SUCCESS;
+}
+
+EFI_STATUS
+SetVariableCheckHandlerMor (
+  IN CHAR16    *VariableName,
+  IN EFI_GUID  *VendorGuid,
+  IN UINT32    Attributes,
+  IN UINTN     DataSize,
+  IN VOID      *Data
+  )
+{
+  return EFI_SUCCESS;
+}
+
+VOID
+VariableSpeculationBarrier (
+  VOID
+  )
+{
+}
+
+EFI_STATUS
+EFIAPI
+AuthVariableLibInitialize (
+  IN  AUTH_VAR_LIB_CONTEXT_IN   *AuthVarLibContextIn,
+  OUT AUTH_VAR_LIB_CONTEXT_OUT  *AuthVarLibContextOut
+  )
+{
+  return EFI_UNSUPPORTED;
+}
+
+EFI_STATUS
+EFIAPI
+AuthVariableLibProcessVariable (
+  IN CHAR16    *VariableName,
+  IN EFI_GUID  *VendorGuid,
+  IN VOID      *Data,
+  IN UINTN     DataSize,
+  IN UINT32    Attributes
+  )
+{
+  return EFI_UNSUPPORTED;
+}
+
+EFI_STATUS
+EFIAPI
+VarCheckLibVariablePropertySet (
+  IN CHAR16                       *Name,
+  IN EFI_GUID                     *Guid,
+  IN VAR_CHECK_VARIABLE_PROPERTY  *VariableProperty
+  )
+{
+  return EFI_SUCCESS;
+}
+
+EFI_STATUS
+EFIAPI
+VarCheckLibVariablePropertyGet (
+  IN CHAR16                        *Name,
+  IN EFI_GUID                      *Guid,
+  OUT VAR_CHECK_VARIABLE_PROPERTY  *VariableProperty
+  )
+{
+  return EFI_NOT_FOUND;
+}
+
+EFI_STATUS
+EFIAPI
+VarCheckLibSetVariableCheck (
+  IN CHAR16                    *VariableName,
+  IN EFI_GUID                  *VendorGuid,
+  IN UINT32                    Attributes,
+  IN UINTN                     DataSize,
+  IN VOID                      *Data,
+  IN VAR_CHECK_REQUEST_SOURCE  RequestSource
+  )
+{
+  return EFI_SUCCESS;
+}
+
+/// === HELPER FUNCTIONS ===========================================================================
+
+/**
+  Format the emulated flash with an empty variable store.
+
+  @param[in] Config  The benchmark scenario.
+
+  @retval EFI_SUCCESS           The flash was formatted.
+  @retval EFI_OUT_OF_RESOURCES  The flash could not be allocated.
+**/
+STATIC
+EFI_STATUS
+FormatFlash (
+  IN VARIABLE_BENCHMARK_CONFIG  *Config
+  )
+{
+  EFI_FIRMWARE_VOLUME_HEADER  *FvHeader;
+  VARIABLE_STORE_HEADER       *VariableStore;
+
+  mFlashSize = ALIGN_VALUE (Config->StoreSize, BENCHMARK_BLOCK_SIZE);
+  mFlash     = AllocatePool (mFlashSize);
+  if (mFlash == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  SetMem (mFlash, mFlashSize, 0xff);
+
+  FvHeader = (EFI_FIRMWARE_VOLUME_HEADER *)mFlash;
+  ZeroMem (FvHeader, BENCHMARK_FV_HEADER_LENGTH);
+  CopyGuid (&FvHeader->FileSystemGuid, &gEfiSystemNvDataFvGuid);
+  FvHeader->FvLength              = mFlashSize;
+  FvHeader->Signature             = EFI_FVH_SIGNATURE;
+  FvHeader->Attributes            = EFI_FVB2_READ_STATUS | EFI_FVB2_WRITE_STATUS | EFI_FVB2_ERASE_POLARITY;
+  FvHeader->HeaderLength          = (UINT16)BENCHMARK_FV_HEADER_LENGTH;
+  FvHeader->Revision              = EFI_FVH_REVISION;
+  FvHeader->BlockMap[0].NumBlocks = (UINT32)(mFlashSize / BENCHMARK_BLOCK_SIZE);
+  FvHeader->BlockMap[0].Length    = BENCHMARK_BLOCK_SIZE;
+
+  VariableStore = (VARIABLE_STORE_HEADER *)(mFlash + BENCHMARK_FV_HEADER_LENGTH);
+  CopyGuid (&VariableStore->Signature, Config->AuthFormat ? &gEfiAuthenticatedVariableGuid : &gEfiVariableGuid);
+  VariableStore->Size      = (UINT32)(mFlashSize - BENCHMARK_FV_HEADER_LENGTH);
+  VariableStore->Format    = VARIABLE_STORE_FORMATTED;
+  VariableStore->State     = VARIABLE_STORE_HEALTHY;
+  VariableStore->Reserved  = 0;
+  VariableStore->Reserved1 = 0;
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Initialize the variable driver on the emulated flash, the way the DXE variable
+  driver does once the Fault Tolerant Write protocol is installed.
+
+  @param[in] Config  The benchmark scenario.
+
+  @retval EFI_SUCCESS  The variable services are ready.
+  @retval others       The variable driver failed to initialize.
+**/
+STATIC
+EFI_STATUS
+StartVariableDriver (
+  IN VARIABLE_BENCHMARK_CONFIG  *Config
+  )
+{
+  EFI_STATUS                          Status;
+  EFI_FIRMWARE_VOLUME_BLOCK_PROTOCOL  *Fvb;
+
+  Status = FormatFlash (Config);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  mEndOfDxe = FALSE;
+  Status    = VariableCommonInitialize ();
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  mVariableModuleGlobal->VariableGlobal.NonVolatileVariableBase = (EFI_PHYSICAL_ADDRESS)(UINTN)mFlash + mNvFvHeaderCache->HeaderLength;
+
+  Status = GetFvbInfoByAddress ((EFI_PHYSICAL_ADDRESS)(UINTN)mFlash, NULL, &Fvb);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  mVariableModuleGlobal->FvbInstance = Fvb;
+
+  return VariableWriteServiceInitialize ();
+}
+
+/**
+  Release everything that StartVariableDriver() allocated.
+**/
+STATIC
+VOID
+StopVariableDriver (
+  VOID
+  )
+{
+  VARIABLE_STORE_HEADER  *VolatileStore;
+
+  if (mVariableModuleGlobal != NULL) {
+    VolatileStore = (VARIABLE_STORE_HEADER *)(UINTN)mVariableModuleGlobal->VariableGlobal.VolatileVariableBase;
+    if (VolatileStore != NULL) {
+      VariableIndexUnregisterStore (VolatileStore);
+      FreePool (VolatileStore);
+    }
+
+    FreePool (mVariableModuleGlobal);
+    mVariableModuleGlobal = NULL;
+  }
+
+  if (mNvVariableCache != NULL) {
+    VariableIndexUnregisterStore (mNvVariableCache);
+    mNvVariableCache = NULL;
+  }
+
+  if (mNvFvHeaderCache != NULL) {
+    FreePool (mNvFvHeaderCache);
+    mNvFvHeaderCache = NULL;
+  }
+
+  if (mFlash != NULL) {
+    FreePool (mFlash);
+    mFlash = NULL;
+  }
+}
+
+/**
+  Build the name of a benchmark variable, "V" followed by the zero padded
+  decimal index.
+
+  @param[in]  Index       Index of the benchmark variable.
+  @param[in]  NameLength  Length of the name in characters.
+  @param[out] Name        Buffer of NameLength + 1 characters for the name.
+**/
+STATIC
+VOID
+GetBenchmarkVariableName (
+  IN  UINTN   Index,
+  IN  UINTN   NameLength,
+  OUT CHAR16  *Name
+  )
+{
+  UINTN  Position;
+
+  Name[0] = L'V';
+  for (Position = NameLength - 1; Position > 0; Position--) {
+    Name[Position] = (CHAR16)(L'0' + Index % 10);
+    Index         /= 10;
+  }
+
+  Name[NameLength] = L'\0';
+}
+
+/**
+  Fill the data of a benchmark variable with a pattern that depends on the
+  variable and on how often it was written.
+
+  @param[in]  Index       Index of the benchmark variable.
+  @param[in]  Generation  Number of earlier writes of the variable.
+  @param[in]  DataSize    Size of Data in bytes.
+  @param[out] Data        The variable data.
+**/
+STATIC
+VOID
+GetBenchmarkVariableData (
+  IN  UINTN  Index,
+  IN  UINTN  Generation,
+  IN  UINTN  DataSize,
+  OUT UINT8  *Data
+  )
+{
+  UINTN  Offset;
+
+  for (Offset = 0; Offset < DataSize; Offset++) {
+    Data[Offset] = (UINT8)(Index * 7 + Generation * 13 + Offset);
+  }
+}
+
+/**
+  Account one operation of a benchmark.
+
+  @param[in, out] Result  The benchmark result.
+  @param[in]      Start   Time stamp taken before the operation.
+**/
+STATIC
+VOID
+RecordOperation (
+  IN OUT VARIABLE_BENCHMARK_RESULT  *Result,
+  IN     UINT64                     Start
+  )
+{
+  UINT64  Time;
+
+  Time               = GetTimeInNanoSecond () - Start;
+  Result->TotalTime += Time;
+  Result->MaxTime    = MAX (Result->MaxTime, Time);
+  Result->Count++;
+}
+
+/**
+  Print the result of a benchmark and check it against the throughput gate.
+
+  @param[in] Operation  Name of the benchmarked operation.
+  @param[in] Result     The benchmark result.
+
+  @retval TRUE   The benchmark met the throughput gate.
+  @retval FALSE  The benchmark ran fewer operations per second than required.
+**/
+STATIC
+BOOLEAN
+ReportResult (
+  IN CHAR8                      *Operation,
+  IN VARIABLE_BENCHMARK_RESULT  *Result
+  )
+{
+  UINT64  OpsPerSecond;
+
+  OpsPerSecond = 0;
+  if (Result->TotalTime != 0) {
+    OpsPerSecond = DivU64x64Remainder (MultU64x32 (Result->Count, 1000000000), Result->TotalTime, NULL);
+  }
+
+  DEBUG ((
+    DEBUG_INFO,
+    "  %-20a %8Lu ops %10Lu ops/s  max %8Lu ns  %4Lu reclaims\n",
+    Operation,
+    (UINT64)Result->Count,
+    OpsPerSecond,
+    Result->MaxTime,
+    (UINT64)Result->ReclaimCount
+    ));
+
+  return (BOOLEAN)(OpsPerSecond >= mMinOpsPerSecond);
+}
+
+/// === TEST CASES =================================================================================
+
+/**
+  Start the variable driver on an empty emulated flash.
+
+  @param[in] Context  The benchmark scenario.
+
+  @retval UNIT_TEST_PASSED                 The variable services are ready.
+  @retval UNIT_TEST_ERROR_PREREQUISITE_NOT_MET  The variable driver did not start.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+BenchmarkSetup (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  VARIABLE_BENCHMARK_CONFIG  *Config;
+
+  Config = (VARIABLE_BENCHMARK_CONFIG *)Context;
+  if ((Config->NameLength < 2) || (Config->NameLength > BENCHMARK_MAX_NAME_LENGTH) ||
+      (Config->DataSize == 0) || (Config->DataSize > BENCHMARK_MAX_DATA_SIZE) ||
+      (Config->Fragmentation > 100))
+  {
+    return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+  }
+
+  mFtwWrites = 0;
+  if (EFI_ERROR (StartVariableDriver (Config))) {
+    StopVariableDriver ();
+    return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Stop the variable driver.
+
+  @param[in] Context  The benchmark scenario.
+**/
+VOID
+EFIAPI
+BenchmarkCleanup (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  StopVariableDriver ();
+}
+
+/**
+  Create, fragment, read, enumerate, update and delete the variables of a
+  benchmark scenario, and report the throughput and the reclaims.
+
+  @param[in] Context  The benchmark scenario.
+
+  @retval UNIT_TEST_PASSED               Every operation succeeded within the gates.
+  @retval UNIT_TEST_ERROR_TEST_FAILED    An operation failed or a gate was missed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+VariableServiceBenchmark (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  VARIABLE_BENCHMARK_CONFIG  *Config;
+  VARIABLE_BENCHMARK_RESULT  Create;
+  VARIABLE_BENCHMARK_RESULT  Get;
+  VARIABLE_BENCHMARK_RESULT  GetNext;
+  VARIABLE_BENCHMARK_RESULT  Update;
+  VARIABLE_BENCHMARK_RESULT  Delete;
+  EFI_STATUS                 Status;
+  CHAR16                     Name[BENCHMARK_MAX_NAME_LENGTH + 1];
+  UINT8                      Data[BENCHMARK_MAX_DATA_SIZE];
+  UINT8                      ReadData[BENCHMARK_MAX_DATA_SIZE];
+  UINT8                      *Generation;
+  UINTN                      Index;
+  UINTN                      Pass;
+  UINTN                      DataSize;
+  UINTN                      NameSize;
+  UINTN                      Found;
+  UINT32                     Attributes;
+  EFI_GUID                   Guid;
+  UINTN                      Reclaims;
+  UINT64                     Start;
+  BOOLEAN                    GateMet;
+
+  Config = (VARIABLE_BENCHMARK_CONFIG *)Context;
+  ZeroMem (&Create, sizeof (Create));
+  ZeroMem (&Get, sizeof (Get));
+  ZeroMem (&GetNext, sizeof (GetNext));
+  ZeroMem (&Update, sizeof (Update));
+  ZeroMem (&Delete, sizeof (Delete));
+
+  Generation = AllocateZeroPool (Config->VariableCount);
+  UT_ASSERT_NOT_NULL (Generation);
+
+  DEBUG ((
+    DEBUG_INFO,
+    "%a: store 0x%x, %Lu variables, name %Lu chars, data %Lu bytes, %Lu%% fragmented, %a\n",
+    Config->Name,
+    Config->StoreSize,
+    (UINT64)Config->VariableCount,
+    (UINT64)Config->NameLength,
+    (UINT64)Config->DataSize,
+    (UINT64)Config->Fragmentation,
+    Config->AuthFormat ? "auth" : "plain"
+    ));
+
+  //
+  // Create the variables.
+  //
+  Reclaims = mFtwWrites;
+  for (Index = 0; Index < Config->VariableCount; Index++) {
+    GetBenchmarkVariableName (Index, Config->NameLength, Name);
+    GetBenchmarkVariableData (Index, Generation[Index], Config->DataSize, Data);
+    Start  = GetTimeInNanoSecond ();
+    Status = VariableServiceSetVariable (Name, &mBenchmarkGuid, BENCHMARK_VARIABLE_ATTRIBUTES, Config->DataSize, Data);
+    RecordOperation (&Create, Start);
+    UT_ASSERT_NOT_EFI_ERROR (Status);
+  }
+
+  Create.ReclaimCount = mFtwWrites - Reclaims;
+
+  //
+  // Leave the requested share of deleted variables in the store.
+  //
+  for (Index = 0; Index < Config->VariableCount * Config->Fragmentation / 100; Index++) {
+    GetBenchmarkVariableName (Index, Config->NameLength, Name);
+    Generation[Index]++;
+    GetBenchmarkVariableData (Index, Generation[Index], Config->DataSize, Data);
+    Status = VariableServiceSetVariable (Name, &mBenchmarkGuid, BENCHMARK_VARIABLE_ATTRIBUTES, Config->DataSize, Data);
+    UT_ASSERT_NOT_EFI_ERROR (Status);
+  }
+
+  //
+  // Read every variable back.
+  //
+  for (Pass = 0; Pass < BENCHMARK_READ_PASSES; Pass++) {
+    for (Index = 0; Index < Config->VariableCount; Index++) {
+      GetBenchmarkVariableName (Index, Config->NameLength, Name);
+      DataSize = sizeof (ReadData);
+      Start    = GetTimeInNanoSecond ();
+      Status   = VariableServiceGetVariable (Name, &mBenchmarkGuid, &Attributes, &DataSize, ReadData);
+      RecordOperation (&Get, Start);
+      UT_ASSERT_NOT_EFI_ERROR (Status);
+      UT_ASSERT_EQUAL (DataSize, Config->DataSize);
+
+      GetBenchmarkVariableData (Index, Generation[Index], Config->DataSize, Data);
+      UT_ASSERT_MEM_EQUAL (ReadData, Data, DataSize);
+    }
+  }
+
+  //
+  // Enumerate the variables.
+  //
+  Found   = 0;
+  Name[0] = L'\0';
+  ZeroMem (&Guid, sizeof (Guid));
+  while (TRUE) {
+    NameSize = sizeof (Name);
+    Start    = GetTimeInNanoSecond ();
+    Status   = VariableServiceGetNextVariableName (&NameSize, Name, &Guid);
+    RecordOperation (&GetNext, Start);
+    if (Status == EFI_NOT_FOUND) {
+      break;
+    }
+
+    UT_ASSERT_NOT_EFI_ERROR (Status);
+    if (CompareGuid (&Guid, &mBenchmarkGuid)) {
+      Found++;
+    }
+  }
+
+  UT_ASSERT_EQUAL (Found, Config->VariableCount);
+
+  //
+  // Update every variable, which reclaims the store whenever it is full.
+  //
+  Reclaims = mFtwWrites;
+  for (Index = 0; Index < Config->VariableCount; Index++) {
+    GetBenchmarkVariableName (Index, Config->NameLength, Name);
+    Generation[Index]++;
+    GetBenchmarkVariableData (Index, Generation[Index], Config->DataSize, Data);
+    Start  = GetTimeInNanoSecond ();
+    Status = VariableServiceSetVariable (Name, &mBenchmarkGuid, BENCHMARK_VARIABLE_ATTRIBUTES, Config->DataSize, Data);
+    RecordOperation (&Update, Start);
+    UT_ASSERT_NOT_EFI_ERROR (Status);
+  }
+
+  Update.ReclaimCount = mFtwWrites - Reclaims;
+
+  //
+  // Delete every variable.
+  //
+  Reclaims = mFtwWrites;
+  for (Index = 0; Index < Config->VariableCount; Index++) {
+    GetBenchmarkVariableName (Index, Config->NameLength, Name);
+    Start  = GetTimeInNanoSecond ();
+    Status = VariableServiceSetVariable (Name, &mBenchmarkGuid, BENCHMARK_VARIABLE_ATTRIBUTES, 0, NULL);
+    RecordOperation (&Delete, Start);
+    UT_ASSERT_NOT_EFI_ERROR (Status);
+  }
+
+  Delete.ReclaimCount = mFtwWrites - Reclaims;
+
+  FreePool (Generation);
+
+  GateMet = ReportResult ("SetVariable (create)", &Create);
+  GateMet = (BOOLEAN)(ReportResult ("GetVariable", &Get) && GateMet);
+  GateMet = (BOOLEAN)(ReportResult ("GetNextVariableName", &GetNext) && GateMet);
+  GateMet = (BOOLEAN)(ReportResult ("SetVariable (update)", &Update) && GateMet);
+  GateMet = (BOOLEAN)(ReportResult ("SetVariable (delete)", &Delete) && GateMet);
+  DEBUG ((
+    DEBUG_INFO,
+    "  %Lu reclaims in %Lu writes\n",
+    (UINT64)mFtwWrites,
+    (UINT64)(Create.Count + Update.Count + Delete.Count + Config->VariableCount * Config->Fragmentation / 100)
+    ));
+
+  UT_ASSERT_TRUE (GateMet);
+  UT_ASSERT_TRUE (mFtwWrites <= Config->MaxReclaimCount);
+
+  return UNIT_TEST_PASSED;
+}
+
+/// === TEST ENGINE ================================================================================
+
+/**
+  Initialize the unit test framework, suite, and unit tests for the
+  variable service benchmarks and run the unit tests.
+**/
+VOID
+EFIAPI
+UnitTestMain (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      BenchmarkTests;
+  UINTN                       Index;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_NAME, UNIT_TEST_VERSION));
+
+  //
+  // Start setting up the test framework for running the tests.
+  //
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_NAME, gEfiCallerBaseName, UNIT_TEST_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  //
+  // Add all test suites and tests.
+  //
+  Status = CreateUnitTestSuite (
+             &BenchmarkTests,
+             Framework,
+             "Variable Service Benchmarks",
+             "Variable.Benchmark",
+             NULL,
+             NULL
+             );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for BenchmarkTests\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  for (Index = 0; Index < ARRAY_SIZE (mBenchmarkConfig); Index++) {
+    AddTestCase (
+      BenchmarkTests,
+      "Variable service throughput",
+      mBenchmarkConfig[Index].Name,
+      VariableServiceBenchmark,
+      BenchmarkSetup,
+      BenchmarkCleanup,
+      &mBenchmarkConfig[Index]
+      );
+  }
+
+  //
+  // Execute the tests.
+  //
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework != NULL) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return;
+}
+
+///
+/// Avoid ECC error for function name that starts with lower case letter
+///
+#define Main  main
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+
+  @param[in] Argc  Number of arguments
+  @param[in] Argv  Array of pointers to arguments
+
+  @retval 0      Success
+  @retval other  Error
+**/
+INT32
+Main (
+  IN INT32  Argc,
+  IN CHAR8  *Argv[]
+  )
+{
+  if (Argc > 2) {
+    DEBUG ((DEBUG_ERROR, "Usage: %a [MinOpsPerSecond]\n", Argv[0]));
+    return 1;
+  }
+
+  if (Argc == 2) {
+    mMinOpsPerSecond = (UINTN)strtoull (Argv[1], NULL, 0);
+  }
+
+  UnitTestMain ();
+  return 0;
+}
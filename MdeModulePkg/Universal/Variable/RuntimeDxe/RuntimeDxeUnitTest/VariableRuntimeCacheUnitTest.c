@@ -0,0 +1,1012 @@
+/** @file
+  This is a host-based unit test for the lock-free readers of the runtime
+  variable cache.
+
+  The SMM side of the runtime cache updates and the runtime DXE side readers run
+  against variable stores in host memory. The read latency is collected in a
+  histogram that is printed by the test.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <time.h>
+#include <cmocka.h>
+
+#include <Library/UnitTestLib.h>
+
+#include "../VariableRuntimeCache.h"
+#include "../VariableRuntimeCacheReader.h"
+
+#define UNIT_TEST_NAME     "Variable Runtime Cache Unit Test"
+#define UNIT_TEST_VERSION  "1.0"
+
+/// === TEST DATA ==================================================================================
+
+//
+// Test GUID {5C7A5A5E-1B7D-4E44-9C25-6A1D2C36B1F0}
+//
+EFI_GUID  mTestGuid = {
+  0x5c7a5a5e, 0x1b7d, 0x4e44, { 0x9c, 0x25, 0x6a, 0x1d, 0x2c, 0x36, 0xb1, 0xf0 }
+};
+
+#define TEST_STORE_SIZE            SIZE_128KB
+#define TEST_VARIABLE_COUNT        64
+#define TEST_NV_VARIABLE_COUNT     8
+#define TEST_NAME_LENGTH           7
+#define TEST_READ_COUNT            16384
+#define TEST_READS_PER_UPDATE      16
+#define TEST_LATENCY_BUCKET_COUNT  32
+
+typedef struct {
+  VARIABLE_STORE_HEADER     *Store;
+  UINTN                     LastVariableOffset;
+  UINT32                    Attributes;
+  VARIABLE_RUNTIME_CACHE    *RuntimeCache;
+} TEST_STORE;
+
+typedef
+VOID
+(*TEST_READ_HOOK)(
+  VOID
+  );
+
+//
+// The SMM side of the variable driver
+//
+VARIABLE_MODULE_GLOBAL  mTestModuleGlobal;
+VARIABLE_MODULE_GLOBAL  *mVariableModuleGlobal = &mTestModuleGlobal;
+VARIABLE_STORE_HEADER   *mNvVariableCache      = NULL;
+TEST_STORE              mVolatileStore;
+TEST_STORE              mNvStore;
+
+//
+// The runtime DXE side of the variable driver
+//
+VARIABLE_STORE_HEADER          *mVolatileCache = NULL;
+VARIABLE_STORE_HEADER          *mNvCache       = NULL;
+BOOLEAN                        mReadLock;
+BOOLEAN                        mPendingUpdate;
+BOOLEAN                        mHobFlushComplete;
+volatile UINT32                mSequence;
+volatile UINT32                mGeneration;
+UINT32                         mIndexGeneration;
+CHAR16                         mNameBuffer[64];
+VARIABLE_RUNTIME_CACHE_READER  mReader;
+
+//
+// The value last written to each test variable
+//
+UINT64  mExpectedValue[TEST_VARIABLE_COUNT + TEST_NV_VARIABLE_COUNT];
+
+//
+// Run by AtRuntime() the next time a lookup matches a variable, as an update
+// made by SMM in the middle of a read
+//
+TEST_READ_HOOK  mReadHook       = NULL;
+UINTN           mAtRuntimeCalls = 0;
+
+/// === HELPER FUNCTIONS ===========================================================================
+
+/**
+  The variable driver never runs at runtime in this test.
+
+  The lookups of the runtime cache readers call it once they matched a
+  variable, so it runs the read hook there.
+
+  @retval FALSE
+**/
+BOOLEAN
+AtRuntime (
+  VOID
+  )
+{
+  TEST_READ_HOOK  ReadHook;
+
+  mAtRuntimeCalls++;
+  if (mReadHook != NULL) {
+    ReadHook  = mReadHook;
+    mReadHook = NULL;
+    ReadHook ();
+  }
+
+  return FALSE;
+}
+
+/**
+  Return a monotonic time stamp.
+
+  @return The time in nanoseconds.
+**/
+STATIC
+UINT64
+GetTimeInNanoSecond (
+  VOID
+  )
+{
+  struct timespec  Time;
+
+  timespec_get (&Time, TIME_UTC);
+  return (UINT64)Time.tv_sec * 1000000000 + (UINT64)Time.tv_nsec;
+}
+
+/**
+  Build the name of a test variable, "Var" followed by three decimal digits.
+
+  @param[in]  Index  Index of the test variable.
+  @param[out] Name   Buffer of TEST_NAME_LENGTH characters for the name.
+**/
+STATIC
+VOID
+GetTestVariableName (
+  IN  UINTN   Index,
+  OUT CHAR16  *Name
+  )
+{
+  Name[0] = L'V';
+  Name[1] = L'a';
+  Name[2] = L'r';
+  Name[3] = (CHAR16)(L'0' + (Index / 100) % 10);
+  Name[4] = (CHAR16)(L'0' + (Index / 10) % 10);
+  Name[5] = (CHAR16)(L'0' + Index % 10);
+  Name[6] = L'\0';
+}
+
+/**
+  Format an empty variable store.
+
+  @param[out] Store  The buffer of TEST_STORE_SIZE bytes for the store.
+**/
+STATIC
+VOID
+FormatTestStore (
+  OUT VARIABLE_STORE_HEADER  *Store
+  )
+{
+  SetMem (Store, TEST_STORE_SIZE, 0xFF);
+  CopyGuid (&Store->Signature, &gEfiVariableGuid);
+  Store->Size      = TEST_STORE_SIZE;
+  Store->Format    = VARIABLE_STORE_FORMATTED;
+  Store->State     = VARIABLE_STORE_HEALTHY;
+  Store->Reserved  = 0;
+  Store->Reserved1 = 0;
+}
+
+/**
+  Add a variable to a store on the SMM side, and publish it to the runtime cache
+  as SMM does at the end of SetVariable().
+
+  @param[in] TestStore  The store to add the variable to.
+  @param[in] Name       The name of the variable.
+  @param[in] Value      The data of the variable.
+
+  @return The status of the runtime cache update.
+**/
+STATIC
+EFI_STATUS
+AddTestVariable (
+  IN TEST_STORE  *TestStore,
+  IN CHAR16      *Name,
+  IN UINT64      Value
+  )
+{
+  EFI_STATUS       Status;
+  VARIABLE_HEADER  *Variable;
+  UINT8            *NamePtr;
+  UINTN            NameSize;
+  UINTN            VariableSize;
+
+  NameSize     = StrSize (Name);
+  VariableSize = sizeof (VARIABLE_HEADER) + NameSize + GET_PAD_SIZE (NameSize) + sizeof (Value);
+  if (TestStore->LastVariableOffset + VariableSize > TEST_STORE_SIZE) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Variable             = (VARIABLE_HEADER *)((UINT8 *)TestStore->Store + TestStore->LastVariableOffset);
+  Variable->StartId    = VARIABLE_DATA;
+  Variable->State      = VAR_ADDED;
+  Variable->Reserved   = 0;
+  Variable->Attributes = TestStore->Attributes;
+  Variable->NameSize   = (UINT32)NameSize;
+  Variable->DataSize   = sizeof (Value);
+  CopyGuid (&Variable->VendorGuid, &mTestGuid);
+
+  NamePtr = (UINT8 *)(Variable + 1);
+  CopyMem (NamePtr, Name, NameSize);
+  CopyMem (NamePtr + NameSize + GET_PAD_SIZE (NameSize), &Value, sizeof (Value));
+
+  Status = SynchronizeRuntimeVariableCache (TestStore->RuntimeCache, TestStore->LastVariableOffset, VariableSize);
+
+  TestStore->LastVariableOffset += HEADER_ALIGN (VariableSize);
+  return Status;
+}
+
+/**
+  Change the state of a variable on the SMM side and publish the change to the
+  runtime cache.
+
+  @param[in] TestStore  The store of the variable.
+  @param[in] Variable   The variable.
+  @param[in] State      The state bits to keep.
+
+  @return The status of the runtime cache update.
+**/
+STATIC
+EFI_STATUS
+UpdateTestVariableState (
+  IN TEST_STORE       *TestStore,
+  IN VARIABLE_HEADER  *Variable,
+  IN UINT8            State
+  )
+{
+  Variable->State &= State;
+  return SynchronizeRuntimeVariableCache (
+           TestStore->RuntimeCache,
+           (UINTN)&Variable->State - (UINTN)TestStore->Store,
+           sizeof (Variable->State)
+           );
+}
+
+/**
+  Replace the data of a variable on the SMM side the way SetVariable() does,
+  publishing every step to the runtime cache.
+
+  @param[in] TestStore  The store of the variable.
+  @param[in] Name       The name of the variable.
+  @param[in] Value      The new data of the variable.
+
+  @return The status of the update.
+**/
+STATIC
+EFI_STATUS
+UpdateTestVariable (
+  IN TEST_STORE  *TestStore,
+  IN CHAR16      *Name,
+  IN UINT64      Value
+  )
+{
+  EFI_STATUS              Status;
+  VARIABLE_POINTER_TRACK  Variable;
+
+  Variable.StartPtr = GetStartPointer (TestStore->Store);
+  Variable.EndPtr   = GetEndPointer (TestStore->Store);
+  Status            = FindVariableEx (Name, &mTestGuid, TRUE, &Variable, FALSE);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = UpdateTestVariableState (TestStore, Variable.CurrPtr, VAR_IN_DELETED_TRANSITION);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = AddTestVariable (TestStore, Name, Value);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  return UpdateTestVariableState (TestStore, Variable.CurrPtr, VAR_DELETED);
+}
+
+/**
+  Set up the SMM side stores, the runtime caches and the cache reader, and fill
+  the stores with the test variables.
+
+  @param[in]  Context  Unit test case context
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+InitRuntimeCaches (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  VARIABLE_RUNTIME_CACHE_CONTEXT  *CacheContext;
+  CHAR16                          Name[TEST_NAME_LENGTH];
+  UINTN                           Index;
+
+  mVolatileStore.Store = AllocatePool (TEST_STORE_SIZE);
+  mNvStore.Store       = AllocatePool (TEST_STORE_SIZE);
+  mVolatileCache       = AllocatePool (TEST_STORE_SIZE);
+  mNvCache             = AllocatePool (TEST_STORE_SIZE);
+  if ((mVolatileStore.Store == NULL) || (mNvStore.Store == NULL) || (mVolatileCache == NULL) || (mNvCache == NULL)) {
+    return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+  }
+
+  FormatTestStore (mVolatileStore.Store);
+  FormatTestStore (mNvStore.Store);
+  FormatTestStore (mVolatileCache);
+  FormatTestStore (mNvCache);
+
+  mReadLock         = FALSE;
+  mPendingUpdate    = FALSE;
+  mHobFlushComplete = FALSE;
+  mSequence         = 0;
+  mGeneration       = 0;
+  mIndexGeneration  = 0;
+
+  ZeroMem (&mTestModuleGlobal, sizeof (mTestModuleGlobal));
+  mTestModuleGlobal.VariableGlobal.VolatileVariableBase = (EFI_PHYSICAL_ADDRESS)(UINTN)mVolatileStore.Store;
+  mNvVariableCache                                      = mNvStore.Store;
+
+  CacheContext                                     = &mTestModuleGlobal.VariableGlobal.VariableRuntimeCacheContext;
+  CacheContext->ReadLock                           = &mReadLock;
+  CacheContext->PendingUpdate                      = &mPendingUpdate;
+  CacheContext->HobFlushComplete                   = &mHobFlushComplete;
+  CacheContext->Sequence                           = &mSequence;
+  CacheContext->Generation                         = &mGeneration;
+  CacheContext->VariableRuntimeVolatileCache.Store = mVolatileCache;
+  CacheContext->VariableRuntimeNvCache.Store       = mNvCache;
+
+  mVolatileStore.LastVariableOffset = (UINTN)GetStartPointer (mVolatileStore.Store) - (UINTN)mVolatileStore.Store;
+  mVolatileStore.Attributes         = EFI_VARIABLE_BOOTSERVICE_ACCESS | EFI_VARIABLE_RUNTIME_ACCESS;
+  mVolatileStore.RuntimeCache       = &CacheContext->VariableRuntimeVolatileCache;
+  mNvStore.LastVariableOffset       = (UINTN)GetStartPointer (mNvStore.Store) - (UINTN)mNvStore.Store;
+  mNvStore.Attributes               = EFI_VARIABLE_NON_VOLATILE | EFI_VARIABLE_BOOTSERVICE_ACCESS | EFI_VARIABLE_RUNTIME_ACCESS;
+  mNvStore.RuntimeCache             = &CacheContext->VariableRuntimeNvCache;
+
+  for (Index = 0; Index < TEST_VARIABLE_COUNT + TEST_NV_VARIABLE_COUNT; Index++) {
+    GetTestVariableName (Index, Name);
+    mExpectedValue[Index] = Index;
+    if (EFI_ERROR (AddTestVariable ((Index < TEST_VARIABLE_COUNT) ? &mVolatileStore : &mNvStore, Name, Index))) {
+      return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+    }
+  }
+
+  VariableIndexRegisterStore (mVolatileCache, TEST_STORE_SIZE);
+  VariableIndexRegisterStore (mNvCache, TEST_STORE_SIZE);
+
+  ZeroMem (&mReader, sizeof (mReader));
+  mReader.Sequence                             = &mSequence;
+  mReader.Generation                           = &mGeneration;
+  mReader.IndexGeneration                      = &mIndexGeneration;
+  mReader.Store[VariableStoreTypeVolatile]     = mVolatileCache;
+  mReader.Store[VariableStoreTypeNv]           = mNvCache;
+  mReader.StoreSize[VariableStoreTypeVolatile] = TEST_STORE_SIZE;
+  mReader.StoreSize[VariableStoreTypeNv]       = TEST_STORE_SIZE;
+  mReader.NameBuffer                           = mNameBuffer;
+  mReader.NameBufferSize                       = sizeof (mNameBuffer);
+  mReader.AuthFormat                           = FALSE;
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Free the stores and the runtime caches.
+
+  @param[in]  Context  Unit test case context
+**/
+STATIC
+VOID
+EFIAPI
+FreeRuntimeCaches (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  VariableIndexUnregisterStore (mVolatileCache);
+  VariableIndexUnregisterStore (mNvCache);
+
+  if (mVolatileStore.Store != NULL) {
+    FreePool (mVolatileStore.Store);
+    mVolatileStore.Store = NULL;
+  }
+
+  if (mNvStore.Store != NULL) {
+    FreePool (mNvStore.Store);
+    mNvStore.Store = NULL;
+  }
+
+  if (mVolatileCache != NULL) {
+    FreePool (mVolatileCache);
+    mVolatileCache = NULL;
+  }
+
+  if (mNvCache != NULL) {
+    FreePool (mNvCache);
+    mNvCache = NULL;
+  }
+}
+
+/// === TEST CASES =================================================================================
+
+/**
+  An update reaches the runtime cache at once, even while a reader holds the
+  read lock, and leaves the sequence counter even.
+
+  @param[in]  Context  Unit test case context
+**/
+UNIT_TEST_STATUS
+EFIAPI
+UpdateIsNotDeferredByReader (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_STATUS  Status;
+  CHAR16      Name[TEST_NAME_LENGTH];
+  UINT64      Value;
+  UINTN       DataSize;
+  UINT32      Sequence;
+
+  GetTestVariableName (0, Name);
+  mReadLock = TRUE;
+  Sequence  = mSequence;
+
+  Status = UpdateTestVariable (&mVolatileStore, Name, 1000);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+  UT_ASSERT_FALSE (mPendingUpdate);
+  UT_ASSERT_EQUAL (mSequence & BIT0, 0);
+  //
+  // Every step of the update was published: two state changes and the new variable
+  //
+  UT_ASSERT_EQUAL (mSequence - Sequence, 6);
+
+  DataSize = sizeof (Value);
+  Status   = RuntimeCacheFindVariable (&mReader, Name, &mTestGuid, NULL, &DataSize, &Value, NULL);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+  UT_ASSERT_EQUAL (Value, 1000);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Update the first test variable on the SMM side, as the read hook.
+**/
+STATIC
+VOID
+UpdateFirstVariable (
+  VOID
+  )
+{
+  CHAR16  Name[TEST_NAME_LENGTH];
+
+  GetTestVariableName (0, Name);
+  mExpectedValue[0] = 2000;
+  UpdateTestVariable (&mVolatileStore, Name, mExpectedValue[0]);
+}
+
+/**
+  A read that overlaps an update of the runtime cache is repeated and returns
+  the data of the update.
+
+  @param[in]  Context  Unit test case context
+**/
+UNIT_TEST_STATUS
+EFIAPI
+ReadIsRepeatedAfterUpdate (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_STATUS  Status;
+  CHAR16      Name[TEST_NAME_LENGTH];
+  UINT64      Value;
+  UINTN       DataSize;
+  UINT32      Sequence;
+
+  GetTestVariableName (0, Name);
+  Sequence        = mSequence;
+  mAtRuntimeCalls = 0;
+  mReadHook       = UpdateFirstVariable;
+
+  DataSize = sizeof (Value);
+  Status   = RuntimeCacheFindVariable (&mReader, Name, &mTestGuid, NULL, &DataSize, &Value, NULL);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+  UT_ASSERT_TRUE (mReadHook == NULL);
+  UT_ASSERT_EQUAL (mSequence - Sequence, 6);
+  //
+  // The first lookup matched the variable before the update, the second one
+  // the updated variable.
+  //
+  UT_ASSERT_EQUAL (mAtRuntimeCalls, 2);
+  UT_ASSERT_EQUAL (Value, mExpectedValue[0]);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  GetVariable() reads from the runtime caches return the data, attributes and
+  sizes of the variables.
+
+  @param[in]  Context  Unit test case context
+**/
+UNIT_TEST_STATUS
+EFIAPI
+FindVariableReturnsCachedVariables (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_STATUS  Status;
+  CHAR16      Name[TEST_NAME_LENGTH];
+  UINT64      Value;
+  UINTN       DataSize;
+  UINT32      Attributes;
+  BOOLEAN     Volatile;
+  UINTN       Index;
+
+  for (Index = 0; Index < TEST_VARIABLE_COUNT + TEST_NV_VARIABLE_COUNT; Index++) {
+    GetTestVariableName (Index, Name);
+    DataSize = sizeof (Value);
+    Status   = RuntimeCacheFindVariable (&mReader, Name, &mTestGuid, &Attributes, &DataSize, &Value, &Volatile);
+    UT_ASSERT_NOT_EFI_ERROR (Status);
+    UT_ASSERT_EQUAL (DataSize, sizeof (Value));
+    UT_ASSERT_EQUAL (Value, mExpectedValue[Index]);
+    UT_ASSERT_EQUAL (Volatile, (BOOLEAN)(Index < TEST_VARIABLE_COUNT));
+    UT_ASSERT_EQUAL (Attributes & EFI_VARIABLE_NON_VOLATILE, (Index < TEST_VARIABLE_COUNT) ? 0 : EFI_VARIABLE_NON_VOLATILE);
+  }
+
+  GetTestVariableName (1, Name);
+  DataSize = 1;
+  Status   = RuntimeCacheFindVariable (&mReader, Name, &mTestGuid, NULL, &DataSize, &Value, NULL);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_BUFFER_TOO_SMALL);
+  UT_ASSERT_EQUAL (DataSize, sizeof (Value));
+
+  Status = RuntimeCacheFindVariable (&mReader, Name, &mTestGuid, NULL, &DataSize, NULL, NULL);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_INVALID_PARAMETER);
+
+  GetTestVariableName (TEST_VARIABLE_COUNT + TEST_NV_VARIABLE_COUNT, Name);
+  Status = RuntimeCacheFindVariable (&mReader, Name, &mTestGuid, NULL, &DataSize, &Value, NULL);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_NOT_FOUND);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  GetNextVariableName() reads from the runtime caches return every variable once,
+  skipping the copies replaced by updates.
+
+  @param[in]  Context  Unit test case context
+**/
+UNIT_TEST_STATUS
+EFIAPI
+GetNextVariableNameWalksCaches (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_STATUS  Status;
+  CHAR16      Name[TEST_NAME_LENGTH];
+  CHAR16      Expected[TEST_NAME_LENGTH];
+  EFI_GUID    Guid;
+  UINTN       NameSize;
+  UINTN       Count;
+
+  Status = UpdateTestVariable (&mVolatileStore, L"Var002", 1000);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  Name[0] = L'\0';
+  ZeroMem (&Guid, sizeof (Guid));
+  for (Count = 0; ; Count++) {
+    NameSize = sizeof (Name);
+    Status   = RuntimeCacheGetNextVariableName (&mReader, &NameSize, Name, &Guid);
+    if (Status == EFI_NOT_FOUND) {
+      break;
+    }
+
+    UT_ASSERT_NOT_EFI_ERROR (Status);
+    UT_ASSERT_TRUE (CompareGuid (&Guid, &mTestGuid));
+    UT_ASSERT_EQUAL (NameSize, StrSize (Name));
+    //
+    // The updated variable moved to the end of the volatile cache
+    //
+    if (Count < 2) {
+      GetTestVariableName (Count, Expected);
+    } else if (Count < TEST_VARIABLE_COUNT - 1) {
+      GetTestVariableName (Count + 1, Expected);
+    } else if (Count == TEST_VARIABLE_COUNT - 1) {
+      GetTestVariableName (2, Expected);
+    } else {
+      GetTestVariableName (Count, Expected);
+    }
+
+    UT_ASSERT_MEM_EQUAL (Name, Expected, sizeof (Expected));
+  }
+
+  UT_ASSERT_EQUAL (Count, TEST_VARIABLE_COUNT + TEST_NV_VARIABLE_COUNT);
+
+  GetTestVariableName (0, Name);
+  NameSize = sizeof (CHAR16);
+  Status   = RuntimeCacheGetNextVariableName (&mReader, &NameSize, Name, &Guid);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_BUFFER_TOO_SMALL);
+  UT_ASSERT_EQUAL (NameSize, sizeof (Name));
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  A variable whose size points outside of the runtime cache, as a read racing
+  with an update could observe, is never copied.
+
+  @param[in]  Context  Unit test case context
+**/
+UNIT_TEST_STATUS
+EFIAPI
+CorruptedCacheIsNotCopied (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_STATUS              Status;
+  CHAR16                  Name[TEST_NAME_LENGTH];
+  UINT64                  Value;
+  UINTN                   DataSize;
+  VARIABLE_POINTER_TRACK  Variable;
+
+  GetTestVariableName (TEST_VARIABLE_COUNT - 1, Name);
+  Variable.StartPtr = GetStartPointer (mVolatileCache);
+  Variable.EndPtr   = GetEndPointer (mVolatileCache);
+  Status            = FindVariableEx (Name, &mTestGuid, TRUE, &Variable, FALSE);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  Variable.CurrPtr->DataSize = TEST_STORE_SIZE;
+
+  DataSize = MAX_UINTN;
+  Status   = RuntimeCacheFindVariable (&mReader, Name, &mTestGuid, NULL, &DataSize, &Value, NULL);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_DEVICE_ERROR);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  A variable whose name reaches past the end of the runtime cache, as a read
+  racing with an update could observe, is neither hashed nor compared.
+
+  @param[in]  Context  Unit test case context
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TornVariableIsNotIndexed (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_STATUS              Status;
+  CHAR16                  Name[TEST_NAME_LENGTH];
+  UINT64                  Value;
+  UINTN                   DataSize;
+  VARIABLE_POINTER_TRACK  Variable;
+
+  GetTestVariableName (TEST_VARIABLE_COUNT - 1, Name);
+  Variable.StartPtr = GetStartPointer (mVolatileCache);
+  Variable.EndPtr   = GetEndPointer (mVolatileCache);
+  Status            = FindVariableEx (Name, &mTestGuid, TRUE, &Variable, FALSE);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  Variable.CurrPtr->NameSize = TEST_STORE_SIZE;
+
+  GetTestVariableName (0, Name);
+  Status = FindVariableEx (Name, &mTestGuid, TRUE, &Variable, FALSE);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_VOLUME_CORRUPTED);
+  UT_ASSERT_TRUE (Variable.CurrPtr == NULL);
+
+  DataSize = sizeof (Value);
+  Status   = RuntimeCacheFindVariable (&mReader, Name, &mTestGuid, NULL, &DataSize, &Value, NULL);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_DEVICE_ERROR);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  After a reclaim step moved variables within the NV cache, reads from the
+  runtime cache return the variables at their new place rather than the stale
+  copies left in the gap.
+
+  @param[in]  Context  Unit test case context
+**/
+UNIT_TEST_STATUS
+EFIAPI
+ReclaimedCacheIsIndexedAgain (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_STATUS              Status;
+  CHAR16                  Name[TEST_NAME_LENGTH];
+  UINT64                  Value;
+  UINTN                   DataSize;
+  VARIABLE_POINTER_TRACK  Variable;
+  VARIABLE_HEADER         *Gap;
+  VARIABLE_HEADER         *Moved;
+  VARIABLE_HEADER         *Next;
+  VARIABLE_HEADER         *Pad;
+  UINTN                   MovedSize;
+  UINTN                   PadSize;
+
+  //
+  // Delete the first two NV variables by updating them, and index the cache.
+  //
+  GetTestVariableName (TEST_VARIABLE_COUNT + 1, Name);
+  Status = UpdateTestVariable (&mNvStore, Name, 1000);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+  GetTestVariableName (TEST_VARIABLE_COUNT + 2, Name);
+  Status = UpdateTestVariable (&mNvStore, Name, 2000);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  GetTestVariableName (TEST_VARIABLE_COUNT + 3, Name);
+  DataSize = sizeof (Value);
+  Status   = RuntimeCacheFindVariable (&mReader, Name, &mTestGuid, NULL, &DataSize, &Value, NULL);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+  UT_ASSERT_EQUAL (Value, mExpectedValue[TEST_VARIABLE_COUNT + 3]);
+
+  //
+  // Move the third NV variable down over the deleted ones and cover the rest
+  // of the gap, as one step of IncrementalReclaim() does.
+  //
+  Variable.StartPtr = GetStartPointer (mNvStore.Store);
+  Variable.EndPtr   = GetEndPointer (mNvStore.Store);
+  Status            = FindVariableEx (Name, &mTestGuid, TRUE, &Variable, FALSE);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  Gap       = GetNextVariablePtr (GetStartPointer (mNvStore.Store), FALSE);
+  Moved     = Variable.CurrPtr;
+  Next      = GetNextVariablePtr (Moved, FALSE);
+  MovedSize = (UINTN)Next - (UINTN)Moved;
+  PadSize   = sizeof (VARIABLE_HEADER) + sizeof (CHAR16);
+  UT_ASSERT_TRUE ((UINTN)Moved - (UINTN)Gap >= PadSize + sizeof (CHAR16));
+
+  CopyMem (Gap, Moved, MovedSize);
+  Pad = (VARIABLE_HEADER *)((UINT8 *)Gap + MovedSize);
+  ZeroMem (Pad, PadSize);
+  Pad->StartId  = VARIABLE_DATA;
+  Pad->State    = VAR_ADDED & VAR_DELETED;
+  Pad->NameSize = sizeof (CHAR16);
+  Pad->DataSize = (UINT32)((UINTN)Next - (UINTN)Pad - PadSize - sizeof (CHAR16));
+  UT_ASSERT_TRUE (GetNextVariablePtr (Pad, FALSE) == Next);
+
+  InvalidateRuntimeVariableCacheLayout ();
+  Status = SynchronizeRuntimeVariableCache (
+             mNvStore.RuntimeCache,
+             (UINTN)Gap - (UINTN)mNvStore.Store,
+             MovedSize + PadSize
+             );
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  //
+  // The stale copy of the moved variable is still in the gap of the cache.
+  //
+  Status = UpdateTestVariable (&mNvStore, Name, 3000);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  DataSize = sizeof (Value);
+  Status   = RuntimeCacheFindVariable (&mReader, Name, &mTestGuid, NULL, &DataSize, &Value, NULL);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+  UT_ASSERT_EQUAL (Value, 3000);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Measure the latency of GetVariable() reads from the runtime caches while SMM
+  publishes an update every TEST_READS_PER_UPDATE reads, and print it as a
+  histogram with power of two buckets.
+
+  @param[in]  Context  Unit test case context
+**/
+UNIT_TEST_STATUS
+EFIAPI
+ReadLatencyHistogram (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_STATUS  Status;
+  CHAR16      Name[TEST_NAME_LENGTH];
+  UINT64      Value;
+  UINTN       DataSize;
+  UINTN       Read;
+  UINTN       Index;
+  UINT64      Start;
+  UINT64      Latency;
+  UINT64      Total;
+  UINT64      Max;
+  UINTN       Bucket;
+  UINT64      Histogram[TEST_LATENCY_BUCKET_COUNT];
+
+  ZeroMem (Histogram, sizeof (Histogram));
+  Total = 0;
+  Max   = 0;
+
+  for (Read = 0; Read < TEST_READ_COUNT; Read++) {
+    if ((Read % TEST_READS_PER_UPDATE) == 0) {
+      Index = (Read / TEST_READS_PER_UPDATE) % TEST_VARIABLE_COUNT;
+      GetTestVariableName (Index, Name);
+      mExpectedValue[Index] = TEST_VARIABLE_COUNT + Read;
+      Status                = UpdateTestVariable (&mVolatileStore, Name, mExpectedValue[Index]);
+      UT_ASSERT_NOT_EFI_ERROR (Status);
+    }
+
+    Index = (Read * 7) % (TEST_VARIABLE_COUNT + TEST_NV_VARIABLE_COUNT);
+    GetTestVariableName (Index, Name);
+    DataSize = sizeof (Value);
+
+    Start   = GetTimeInNanoSecond ();
+    Status  = RuntimeCacheFindVariable (&mReader, Name, &mTestGuid, NULL, &DataSize, &Value, NULL);
+    Latency = GetTimeInNanoSecond () - Start;
+
+    UT_ASSERT_NOT_EFI_ERROR (Status);
+    UT_ASSERT_EQUAL (Value, mExpectedValue[Index]);
+
+    Bucket = (UINTN)HighBitSet64 (MAX (Latency, 1));
+    Bucket = MIN (Bucket, TEST_LATENCY_BUCKET_COUNT - 1);
+    Histogram[Bucket]++;
+    Total += Latency;
+    Max    = MAX (Max, Latency);
+  }
+
+  DEBUG ((
+    DEBUG_INFO,
+    "GetVariable() from the runtime cache: %d reads, one update every %d reads, average %Lu ns, max %Lu ns\n",
+    TEST_READ_COUNT,
+    TEST_READS_PER_UPDATE,
+    Total / TEST_READ_COUNT,
+    Max
+    ));
+  for (Bucket = 0; Bucket < TEST_LATENCY_BUCKET_COUNT; Bucket++) {
+    if (Histogram[Bucket] != 0) {
+      DEBUG ((
+        DEBUG_INFO,
+        "  %10Lu - %10Lu ns: %8Lu\n",
+        LShiftU64 (1, Bucket),
+        LShiftU64 (1, Bucket + 1) - 1,
+        Histogram[Bucket]
+        ));
+    }
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/// === TEST ENGINE ================================================================================
+
+/**
+  Initialize the unit test framework, suite, and unit tests for the
+  runtime variable cache readers and run the unit tests.
+**/
+VOID
+EFIAPI
+UnitTestMain (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      CacheTests;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_NAME, UNIT_TEST_VERSION));
+
+  //
+  // Start setting up the test framework for running the tests.
+  //
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_NAME, gEfiCallerBaseName, UNIT_TEST_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  //
+  // Add all test suites and tests.
+  //
+  Status = CreateUnitTestSuite (
+             &CacheTests,
+             Framework,
+             "Variable Runtime Cache Reader Tests",
+             "Variable.RuntimeCache",
+             NULL,
+             NULL
+             );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for CacheTests\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  AddTestCase (
+    CacheTests,
+    "An update should reach the runtime cache while a reader holds the read lock",
+    "UpdateNotDeferred",
+    UpdateIsNotDeferredByReader,
+    InitRuntimeCaches,
+    FreeRuntimeCaches,
+    NULL
+    );
+  AddTestCase (
+    CacheTests,
+    "Reads from the runtime cache should return the variable data and attributes",
+    "FindVariable",
+    FindVariableReturnsCachedVariables,
+    InitRuntimeCaches,
+    FreeRuntimeCaches,
+    NULL
+    );
+  AddTestCase (
+    CacheTests,
+    "A read overlapping an update of the runtime cache should be repeated",
+    "ReadRetry",
+    ReadIsRepeatedAfterUpdate,
+    InitRuntimeCaches,
+    FreeRuntimeCaches,
+    NULL
+    );
+  AddTestCase (
+    CacheTests,
+    "Walking the runtime cache should return every variable once",
+    "GetNextVariableName",
+    GetNextVariableNameWalksCaches,
+    InitRuntimeCaches,
+    FreeRuntimeCaches,
+    NULL
+    );
+  AddTestCase (
+    CacheTests,
+    "A variable that does not fit in the runtime cache should never be copied",
+    "CorruptedCache",
+    CorruptedCacheIsNotCopied,
+    InitRuntimeCaches,
+    FreeRuntimeCaches,
+    NULL
+    );
+  AddTestCase (
+    CacheTests,
+    "A variable reaching past the end of the runtime cache should not be indexed",
+    "TornVariable",
+    TornVariableIsNotIndexed,
+    InitRuntimeCaches,
+    FreeRuntimeCaches,
+    NULL
+    );
+  AddTestCase (
+    CacheTests,
+    "Reads from the runtime cache should not return variables moved by a reclaim",
+    "ReclaimedCache",
+    ReclaimedCacheIsIndexedAgain,
+    InitRuntimeCaches,
+    FreeRuntimeCaches,
+    NULL
+    );
+  AddTestCase (
+    CacheTests,
+    "Read latency from the runtime cache while SMM publishes updates",
+    "ReadLatency",
+    ReadLatencyHistogram,
+    InitRuntimeCaches,
+    FreeRuntimeCaches,
+    NULL
+    );
+
+  //
+  // Execute the tests.
+  //
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework != NULL) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return;
+}
+
+///
+/// Avoid ECC error for function name that starts with lower case letter
+///
+#define Main  main
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+
+  @param[in] Argc  Number of arguments
+  @param[in] Argv  Array of pointers to arguments
+
+  @retval 0      Success
+  @retval other  Error
+**/
+INT32
+Main (
+  IN INT32  Argc,
+  IN CHAR8  *Argv[]
+  )
+{
+  UnitTestMain ();
+  return 0;
+}
@@ -43,6 +43,17 @@ VARIABLE_STORE_HEADER  *mNvVariableCache = NULL;
 ///
 EFI_FIRMWARE_VOLUME_HEADER  *mNvFvHeaderCache = NULL;
 
+///
+/// TRUE if the non-volatile variable store holds no deleted variables, as
+/// found by IncrementalReclaim(). Any write to the store clears it.
+///
+BOOLEAN  mNvVariableStoreCompacted = FALSE;
+
+///
+/// The batch of non-volatile variable updates in progress, if any.
+///
+VARIABLE_BATCH  mVariableBatch;
+
 ///
 /// The memory entry used for variable statistics data.
 ///
@@ -205,6 +216,19 @@ UpdateVariableStore (
   //
   // If we are here we are dealing with Non-Volatile Variables.
   //
+  mNvVariableStoreCompacted = FALSE;
+
+  if (mVariableBatch.Active) {
+    //
+    // The caller has updated or will update the NV cache the same way, the
+    // changed range of it is written to flash when the batch ends.
+    //
+    LinearOffset              = (UINTN)(DataPtr - mVariableModuleGlobal->VariableGlobal.NonVolatileVariableBase);
+    mVariableBatch.DirtyStart = MIN (mVariableBatch.DirtyStart, LinearOffset);
+    mVariableBatch.DirtyEnd   = MAX (mVariableBatch.DirtyEnd, LinearOffset + DataSize);
+    return EFI_SUCCESS;
+  }
+
   LinearOffset  = (UINTN)FvVolHdr;
   CurrWritePtr  = (UINTN)DataPtr;
   CurrWriteSize = DataSize;
@@ -497,6 +521,54 @@ InitializeVariableQuota (
   CalculateCommonUserVariableTotalSize ();
 }
 
+/**
+  Account a reclaim of the non-volatile variable store in the variable
+  statistics.
+
+  Reclaims are recorded as variables of the vendor GUID of the variable driver,
+  L"Reclaim" for whole store reclaims and L"IncrementalReclaim" for incremental
+  ones. WriteCount counts the FTW writes, DeleteCount the bytes that were freed
+  and CacheCount the flash blocks that were erased, including the FTW spare
+  blocks.
+
+  @param[in] Name             L"Reclaim" or L"IncrementalReclaim".
+  @param[in] Offset           Offset of the range written in the variable store.
+  @param[in] Length           Length of the range written.
+  @param[in] ReclaimedBytes   Number of bytes of the store that were freed.
+
+**/
+STATIC
+VOID
+RecordReclaimInfo (
+  IN CHAR16  *Name,
+  IN UINTN   Offset,
+  IN UINTN   Length,
+  IN UINTN   ReclaimedBytes
+  )
+{
+  VARIABLE_INFO_ENTRY  *Entry;
+  UINTN                FirstBlock;
+  UINTN                LastBlock;
+
+  if (!FeaturePcdGet (PcdVariableCollectStatistics) || AtRuntime () || (Length == 0)) {
+    return;
+  }
+
+  UpdateVariableInfo (Name, &gEfiCallerIdGuid, FALSE, FALSE, TRUE, FALSE, FALSE, &gVariableInfo);
+  for (Entry = gVariableInfo; Entry != NULL; Entry = Entry->Next) {
+    if (CompareGuid (&Entry->VendorGuid, &gEfiCallerIdGuid) && (StrCmp (Entry->Name, Name) == 0)) {
+      //
+      // The variable store follows the FV header.
+      //
+      FirstBlock          = (mNvFvHeaderCache->HeaderLength + Offset) / mNvFvHeaderCache->BlockMap[0].Length;
+      LastBlock           = (mNvFvHeaderCache->HeaderLength + Offset + Length - 1) / mNvFvHeaderCache->BlockMap[0].Length;
+      Entry->DeleteCount += (UINT32)ReclaimedBytes;
+      Entry->CacheCount  += (UINT32)(2 * (LastBlock - FirstBlock + 1));
+      return;
+    }
+  }
+}
+
 /**
 
   Variable store garbage collection and reclaim operation.
@@ -763,6 +835,12 @@ Reclaim (
                (VARIABLE_STORE_HEADER *)ValidBuffer
                );
     if (!EFI_ERROR (Status)) {
+      RecordReclaimInfo (
+        L"Reclaim",
+        0,
+        VariableStoreHeader->Size,
+        *LastVariableOffset - MIN (*LastVariableOffset, (UINTN)CurrPtr - (UINTN)ValidBuffer)
+        );
       *LastVariableOffset                                = (UINTN)CurrPtr - (UINTN)ValidBuffer;
       mVariableModuleGlobal->HwErrVariableTotalSize      = HwErrVariableTotalSize;
       mVariableModuleGlobal->CommonVariableTotalSize     = CommonVariableTotalSize;
@@ -792,6 +870,8 @@ Reclaim (
   }
 
 Done:
+  VariableIndexInvalidate ((VARIABLE_STORE_HEADER *)(UINTN)VariableBase);
+  InvalidateRuntimeVariableCacheLayout ();
   DoneStatus = EFI_SUCCESS;
   if (IsVolatile || mVariableModuleGlobal->VariableGlobal.EmuNvMode) {
     DoneStatus = SynchronizeRuntimeVariableCache (
@@ -806,6 +886,7 @@ Done:
     // For NV variable reclaim, we use mNvVariableCache as the buffer, so copy the data back.
     //
     CopyMem (mNvVariableCache, (UINT8 *)(UINTN)VariableBase, VariableStoreHeader->Size);
+    VariableIndexInvalidate (mNvVariableCache);
     DoneStatus = SynchronizeRuntimeVariableCache (
                    &mVariableModuleGlobal->VariableGlobal.VariableRuntimeCacheContext.VariableRuntimeNvCache,
                    0,
@@ -821,6 +902,399 @@ Done:
   return Status;
 }
 
+/**
+  Compact one region of the non-volatile variable store.
+
+  The valid variables that follow the first deleted variable of the store are
+  moved down over the deleted variables, and the rest of the gap is covered by
+  one deleted variable so the store can still be walked. The variables moved
+  fill the flash blocks from the one that holds the start of the gap up to a
+  block boundary, so no block is left partly rewritten for the next step. The
+  region is written with one FTW write, so an interrupted step leaves the store
+  as it was before or after the step. Once the gap reaches the end of the store,
+  it is erased and becomes free space. A gap larger than the step is erased
+  from its end, over several steps. When one deleted variable alone is larger
+  than the step, the end of its data is erased first and the rest is covered by
+  the pad with a second write, each write leaving the store valid.
+
+  @param[in] StepBlocks         The count of flash blocks to fill, counting the
+                                one that holds the start of the gap. More are
+                                filled if the first variable to move needs them.
+
+  @retval EFI_SUCCESS           One region was compacted.
+  @retval EFI_NOT_FOUND         The store holds no deleted variables.
+  @retval EFI_UNSUPPORTED       The store is emulated or cannot be written yet.
+  @retval Others                The region could not be written.
+
+**/
+EFI_STATUS
+IncrementalReclaim (
+  IN UINTN  StepBlocks
+  )
+{
+  EFI_STATUS       Status;
+  VARIABLE_HEADER  *Variable;
+  VARIABLE_HEADER  *NextVariable;
+  VARIABLE_HEADER  *StoreEnd;
+  VARIABLE_HEADER  *Pad;
+  VARIABLE_HEADER  *Tail;
+  UINT8            *Gap;
+  UINTN            GapOffset;
+  UINTN            GapSize;
+  UINTN            MovedSize;
+  UINTN            VariableSize;
+  UINTN            HeaderSize;
+  UINTN            PadSize;
+  UINTN            BlockSize;
+  UINTN            Room;
+  UINTN            WriteSize;
+  UINTN            Split;
+  BOOLEAN          Truncate;
+  BOOLEAN          Compacted;
+  BOOLEAN          AuthFormat;
+
+  if (mVariableModuleGlobal->VariableGlobal.EmuNvMode || (mVariableModuleGlobal->FvbInstance == NULL)) {
+    return EFI_UNSUPPORTED;
+  }
+
+  if (mNvVariableStoreCompacted) {
+    return EFI_NOT_FOUND;
+  }
+
+  AuthFormat = mVariableModuleGlobal->VariableGlobal.AuthFormat;
+  StoreEnd   = GetEndPointer (mNvVariableCache);
+  HeaderSize = GetVariableHeaderSize (AuthFormat);
+  BlockSize  = mNvFvHeaderCache->BlockMap[0].Length;
+
+  //
+  // A deleted variable that covers a gap has an empty name.
+  //
+  PadSize = HeaderSize + 2 * sizeof (CHAR16);
+
+  //
+  // The variables before the first deleted one are already compacted.
+  //
+  for ( Variable = GetStartPointer (mNvVariableCache)
+        ; IsValidVariableHeader (Variable, StoreEnd)
+        ; Variable = GetNextVariablePtr (Variable, AuthFormat)
+        )
+  {
+    if ((Variable->State != VAR_ADDED) && (Variable->State != (VAR_IN_DELETED_TRANSITION & VAR_ADDED))) {
+      break;
+    }
+  }
+
+  if (!IsValidVariableHeader (Variable, StoreEnd)) {
+    mNvVariableStoreCompacted = TRUE;
+    return EFI_NOT_FOUND;
+  }
+
+  //
+  // Move the valid variables that follow down into the gap. The gap is never
+  // empty, so every variable moves to a lower address of the NV cache.
+  //
+  Gap       = (UINT8 *)Variable;
+  GapOffset = (UINTN)Gap - (UINTN)mNvVariableCache;
+  GapSize   = 0;
+  MovedSize = 0;
+  //
+  // The step ends at a block boundary, the variable store follows the FV header.
+  //
+  Room = MAX (StepBlocks, 1) * BlockSize - (mNvFvHeaderCache->HeaderLength + GapOffset) % BlockSize;
+  while (IsValidVariableHeader (Variable, StoreEnd)) {
+    NextVariable = GetNextVariablePtr (Variable, AuthFormat);
+    VariableSize = (UINTN)NextVariable - (UINTN)Variable;
+    if ((Variable->State == VAR_ADDED) || (Variable->State == (VAR_IN_DELETED_TRANSITION & VAR_ADDED))) {
+      if (MovedSize == 0) {
+        while (Room < VariableSize + PadSize) {
+          Room += BlockSize;
+        }
+      } else if (MovedSize + VariableSize + PadSize > Room) {
+        break;
+      }
+
+      CopyMem (Gap + MovedSize, Variable, VariableSize);
+      MovedSize += VariableSize;
+    } else {
+      GapSize += VariableSize;
+    }
+
+    Variable = NextVariable;
+  }
+
+  Truncate  = (BOOLEAN)!IsValidVariableHeader (Variable, StoreEnd);
+  Compacted = (BOOLEAN)(Truncate && (MovedSize + GapSize <= Room));
+  Split     = 0;
+  if (Truncate && !Compacted) {
+    if (MovedSize != 0) {
+      //
+      // The gap is too large to be erased with the moved variables, cover it
+      // with the pad and leave it to the next steps.
+      //
+      Truncate = FALSE;
+    } else {
+      //
+      // Only deleted variables are left, more than the room of the step. The
+      // store ends at the first of them that leaves at most the room of the
+      // step to erase, the others are left to the next steps.
+      //
+      Tail = (VARIABLE_HEADER *)Gap;
+      while ((UINTN)Variable - (UINTN)Tail > Room) {
+        NextVariable = GetNextVariablePtr (Tail, AuthFormat);
+        if (NextVariable == Variable) {
+          break;
+        }
+
+        Tail = NextVariable;
+      }
+
+      if ((UINTN)Variable - (UINTN)Tail > Room) {
+        //
+        // The last of them alone is larger than the step, as the pad of the
+        // previous steps is. Erase the end of its data first, then cover the
+        // rest with the pad so the store ends where the erased flash begins.
+        //
+        Split  = MAX (HEADER_ALIGN ((UINTN)Variable - Room), (UINTN)Tail + PadSize);
+        SetMem ((UINT8 *)Split, (UINTN)Variable - Split, 0xff);
+        Status = FtwVariableRegion (
+                   mVariableModuleGlobal->VariableGlobal.NonVolatileVariableBase + (Split - (UINTN)mNvVariableCache),
+                   (UINTN)Variable - Split,
+                   (UINT8 *)Split
+                   );
+        if (EFI_ERROR (Status)) {
+          goto Restore;
+        }
+
+        RecordReclaimInfo (L"IncrementalReclaim", Split - (UINTN)mNvVariableCache, (UINTN)Variable - Split, (UINTN)Variable - Split);
+        Status = SynchronizeRuntimeVariableCache (
+                   &mVariableModuleGlobal->VariableGlobal.VariableRuntimeCacheContext.VariableRuntimeNvCache,
+                   Split - (UINTN)mNvVariableCache,
+                   (UINTN)Variable - Split
+                   );
+        ASSERT_EFI_ERROR (Status);
+        Variable = (VARIABLE_HEADER *)Split;
+      }
+
+      Gap       = (UINT8 *)Tail;
+      GapOffset = (UINTN)Gap - (UINTN)mNvVariableCache;
+      GapSize   = (UINTN)Variable - (UINTN)Gap;
+    }
+  }
+
+  if (Truncate && (Split == 0)) {
+    //
+    // Nothing follows the gap, erase it.
+    //
+    SetMem (Gap + MovedSize, GapSize, 0xff);
+    WriteSize = MovedSize + GapSize;
+  } else if (GapSize >= PadSize) {
+    //
+    // Cover the gap up to the first variable that was not moved.
+    //
+    Pad = (VARIABLE_HEADER *)(Gap + MovedSize);
+    ZeroMem (Pad, HeaderSize + sizeof (CHAR16));
+    Pad->StartId = VARIABLE_DATA;
+    Pad->State   = VAR_ADDED & VAR_DELETED;
+    SetNameSizeOfVariable (Pad, sizeof (CHAR16), AuthFormat);
+    SetDataSizeOfVariable (Pad, (UINT32)(GapSize - PadSize), AuthFormat);
+    ASSERT (GetNextVariablePtr (Pad, AuthFormat) == Variable);
+    WriteSize = MovedSize + HeaderSize + sizeof (CHAR16);
+  } else {
+    //
+    // Only a corrupted variable can be smaller than the pad.
+    //
+    Status = EFI_VOLUME_CORRUPTED;
+    goto Restore;
+  }
+
+  Status = FtwVariableRegion (
+             mVariableModuleGlobal->VariableGlobal.NonVolatileVariableBase + GapOffset,
+             WriteSize,
+             Gap
+             );
+  if (EFI_ERROR (Status)) {
+    goto Restore;
+  }
+
+  VariableIndexInvalidate (mNvVariableCache);
+  if (Truncate) {
+    //
+    // The end of the store moved, recount the variables.
+    //
+    mVariableModuleGlobal->HwErrVariableTotalSize      = 0;
+    mVariableModuleGlobal->CommonVariableTotalSize     = 0;
+    mVariableModuleGlobal->CommonUserVariableTotalSize = 0;
+    Variable                                           = GetStartPointer (mNvVariableCache);
+    while (IsValidVariableHeader (Variable, StoreEnd)) {
+      NextVariable = GetNextVariablePtr (Variable, AuthFormat);
+      VariableSize = (UINTN)NextVariable - (UINTN)Variable;
+      if ((Variable->Attributes & EFI_VARIABLE_HARDWARE_ERROR_RECORD) == EFI_VARIABLE_HARDWARE_ERROR_RECORD) {
+        mVariableModuleGlobal->HwErrVariableTotalSize += VariableSize;
+      } else {
+        mVariableModuleGlobal->CommonVariableTotalSize += VariableSize;
+        if (IsUserVariable (Variable)) {
+          mVariableModuleGlobal->CommonUserVariableTotalSize += VariableSize;
+        }
+      }
+
+      Variable = NextVariable;
+    }
+
+    mVariableModuleGlobal->NonVolatileLastVariableOffset = (UINTN)Variable - (UINTN)mNvVariableCache;
+    mNvVariableStoreCompacted                            = Compacted;
+  }
+
+  RecordReclaimInfo (L"IncrementalReclaim", GapOffset, WriteSize, (Truncate && (Split == 0)) ? GapSize : 0);
+
+  InvalidateRuntimeVariableCacheLayout ();
+  Status = SynchronizeRuntimeVariableCache (
+             &mVariableModuleGlobal->VariableGlobal.VariableRuntimeCacheContext.VariableRuntimeNvCache,
+             GapOffset,
+             WriteSize
+             );
+  ASSERT_EFI_ERROR (Status);
+  return Status;
+
+Restore:
+  //
+  // The NV cache is a copy of the flash, take back the moved variables.
+  //
+  CopyMem (
+    Gap,
+    (UINT8 *)(UINTN)mVariableModuleGlobal->VariableGlobal.NonVolatileVariableBase + GapOffset,
+    (UINTN)Variable - (UINTN)Gap
+    );
+  return Status;
+}
+
+/**
+  Begin a batch of non-volatile variable updates.
+
+  Until VariableBatchEnd() is called, non-volatile variable updates are only
+  made to the NV cache, and the non-volatile variable store is not reclaimed.
+  The store is reclaimed here instead if it cannot take RequiredSize bytes.
+
+  @param[in] RequiredSize       The estimated size of the variables to write.
+
+  @retval EFI_SUCCESS           The batch has begun.
+  @retval EFI_UNSUPPORTED       The store is emulated or cannot be written yet.
+  @retval EFI_ALREADY_STARTED   A batch is in progress.
+  @retval Others                The store could not be reclaimed.
+
+**/
+EFI_STATUS
+VariableBatchBegin (
+  IN UINTN  RequiredSize
+  )
+{
+  EFI_STATUS  Status;
+
+  if (mVariableBatch.Active) {
+    return EFI_ALREADY_STARTED;
+  }
+
+  //
+  // An emulated store has no copy to roll the batch back from.
+  //
+  if (mVariableModuleGlobal->VariableGlobal.EmuNvMode || (mVariableModuleGlobal->FvbInstance == NULL)) {
+    return EFI_UNSUPPORTED;
+  }
+
+  if (!AtRuntime () &&
+      (RequiredSize > mNvVariableCache->Size - mVariableModuleGlobal->NonVolatileLastVariableOffset))
+  {
+    Status = Reclaim (
+               mVariableModuleGlobal->VariableGlobal.NonVolatileVariableBase,
+               &mVariableModuleGlobal->NonVolatileLastVariableOffset,
+               FALSE,
+               NULL,
+               NULL,
+               0
+               );
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+  }
+
+  mVariableBatch.DirtyStart                    = MAX_UINTN;
+  mVariableBatch.DirtyEnd                      = 0;
+  mVariableBatch.NonVolatileLastVariableOffset = mVariableModuleGlobal->NonVolatileLastVariableOffset;
+  mVariableBatch.CommonVariableTotalSize       = mVariableModuleGlobal->CommonVariableTotalSize;
+  mVariableBatch.CommonUserVariableTotalSize   = mVariableModuleGlobal->CommonUserVariableTotalSize;
+  mVariableBatch.HwErrVariableTotalSize        = mVariableModuleGlobal->HwErrVariableTotalSize;
+  mVariableBatch.Active                        = TRUE;
+
+  return EFI_SUCCESS;
+}
+
+/**
+  End a batch of non-volatile variable updates.
+
+  The part of the NV cache changed by the batch is written to the store with
+  one FTW write, so the store holds either all or none of the updates. If the
+  batch is not committed or the write fails, the NV cache is restored from the
+  store.
+
+  @param[in] Commit             TRUE to write the updates to the store, FALSE to
+                                discard them.
+
+  @retval EFI_SUCCESS           The updates were written or discarded.
+  @retval EFI_NOT_STARTED       No batch is in progress.
+  @retval Others                The updates could not be written, they were
+                                discarded.
+
+**/
+EFI_STATUS
+VariableBatchEnd (
+  IN BOOLEAN  Commit
+  )
+{
+  EFI_STATUS  Status;
+  EFI_STATUS  SyncStatus;
+  UINTN       Length;
+
+  if (!mVariableBatch.Active) {
+    return EFI_NOT_STARTED;
+  }
+
+  mVariableBatch.Active = FALSE;
+  if (mVariableBatch.DirtyEnd <= mVariableBatch.DirtyStart) {
+    return EFI_SUCCESS;
+  }
+
+  Length = mVariableBatch.DirtyEnd - mVariableBatch.DirtyStart;
+  Status = EFI_SUCCESS;
+  if (Commit) {
+    Status = FtwVariableRegion (
+               mVariableModuleGlobal->VariableGlobal.NonVolatileVariableBase + mVariableBatch.DirtyStart,
+               Length,
+               (UINT8 *)mNvVariableCache + mVariableBatch.DirtyStart
+               );
+  }
+
+  if (!Commit || EFI_ERROR (Status)) {
+    CopyMem (
+      (UINT8 *)mNvVariableCache + mVariableBatch.DirtyStart,
+      (UINT8 *)(UINTN)mVariableModuleGlobal->VariableGlobal.NonVolatileVariableBase + mVariableBatch.DirtyStart,
+      Length
+      );
+    mVariableModuleGlobal->NonVolatileLastVariableOffset = mVariableBatch.NonVolatileLastVariableOffset;
+    mVariableModuleGlobal->CommonVariableTotalSize       = mVariableBatch.CommonVariableTotalSize;
+    mVariableModuleGlobal->CommonUserVariableTotalSize   = mVariableBatch.CommonUserVariableTotalSize;
+    mVariableModuleGlobal->HwErrVariableTotalSize        = mVariableBatch.HwErrVariableTotalSize;
+    VariableIndexInvalidate (mNvVariableCache);
+  }
+
+  SyncStatus = SynchronizeRuntimeVariableCache (
+                 &mVariableModuleGlobal->VariableGlobal.VariableRuntimeCacheContext.VariableRuntimeNvCache,
+                 mVariableBatch.DirtyStart,
+                 Length
+                 );
+  ASSERT_EFI_ERROR (SyncStatus);
+
+  return Status;
+}
+
 /**
   Finds variable in storage blocks of volatile and non-volatile storage areas.
 
@@ -2131,6 +2605,14 @@ UpdateVariable (
         goto Done;
       }
 
+      if (mVariableBatch.Active) {
+        //
+        // Reclaim writes the store, which would commit part of the batch.
+        //
+        Status = EFI_OUT_OF_RESOURCES;
+        goto Done;
+      }
+
       //
       // Perform garbage collection & reclaim operation, and integrate the new variable at the same time.
       //
@@ -2393,7 +2875,13 @@ Done:
       VolatileCacheInstance = &(mVariableModuleGlobal->VariableGlobal.VariableRuntimeCacheContext.VariableRuntimeVolatileCache);
     }
 
-    if (VolatileCacheInstance->Store != NULL) {
+    //
+    // The runtime cache gets the updates of a batch when the batch ends, so
+    // readers never see part of a batch.
+    //
+    if ((VolatileCacheInstance->Store != NULL) &&
+        !(mVariableBatch.Active && (VolatileCacheInstance == &(mVariableModuleGlobal->VariableGlobal.VariableRuntimeCacheContext.VariableRuntimeNvCache))))
+    {
       Status =  SynchronizeRuntimeVariableCache (
                   VolatileCacheInstance,
                   0,
@@ -3200,6 +3688,37 @@ VariableServiceQueryVariableInfo (
   return Status;
 }
 
+/**
+  Check if the free area of the non-volatile variable store is below the
+  threshold that triggers a reclaim for the OS.
+
+  @retval TRUE              The free area is below the threshold.
+  @retval FALSE             The free area is enough.
+
+**/
+STATIC
+BOOLEAN
+IsVariableSpaceBelowThreshold (
+  VOID
+  )
+{
+  UINTN  RemainingCommonRuntimeVariableSpace;
+  UINTN  RemainingHwErrVariableSpace;
+
+  if (mVariableModuleGlobal->CommonRuntimeVariableSpace < mVariableModuleGlobal->CommonVariableTotalSize) {
+    RemainingCommonRuntimeVariableSpace = 0;
+  } else {
+    RemainingCommonRuntimeVariableSpace = mVariableModuleGlobal->CommonRuntimeVariableSpace - mVariableModuleGlobal->CommonVariableTotalSize;
+  }
+
+  RemainingHwErrVariableSpace = PcdGet32 (PcdHwErrStorageSize) - mVariableModuleGlobal->HwErrVariableTotalSize;
+
+  return (BOOLEAN)(((RemainingCommonRuntimeVariableSpace < mVariableModuleGlobal->MaxVariableSize) ||
+                    (RemainingCommonRuntimeVariableSpace < mVariableModuleGlobal->MaxAuthVariableSize)) ||
+                   ((PcdGet32 (PcdHwErrStorageSize) != 0) &&
+                    (RemainingHwErrVariableSpace < PcdGet32 (PcdMaxHardwareErrorVariableSize))));
+}
+
 /**
   This function reclaims variable storage if free size is below the threshold.
 
@@ -3213,9 +3732,8 @@ ReclaimForOS (
   )
 {
   EFI_STATUS      Status;
-  UINTN           RemainingCommonRuntimeVariableSpace;
-  UINTN           RemainingHwErrVariableSpace;
   STATIC BOOLEAN  Reclaimed;
+  UINTN           Step;
 
   //
   // This function will be called only once at EndOfDxe or ReadyToBoot event.
@@ -3226,24 +3744,28 @@ ReclaimForOS (
 
   Reclaimed = TRUE;
 
-  Status = EFI_SUCCESS;
+  if (FeaturePcdGet (PcdEnableVariableIncrementalReclaim)) {
+    //
+    // Compacting a region at a time only rewrites the blocks from the first
+    // deleted variable on. Past a few steps one FTW write of the whole store
+    // is cheaper, fall back to it if the steps were not enough.
+    //
+    for (Step = 0; Step < INCREMENTAL_RECLAIM_FOR_OS_STEPS; Step++) {
+      if (!IsVariableSpaceBelowThreshold ()) {
+        return;
+      }
 
-  if (mVariableModuleGlobal->CommonRuntimeVariableSpace < mVariableModuleGlobal->CommonVariableTotalSize) {
-    RemainingCommonRuntimeVariableSpace = 0;
-  } else {
-    RemainingCommonRuntimeVariableSpace = mVariableModuleGlobal->CommonRuntimeVariableSpace - mVariableModuleGlobal->CommonVariableTotalSize;
+      Status = IncrementalReclaim (INCREMENTAL_RECLAIM_FOR_OS_BLOCKS);
+      if (EFI_ERROR (Status)) {
+        break;
+      }
+    }
   }
 
-  RemainingHwErrVariableSpace = PcdGet32 (PcdHwErrStorageSize) - mVariableModuleGlobal->HwErrVariableTotalSize;
-
   //
   // Check if the free area is below a threshold.
   //
-  if (((RemainingCommonRuntimeVariableSpace < mVariableModuleGlobal->MaxVariableSize) ||
-       (RemainingCommonRuntimeVariableSpace < mVariableModuleGlobal->MaxAuthVariableSize)) ||
-      ((PcdGet32 (PcdHwErrStorageSize) != 0) &&
-       (RemainingHwErrVariableSpace < PcdGet32 (PcdMaxHardwareErrorVariableSize))))
-  {
+  if (IsVariableSpaceBelowThreshold ()) {
     Status = Reclaim (
                mVariableModuleGlobal->VariableGlobal.NonVolatileVariableBase,
                &mVariableModuleGlobal->NonVolatileLastVariableOffset,
@@ -3281,9 +3803,114 @@ GetMaxVariableSize (
   return MaxVariableSize;
 }
 
+/**
+  Append a HOB variable that has no non-volatile copy to the NV cache, as part
+  of the batch that flushes the HOB variables.
+
+  The HOB variable is already in the format of the non-volatile store, so it is
+  copied as is instead of being rebuilt by UpdateVariable(). A HOB variable that
+  does not pass the checks of SetVariable() or that does not fit is left to
+  UpdateVariable().
+
+  @param[in] Variable           The HOB variable.
+
+  @retval TRUE                  The variable was appended.
+  @retval FALSE                 The variable was not appended.
+
+**/
+BOOLEAN
+AppendHobVariable (
+  IN VARIABLE_HEADER  *Variable
+  )
+{
+  EFI_STATUS  Status;
+  BOOLEAN     AuthFormat;
+  CHAR16      *VariableName;
+  UINTN       NameSize;
+  UINTN       DataSize;
+  UINTN       VarSize;
+  UINTN       MaxVariableSize;
+  BOOLEAN     IsCommonVariable;
+  BOOLEAN     IsCommonUserVariable;
+
+  AuthFormat   = mVariableModuleGlobal->VariableGlobal.AuthFormat;
+  VariableName = GetVariableNamePtr (Variable, AuthFormat);
+  NameSize     = NameSizeOfVariable (Variable, AuthFormat);
+  DataSize     = DataSizeOfVariable (Variable, AuthFormat);
+  if ((NameSize < sizeof (CHAR16)) || (VariableName[NameSize / sizeof (CHAR16) - 1] != L'\0') ||
+      ((Variable->Attributes & EFI_VARIABLE_NON_VOLATILE) == 0))
+  {
+    return FALSE;
+  }
+
+  if ((Variable->Attributes & EFI_VARIABLE_HARDWARE_ERROR_RECORD) == EFI_VARIABLE_HARDWARE_ERROR_RECORD) {
+    MaxVariableSize = PcdGet32 (PcdMaxHardwareErrorVariableSize);
+  } else if ((Variable->Attributes & VARIABLE_ATTRIBUTE_AT_AW) != 0) {
+    MaxVariableSize = mVariableModuleGlobal->MaxAuthVariableSize;
+  } else {
+    MaxVariableSize = mVariableModuleGlobal->MaxVariableSize;
+  }
+
+  VarSize = (UINTN)GetVariableDataPtr (Variable, AuthFormat) + DataSize + GET_PAD_SIZE (DataSize) - (UINTN)Variable;
+  if (VarSize > MaxVariableSize) {
+    return FALSE;
+  }
+
+  IsCommonVariable     = FALSE;
+  IsCommonUserVariable = FALSE;
+  if ((Variable->Attributes & EFI_VARIABLE_HARDWARE_ERROR_RECORD) == 0) {
+    IsCommonVariable     = TRUE;
+    IsCommonUserVariable = IsUserVariable (Variable);
+  }
+
+  if (  (  ((Variable->Attributes & EFI_VARIABLE_HARDWARE_ERROR_RECORD) != 0)
+        && ((VarSize + mVariableModuleGlobal->HwErrVariableTotalSize) > PcdGet32 (PcdHwErrStorageSize)))
+     || (IsCommonVariable && ((VarSize + mVariableModuleGlobal->CommonVariableTotalSize) > mVariableModuleGlobal->CommonVariableSpace))
+     || (IsCommonUserVariable && ((VarSize + mVariableModuleGlobal->CommonUserVariableTotalSize) > mVariableModuleGlobal->CommonMaxUserVariableSpace))
+     || (VarSize > mNvVariableCache->Size - mVariableModuleGlobal->NonVolatileLastVariableOffset))
+  {
+    return FALSE;
+  }
+
+  //
+  // Within a batch this only records the range to write to flash.
+  //
+  Status = UpdateVariableStore (
+             &mVariableModuleGlobal->VariableGlobal,
+             FALSE,
+             TRUE,
+             mVariableModuleGlobal->FvbInstance,
+             mVariableModuleGlobal->NonVolatileLastVariableOffset,
+             (UINT32)VarSize,
+             (UINT8 *)Variable
+             );
+  if (EFI_ERROR (Status)) {
+    return FALSE;
+  }
+
+  CopyMem ((UINT8 *)mNvVariableCache + mVariableModuleGlobal->NonVolatileLastVariableOffset, Variable, VarSize);
+  mVariableModuleGlobal->NonVolatileLastVariableOffset += HEADER_ALIGN (VarSize);
+
+  if ((Variable->Attributes & EFI_VARIABLE_HARDWARE_ERROR_RECORD) != 0) {
+    mVariableModuleGlobal->HwErrVariableTotalSize += HEADER_ALIGN (VarSize);
+  } else {
+    mVariableModuleGlobal->CommonVariableTotalSize += HEADER_ALIGN (VarSize);
+    if (IsCommonUserVariable) {
+      mVariableModuleGlobal->CommonUserVariableTotalSize += HEADER_ALIGN (VarSize);
+    }
+  }
+
+  UpdateVariableInfo (VariableName, GetVendorGuidPtr (Variable, AuthFormat), FALSE, FALSE, TRUE, FALSE, FALSE, &gVariableInfo);
+  return TRUE;
+}
+
 /**
   Flush the HOB variable to flash.
 
+  When all the HOB variables are flushed, they are written to flash as one
+  batch, so the store takes one FTW write instead of a series of writes for
+  every variable.
+
   @param[in] VariableName       Name of variable has been updated or deleted.
   @param[in] VendorGuid         Guid of variable has been updated or deleted.
 
@@ -3301,6 +3928,8 @@ FlushHobVariableToFlash (
   VARIABLE_POINTER_TRACK  VariablePtrTrack;
   BOOLEAN                 ErrorFlag;
   BOOLEAN                 AuthFormat;
+  BOOLEAN                 Batched;
+  UINTN                   RequiredSize;
 
   ErrorFlag  = FALSE;
   AuthFormat = mVariableModuleGlobal->VariableGlobal.AuthFormat;
@@ -3309,11 +3938,30 @@ FlushHobVariableToFlash (
   // Flush the HOB variable to flash.
   //
   if (mVariableModuleGlobal->VariableGlobal.HobVariableBase != 0) {
+    PERF_INMODULE_BEGIN ("FlushHobVariable");
+
     VariableStoreHeader = (VARIABLE_STORE_HEADER *)(UINTN)mVariableModuleGlobal->VariableGlobal.HobVariableBase;
     //
     // Set HobVariableBase to 0, it can avoid SetVariable to call back.
     //
     mVariableModuleGlobal->VariableGlobal.HobVariableBase = 0;
+
+    Batched = FALSE;
+    if ((VariableName == NULL) && (VendorGuid == NULL)) {
+      RequiredSize = 0;
+      for ( Variable = GetStartPointer (VariableStoreHeader)
+            ; IsValidVariableHeader (Variable, GetEndPointer (VariableStoreHeader))
+            ; Variable = GetNextVariablePtr (Variable, AuthFormat)
+            )
+      {
+        if (Variable->State == VAR_ADDED) {
+          RequiredSize += (UINTN)GetNextVariablePtr (Variable, AuthFormat) - (UINTN)Variable;
+        }
+      }
+
+      Batched = (BOOLEAN)!EFI_ERROR (VariableBatchBegin (RequiredSize));
+    }
+
     for ( Variable = GetStartPointer (VariableStoreHeader)
           ; IsValidVariableHeader (Variable, GetEndPointer (VariableStoreHeader))
           ; Variable = GetNextVariablePtr (Variable, AuthFormat)
@@ -3339,17 +3987,22 @@ FlushHobVariableToFlash (
           &mVariableModuleGlobal->VariableGlobal,
           FALSE
           );
-        Status = UpdateVariable (
-                   GetVariableNamePtr (Variable, AuthFormat),
-                   GetVendorGuidPtr (Variable, AuthFormat),
-                   VariableData,
-                   DataSizeOfVariable (Variable, AuthFormat),
-                   Variable->Attributes,
-                   0,
-                   0,
-                   &VariablePtrTrack,
-                   NULL
-                   );
+        if (Batched && (VariablePtrTrack.CurrPtr == NULL) && AppendHobVariable (Variable)) {
+          Status = EFI_SUCCESS;
+        } else {
+          Status = UpdateVariable (
+                     GetVariableNamePtr (Variable, AuthFormat),
+                     GetVendorGuidPtr (Variable, AuthFormat),
+                     VariableData,
+                     DataSizeOfVariable (Variable, AuthFormat),
+                     Variable->Attributes,
+                     0,
+                     0,
+                     &VariablePtrTrack,
+                     NULL
+                     );
+        }
+
         DEBUG ((
           DEBUG_INFO,
           "Variable driver flush the HOB variable to flash: %g %s %r\n",
@@ -3366,7 +4019,12 @@ FlushHobVariableToFlash (
         Status = EFI_SUCCESS;
       }
 
-      if (!EFI_ERROR (Status)) {
+      if (!EFI_ERROR (Status) && Batched) {
+        //
+        // The variable only reaches flash with the rest of the batch.
+        //
+        Variable->State &= VAR_IN_DELETED_TRANSITION;
+      } else if (!EFI_ERROR (Status)) {
         //
         // If set variable successful, or the updated or deleted variable is matched with the HOB variable,
         // set the HOB variable to DELETED state in local.
@@ -3383,6 +4041,32 @@ FlushHobVariableToFlash (
       }
     }
 
+    if (Batched) {
+      Status = VariableBatchEnd (TRUE);
+      if (EFI_ERROR (Status)) {
+        DEBUG ((DEBUG_ERROR, "Variable driver failed to flush the HOB variables to flash: %r\n", Status));
+        ErrorFlag = TRUE;
+      }
+
+      //
+      // Delete the HOB variables written by the batch, or take them back if
+      // the batch could not be written.
+      //
+      for ( Variable = GetStartPointer (VariableStoreHeader)
+            ; IsValidVariableHeader (Variable, GetEndPointer (VariableStoreHeader))
+            ; Variable = GetNextVariablePtr (Variable, AuthFormat)
+            )
+      {
+        if (Variable->State == (VAR_ADDED & VAR_IN_DELETED_TRANSITION)) {
+          if (EFI_ERROR (Status)) {
+            Variable->State = VAR_ADDED;
+          } else {
+            Variable->State &= VAR_DELETED;
+          }
+        }
+      }
+    }
+
     if (mVariableModuleGlobal->VariableGlobal.VariableRuntimeCacheContext.VariableRuntimeHobCache.Store != NULL) {
       Status =  SynchronizeRuntimeVariableCache (
                   &mVariableModuleGlobal->VariableGlobal.VariableRuntimeCacheContext.VariableRuntimeHobCache,
@@ -3406,10 +4090,13 @@ FlushHobVariableToFlash (
         *(mVariableModuleGlobal->VariableGlobal.VariableRuntimeCacheContext.HobFlushComplete) = TRUE;
       }
 
+      VariableIndexUnregisterStore (VariableStoreHeader);
       if (!AtRuntime ()) {
         FreePool ((VOID *)VariableStoreHeader);
       }
     }
+
+    PERF_INMODULE_END ("FlushHobVariable");
   }
 }
 
@@ -3805,6 +4492,18 @@ VariableCommonInitialize (
   VolatileVariableStore->Reserved  = 0;
   VolatileVariableStore->Reserved1 = 0;
 
+  //
+  // Index the variable stores that FindVariable() searches.
+  //
+  VariableIndexRegisterStore (VolatileVariableStore, VolatileVariableStore->Size);
+  VariableIndexRegisterStore (mNvVariableCache, mNvVariableCache->Size);
+  if (mVariableModuleGlobal->VariableGlobal.HobVariableBase != 0) {
+    VariableIndexRegisterStore (
+      (VARIABLE_STORE_HEADER *)(UINTN)mVariableModuleGlobal->VariableGlobal.HobVariableBase,
+      ((VARIABLE_STORE_HEADER *)(UINTN)mVariableModuleGlobal->VariableGlobal.HobVariableBase)->Size
+      );
+  }
+
   return EFI_SUCCESS;
 }
 
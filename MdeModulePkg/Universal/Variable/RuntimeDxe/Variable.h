@@ -33,6 +33,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/VarCheckLib.h>
 #include <Library/VariableFlashInfoLib.h>
 #include <Library/SafeIntLib.h>
+#include <Library/PerformanceLib.h>
 #include <Guid/GlobalVariable.h>
 #include <Guid/EventGroup.h>
 #include <Guid/VariableFormat.h>
@@ -54,6 +55,15 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 ///
 #define ISO_639_2_ENTRY_SIZE  3
 
+///
+/// The flash blocks written by one step of IncrementalReclaim() on the idle
+/// loop and by ReclaimForOS(), and the count of steps ReclaimForOS() takes
+/// before it reclaims the whole store instead.
+///
+#define INCREMENTAL_RECLAIM_IDLE_BLOCKS    2
+#define INCREMENTAL_RECLAIM_FOR_OS_BLOCKS  8
+#define INCREMENTAL_RECLAIM_FOR_OS_STEPS   4
+
 typedef enum {
   VariableStoreTypeVolatile,
   VariableStoreTypeHob,
@@ -71,6 +81,9 @@ typedef struct {
   BOOLEAN                   *ReadLock;
   BOOLEAN                   *PendingUpdate;
   BOOLEAN                   *HobFlushComplete;
+  volatile UINT32           *Sequence;
+  volatile UINT32           *Generation;
+  BOOLEAN                   GenerationPending;
   VARIABLE_RUNTIME_CACHE    VariableRuntimeHobCache;
   VARIABLE_RUNTIME_CACHE    VariableRuntimeNvCache;
   VARIABLE_RUNTIME_CACHE    VariableRuntimeVolatileCache;
@@ -123,6 +136,25 @@ typedef struct {
   EFI_FIRMWARE_VOLUME_BLOCK_PROTOCOL    *FvbInstance;
 } VARIABLE_MODULE_GLOBAL;
 
+typedef struct {
+  ///
+  /// TRUE while non-volatile variable updates are kept in the NV cache only.
+  ///
+  BOOLEAN    Active;
+  ///
+  /// The range of the non-volatile variable store changed by the batch.
+  ///
+  UINTN      DirtyStart;
+  UINTN      DirtyEnd;
+  ///
+  /// The state of the store when the batch began, to roll the batch back.
+  ///
+  UINTN      NonVolatileLastVariableOffset;
+  UINTN      CommonVariableTotalSize;
+  UINTN      CommonUserVariableTotalSize;
+  UINTN      HwErrVariableTotalSize;
+} VARIABLE_BATCH;
+
 /**
   Flush the HOB variable to flash.
 
@@ -157,6 +189,28 @@ FtwVariableSpace (
   IN VARIABLE_STORE_HEADER  *VariableBuffer
   );
 
+/**
+  Writes a buffer to a range of the variable storage space.
+
+  Fault Tolerant Write protocol is used for writing, so an interrupted write
+  leaves either the old or the new content in the whole range.
+
+  @param  Address        Address of the range to write.
+  @param  Length         Length of the range in bytes.
+  @param  Buffer         Point to the data to write.
+
+  @retval EFI_SUCCESS    The function completed successfully.
+  @retval EFI_NOT_FOUND  Fail to locate Fault Tolerant Write protocol.
+  @retval EFI_ABORTED    The function could not complete successfully.
+
+**/
+EFI_STATUS
+FtwVariableRegion (
+  IN EFI_PHYSICAL_ADDRESS  Address,
+  IN UINTN                 Length,
+  IN VOID                  *Buffer
+  );
+
 /**
   Finds variable in storage blocks of volatile and non-volatile storage areas.
 
@@ -377,6 +431,75 @@ ReclaimForOS (
   VOID
   );
 
+/**
+  Compact one region of the non-volatile variable store.
+
+  The valid variables that follow the first deleted variable of the store are
+  moved down over the deleted variables, and the rest of the gap is covered by
+  one deleted variable so the store can still be walked. The variables moved
+  fill the flash blocks from the one that holds the start of the gap up to a
+  block boundary, so no block is left partly rewritten for the next step. The
+  region is written with one FTW write, so an interrupted step leaves the store
+  as it was before or after the step. Once the gap reaches the end of the store,
+  it is erased and becomes free space.
+
+  @param[in] StepBlocks         The count of flash blocks to fill, counting the
+                                one that holds the start of the gap. More are
+                                filled if the first variable to move needs them.
+
+  @retval EFI_SUCCESS           One region was compacted.
+  @retval EFI_NOT_FOUND         The store holds no deleted variables.
+  @retval EFI_UNSUPPORTED       The store is emulated or cannot be written yet.
+  @retval Others                The region could not be written.
+
+**/
+EFI_STATUS
+IncrementalReclaim (
+  IN UINTN  StepBlocks
+  );
+
+/**
+  Begin a batch of non-volatile variable updates.
+
+  Until VariableBatchEnd() is called, non-volatile variable updates are only
+  made to the NV cache, and the non-volatile variable store is not reclaimed.
+  The store is reclaimed here instead if it cannot take RequiredSize bytes.
+
+  @param[in] RequiredSize       The estimated size of the variables to write.
+
+  @retval EFI_SUCCESS           The batch has begun.
+  @retval EFI_UNSUPPORTED       The store is emulated or cannot be written yet.
+  @retval EFI_ALREADY_STARTED   A batch is in progress.
+  @retval Others                The store could not be reclaimed.
+
+**/
+EFI_STATUS
+VariableBatchBegin (
+  IN UINTN  RequiredSize
+  );
+
+/**
+  End a batch of non-volatile variable updates.
+
+  The part of the NV cache changed by the batch is written to the store with
+  one FTW write, so the store holds either all or none of the updates. If the
+  batch is not committed or the write fails, the NV cache is restored from the
+  store.
+
+  @param[in] Commit             TRUE to write the updates to the store, FALSE to
+                                discard them.
+
+  @retval EFI_SUCCESS           The updates were written or discarded.
+  @retval EFI_NOT_STARTED       No batch is in progress.
+  @retval Others                The updates could not be written, they were
+                                discarded.
+
+**/
+EFI_STATUS
+VariableBatchEnd (
+  IN BOOLEAN  Commit
+  );
+
 /**
   Get maximum variable size, covering both non-volatile and volatile variables.
 
@@ -11,10 +11,17 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 **/
 
 #include "Variable.h"
+#include "VariableParsing.h"
 
+#include <Guid/IdleLoopEvent.h>
 #include <Protocol/VariablePolicy.h>
 #include <Library/VariablePolicyLib.h>
 
+//
+// The least time between two steps of the reclaim on the idle loop.
+//
+#define IDLE_RECLAIM_INTERVAL  EFI_TIMER_PERIOD_SECONDS (1)
+
 EFI_STATUS
 EFIAPI
 ProtocolIsVariablePolicyEnabled (
@@ -23,6 +30,8 @@ ProtocolIsVariablePolicyEnabled (
 
 EFI_HANDLE                      mHandle                      = NULL;
 EFI_EVENT                       mVirtualAddressChangeEvent   = NULL;
+EFI_EVENT                       mIdleReclaimEvent            = NULL;
+EFI_EVENT                       mIdleReclaimTimerEvent       = NULL;
 VOID                            *mFtwRegistration            = NULL;
 VOID                            ***mVarCheckAddressPointer   = NULL;
 UINTN                           mVarCheckAddressPointerCount = 0;
@@ -265,6 +274,7 @@ VariableClassAddressChangeEvent (
   EfiConvertPointer (0x0, (VOID **)&mVariableModuleGlobal);
   EfiConvertPointer (0x0, (VOID **)&mNvVariableCache);
   EfiConvertPointer (0x0, (VOID **)&mNvFvHeaderCache);
+  VariableIndexConvertPointers (EfiConvertPointer);
 
   if (mAuthContextOut.AddressPointer != NULL) {
     for (Index = 0; Index < mAuthContextOut.AddressPointerCount; Index++) {
@@ -362,6 +372,41 @@ OnEndOfDxe (
   gBS->CloseEvent (Event);
 }
 
+/**
+  Notification function of the idle loop event group.
+
+  Compact one region of the non-volatile variable store while the system is
+  idle, once less than a quarter of the store is free, so that the store does
+  not fill up with deleted variables. The idle loop runs far more often than
+  the flash should be written, so a step is only taken once
+  IDLE_RECLAIM_INTERVAL has passed since the previous one.
+
+  @param  Event        Event whose notification function is being invoked.
+  @param  Context      Pointer to the notification function's context.
+
+**/
+VOID
+EFIAPI
+OnIdleReclaim (
+  EFI_EVENT  Event,
+  VOID       *Context
+  )
+{
+  if (mNvVariableCache->Size - mVariableModuleGlobal->NonVolatileLastVariableOffset > mNvVariableCache->Size / 4) {
+    return;
+  }
+
+  if (gBS->CheckEvent (mIdleReclaimTimerEvent) != EFI_SUCCESS) {
+    return;
+  }
+
+  AcquireLockOnlyAtBootTime (&mVariableModuleGlobal->VariableGlobal.VariableServicesLock);
+  IncrementalReclaim (INCREMENTAL_RECLAIM_IDLE_BLOCKS);
+  ReleaseLockOnlyAtBootTime (&mVariableModuleGlobal->VariableGlobal.VariableServicesLock);
+
+  gBS->SetTimer (mIdleReclaimTimerEvent, TimerRelative, IDLE_RECLAIM_INTERVAL);
+}
+
 /**
   Initializes variable write service for DXE.
 
@@ -376,6 +421,21 @@ VariableWriteServiceInitializeDxe (
   Status = VariableWriteServiceInitialize ();
   if (EFI_ERROR (Status)) {
     DEBUG ((DEBUG_ERROR, "Variable write service initialization failed. Status = %r\n", Status));
+  } else if (FeaturePcdGet (PcdEnableVariableIncrementalReclaim) && !mVariableModuleGlobal->VariableGlobal.EmuNvMode) {
+    Status = gBS->CreateEvent (EVT_TIMER, 0, NULL, NULL, &mIdleReclaimTimerEvent);
+    ASSERT_EFI_ERROR (Status);
+    Status = gBS->SetTimer (mIdleReclaimTimerEvent, TimerRelative, IDLE_RECLAIM_INTERVAL);
+    ASSERT_EFI_ERROR (Status);
+
+    Status = gBS->CreateEventEx (
+                    EVT_NOTIFY_SIGNAL,
+                    TPL_CALLBACK,
+                    OnIdleReclaim,
+                    NULL,
+                    &gIdleLoopEventGuid,
+                    &mIdleReclaimEvent
+                    );
+    ASSERT_EFI_ERROR (Status);
   }
 
   //
@@ -445,6 +445,528 @@ VariableCompareTimeStampInternal (
   return (BOOLEAN)(FirstTime->Second <= SecondTime->Second);
 }
 
+//
+// Variables are indexed at one entry per this many bytes of variable store.
+// A store that holds more variables than that falls back to the linear walk.
+//
+#define VARIABLE_INDEX_BYTES_PER_ENTRY  64
+
+///
+/// Name and GUID hash index of a variable store. The entries are the
+/// variables of the store in store order. Every bucket chains its entries in
+/// descending offset order, the links are entry numbers plus one.
+///
+typedef struct {
+  VARIABLE_STORE_HEADER    *Store;
+  UINT32                   *Bucket;
+  UINT32                   *Next;
+  UINT32                   *Offset;
+  UINT32                   *Hash;
+  UINT32                   BucketMask;
+  UINT32                   Capacity;
+  UINT32                   Count;
+  ///
+  /// Offset of the first variable that is not indexed yet, 0 if none is.
+  ///
+  UINT32                   IndexedEnd;
+  BOOLEAN                  AuthFormat;
+  BOOLEAN                  Overflow;
+} VARIABLE_STORE_INDEX;
+
+VARIABLE_STORE_INDEX  mVariableStoreIndex[VariableStoreTypeMax];
+
+/**
+  Check that the header, name and data of a variable lie in its store.
+
+  A runtime cache may be rewritten while it is read, so the sizes in a variable
+  header may be the ones of a partially written variable.
+
+  @param[in] Variable     The variable header.
+  @param[in] StoreEnd     The end of the variable store.
+  @param[in] AuthFormat   TRUE indicates authenticated variables are used.
+
+  @retval TRUE            The variable lies in the store.
+  @retval FALSE           The variable reaches past the end of the store.
+**/
+STATIC
+BOOLEAN
+VariableIndexIsInStore (
+  IN VARIABLE_HEADER  *Variable,
+  IN VARIABLE_HEADER  *StoreEnd,
+  IN BOOLEAN          AuthFormat
+  )
+{
+  UINTN  Size;
+  UINTN  NameSize;
+
+  if ((Variable >= StoreEnd) || ((UINTN)StoreEnd - (UINTN)Variable < GetVariableHeaderSize (AuthFormat))) {
+    return FALSE;
+  }
+
+  Size     = (UINTN)StoreEnd - (UINTN)Variable - GetVariableHeaderSize (AuthFormat);
+  NameSize = NameSizeOfVariable (Variable, AuthFormat);
+  if ((NameSize > Size) || (GET_PAD_SIZE (NameSize) > Size - NameSize)) {
+    return FALSE;
+  }
+
+  return (BOOLEAN)(DataSizeOfVariable (Variable, AuthFormat) <= Size - NameSize - GET_PAD_SIZE (NameSize));
+}
+
+/**
+  Compute the index hash of a variable name and vendor GUID.
+
+  @param[in] VendorGuid     The vendor GUID.
+  @param[in] VariableName   The variable name.
+  @param[in] NameSize       Size of the variable name in bytes.
+
+  @return The hash.
+**/
+STATIC
+UINT32
+VariableIndexHash (
+  IN CONST EFI_GUID  *VendorGuid,
+  IN CONST VOID      *VariableName,
+  IN UINTN           NameSize
+  )
+{
+  CONST UINT8  *Name;
+  UINT32       Hash;
+  UINTN        Index;
+
+  //
+  // FNV-1a over the name, then the words of the GUID
+  //
+  Name = VariableName;
+  Hash = 0x811c9dc5;
+  for (Index = 0; Index < NameSize; Index++) {
+    Hash = (Hash ^ Name[Index]) * 0x01000193;
+  }
+
+  for (Index = 0; Index < sizeof (EFI_GUID); Index += sizeof (UINT32)) {
+    Hash = (Hash ^ ReadUnaligned32 ((CONST UINT32 *)((CONST UINT8 *)VendorGuid + Index))) * 0x01000193;
+  }
+
+  return Hash ^ (Hash >> 16);
+}
+
+/**
+  Compute the index hash of a variable in a store.
+
+  @param[in] Variable     The variable header.
+  @param[in] AuthFormat   TRUE indicates authenticated variables are used.
+
+  @return The hash.
+**/
+STATIC
+UINT32
+VariableIndexHashVariable (
+  IN VARIABLE_HEADER  *Variable,
+  IN BOOLEAN          AuthFormat
+  )
+{
+  return VariableIndexHash (
+           GetVendorGuidPtr (Variable, AuthFormat),
+           GetVariableNamePtr (Variable, AuthFormat),
+           NameSizeOfVariable (Variable, AuthFormat)
+           );
+}
+
+/**
+  Drop all the entries of a variable store index.
+
+  @param[in, out] StoreIndex    The variable store index.
+**/
+STATIC
+VOID
+VariableIndexReset (
+  IN OUT VARIABLE_STORE_INDEX  *StoreIndex
+  )
+{
+  ZeroMem (StoreIndex->Bucket, (StoreIndex->BucketMask + 1) * sizeof (UINT32));
+  StoreIndex->Count      = 0;
+  StoreIndex->IndexedEnd = 0;
+  StoreIndex->Overflow   = FALSE;
+}
+
+/**
+  Check whether an indexed variable is still the one that was indexed.
+
+  @param[in] StoreIndex   The variable store index.
+  @param[in] Entry        The entry number.
+
+  @retval TRUE            The variable matches its entry.
+  @retval FALSE           The variable store was rewritten.
+**/
+STATIC
+BOOLEAN
+VariableIndexEntryIsValid (
+  IN VARIABLE_STORE_INDEX  *StoreIndex,
+  IN UINT32                Entry
+  )
+{
+  VARIABLE_HEADER  *Variable;
+
+  Variable = (VARIABLE_HEADER *)((UINT8 *)StoreIndex->Store + StoreIndex->Offset[Entry]);
+  return (BOOLEAN)(IsValidVariableHeader (Variable, GetEndPointer (StoreIndex->Store)) &&
+                   VariableIndexIsInStore (Variable, GetEndPointer (StoreIndex->Store), StoreIndex->AuthFormat) &&
+                   (VariableIndexHashVariable (Variable, StoreIndex->AuthFormat) == StoreIndex->Hash[Entry]));
+}
+
+/**
+  Bring a variable store index up to date with its store.
+
+  Variables are only appended to a store between reclaims, so the variables
+  added since the last call are indexed. A store that was rewritten, such as a
+  runtime cache that was reclaimed in MM, is detected by checking the first
+  and last indexed variables, and is indexed again.
+
+  A variable that reaches past the end of the store stops the indexing, as a
+  runtime cache that is being rewritten may hold one. The variables before it
+  stay indexed.
+
+  @param[in, out] StoreIndex      The variable store index.
+  @param[in]      AuthFormat      TRUE indicates authenticated variables are used.
+
+  @retval EFI_SUCCESS             The index covers all the variables of the store.
+  @retval EFI_OUT_OF_RESOURCES    The store holds too many variables to be indexed.
+  @retval EFI_VOLUME_CORRUPTED    A variable reaches past the end of the store.
+**/
+STATIC
+EFI_STATUS
+VariableIndexRefresh (
+  IN OUT VARIABLE_STORE_INDEX  *StoreIndex,
+  IN     BOOLEAN               AuthFormat
+  )
+{
+  VARIABLE_HEADER  *Variable;
+  VARIABLE_HEADER  *NextVariable;
+  VARIABLE_HEADER  *StoreEnd;
+  UINT32           Hash;
+  UINT32           Bucket;
+
+  if (StoreIndex->AuthFormat != AuthFormat) {
+    VariableIndexReset (StoreIndex);
+    StoreIndex->AuthFormat = AuthFormat;
+  } else if ((StoreIndex->Count != 0) &&
+             (!VariableIndexEntryIsValid (StoreIndex, 0) ||
+              !VariableIndexEntryIsValid (StoreIndex, StoreIndex->Count - 1) ||
+              ((UINTN)GetNextVariablePtr (
+                        (VARIABLE_HEADER *)((UINT8 *)StoreIndex->Store + StoreIndex->Offset[StoreIndex->Count - 1]),
+                        AuthFormat
+                        ) - (UINTN)StoreIndex->Store != StoreIndex->IndexedEnd)))
+  {
+    VariableIndexReset (StoreIndex);
+  }
+
+  if (StoreIndex->Overflow) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  StoreEnd = GetEndPointer (StoreIndex->Store);
+  if (StoreIndex->IndexedEnd == 0) {
+    Variable = GetStartPointer (StoreIndex->Store);
+  } else {
+    Variable = (VARIABLE_HEADER *)((UINT8 *)StoreIndex->Store + StoreIndex->IndexedEnd);
+  }
+
+  while (IsValidVariableHeader (Variable, StoreEnd)) {
+    if (!VariableIndexIsInStore (Variable, StoreEnd, AuthFormat)) {
+      return EFI_VOLUME_CORRUPTED;
+    }
+
+    NextVariable = GetNextVariablePtr (Variable, AuthFormat);
+    if ((Variable->State == VAR_HEADER_VALID_ONLY) && !IsValidVariableHeader (NextVariable, StoreEnd)) {
+      //
+      // The last variable may still be being written, index it once it is
+      // complete or followed by another variable.
+      //
+      break;
+    }
+
+    if (StoreIndex->Count == StoreIndex->Capacity) {
+      StoreIndex->Overflow = TRUE;
+      return EFI_OUT_OF_RESOURCES;
+    }
+
+    Hash                                  = VariableIndexHashVariable (Variable, AuthFormat);
+    Bucket                                = Hash & StoreIndex->BucketMask;
+    StoreIndex->Offset[StoreIndex->Count] = (UINT32)((UINTN)Variable - (UINTN)StoreIndex->Store);
+    StoreIndex->Hash[StoreIndex->Count]   = Hash;
+    StoreIndex->Next[StoreIndex->Count]   = StoreIndex->Bucket[Bucket];
+    StoreIndex->Count++;
+    StoreIndex->Bucket[Bucket] = StoreIndex->Count;
+    StoreIndex->IndexedEnd     = (UINT32)((UINTN)NextVariable - (UINTN)StoreIndex->Store);
+    Variable                   = NextVariable;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Find the index of the variable store searched by a variable pointer track.
+
+  @param[in] PtrTrack     The variable pointer track.
+
+  @return The variable store index, or NULL if the range of PtrTrack is not a
+          whole indexed variable store.
+**/
+STATIC
+VARIABLE_STORE_INDEX *
+VariableIndexFind (
+  IN VARIABLE_POINTER_TRACK  *PtrTrack
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < ARRAY_SIZE (mVariableStoreIndex); Index++) {
+    if ((mVariableStoreIndex[Index].Store != NULL) &&
+        (PtrTrack->StartPtr == GetStartPointer (mVariableStoreIndex[Index].Store)) &&
+        (PtrTrack->EndPtr == GetEndPointer (mVariableStoreIndex[Index].Store)))
+    {
+      return &mVariableStoreIndex[Index];
+    }
+  }
+
+  return NULL;
+}
+
+/**
+  Find a variable through the index of its variable store.
+
+  The result is the same as the one of the walk of FindVariableEx(): the first
+  added variable in store order, and the last variable in deleted transition
+  that precedes it.
+
+  @param[in]       StoreIndex          The index of the variable store of PtrTrack.
+  @param[in]       VariableName        Name of the variable to be found, not empty.
+  @param[in]       VendorGuid          Vendor GUID to be found.
+  @param[in]       IgnoreRtCheck       Ignore EFI_VARIABLE_RUNTIME_ACCESS attribute
+                                       check at runtime when searching variable.
+  @param[in, out]  PtrTrack            Variable Track Pointer structure that contains Variable Information.
+  @param[in]       AuthFormat          TRUE indicates authenticated variables are used.
+                                       FALSE indicates authenticated variables are not used.
+
+  @retval          EFI_SUCCESS         Variable found successfully
+  @retval          EFI_NOT_FOUND       Variable not found
+  @retval          EFI_VOLUME_CORRUPTED  An indexed variable now reaches past
+                                       the end of the store.
+**/
+STATIC
+EFI_STATUS
+FindVariableByIndex (
+  IN     VARIABLE_STORE_INDEX    *StoreIndex,
+  IN     CHAR16                  *VariableName,
+  IN     EFI_GUID                *VendorGuid,
+  IN     BOOLEAN                 IgnoreRtCheck,
+  IN OUT VARIABLE_POINTER_TRACK  *PtrTrack,
+  IN     BOOLEAN                 AuthFormat
+  )
+{
+  VARIABLE_HEADER  *Variable;
+  VARIABLE_HEADER  *AddedVariable;
+  VARIABLE_HEADER  *InDeletedVariable;
+  VARIABLE_HEADER  *StoreEnd;
+  UINT32           Hash;
+  UINT32           Link;
+  UINTN            Pass;
+
+  StoreEnd          = GetEndPointer (StoreIndex->Store);
+  Hash              = VariableIndexHash (VendorGuid, VariableName, StrSize (VariableName));
+  AddedVariable     = NULL;
+  InDeletedVariable = NULL;
+
+  //
+  // The chain is in descending store order. The first pass finds the added
+  // variable with the lowest offset, the second pass the variable in deleted
+  // transition with the highest offset below it.
+  //
+  for (Pass = 0; Pass < 2; Pass++) {
+    for (Link = StoreIndex->Bucket[Hash & StoreIndex->BucketMask]; Link != 0; Link = StoreIndex->Next[Link - 1]) {
+      if (StoreIndex->Hash[Link - 1] != Hash) {
+        continue;
+      }
+
+      Variable = (VARIABLE_HEADER *)((UINT8 *)StoreIndex->Store + StoreIndex->Offset[Link - 1]);
+      if (!VariableIndexIsInStore (Variable, StoreEnd, AuthFormat)) {
+        return EFI_VOLUME_CORRUPTED;
+      }
+
+      if (Pass == 0) {
+        if (Variable->State != VAR_ADDED) {
+          continue;
+        }
+      } else if ((Variable->State != (VAR_IN_DELETED_TRANSITION & VAR_ADDED)) ||
+                 ((AddedVariable != NULL) && (Variable >= AddedVariable)))
+      {
+        continue;
+      }
+
+      if (!IgnoreRtCheck && AtRuntime () && ((Variable->Attributes & EFI_VARIABLE_RUNTIME_ACCESS) == 0)) {
+        continue;
+      }
+
+      if (!CompareGuid (VendorGuid, GetVendorGuidPtr (Variable, AuthFormat))) {
+        continue;
+      }
+
+      ASSERT (NameSizeOfVariable (Variable, AuthFormat) != 0);
+      if (CompareMem (VariableName, GetVariableNamePtr (Variable, AuthFormat), NameSizeOfVariable (Variable, AuthFormat)) != 0) {
+        continue;
+      }
+
+      if (Pass == 0) {
+        AddedVariable = Variable;
+      } else {
+        InDeletedVariable = Variable;
+        break;
+      }
+    }
+  }
+
+  if (AddedVariable != NULL) {
+    PtrTrack->CurrPtr                = AddedVariable;
+    PtrTrack->InDeletedTransitionPtr = InDeletedVariable;
+    return EFI_SUCCESS;
+  }
+
+  PtrTrack->CurrPtr = InDeletedVariable;
+  return (PtrTrack->CurrPtr == NULL) ? EFI_NOT_FOUND : EFI_SUCCESS;
+}
+
+/**
+  Index a variable store by variable name and vendor GUID, so that
+  FindVariableEx() over the whole store does not walk it.
+
+  The index is kept up to date on lookups as variables are appended to the
+  store. Whoever rewrites the store in place, as reclaim does, must call
+  VariableIndexInvalidate(). The index memory is allocated here, so the store
+  must be registered before ExitBootServices().
+
+  @param[in] Store        The variable store.
+  @param[in] StoreSize    The size of the memory of the variable store.
+**/
+VOID
+VariableIndexRegisterStore (
+  IN VARIABLE_STORE_HEADER  *Store,
+  IN UINTN                  StoreSize
+  )
+{
+  VARIABLE_STORE_INDEX  *StoreIndex;
+  UINTN                 Index;
+  UINT32                Capacity;
+  UINT32                BucketCount;
+  UINT32                *Buffer;
+
+  if ((Store == NULL) || (StoreSize < sizeof (VARIABLE_STORE_HEADER)) || (StoreSize > MAX_UINT32)) {
+    return;
+  }
+
+  StoreIndex = NULL;
+  for (Index = 0; Index < ARRAY_SIZE (mVariableStoreIndex); Index++) {
+    if (mVariableStoreIndex[Index].Store == Store) {
+      return;
+    }
+
+    if ((StoreIndex == NULL) && (mVariableStoreIndex[Index].Store == NULL)) {
+      StoreIndex = &mVariableStoreIndex[Index];
+    }
+  }
+
+  if (StoreIndex == NULL) {
+    return;
+  }
+
+  Capacity    = (UINT32)MAX (StoreSize / VARIABLE_INDEX_BYTES_PER_ENTRY, 1);
+  BucketCount = GetPowerOfTwo32 (Capacity);
+  Buffer      = AllocateRuntimePool ((BucketCount + 3 * Capacity) * sizeof (UINT32));
+  if (Buffer == NULL) {
+    //
+    // Lookups in this store walk it.
+    //
+    return;
+  }
+
+  StoreIndex->Store      = Store;
+  StoreIndex->Bucket     = Buffer;
+  StoreIndex->Next       = StoreIndex->Bucket + BucketCount;
+  StoreIndex->Offset     = StoreIndex->Next + Capacity;
+  StoreIndex->Hash       = StoreIndex->Offset + Capacity;
+  StoreIndex->BucketMask = BucketCount - 1;
+  StoreIndex->Capacity   = Capacity;
+  VariableIndexReset (StoreIndex);
+}
+
+/**
+  Stop indexing a variable store.
+
+  @param[in] Store        The variable store.
+**/
+VOID
+VariableIndexUnregisterStore (
+  IN VARIABLE_STORE_HEADER  *Store
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < ARRAY_SIZE (mVariableStoreIndex); Index++) {
+    if ((Store != NULL) && (mVariableStoreIndex[Index].Store == Store)) {
+      if (!AtRuntime ()) {
+        FreePool (mVariableStoreIndex[Index].Bucket);
+      }
+
+      ZeroMem (&mVariableStoreIndex[Index], sizeof (mVariableStoreIndex[Index]));
+      return;
+    }
+  }
+}
+
+/**
+  Drop the index of a variable store that was rewritten in place. The store is
+  indexed again on the next lookup.
+
+  @param[in] Store        The variable store.
+**/
+VOID
+VariableIndexInvalidate (
+  IN VARIABLE_STORE_HEADER  *Store
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < ARRAY_SIZE (mVariableStoreIndex); Index++) {
+    if ((Store != NULL) && (mVariableStoreIndex[Index].Store == Store)) {
+      VariableIndexReset (&mVariableStoreIndex[Index]);
+      return;
+    }
+  }
+}
+
+/**
+  Convert the pointers of the variable store indexes to virtual addresses.
+
+  @param[in] ConvertPointer   The function that converts a pointer, such as
+                              EfiConvertPointer().
+**/
+VOID
+VariableIndexConvertPointers (
+  IN VARIABLE_INDEX_CONVERT_POINTER  ConvertPointer
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < ARRAY_SIZE (mVariableStoreIndex); Index++) {
+    if (mVariableStoreIndex[Index].Store == NULL) {
+      continue;
+    }
+
+    ConvertPointer (0x0, (VOID **)&mVariableStoreIndex[Index].Store);
+    ConvertPointer (0x0, (VOID **)&mVariableStoreIndex[Index].Bucket);
+    ConvertPointer (0x0, (VOID **)&mVariableStoreIndex[Index].Next);
+    ConvertPointer (0x0, (VOID **)&mVariableStoreIndex[Index].Offset);
+    ConvertPointer (0x0, (VOID **)&mVariableStoreIndex[Index].Hash);
+  }
+}
+
 /**
   Find the variable in the specified variable store.
 
@@ -458,6 +980,9 @@ VariableCompareTimeStampInternal (
 
   @retval          EFI_SUCCESS         Variable found successfully
   @retval          EFI_NOT_FOUND       Variable not found
+  @retval          EFI_VOLUME_CORRUPTED  A variable of the store reaches past its
+                                       end, as one being written in a runtime
+                                       cache may.
 **/
 EFI_STATUS
 FindVariableEx (
@@ -468,11 +993,28 @@ FindVariableEx (
   IN     BOOLEAN                 AuthFormat
   )
 {
-  VARIABLE_HEADER  *InDeletedVariable;
-  VOID             *Point;
+  EFI_STATUS            Status;
+  VARIABLE_STORE_INDEX  *StoreIndex;
+  VARIABLE_HEADER       *InDeletedVariable;
+  VOID                  *Point;
 
   PtrTrack->InDeletedTransitionPtr = NULL;
 
+  if (VariableName[0] != 0) {
+    StoreIndex = VariableIndexFind (PtrTrack);
+    if (StoreIndex != NULL) {
+      Status = VariableIndexRefresh (StoreIndex, AuthFormat);
+      if (Status == EFI_VOLUME_CORRUPTED) {
+        PtrTrack->CurrPtr = NULL;
+        return Status;
+      }
+
+      if (!EFI_ERROR (Status)) {
+        return FindVariableByIndex (StoreIndex, VariableName, VendorGuid, IgnoreRtCheck, PtrTrack, AuthFormat);
+      }
+    }
+  }
+
   //
   // Find the variable by walk through HOB, volatile and non-volatile variable store.
   //
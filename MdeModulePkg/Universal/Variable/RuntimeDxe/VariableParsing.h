@@ -13,6 +13,22 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Guid/ImageAuthentication.h>
 #include "Variable.h"
 
+/**
+  Convert a pointer to its virtual address, as EfiConvertPointer() does.
+
+  @param[in]      DebugDisposition  Supplies type information for the pointer being converted.
+  @param[in, out] Address           The pointer to convert.
+
+  @retval EFI_SUCCESS               The pointer was converted.
+  @retval others                    The pointer could not be converted.
+**/
+typedef
+EFI_STATUS
+(EFIAPI *VARIABLE_INDEX_CONVERT_POINTER)(
+  IN     UINTN  DebugDisposition,
+  IN OUT VOID   **Address
+  );
+
 /**
 
   This code checks if variable header is valid or not.
@@ -270,6 +286,9 @@ VariableCompareTimeStampInternal (
 
   @retval          EFI_SUCCESS         Variable found successfully
   @retval          EFI_NOT_FOUND       Variable not found
+  @retval          EFI_VOLUME_CORRUPTED  A variable of the store reaches past its
+                                       end, as one being written in a runtime
+                                       cache may.
 **/
 EFI_STATUS
 FindVariableEx (
@@ -280,6 +299,56 @@ FindVariableEx (
   IN     BOOLEAN                 AuthFormat
   );
 
+/**
+  Index a variable store by variable name and vendor GUID, so that
+  FindVariableEx() over the whole store does not walk it.
+
+  The index is kept up to date on lookups as variables are appended to the
+  store. Whoever rewrites the store in place, as reclaim does, must call
+  VariableIndexInvalidate(). The index memory is allocated here, so the store
+  must be registered before ExitBootServices().
+
+  @param[in] Store        The variable store.
+  @param[in] StoreSize    The size of the memory of the variable store.
+**/
+VOID
+VariableIndexRegisterStore (
+  IN VARIABLE_STORE_HEADER  *Store,
+  IN UINTN                  StoreSize
+  );
+
+/**
+  Stop indexing a variable store.
+
+  @param[in] Store        The variable store.
+**/
+VOID
+VariableIndexUnregisterStore (
+  IN VARIABLE_STORE_HEADER  *Store
+  );
+
+/**
+  Drop the index of a variable store that was rewritten in place. The store is
+  indexed again on the next lookup.
+
+  @param[in] Store        The variable store.
+**/
+VOID
+VariableIndexInvalidate (
+  IN VARIABLE_STORE_HEADER  *Store
+  );
+
+/**
+  Convert the pointers of the variable store indexes to virtual addresses.
+
+  @param[in] ConvertPointer   The function that converts a pointer, such as
+                              EfiConvertPointer().
+**/
+VOID
+VariableIndexConvertPointers (
+  IN VARIABLE_INDEX_CONVERT_POINTER  ConvertPointer
+  );
+
 /**
   This code finds the next available variable.
 
@@ -21,6 +21,12 @@ extern VARIABLE_STORE_HEADER   *mNvVariableCache;
 /**
   Copies any pending updates to runtime variable caches.
 
+  The copy is bracketed by two increments of the runtime cache sequence counter,
+  which is odd while the caches are being updated. The readers in the runtime
+  DXE driver never block the update, they retry any read that overlapped it.
+  If variables were moved within the caches since the last update, the
+  generation of the caches is incremented in the same bracket.
+
   @retval EFI_UNSUPPORTED         The volatile store to be updated is not initialized properly.
   @retval EFI_SUCCESS             The volatile store was updated successfully.
 
@@ -36,12 +42,21 @@ FlushPendingRuntimeVariableCacheUpdates (
 
   if ((VariableRuntimeCacheContext->VariableRuntimeNvCache.Store == NULL) ||
       (VariableRuntimeCacheContext->VariableRuntimeVolatileCache.Store == NULL) ||
-      (VariableRuntimeCacheContext->PendingUpdate == NULL))
+      (VariableRuntimeCacheContext->PendingUpdate == NULL) ||
+      (VariableRuntimeCacheContext->Sequence == NULL))
   {
     return EFI_UNSUPPORTED;
   }
 
   if (*(VariableRuntimeCacheContext->PendingUpdate)) {
+    *(VariableRuntimeCacheContext->Sequence) += 1;
+    MemoryFence ();
+
+    if (VariableRuntimeCacheContext->GenerationPending && (VariableRuntimeCacheContext->Generation != NULL)) {
+      *(VariableRuntimeCacheContext->Generation)    += 1;
+      VariableRuntimeCacheContext->GenerationPending = FALSE;
+    }
+
     if ((VariableRuntimeCacheContext->VariableRuntimeHobCache.Store != NULL) &&
         (mVariableModuleGlobal->VariableGlobal.HobVariableBase > 0))
     {
@@ -88,6 +103,9 @@ FlushPendingRuntimeVariableCacheUpdates (
     VariableRuntimeCacheContext->VariableRuntimeVolatileCache.PendingUpdateLength = 0;
     VariableRuntimeCacheContext->VariableRuntimeVolatileCache.PendingUpdateOffset = 0;
     *(VariableRuntimeCacheContext->PendingUpdate)                                 = FALSE;
+
+    MemoryFence ();
+    *(VariableRuntimeCacheContext->Sequence) += 1;
   }
 
   return EFI_SUCCESS;
@@ -96,17 +114,16 @@ FlushPendingRuntimeVariableCacheUpdates (
 /**
   Synchronizes the runtime variable caches with all pending updates outside runtime.
 
-  Ensures all conditions are met to maintain coherency for runtime cache updates. This function will attempt
-  to write the given update (and any other pending updates) if the ReadLock is available. Otherwise, the
-  update is added as a pending update for the given variable store and it will be flushed to the runtime cache
-  at the next opportunity the ReadLock is available.
+  Ensures all conditions are met to maintain coherency for runtime cache updates. The given update is merged
+  with any other pending update for the given variable store and all pending updates are written to the runtime
+  caches immediately. Readers detect a concurrent update through the runtime cache sequence counter, so the
+  update never waits for, or is deferred by, a reader.
 
   @param[in] VariableRuntimeCache Variable runtime cache structure for the runtime cache being synchronized.
   @param[in] Offset               Offset in bytes to apply the update.
   @param[in] Length               Length of data in bytes of the update.
 
-  @retval EFI_SUCCESS             The update was added as a pending update successfully. If the variable runtime
-                                  cache ReadLock was available, the runtime cache was updated successfully.
+  @retval EFI_SUCCESS             The runtime cache was updated successfully.
   @retval EFI_UNSUPPORTED         The volatile store to be updated is not initialized properly.
 
 **/
@@ -126,7 +143,7 @@ SynchronizeRuntimeVariableCache (
   }
 
   if ((mVariableModuleGlobal->VariableGlobal.VariableRuntimeCacheContext.PendingUpdate == NULL) ||
-      (mVariableModuleGlobal->VariableGlobal.VariableRuntimeCacheContext.ReadLock == NULL))
+      (mVariableModuleGlobal->VariableGlobal.VariableRuntimeCacheContext.Sequence == NULL))
   {
     return EFI_UNSUPPORTED;
   }
@@ -150,9 +167,22 @@ SynchronizeRuntimeVariableCache (
 
   *(mVariableModuleGlobal->VariableGlobal.VariableRuntimeCacheContext.PendingUpdate) = TRUE;
 
-  if (*(mVariableModuleGlobal->VariableGlobal.VariableRuntimeCacheContext.ReadLock) == FALSE) {
-    return FlushPendingRuntimeVariableCacheUpdates ();
-  }
+  return FlushPendingRuntimeVariableCacheUpdates ();
+}
 
-  return EFI_SUCCESS;
+/**
+  Records that variables were moved within the runtime variable caches.
+
+  A reclaim rewrites variables in place, which the readers of the runtime
+  caches cannot tell from appended variables by looking at the caches. The
+  generation of the caches is incremented with their next update, so the
+  readers drop the indexes they built from the old layout.
+
+**/
+VOID
+InvalidateRuntimeVariableCacheLayout (
+  VOID
+  )
+{
+  mVariableModuleGlobal->VariableGlobal.VariableRuntimeCacheContext.GenerationPending = TRUE;
 }
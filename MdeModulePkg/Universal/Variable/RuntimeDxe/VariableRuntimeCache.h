@@ -27,17 +27,16 @@ FlushPendingRuntimeVariableCacheUpdates (
 /**
   Synchronizes the runtime variable caches with all pending updates outside runtime.
 
-  Ensures all conditions are met to maintain coherency for runtime cache updates. This function will attempt
-  to write the given update (and any other pending updates) if the ReadLock is available. Otherwise, the
-  update is added as a pending update for the given variable store and it will be flushed to the runtime cache
-  at the next opportunity the ReadLock is available.
+  Ensures all conditions are met to maintain coherency for runtime cache updates. The given update is merged
+  with any other pending update for the given variable store and all pending updates are written to the runtime
+  caches immediately. Readers detect a concurrent update through the runtime cache sequence counter, so the
+  update never waits for, or is deferred by, a reader.
 
   @param[in] VariableRuntimeCache Variable runtime cache structure for the runtime cache being synchronized.
   @param[in] Offset               Offset in bytes to apply the update.
   @param[in] Length               Length of data in bytes of the update.
 
-  @retval EFI_SUCCESS             The update was added as a pending update successfully. If the variable runtime
-                                  cache ReadLock was available, the runtime cache was updated successfully.
+  @retval EFI_SUCCESS             The runtime cache was updated successfully.
   @retval EFI_UNSUPPORTED         The volatile store to be updated is not initialized properly.
 
 **/
@@ -48,4 +47,16 @@ SynchronizeRuntimeVariableCache (
   IN  UINTN                   Length
   );
 
+/**
+  Records that variables were moved within the runtime variable caches.
+
+  The generation of the caches is incremented with their next update, so the
+  readers drop the indexes they built from the old layout.
+
+**/
+VOID
+InvalidateRuntimeVariableCacheLayout (
+  VOID
+  );
+
 #endif
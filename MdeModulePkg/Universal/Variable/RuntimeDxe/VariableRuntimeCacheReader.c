@@ -0,0 +1,325 @@
+/** @file
+  Lock-free readers of the runtime variable caches, used by the runtime DXE part
+  of the SMM variable driver.
+
+  SMM writes every variable update to the runtime caches as soon as it is made,
+  between two increments of a sequence counter shared with the readers. A reader
+  samples the counter before and after a lookup and repeats the lookup if the
+  counter was odd or has changed, so a read never triggers a SMI and never holds
+  back an update.
+
+  Caution: This module requires additional review when modified.
+  The runtime caches may change while they are read, so a lookup can observe a
+  partially written variable. Sizes read from the caches are validated against
+  the cache buffers before they are used.
+
+Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "VariableRuntimeCacheReader.h"
+
+/**
+  Waits until no update of the runtime caches is in progress.
+
+  If a reclaim moved variables within the caches since the indexes of the
+  caches were built, the indexes are discarded. An index only notices
+  appended variables and a rewritten start or end of its store, so it could
+  otherwise keep pointing at stale copies of moved variables.
+
+  @param[in] Reader    The runtime variable caches to read.
+
+  @return The sequence counter that starts the read.
+
+**/
+STATIC
+UINT32
+RuntimeCacheReadBegin (
+  IN VARIABLE_RUNTIME_CACHE_READER  *Reader
+  )
+{
+  UINT32               Sequence;
+  UINT32               Generation;
+  VARIABLE_STORE_TYPE  StoreType;
+
+  Sequence = *(Reader->Sequence);
+  while ((Sequence & BIT0) != 0) {
+    CpuPause ();
+    Sequence = *(Reader->Sequence);
+  }
+
+  MemoryFence ();
+
+  //
+  // The generation only changes while the sequence counter is odd, so a
+  // change during the read is caught by RuntimeCacheReadRetry().
+  //
+  Generation = *(Reader->Generation);
+  if (Generation != *(Reader->IndexGeneration)) {
+    for (StoreType = (VARIABLE_STORE_TYPE)0; StoreType < VariableStoreTypeMax; StoreType++) {
+      VariableIndexInvalidate (Reader->Store[StoreType]);
+    }
+
+    *(Reader->IndexGeneration) = Generation;
+  }
+
+  return Sequence;
+}
+
+/**
+  Checks whether the runtime caches were updated since a read started.
+
+  The index of the caches may have been refreshed from a partial update during
+  such a read, so it is discarded.
+
+  @param[in] Reader    The runtime variable caches to read.
+  @param[in] Sequence  The sequence counter that started the read.
+
+  @retval TRUE         The read must be repeated.
+  @retval FALSE        The read observed a consistent state of the caches.
+
+**/
+STATIC
+BOOLEAN
+RuntimeCacheReadRetry (
+  IN VARIABLE_RUNTIME_CACHE_READER  *Reader,
+  IN UINT32                         Sequence
+  )
+{
+  VARIABLE_STORE_TYPE  StoreType;
+
+  MemoryFence ();
+  if (*(Reader->Sequence) == Sequence) {
+    return FALSE;
+  }
+
+  for (StoreType = (VARIABLE_STORE_TYPE)0; StoreType < VariableStoreTypeMax; StoreType++) {
+    VariableIndexInvalidate (Reader->Store[StoreType]);
+  }
+
+  return TRUE;
+}
+
+/**
+  Checks whether a buffer lies in one of the runtime caches.
+
+  @param[in] Reader    The runtime variable caches to read.
+  @param[in] Buffer    The start of the buffer.
+  @param[in] Length    The length of the buffer in bytes.
+
+  @retval TRUE         The buffer lies in a runtime cache.
+  @retval FALSE        The buffer does not lie in a runtime cache.
+
+**/
+STATIC
+BOOLEAN
+IsBufferInRuntimeCache (
+  IN VARIABLE_RUNTIME_CACHE_READER  *Reader,
+  IN VOID                           *Buffer,
+  IN UINTN                          Length
+  )
+{
+  VARIABLE_STORE_TYPE  StoreType;
+  UINTN                Store;
+
+  for (StoreType = (VARIABLE_STORE_TYPE)0; StoreType < VariableStoreTypeMax; StoreType++) {
+    Store = (UINTN)Reader->Store[StoreType];
+    if ((Store != 0) &&
+        ((UINTN)Buffer >= Store) &&
+        (Length <= Reader->StoreSize[StoreType]) &&
+        ((UINTN)Buffer - Store <= Reader->StoreSize[StoreType] - Length))
+    {
+      return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
+/**
+  Finds the given variable in the runtime variable caches.
+
+  The lookup is repeated until it did not overlap an update of the caches by
+  SMM, so the returned data is a consistent copy of the variable.
+
+  @param[in]      Reader             The runtime variable caches to read.
+  @param[in]      VariableName       Name of Variable to be found.
+  @param[in]      VendorGuid         Variable vendor GUID.
+  @param[out]     Attributes         Attribute value of the variable found.
+  @param[in, out] DataSize           Size of Data found. If size is less than the
+                                     data, this value contains the required size.
+  @param[out]     Data               Data pointer.
+  @param[out]     Volatile           TRUE if the variable was found in the
+                                     volatile cache.
+
+  @retval EFI_SUCCESS                Found the specified variable.
+  @retval EFI_INVALID_PARAMETER      Data is NULL and DataSize is large enough.
+  @retval EFI_NOT_FOUND              The specified variable could not be found.
+  @retval EFI_BUFFER_TOO_SMALL       DataSize is too small for the result.
+  @retval EFI_DEVICE_ERROR           The runtime variable caches are corrupted.
+
+**/
+EFI_STATUS
+RuntimeCacheFindVariable (
+  IN      VARIABLE_RUNTIME_CACHE_READER  *Reader,
+  IN      CHAR16                         *VariableName,
+  IN      EFI_GUID                       *VendorGuid,
+  OUT     UINT32                         *Attributes OPTIONAL,
+  IN OUT  UINTN                          *DataSize,
+  OUT     VOID                           *Data OPTIONAL,
+  OUT     BOOLEAN                        *Volatile OPTIONAL
+  )
+{
+  EFI_STATUS              Status;
+  UINT32                  Sequence;
+  UINTN                   TempDataSize;
+  UINT32                  TempAttributes;
+  UINT8                   *DataPtr;
+  VARIABLE_POINTER_TRACK  RtPtrTrack;
+  VARIABLE_STORE_TYPE     StoreType;
+
+  do {
+    Sequence       = RuntimeCacheReadBegin (Reader);
+    Status         = EFI_NOT_FOUND;
+    TempDataSize   = 0;
+    TempAttributes = 0;
+    ZeroMem (&RtPtrTrack, sizeof (RtPtrTrack));
+
+    //
+    // 0: Volatile, 1: HOB, 2: Non-Volatile.
+    // The index and attributes mapping must be kept in this order as FindVariable
+    // makes use of this mapping to implement search algorithm.
+    //
+    for (StoreType = (VARIABLE_STORE_TYPE)0; StoreType < VariableStoreTypeMax; StoreType++) {
+      if (Reader->Store[StoreType] == NULL) {
+        continue;
+      }
+
+      RtPtrTrack.StartPtr = GetStartPointer (Reader->Store[StoreType]);
+      RtPtrTrack.EndPtr   = GetEndPointer (Reader->Store[StoreType]);
+      RtPtrTrack.Volatile = (BOOLEAN)(StoreType == VariableStoreTypeVolatile);
+
+      Status = FindVariableEx (VariableName, VendorGuid, FALSE, &RtPtrTrack, Reader->AuthFormat);
+      if (Status != EFI_NOT_FOUND) {
+        break;
+      }
+    }
+
+    if (Status == EFI_VOLUME_CORRUPTED) {
+      //
+      // A variable of the cache reaches past its end. It is being written if
+      // the read is repeated, else the cache is corrupted.
+      //
+      Status = EFI_DEVICE_ERROR;
+    } else if (!EFI_ERROR (Status)) {
+      TempDataSize   = DataSizeOfVariable (RtPtrTrack.CurrPtr, Reader->AuthFormat);
+      TempAttributes = RtPtrTrack.CurrPtr->Attributes;
+      DataPtr        = GetVariableDataPtr (RtPtrTrack.CurrPtr, Reader->AuthFormat);
+
+      if ((TempDataSize == 0) || !IsBufferInRuntimeCache (Reader, DataPtr, TempDataSize)) {
+        Status = EFI_DEVICE_ERROR;
+      } else if (*DataSize < TempDataSize) {
+        Status = EFI_BUFFER_TOO_SMALL;
+      } else if (Data == NULL) {
+        Status = EFI_INVALID_PARAMETER;
+      } else {
+        CopyMem (Data, DataPtr, TempDataSize);
+        Status = EFI_SUCCESS;
+      }
+    }
+  } while (RuntimeCacheReadRetry (Reader, Sequence));
+
+  if ((Status == EFI_SUCCESS) || (Status == EFI_BUFFER_TOO_SMALL)) {
+    *DataSize = TempDataSize;
+    if (Attributes != NULL) {
+      *Attributes = TempAttributes;
+    }
+
+    if (Volatile != NULL) {
+      *Volatile = RtPtrTrack.Volatile;
+    }
+  }
+
+  return Status;
+}
+
+/**
+  Finds the next available variable in the runtime variable caches.
+
+  The lookup is repeated until it did not overlap an update of the caches by
+  SMM, so the returned name is a consistent copy of the variable name.
+
+  @param[in]      Reader             The runtime variable caches to read.
+  @param[in, out] VariableNameSize   Size of the variable name.
+  @param[in, out] VariableName       Pointer to variable name.
+  @param[in, out] VendorGuid         Variable Vendor Guid.
+
+  @retval EFI_INVALID_PARAMETER      Invalid parameter.
+  @retval EFI_SUCCESS                Find the specified variable.
+  @retval EFI_NOT_FOUND              Not found.
+  @retval EFI_BUFFER_TO_SMALL        DataSize is too small for the result.
+  @retval EFI_DEVICE_ERROR           The runtime variable caches are corrupted.
+
+**/
+EFI_STATUS
+RuntimeCacheGetNextVariableName (
+  IN      VARIABLE_RUNTIME_CACHE_READER  *Reader,
+  IN OUT  UINTN                          *VariableNameSize,
+  IN OUT  CHAR16                         *VariableName,
+  IN OUT  EFI_GUID                       *VendorGuid
+  )
+{
+  EFI_STATUS       Status;
+  UINT32           Sequence;
+  UINTN            NameSize;
+  UINTN            VarNameSize;
+  CHAR16           *NamePtr;
+  VARIABLE_HEADER  *VariablePtr;
+  EFI_GUID         Guid;
+
+  //
+  // The result overwrites the input name and GUID, which a repeated lookup
+  // still needs, so the lookup works on a copy of them.
+  //
+  NameSize = StrSize (VariableName);
+  if (NameSize > Reader->NameBufferSize) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  CopyMem (Reader->NameBuffer, VariableName, NameSize);
+  CopyGuid (&Guid, VendorGuid);
+
+  do {
+    Sequence    = RuntimeCacheReadBegin (Reader);
+    VarNameSize = 0;
+
+    Status = VariableServiceGetNextVariableInternal (
+               Reader->NameBuffer,
+               &Guid,
+               Reader->Store,
+               &VariablePtr,
+               Reader->AuthFormat
+               );
+    if (!EFI_ERROR (Status)) {
+      VarNameSize = NameSizeOfVariable (VariablePtr, Reader->AuthFormat);
+      NamePtr     = GetVariableNamePtr (VariablePtr, Reader->AuthFormat);
+
+      if ((VarNameSize == 0) || !IsBufferInRuntimeCache (Reader, NamePtr, VarNameSize)) {
+        Status = EFI_DEVICE_ERROR;
+      } else if (VarNameSize <= *VariableNameSize) {
+        CopyMem (VariableName, NamePtr, VarNameSize);
+        CopyGuid (VendorGuid, GetVendorGuidPtr (VariablePtr, Reader->AuthFormat));
+        Status = EFI_SUCCESS;
+      } else {
+        Status = EFI_BUFFER_TOO_SMALL;
+      }
+    }
+  } while (RuntimeCacheReadRetry (Reader, Sequence));
+
+  if ((Status == EFI_SUCCESS) || (Status == EFI_BUFFER_TOO_SMALL)) {
+    *VariableNameSize = VarNameSize;
+  }
+
+  return Status;
+}
@@ -0,0 +1,102 @@
+/** @file
+  Lock-free readers of the runtime variable caches, used by the runtime DXE part
+  of the SMM variable driver.
+
+Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef _VARIABLE_RUNTIME_CACHE_READER_H_
+#define _VARIABLE_RUNTIME_CACHE_READER_H_
+
+#include "VariableParsing.h"
+
+typedef struct {
+  ///
+  /// Sequence counter of the runtime caches, odd while SMM updates them.
+  ///
+  volatile UINT32          *Sequence;
+  ///
+  /// Generation of the layout of the runtime caches, incremented by SMM when a
+  /// reclaim moves variables within them, and the generation the indexes of
+  /// the caches were built for.
+  ///
+  volatile UINT32          *Generation;
+  UINT32                   *IndexGeneration;
+  ///
+  /// The runtime caches and the size of their buffers, indexed by
+  /// VARIABLE_STORE_TYPE. A NULL cache is skipped.
+  ///
+  VARIABLE_STORE_HEADER    *Store[VariableStoreTypeMax];
+  UINTN                    StoreSize[VariableStoreTypeMax];
+  ///
+  /// Buffer that keeps the input name of RuntimeCacheGetNextVariableName()
+  /// while a read is repeated.
+  ///
+  CHAR16                   *NameBuffer;
+  UINTN                    NameBufferSize;
+  BOOLEAN                  AuthFormat;
+} VARIABLE_RUNTIME_CACHE_READER;
+
+/**
+  Finds the given variable in the runtime variable caches.
+
+  The lookup is repeated until it did not overlap an update of the caches by
+  SMM, so the returned data is a consistent copy of the variable.
+
+  @param[in]      Reader             The runtime variable caches to read.
+  @param[in]      VariableName       Name of Variable to be found.
+  @param[in]      VendorGuid         Variable vendor GUID.
+  @param[out]     Attributes         Attribute value of the variable found.
+  @param[in, out] DataSize           Size of Data found. If size is less than the
+                                     data, this value contains the required size.
+  @param[out]     Data               Data pointer.
+  @param[out]     Volatile           TRUE if the variable was found in the
+                                     volatile cache.
+
+  @retval EFI_SUCCESS                Found the specified variable.
+  @retval EFI_INVALID_PARAMETER      Data is NULL and DataSize is large enough.
+  @retval EFI_NOT_FOUND              The specified variable could not be found.
+  @retval EFI_BUFFER_TOO_SMALL       DataSize is too small for the result.
+  @retval EFI_DEVICE_ERROR           The runtime variable caches are corrupted.
+
+**/
+EFI_STATUS
+RuntimeCacheFindVariable (
+  IN      VARIABLE_RUNTIME_CACHE_READER  *Reader,
+  IN      CHAR16                         *VariableName,
+  IN      EFI_GUID                       *VendorGuid,
+  OUT     UINT32                         *Attributes OPTIONAL,
+  IN OUT  UINTN                          *DataSize,
+  OUT     VOID                           *Data OPTIONAL,
+  OUT     BOOLEAN                        *Volatile OPTIONAL
+  );
+
+/**
+  Finds the next available variable in the runtime variable caches.
+
+  The lookup is repeated until it did not overlap an update of the caches by
+  SMM, so the returned name is a consistent copy of the variable name.
+
+  @param[in]      Reader             The runtime variable caches to read.
+  @param[in, out] VariableNameSize   Size of the variable name.
+  @param[in, out] VariableName       Pointer to variable name.
+  @param[in, out] VendorGuid         Variable Vendor Guid.
+
+  @retval EFI_INVALID_PARAMETER      Invalid parameter.
+  @retval EFI_SUCCESS                Find the specified variable.
+  @retval EFI_NOT_FOUND              Not found.
+  @retval EFI_BUFFER_TO_SMALL        DataSize is too small for the result.
+  @retval EFI_DEVICE_ERROR           The runtime variable caches are corrupted.
+
+**/
+EFI_STATUS
+RuntimeCacheGetNextVariableName (
+  IN      VARIABLE_RUNTIME_CACHE_READER  *Reader,
+  IN OUT  UINTN                          *VariableNameSize,
+  IN OUT  CHAR16                         *VariableName,
+  IN OUT  EFI_GUID                       *VendorGuid
+  );
+
+#endif
@@ -40,6 +40,14 @@ BOOLEAN  mAtRuntime              = FALSE;
 UINT8    *mVariableBufferPayload = NULL;
 UINTN    mVariableBufferPayloadSize;
 
+///
+/// The chunks of the batch sent by the variable wrapper driver so far.
+///
+UINT8  *mVariableBatchBuffer    = NULL;
+UINTN  mVariableBatchBufferSize = 0;
+UINTN  mVariableBatchStagedSize = 0;
+UINTN  mVariableBatchEntryCount = 0;
+
 /**
   SecureBoot Hook for SetVariable.
 
@@ -424,6 +432,209 @@ SmmVariableGetStatistics (
   return EFI_SUCCESS;
 }
 
+/**
+  Set the variables of a batch from the variable wrapper driver.
+
+  The entries are in SMRAM, staged by SmmStageVariableBatch(), so they cannot
+  change while they are used. Each entry is still validated as for a single
+  SetVariable request.
+
+  @param[in]  Entries            The entries of the batch.
+  @param[in]  EntryCount         The number of entries.
+  @param[in]  BatchSize          The size of the entries in bytes.
+  @param[out] FailedEntry        The index of the entry that failed.
+
+  @retval EFI_SUCCESS            All the variables were set.
+  @retval EFI_ACCESS_DENIED      An entry does not fit in the batch.
+  @retval EFI_INVALID_PARAMETER  An entry cannot be set in a batch.
+  @retval Others                 The status of the entry that failed, or of
+                                 writing the batch to the variable store.
+
+**/
+EFI_STATUS
+SmmSetVariableBatch (
+  IN  UINT8  *Entries,
+  IN  UINTN  EntryCount,
+  IN  UINTN  BatchSize,
+  OUT UINTN  *FailedEntry
+  )
+{
+  EFI_STATUS                                Status;
+  SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE  *SmmVariableHeader;
+  UINTN                                     Index;
+  UINTN                                     Offset;
+  UINTN                                     InfoSize;
+
+  *FailedEntry = MAX_UINTN;
+
+  //
+  // The variables take about as much room in the store as in the batch.
+  //
+  Status = VariableBatchBegin (BatchSize);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Offset = 0;
+  for (Index = 0; Index < EntryCount; Index++) {
+    if ((Offset > BatchSize) || (BatchSize - Offset < OFFSET_OF (SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE, Name))) {
+      DEBUG ((DEBUG_ERROR, "SetVariableBatch: Entry exceeds batch size limit!\n"));
+      Status = EFI_ACCESS_DENIED;
+      break;
+    }
+
+    SmmVariableHeader = (SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE *)(Entries + Offset);
+    if (((UINTN)(~0) - SmmVariableHeader->DataSize < OFFSET_OF (SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE, Name)) ||
+        ((UINTN)(~0) - SmmVariableHeader->NameSize < OFFSET_OF (SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE, Name) + SmmVariableHeader->DataSize))
+    {
+      //
+      // Prevent InfoSize overflow happen
+      //
+      Status = EFI_ACCESS_DENIED;
+      break;
+    }
+
+    InfoSize = OFFSET_OF (SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE, Name)
+               + SmmVariableHeader->DataSize + SmmVariableHeader->NameSize;
+    if (InfoSize > BatchSize - Offset) {
+      DEBUG ((DEBUG_ERROR, "SetVariableBatch: Data size exceed batch size limit!\n"));
+      Status = EFI_ACCESS_DENIED;
+      break;
+    }
+
+    VariableSpeculationBarrier ();
+    if ((SmmVariableHeader->NameSize < sizeof (CHAR16)) || (SmmVariableHeader->Name[SmmVariableHeader->NameSize/sizeof (CHAR16) - 1] != L'\0')) {
+      //
+      // Make sure VariableName is A Null-terminated string.
+      //
+      Status = EFI_ACCESS_DENIED;
+      break;
+    }
+
+    //
+    // Only the non-volatile store is rolled back, and authenticated writes
+    // update the certificate database behind the variable.
+    //
+    if (((SmmVariableHeader->Attributes & EFI_VARIABLE_NON_VOLATILE) == 0) ||
+        ((SmmVariableHeader->Attributes & VARIABLE_ATTRIBUTE_AT_AW) != 0))
+    {
+      Status = EFI_INVALID_PARAMETER;
+      break;
+    }
+
+    Status = VariableServiceSetVariable (
+               SmmVariableHeader->Name,
+               &SmmVariableHeader->Guid,
+               SmmVariableHeader->Attributes,
+               SmmVariableHeader->DataSize,
+               (UINT8 *)SmmVariableHeader->Name + SmmVariableHeader->NameSize
+               );
+    if (EFI_ERROR (Status)) {
+      break;
+    }
+
+    Offset += ALIGN_VALUE (InfoSize, sizeof (UINTN));
+  }
+
+  if (EFI_ERROR (Status)) {
+    *FailedEntry = Index;
+    VariableBatchEnd (FALSE);
+    return Status;
+  }
+
+  return VariableBatchEnd (TRUE);
+}
+
+/**
+  Stage a chunk of a batch from the variable wrapper driver, and set the
+  variables of the batch once its last chunk arrived.
+
+  A batch is sent in chunks that fit in the variable communicate buffer. The
+  chunks are copied to a buffer in SMRAM, and the whole batch is set in the
+  SMI of its last chunk, so it is still written to the store at once. A batch
+  that is never completed is dropped by the first chunk of the next batch.
+
+  Caution: This function may receive untrusted input.
+  The chunk is in the communicate buffer, which is validated by the caller.
+
+  @param[in, out] Chunk          The chunk in the communicate buffer.
+  @param[in]      ChunkSize      The size of the chunk in bytes.
+
+  @retval EFI_SUCCESS            The chunk was staged, or all the variables of
+                                 the batch were set.
+  @retval EFI_NOT_STARTED        The first chunk of the batch is missing.
+  @retval EFI_BAD_BUFFER_SIZE    The batch does not fit in the variable store.
+  @retval EFI_OUT_OF_RESOURCES   The batch cannot be staged.
+  @retval Others                 The status of SmmSetVariableBatch().
+
+**/
+EFI_STATUS
+SmmStageVariableBatch (
+  IN OUT SMM_VARIABLE_COMMUNICATE_SET_VARIABLE_BATCH  *Chunk,
+  IN     UINTN                                        ChunkSize
+  )
+{
+  EFI_STATUS                                   Status;
+  SMM_VARIABLE_COMMUNICATE_SET_VARIABLE_BATCH  Header;
+  UINTN                                        EntriesSize;
+  UINTN                                        FailedEntry;
+
+  CopyMem (&Header, Chunk, sizeof (Header));
+  Chunk->FailedEntry = MAX_UINTN;
+  EntriesSize        = ChunkSize - sizeof (Header);
+
+  if (Header.FirstChunk) {
+    if (mVariableBatchBuffer != NULL) {
+      FreePool (mVariableBatchBuffer);
+      mVariableBatchBuffer = NULL;
+    }
+
+    //
+    // A batch larger than the store could never be written.
+    //
+    if ((Header.BatchSize == 0) || (Header.BatchSize > mNvVariableCache->Size)) {
+      return EFI_BAD_BUFFER_SIZE;
+    }
+
+    mVariableBatchBuffer = AllocatePool (Header.BatchSize);
+    if (mVariableBatchBuffer == NULL) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+
+    mVariableBatchBufferSize = Header.BatchSize;
+    mVariableBatchStagedSize = 0;
+    mVariableBatchEntryCount = 0;
+  } else if (mVariableBatchBuffer == NULL) {
+    return EFI_NOT_STARTED;
+  }
+
+  //
+  // Every entry takes at least its header.
+  //
+  if ((EntriesSize > mVariableBatchBufferSize - mVariableBatchStagedSize) ||
+      (Header.EntryCount > EntriesSize / OFFSET_OF (SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE, Name)))
+  {
+    DEBUG ((DEBUG_ERROR, "SetVariableBatch: Chunk exceeds batch size limit!\n"));
+    Status = EFI_ACCESS_DENIED;
+    goto Done;
+  }
+
+  CopyMem (mVariableBatchBuffer + mVariableBatchStagedSize, Chunk + 1, EntriesSize);
+  mVariableBatchStagedSize += EntriesSize;
+  mVariableBatchEntryCount += Header.EntryCount;
+  if (!Header.LastChunk) {
+    return EFI_SUCCESS;
+  }
+
+  Status             = SmmSetVariableBatch (mVariableBatchBuffer, mVariableBatchEntryCount, mVariableBatchStagedSize, &FailedEntry);
+  Chunk->FailedEntry = FailedEntry;
+
+Done:
+  FreePool (mVariableBatchBuffer);
+  mVariableBatchBuffer = NULL;
+  return Status;
+}
+
 /**
   Communication service SMI Handler entry.
 
@@ -469,6 +680,7 @@ SmmVariableHandler (
   SMM_VARIABLE_COMMUNICATE_GET_RUNTIME_CACHE_INFO          *GetRuntimeCacheInfo;
   SMM_VARIABLE_COMMUNICATE_LOCK_VARIABLE                   *VariableToLock;
   SMM_VARIABLE_COMMUNICATE_VAR_CHECK_VARIABLE_PROPERTY     *CommVariableProperty;
+  SMM_VARIABLE_COMMUNICATE_SET_VARIABLE_BATCH              *SetVariableBatch;
   VARIABLE_INFO_ENTRY                                      *VariableInfo;
   VARIABLE_RUNTIME_CACHE_CONTEXT                           *VariableCacheContext;
   VARIABLE_STORE_HEADER                                    *VariableCache;
@@ -714,6 +926,16 @@ SmmVariableHandler (
       Status = EFI_SUCCESS;
       break;
 
+    case SMM_VARIABLE_FUNCTION_SET_VARIABLE_BATCH:
+      if (CommBufferPayloadSize < sizeof (SMM_VARIABLE_COMMUNICATE_SET_VARIABLE_BATCH)) {
+        DEBUG ((DEBUG_ERROR, "SetVariableBatch: SMM communication buffer size invalid!\n"));
+        return EFI_SUCCESS;
+      }
+
+      SetVariableBatch = (SMM_VARIABLE_COMMUNICATE_SET_VARIABLE_BATCH *)SmmVariableFunctionHeader->Data;
+      Status           = SmmStageVariableBatch (SetVariableBatch, CommBufferPayloadSize);
+      break;
+
     case SMM_VARIABLE_FUNCTION_EXIT_BOOT_SERVICE:
       mAtRuntime = TRUE;
       Status     = EFI_SUCCESS;
@@ -840,7 +1062,9 @@ SmmVariableHandler (
           (RuntimeVariableCacheContext->RuntimeNvCache == NULL) ||
           (RuntimeVariableCacheContext->PendingUpdate == NULL) ||
           (RuntimeVariableCacheContext->ReadLock == NULL) ||
-          (RuntimeVariableCacheContext->HobFlushComplete == NULL))
+          (RuntimeVariableCacheContext->HobFlushComplete == NULL) ||
+          (RuntimeVariableCacheContext->Sequence == NULL) ||
+          (RuntimeVariableCacheContext->Generation == NULL))
       {
         DEBUG ((DEBUG_ERROR, "InitRuntimeVariableCacheContext: Required runtime cache buffer is NULL!\n"));
         Status = EFI_ACCESS_DENIED;
@@ -924,6 +1148,26 @@ SmmVariableHandler (
         goto EXIT;
       }
 
+      if (!VariableSmmIsBufferOutsideSmmValid (
+             (UINTN)RuntimeVariableCacheContext->Sequence,
+             sizeof (*(RuntimeVariableCacheContext->Sequence))
+             ))
+      {
+        DEBUG ((DEBUG_ERROR, "InitRuntimeVariableCacheContext: Runtime cache sequence buffer in SMRAM or overflow!\n"));
+        Status = EFI_ACCESS_DENIED;
+        goto EXIT;
+      }
+
+      if (!VariableSmmIsBufferOutsideSmmValid (
+             (UINTN)RuntimeVariableCacheContext->Generation,
+             sizeof (*(RuntimeVariableCacheContext->Generation))
+             ))
+      {
+        DEBUG ((DEBUG_ERROR, "InitRuntimeVariableCacheContext: Runtime cache generation buffer in SMRAM or overflow!\n"));
+        Status = EFI_ACCESS_DENIED;
+        goto EXIT;
+      }
+
       VariableCacheContext                                     = &mVariableModuleGlobal->VariableGlobal.VariableRuntimeCacheContext;
       VariableCacheContext->VariableRuntimeHobCache.Store      = RuntimeVariableCacheContext->RuntimeHobCache;
       VariableCacheContext->VariableRuntimeVolatileCache.Store = RuntimeVariableCacheContext->RuntimeVolatileCache;
@@ -931,6 +1175,8 @@ SmmVariableHandler (
       VariableCacheContext->PendingUpdate                      = RuntimeVariableCacheContext->PendingUpdate;
       VariableCacheContext->ReadLock                           = RuntimeVariableCacheContext->ReadLock;
       VariableCacheContext->HobFlushComplete                   = RuntimeVariableCacheContext->HobFlushComplete;
+      VariableCacheContext->Sequence                           = RuntimeVariableCacheContext->Sequence;
+      VariableCacheContext->Generation                         = RuntimeVariableCacheContext->Generation;
 
       // Set up the intial pending request since the RT cache needs to be in sync with SMM cache
       VariableCacheContext->VariableRuntimeHobCache.PendingUpdateOffset = 0;
@@ -25,6 +25,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Protocol/SmmVariable.h>
 #include <Protocol/VariableLock.h>
 #include <Protocol/VarCheck.h>
+#include <Protocol/VariableBatch.h>
 
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/UefiRuntimeServicesTableLib.h>
@@ -42,6 +43,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #include "PrivilegePolymorphic.h"
 #include "VariableParsing.h"
+#include "VariableRuntimeCacheReader.h"
 
 EFI_HANDLE                      mHandle                              = NULL;
 EFI_SMM_VARIABLE_PROTOCOL       *mSmmVariable                        = NULL;
@@ -62,9 +64,13 @@ BOOLEAN                         mVariableRuntimeCachePendingUpdate;
 BOOLEAN                         mVariableRuntimeCacheReadLock;
 BOOLEAN                         mVariableAuthFormat;
 BOOLEAN                         mHobFlushComplete;
+volatile UINT32                 mVariableRuntimeCacheSequence;
+volatile UINT32                 mVariableRuntimeCacheGeneration;
+UINT32                          mVariableRuntimeCacheIndexGeneration;
 EFI_LOCK                        mVariableServicesLock;
 EDKII_VARIABLE_LOCK_PROTOCOL    mVariableLock;
 EDKII_VAR_CHECK_PROTOCOL        mVarCheck;
+EDKII_VARIABLE_BATCH_PROTOCOL   mVariableBatch;
 
 /**
   The logic to initialize the VariablePolicy engine is in its own file.
@@ -580,6 +586,7 @@ CheckForRuntimeCacheSync (
   // The HOB variable data may have finished being flushed in the runtime cache sync update
   //
   if (mHobFlushComplete && (mVariableRuntimeHobCacheBuffer != NULL)) {
+    VariableIndexUnregisterStore (mVariableRuntimeHobCacheBuffer);
     if (!EfiAtRuntime ()) {
       FreePages (mVariableRuntimeHobCacheBuffer, EFI_SIZE_TO_PAGES (mVariableRuntimeHobCacheBufferSize));
     }
@@ -588,9 +595,38 @@ CheckForRuntimeCacheSync (
   }
 }
 
+/**
+  Describes the runtime variable caches to the lock-free runtime cache readers.
+
+  @param[out] Reader    The runtime variable caches to read.
+
+**/
+STATIC
+VOID
+InitRuntimeCacheReader (
+  OUT VARIABLE_RUNTIME_CACHE_READER  *Reader
+  )
+{
+  Reader->Sequence                             = &mVariableRuntimeCacheSequence;
+  Reader->Generation                           = &mVariableRuntimeCacheGeneration;
+  Reader->IndexGeneration                      = &mVariableRuntimeCacheIndexGeneration;
+  Reader->Store[VariableStoreTypeVolatile]     = mVariableRuntimeVolatileCacheBuffer;
+  Reader->Store[VariableStoreTypeHob]          = mVariableRuntimeHobCacheBuffer;
+  Reader->Store[VariableStoreTypeNv]           = mVariableRuntimeNvCacheBuffer;
+  Reader->StoreSize[VariableStoreTypeVolatile] = mVariableRuntimeVolatileCacheBufferSize;
+  Reader->StoreSize[VariableStoreTypeHob]      = mVariableRuntimeHobCacheBufferSize;
+  Reader->StoreSize[VariableStoreTypeNv]       = mVariableRuntimeNvCacheBufferSize;
+  Reader->NameBuffer                           = (CHAR16 *)mVariableBuffer;
+  Reader->NameBufferSize                       = mVariableBufferSize;
+  Reader->AuthFormat                           = mVariableAuthFormat;
+}
+
 /**
   Finds the given variable in a runtime cache variable store.
 
+  SMM updates the runtime caches as soon as a variable changes, so the caches are
+  read without a SMI. A read that overlaps such an update is repeated.
+
   Caution: This function may receive untrusted input.
   The data size is external input, so this function will validate it carefully to avoid buffer overflow.
 
@@ -615,11 +651,9 @@ FindVariableInRuntimeCache (
   OUT     VOID      *Data OPTIONAL
   )
 {
-  EFI_STATUS              Status;
-  UINTN                   TempDataSize;
-  VARIABLE_POINTER_TRACK  RtPtrTrack;
-  VARIABLE_STORE_TYPE     StoreType;
-  VARIABLE_STORE_HEADER   *VariableStoreList[VariableStoreTypeMax];
+  EFI_STATUS                     Status;
+  BOOLEAN                        Volatile;
+  VARIABLE_RUNTIME_CACHE_READER  Reader;
 
   Status = EFI_NOT_FOUND;
 
@@ -627,8 +661,6 @@ FindVariableInRuntimeCache (
     return EFI_INVALID_PARAMETER;
   }
 
-  ZeroMem (&RtPtrTrack, sizeof (RtPtrTrack));
-
   //
   // The UEFI specification restricts Runtime Services callers from invoking the same or certain other Runtime Service
   // functions prior to completion and return from a previous Runtime Service call. These restrictions prevent
@@ -641,62 +673,10 @@ FindVariableInRuntimeCache (
   CheckForRuntimeCacheSync ();
 
   if (!mVariableRuntimeCachePendingUpdate) {
-    //
-    // 0: Volatile, 1: HOB, 2: Non-Volatile.
-    // The index and attributes mapping must be kept in this order as FindVariable
-    // makes use of this mapping to implement search algorithm.
-    //
-    VariableStoreList[VariableStoreTypeVolatile] = mVariableRuntimeVolatileCacheBuffer;
-    VariableStoreList[VariableStoreTypeHob]      = mVariableRuntimeHobCacheBuffer;
-    VariableStoreList[VariableStoreTypeNv]       = mVariableRuntimeNvCacheBuffer;
-
-    for (StoreType = (VARIABLE_STORE_TYPE)0; StoreType < VariableStoreTypeMax; StoreType++) {
-      if (VariableStoreList[StoreType] == NULL) {
-        continue;
-      }
-
-      RtPtrTrack.StartPtr = GetStartPointer (VariableStoreList[StoreType]);
-      RtPtrTrack.EndPtr   = GetEndPointer (VariableStoreList[StoreType]);
-      RtPtrTrack.Volatile = (BOOLEAN)(StoreType == VariableStoreTypeVolatile);
-
-      Status = FindVariableEx (VariableName, VendorGuid, FALSE, &RtPtrTrack, mVariableAuthFormat);
-      if (!EFI_ERROR (Status)) {
-        break;
-      }
-    }
-
-    if (!EFI_ERROR (Status)) {
-      //
-      // Get data size
-      //
-      TempDataSize = DataSizeOfVariable (RtPtrTrack.CurrPtr, mVariableAuthFormat);
-      ASSERT (TempDataSize != 0);
-
-      if (*DataSize >= TempDataSize) {
-        if (Data == NULL) {
-          Status = EFI_INVALID_PARAMETER;
-          goto Done;
-        }
-
-        CopyMem (Data, GetVariableDataPtr (RtPtrTrack.CurrPtr, mVariableAuthFormat), TempDataSize);
-        *DataSize = TempDataSize;
-
-        UpdateVariableInfo (VariableName, VendorGuid, RtPtrTrack.Volatile, TRUE, FALSE, FALSE, TRUE, &mVariableInfo);
-
-        Status = EFI_SUCCESS;
-        goto Done;
-      } else {
-        *DataSize = TempDataSize;
-        Status    = EFI_BUFFER_TOO_SMALL;
-        goto Done;
-      }
-    }
-  }
-
-Done:
-  if ((Status == EFI_SUCCESS) || (Status == EFI_BUFFER_TOO_SMALL)) {
-    if ((Attributes != NULL) && (RtPtrTrack.CurrPtr != NULL)) {
-      *Attributes = RtPtrTrack.CurrPtr->Attributes;
+    InitRuntimeCacheReader (&Reader);
+    Status = RuntimeCacheFindVariable (&Reader, VariableName, VendorGuid, Attributes, DataSize, Data, &Volatile);
+    if (Status == EFI_SUCCESS) {
+      UpdateVariableInfo (VariableName, VendorGuid, Volatile, TRUE, FALSE, FALSE, TRUE, &mVariableInfo);
     }
   }
 
@@ -872,6 +852,9 @@ RuntimeServiceGetVariable (
 /**
   Finds the next available variable in a runtime cache variable store.
 
+  SMM updates the runtime caches as soon as a variable changes, so the caches are
+  read without a SMI. A read that overlaps such an update is repeated.
+
   @param[in, out] VariableNameSize   Size of the variable name.
   @param[in, out] VariableName       Pointer to variable name.
   @param[in, out] VendorGuid         Variable Vendor Guid.
@@ -889,10 +872,8 @@ GetNextVariableNameInRuntimeCache (
   IN OUT  EFI_GUID  *VendorGuid
   )
 {
-  EFI_STATUS             Status;
-  UINTN                  VarNameSize;
-  VARIABLE_HEADER        *VariablePtr;
-  VARIABLE_STORE_HEADER  *VariableStoreHeader[VariableStoreTypeMax];
+  EFI_STATUS                     Status;
+  VARIABLE_RUNTIME_CACHE_READER  Reader;
 
   Status = EFI_NOT_FOUND;
 
@@ -908,35 +889,8 @@ GetNextVariableNameInRuntimeCache (
 
   mVariableRuntimeCacheReadLock = TRUE;
   if (!mVariableRuntimeCachePendingUpdate) {
-    //
-    // 0: Volatile, 1: HOB, 2: Non-Volatile.
-    // The index and attributes mapping must be kept in this order as FindVariable
-    // makes use of this mapping to implement search algorithm.
-    //
-    VariableStoreHeader[VariableStoreTypeVolatile] = mVariableRuntimeVolatileCacheBuffer;
-    VariableStoreHeader[VariableStoreTypeHob]      = mVariableRuntimeHobCacheBuffer;
-    VariableStoreHeader[VariableStoreTypeNv]       = mVariableRuntimeNvCacheBuffer;
-
-    Status =  VariableServiceGetNextVariableInternal (
-                VariableName,
-                VendorGuid,
-                VariableStoreHeader,
-                &VariablePtr,
-                mVariableAuthFormat
-                );
-    if (!EFI_ERROR (Status)) {
-      VarNameSize = NameSizeOfVariable (VariablePtr, mVariableAuthFormat);
-      ASSERT (VarNameSize != 0);
-      if (VarNameSize <= *VariableNameSize) {
-        CopyMem (VariableName, GetVariableNamePtr (VariablePtr, mVariableAuthFormat), VarNameSize);
-        CopyMem (VendorGuid, GetVendorGuidPtr (VariablePtr, mVariableAuthFormat), sizeof (EFI_GUID));
-        Status = EFI_SUCCESS;
-      } else {
-        Status = EFI_BUFFER_TOO_SMALL;
-      }
-
-      *VariableNameSize = VarNameSize;
-    }
+    InitRuntimeCacheReader (&Reader);
+    Status = RuntimeCacheGetNextVariableName (&Reader, VariableNameSize, VariableName, VendorGuid);
   }
 
   mVariableRuntimeCacheReadLock = FALSE;
@@ -1198,6 +1152,168 @@ Done:
   return Status;
 }
 
+/**
+  Set a batch of non-volatile variables.
+
+  The variables are sent to SMM in chunks that fit in the variable communicate
+  buffer, and SMM writes all of them to the variable store with one FTW write
+  when the last chunk arrives.
+
+  Caution: This function may receive untrusted input.
+  The sizes of the entries are external input, so this function will validate
+  them as RuntimeServiceSetVariable() does.
+
+  @param[in]  This              The EDKII_VARIABLE_BATCH_PROTOCOL instance.
+  @param[in]  EntryCount        The number of entries in Entries.
+  @param[in]  Entries           The variables to set.
+  @param[out] FailedEntry       The index of the entry that failed, if the
+                                returned status is the status of an entry.
+
+  @retval EFI_SUCCESS           All the variables were set.
+  @retval EFI_INVALID_PARAMETER Entries is NULL and EntryCount is not 0, or an
+                                entry is not valid.
+  @retval EFI_BAD_BUFFER_SIZE   The batch is too large to be set at once.
+  @retval EFI_UNSUPPORTED       The variable store cannot be updated atomically.
+  @retval EFI_OUT_OF_RESOURCES  There is not enough memory to send the batch.
+  @retval Others                The status of the entry that failed, no variable
+                                was set.
+**/
+EFI_STATUS
+EFIAPI
+VariableBatchSetVariables (
+  IN CONST EDKII_VARIABLE_BATCH_PROTOCOL  *This,
+  IN       UINTN                          EntryCount,
+  IN       EDKII_VARIABLE_BATCH_ENTRY     *Entries,
+  OUT      UINTN                          *FailedEntry OPTIONAL
+  )
+{
+  EFI_STATUS                                   Status;
+  UINTN                                        Index;
+  UINTN                                        ChunkStart;
+  UINTN                                        ChunkCount;
+  UINTN                                        ChunkSize;
+  UINTN                                        MaxChunkSize;
+  UINTN                                        BatchSize;
+  UINTN                                        EntrySize;
+  UINTN                                        VariableNameSize;
+  SMM_VARIABLE_COMMUNICATE_SET_VARIABLE_BATCH  *SetVariableBatch;
+  SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE     *SmmVariableHeader;
+
+  if (FailedEntry != NULL) {
+    *FailedEntry = MAX_UINTN;
+  }
+
+  if ((Entries == NULL) && (EntryCount != 0)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (EntryCount == 0) {
+    return EFI_SUCCESS;
+  }
+
+  //
+  // Check the entries as SetVariable() does and size the batch. Every entry
+  // must fit in a chunk of its own.
+  //
+  MaxChunkSize = mVariableBufferPayloadSize - sizeof (SMM_VARIABLE_COMMUNICATE_SET_VARIABLE_BATCH);
+  BatchSize    = 0;
+  for (Index = 0; Index < EntryCount; Index++) {
+    if ((Entries[Index].VariableName == NULL) || (Entries[Index].VariableName[0] == 0) || (Entries[Index].VendorGuid == NULL) ||
+        ((Entries[Index].DataSize != 0) && (Entries[Index].Data == NULL)))
+    {
+      break;
+    }
+
+    VariableNameSize = StrSize (Entries[Index].VariableName);
+    if ((VariableNameSize > MaxChunkSize - OFFSET_OF (SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE, Name)) ||
+        (Entries[Index].DataSize > MaxChunkSize - OFFSET_OF (SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE, Name) - VariableNameSize))
+    {
+      break;
+    }
+
+    EntrySize = ALIGN_VALUE (OFFSET_OF (SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE, Name) + VariableNameSize + Entries[Index].DataSize, sizeof (UINTN));
+    if ((EntrySize > MaxChunkSize) || (EntrySize > MAX_UINTN - BatchSize)) {
+      break;
+    }
+
+    BatchSize += EntrySize;
+  }
+
+  if (Index < EntryCount) {
+    if (FailedEntry != NULL) {
+      *FailedEntry = Index;
+    }
+
+    return EFI_INVALID_PARAMETER;
+  }
+
+  AcquireLockOnlyAtBootTime (&mVariableServicesLock);
+
+  //
+  // Send the entries in the variable communicate buffer, as many of them as fit
+  // at a time.
+  //
+  Status = EFI_SUCCESS;
+  for (ChunkStart = 0; ChunkStart < EntryCount; ChunkStart += ChunkCount) {
+    ChunkSize = 0;
+    for (ChunkCount = 0; ChunkStart + ChunkCount < EntryCount; ChunkCount++) {
+      Index     = ChunkStart + ChunkCount;
+      EntrySize = ALIGN_VALUE (
+                    OFFSET_OF (SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE, Name) + StrSize (Entries[Index].VariableName) + Entries[Index].DataSize,
+                    sizeof (UINTN)
+                    );
+      if (EntrySize > MaxChunkSize - ChunkSize) {
+        break;
+      }
+
+      ChunkSize += EntrySize;
+    }
+
+    Status = InitCommunicateBuffer (
+               (VOID **)&SetVariableBatch,
+               sizeof (SMM_VARIABLE_COMMUNICATE_SET_VARIABLE_BATCH) + ChunkSize,
+               SMM_VARIABLE_FUNCTION_SET_VARIABLE_BATCH
+               );
+    if (EFI_ERROR (Status)) {
+      break;
+    }
+
+    ASSERT (SetVariableBatch != NULL);
+
+    SetVariableBatch->EntryCount  = ChunkCount;
+    SetVariableBatch->FailedEntry = MAX_UINTN;
+    SetVariableBatch->BatchSize   = BatchSize;
+    SetVariableBatch->FirstChunk  = (BOOLEAN)(ChunkStart == 0);
+    SetVariableBatch->LastChunk   = (BOOLEAN)(ChunkStart + ChunkCount == EntryCount);
+
+    SmmVariableHeader = (SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE *)(SetVariableBatch + 1);
+    for (Index = ChunkStart; Index < ChunkStart + ChunkCount; Index++) {
+      CopyGuid (&SmmVariableHeader->Guid, Entries[Index].VendorGuid);
+      SmmVariableHeader->DataSize   = Entries[Index].DataSize;
+      SmmVariableHeader->NameSize   = StrSize (Entries[Index].VariableName);
+      SmmVariableHeader->Attributes = Entries[Index].Attributes;
+      CopyMem (SmmVariableHeader->Name, Entries[Index].VariableName, SmmVariableHeader->NameSize);
+      CopyMem ((UINT8 *)SmmVariableHeader->Name + SmmVariableHeader->NameSize, Entries[Index].Data, Entries[Index].DataSize);
+
+      EntrySize         = OFFSET_OF (SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE, Name) + SmmVariableHeader->NameSize + SmmVariableHeader->DataSize;
+      SmmVariableHeader = (SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE *)((UINT8 *)SmmVariableHeader + ALIGN_VALUE (EntrySize, sizeof (UINTN)));
+    }
+
+    Status = SendCommunicateBuffer (sizeof (SMM_VARIABLE_COMMUNICATE_SET_VARIABLE_BATCH) + ChunkSize);
+    if (EFI_ERROR (Status)) {
+      if ((FailedEntry != NULL) && (SetVariableBatch->FailedEntry < EntryCount)) {
+        *FailedEntry = SetVariableBatch->FailedEntry;
+      }
+
+      break;
+    }
+  }
+
+  ReleaseLockOnlyAtBootTime (&mVariableServicesLock);
+
+  return Status;
+}
+
 /**
   This code returns information about the EFI variables.
 
@@ -1361,6 +1477,7 @@ VariableAddressChangeEvent (
   EfiConvertPointer (EFI_OPTIONAL_PTR, (VOID **)&mVariableRuntimeHobCacheBuffer);
   EfiConvertPointer (EFI_OPTIONAL_PTR, (VOID **)&mVariableRuntimeNvCacheBuffer);
   EfiConvertPointer (EFI_OPTIONAL_PTR, (VOID **)&mVariableRuntimeVolatileCacheBuffer);
+  VariableIndexConvertPointers (EfiConvertPointer);
 }
 
 /**
@@ -1570,6 +1687,8 @@ SendRuntimeVariableCacheContextToSmm (
   SmmRuntimeVarCacheContext->PendingUpdate        = &mVariableRuntimeCachePendingUpdate;
   SmmRuntimeVarCacheContext->ReadLock             = &mVariableRuntimeCacheReadLock;
   SmmRuntimeVarCacheContext->HobFlushComplete     = &mHobFlushComplete;
+  SmmRuntimeVarCacheContext->Sequence             = &mVariableRuntimeCacheSequence;
+  SmmRuntimeVarCacheContext->Generation           = &mVariableRuntimeCacheGeneration;
 
   //
   // Request to unblock this region to be accessible from inside MM environment
@@ -1599,6 +1718,22 @@ SendRuntimeVariableCacheContextToSmm (
     goto Done;
   }
 
+  Status = MmUnblockMemoryRequest (
+             (EFI_PHYSICAL_ADDRESS)ALIGN_VALUE ((UINTN)SmmRuntimeVarCacheContext->Sequence - EFI_PAGE_SIZE + 1, EFI_PAGE_SIZE),
+             EFI_SIZE_TO_PAGES (sizeof (mVariableRuntimeCacheSequence))
+             );
+  if ((Status != EFI_UNSUPPORTED) && EFI_ERROR (Status)) {
+    goto Done;
+  }
+
+  Status = MmUnblockMemoryRequest (
+             (EFI_PHYSICAL_ADDRESS)ALIGN_VALUE ((UINTN)SmmRuntimeVarCacheContext->Generation - EFI_PAGE_SIZE + 1, EFI_PAGE_SIZE),
+             EFI_SIZE_TO_PAGES (sizeof (mVariableRuntimeCacheGeneration))
+             );
+  if ((Status != EFI_UNSUPPORTED) && EFI_ERROR (Status)) {
+    goto Done;
+  }
+
   //
   // Send data to SMM.
   //
@@ -1678,6 +1813,9 @@ SmmVariableReady (
             Status = SendRuntimeVariableCacheContextToSmm ();
             if (!EFI_ERROR (Status)) {
               SyncRuntimeCache ();
+              VariableIndexRegisterStore (mVariableRuntimeHobCacheBuffer, mVariableRuntimeHobCacheBufferSize);
+              VariableIndexRegisterStore (mVariableRuntimeNvCacheBuffer, mVariableRuntimeNvCacheBufferSize);
+              VariableIndexRegisterStore (mVariableRuntimeVolatileCacheBuffer, mVariableRuntimeVolatileCacheBufferSize);
             }
           }
         }
@@ -1773,6 +1911,15 @@ SmmVariableWriteReady (
                   );
   ASSERT_EFI_ERROR (Status);
 
+  mVariableBatch.SetVariables = VariableBatchSetVariables;
+  Status                      = gBS->InstallMultipleProtocolInterfaces (
+                                       &mHandle,
+                                       &gEdkiiVariableBatchProtocolGuid,
+                                       &mVariableBatch,
+                                       NULL
+                                       );
+  ASSERT_EFI_ERROR (Status);
+
   gBS->CloseEvent (Event);
 }
 
@@ -0,0 +1,549 @@
+/** @file
+  Throughput test of the Block I/O and Block I/O 2 protocols that VirtioBlkDxe
+  produces, built for execution in the UEFI Shell of a QEMU guest.
+
+  The test reads the beginning of the first virtio-blk disk, once with blocking
+  EFI_BLOCK_IO_PROTOCOL requests and once with EFI_BLOCK_IO2_PROTOCOL requests
+  kept in flight, reports the throughput of both, and checks that both return
+  the same data. The disk is never written. For example:
+
+    qemu-system-x86_64 -machine q35 -bios OVMF.fd \
+      -drive if=none,id=disk0,file=disk.img,format=raw,cache=none,aio=native \
+      -device virtio-blk-pci,drive=disk0 \
+      -drive file=fat:rw:TestDir,format=raw ...
+
+    Shell> fs0:VirtioBlkThroughputUnitTestUefiShell.efi
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+#include <Uefi.h>
+#include <IndustryStandard/Virtio.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/TimerLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/UnitTestLib.h>
+#include <Protocol/BlockIo.h>
+#include <Protocol/BlockIo2.h>
+#include <Protocol/VirtioDevice.h>
+
+#define UNIT_TEST_NAME     "VirtioBlkDxe Throughput Test"
+#define UNIT_TEST_VERSION  "1.0"
+
+#define THROUGHPUT_REGION_SIZE    SIZE_64MB
+#define THROUGHPUT_TRANSFER_SIZE  SIZE_1MB
+#define THROUGHPUT_MAX_TOKENS     16
+#define COMPARE_REGION_SIZE       SIZE_8MB
+
+///
+/// The disk under test.
+///
+EFI_BLOCK_IO_PROTOCOL   *mBlockIo;
+EFI_BLOCK_IO2_PROTOCOL  *mBlockIo2;
+UINTN                   mRegionSize;
+
+///
+/// Range of the performance counter.
+///
+UINT64  mCounterStart;
+UINT64  mCounterEnd;
+
+///
+/// Throughput of the blocking reads, in MB/s; zero if not measured.
+///
+UINT64  mBlockIoThroughput;
+
+///
+/// Transfer sizes, in blocks, of the Block I/O 2 reads that are compared with
+/// the Block I/O reads. They include transfers that straddle a segment of the
+/// driver.
+///
+CONST UINTN  mMixedTransferBlocks[] = { 1, 7, 64, 513, 2049 };
+
+//
+// Accumulates the performance counter ticks between updates. Updates must be
+// more frequent than the wraparound of the counter.
+//
+typedef struct {
+  UINT64    Last;
+  UINT64    Ticks;
+} STOPWATCH;
+
+typedef struct {
+  EFI_BLOCK_IO2_TOKEN    Token;
+  BOOLEAN                InFlight;
+} ASYNC_READ;
+
+/**
+  Start a stopwatch.
+
+  @param[out] Watch  The stopwatch to start.
+**/
+VOID
+StopwatchStart (
+  OUT STOPWATCH  *Watch
+  )
+{
+  Watch->Ticks = 0;
+  Watch->Last  = GetPerformanceCounter ();
+}
+
+/**
+  Add the ticks since the last update to a stopwatch.
+
+  @param[in, out] Watch  The stopwatch to update.
+**/
+VOID
+StopwatchUpdate (
+  IN OUT STOPWATCH  *Watch
+  )
+{
+  UINT64  Now;
+
+  Now = GetPerformanceCounter ();
+  if (mCounterStart < mCounterEnd) {
+    if (Now >= Watch->Last) {
+      Watch->Ticks += Now - Watch->Last;
+    } else {
+      Watch->Ticks += (mCounterEnd - Watch->Last) + (Now - mCounterStart) + 1;
+    }
+  } else {
+    if (Now <= Watch->Last) {
+      Watch->Ticks += Watch->Last - Now;
+    } else {
+      Watch->Ticks += (Watch->Last - mCounterEnd) + (mCounterStart - Now) + 1;
+    }
+  }
+
+  Watch->Last = Now;
+}
+
+/**
+  Compute a throughput.
+
+  @param[in] Bytes  The number of bytes transferred.
+  @param[in] Watch  The stopwatch that timed the transfer.
+
+  @return  The throughput in MB/s.
+**/
+UINT64
+Throughput (
+  IN UINTN            Bytes,
+  IN CONST STOPWATCH  *Watch
+  )
+{
+  UINT64  NanoSeconds;
+
+  NanoSeconds = MAX (GetTimeInNanoSecond (Watch->Ticks), 1);
+  return DivU64x64Remainder (MultU64x32 (Bytes, 1000), NanoSeconds, NULL);
+}
+
+/**
+  Read the beginning of the disk with blocking Block I/O requests.
+
+  @param[out] Buffer        The buffer to read into.
+  @param[in]  Size          The number of bytes to read, whole blocks.
+  @param[in]  TransferSize  The size of each request, whole blocks.
+  @param[out] Watch         The stopwatch that times the reads.
+
+  @return  The status of the first failed request, or EFI_SUCCESS.
+**/
+EFI_STATUS
+ReadBlocking (
+  OUT VOID       *Buffer,
+  IN  UINTN      Size,
+  IN  UINTN      TransferSize,
+  OUT STOPWATCH  *Watch
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       Offset;
+  UINTN       Length;
+
+  StopwatchStart (Watch);
+  for (Offset = 0; Offset < Size; Offset += Length) {
+    Length = MIN (Size - Offset, TransferSize);
+    Status = mBlockIo->ReadBlocks (
+                         mBlockIo,
+                         mBlockIo->Media->MediaId,
+                         Offset / mBlockIo->Media->BlockSize,
+                         Length,
+                         (UINT8 *)Buffer + Offset
+                         );
+    StopwatchUpdate (Watch);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Read the beginning of the disk with up to THROUGHPUT_MAX_TOKENS Block I/O 2
+  requests in flight.
+
+  @param[out] Buffer          The buffer to read into.
+  @param[in]  Size            The number of bytes to read, whole blocks.
+  @param[in]  TransferBlocks  The sizes of the requests in blocks, used in
+                              turn.
+  @param[in]  TransferCount   The number of elements in TransferBlocks.
+  @param[out] Watch           The stopwatch that times the reads.
+
+  @return  The status of the first failed request, or EFI_SUCCESS.
+**/
+EFI_STATUS
+ReadAsync (
+  OUT VOID         *Buffer,
+  IN  UINTN        Size,
+  IN  CONST UINTN  *TransferBlocks,
+  IN  UINTN        TransferCount,
+  OUT STOPWATCH    *Watch
+  )
+{
+  ASYNC_READ  Read[THROUGHPUT_MAX_TOKENS];
+  UINT32      BlockSize;
+  UINTN       Offset;
+  UINTN       Length;
+  UINTN       Next;
+  UINTN       InFlight;
+  UINTN       Index;
+  EFI_STATUS  Status;
+
+  for (Index = 0; Index < THROUGHPUT_MAX_TOKENS; Index++) {
+    Read[Index].InFlight = FALSE;
+    Status               = gBS->CreateEvent (0, 0, NULL, NULL, &Read[Index].Token.Event);
+    if (EFI_ERROR (Status)) {
+      while (Index > 0) {
+        gBS->CloseEvent (Read[--Index].Token.Event);
+      }
+
+      return Status;
+    }
+  }
+
+  BlockSize = mBlockIo2->Media->BlockSize;
+  Offset    = 0;
+  Next      = 0;
+  InFlight  = 0;
+  Status    = EFI_SUCCESS;
+
+  StopwatchStart (Watch);
+  do {
+    for (Index = 0; Index < THROUGHPUT_MAX_TOKENS; Index++) {
+      if (Read[Index].InFlight) {
+        if (gBS->CheckEvent (Read[Index].Token.Event) != EFI_SUCCESS) {
+          continue;
+        }
+
+        Read[Index].InFlight = FALSE;
+        InFlight--;
+        if (EFI_ERROR (Read[Index].Token.TransactionStatus) && !EFI_ERROR (Status)) {
+          Status = Read[Index].Token.TransactionStatus;
+        }
+      }
+
+      if (EFI_ERROR (Status) || (Offset == Size)) {
+        continue;
+      }
+
+      Length                              = MIN (Size - Offset, TransferBlocks[Next++ % TransferCount] * BlockSize);
+      Read[Index].Token.TransactionStatus = EFI_NOT_READY;
+
+      Status = mBlockIo2->ReadBlocksEx (
+                            mBlockIo2,
+                            mBlockIo2->Media->MediaId,
+                            Offset / BlockSize,
+                            &Read[Index].Token,
+                            Length,
+                            (UINT8 *)Buffer + Offset
+                            );
+      if (!EFI_ERROR (Status)) {
+        Read[Index].InFlight = TRUE;
+        InFlight++;
+        Offset += Length;
+      }
+    }
+
+    StopwatchUpdate (Watch);
+  } while (InFlight > 0);
+
+  for (Index = 0; Index < THROUGHPUT_MAX_TOKENS; Index++) {
+    gBS->CloseEvent (Read[Index].Token.Event);
+  }
+
+  return Status;
+}
+
+/**
+  Measure the throughput of blocking Block I/O reads.
+
+  @param[in]  Context    Unused.
+
+  @retval  UNIT_TEST_PASSED             The reads succeeded.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  A read failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+BlockIoReadThroughput (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  VOID        *Buffer;
+  STOPWATCH   Watch;
+  EFI_STATUS  Status;
+
+  Buffer = AllocatePool (mRegionSize);
+  UT_ASSERT_NOT_NULL (Buffer);
+
+  Status = ReadBlocking (Buffer, mRegionSize, THROUGHPUT_TRANSFER_SIZE, &Watch);
+  FreePool (Buffer);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  mBlockIoThroughput = Throughput (mRegionSize, &Watch);
+  UT_LOG_INFO ("BlockIo:  %Lu MB/s reading 0x%x bytes\n", mBlockIoThroughput, mRegionSize);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Measure the throughput of Block I/O 2 reads kept in flight.
+
+  @param[in]  Context    Unused.
+
+  @retval  UNIT_TEST_PASSED             The reads succeeded.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  A read failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+BlockIo2ReadThroughput (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  VOID        *Buffer;
+  UINTN       TransferBlocks;
+  STOPWATCH   Watch;
+  EFI_STATUS  Status;
+  UINT64      BlockIo2Throughput;
+
+  Buffer = AllocatePool (mRegionSize);
+  UT_ASSERT_NOT_NULL (Buffer);
+
+  TransferBlocks = THROUGHPUT_TRANSFER_SIZE / mBlockIo2->Media->BlockSize;
+  Status         = ReadAsync (Buffer, mRegionSize, &TransferBlocks, 1, &Watch);
+  FreePool (Buffer);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  BlockIo2Throughput = Throughput (mRegionSize, &Watch);
+  UT_LOG_INFO ("BlockIo2: %Lu MB/s reading 0x%x bytes\n", BlockIo2Throughput, mRegionSize);
+  if (mBlockIoThroughput > 0) {
+    UT_LOG_INFO (
+      "BlockIo2: %Lu%% of BlockIo\n",
+      DivU64x64Remainder (MultU64x32 (BlockIo2Throughput, 100), mBlockIoThroughput, NULL)
+      );
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Check that Block I/O 2 reads of mixed sizes, kept in flight, return the same
+  data as blocking Block I/O reads.
+
+  @param[in]  Context    Unused.
+
+  @retval  UNIT_TEST_PASSED             The data matches.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  A read failed, or the data differs.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+BlockIo2DataMatchesBlockIo (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINTN       Size;
+  UINT8       *Expected;
+  UINT8       *Actual;
+  STOPWATCH   Watch;
+  EFI_STATUS  Status;
+  INTN        Difference;
+
+  Difference = 0;
+  Size       = MIN (mRegionSize, COMPARE_REGION_SIZE);
+  Expected   = AllocatePool (Size);
+  Actual     = AllocatePool (Size);
+  if ((Expected == NULL) || (Actual == NULL)) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto FreeBuffers;
+  }
+
+  SetMem (Actual, Size, 0xA5);
+
+  Status = ReadBlocking (Expected, Size, THROUGHPUT_TRANSFER_SIZE, &Watch);
+  if (EFI_ERROR (Status)) {
+    goto FreeBuffers;
+  }
+
+  Status = ReadAsync (
+             Actual,
+             Size,
+             mMixedTransferBlocks,
+             ARRAY_SIZE (mMixedTransferBlocks),
+             &Watch
+             );
+  if (EFI_ERROR (Status)) {
+    goto FreeBuffers;
+  }
+
+  Difference = CompareMem (Expected, Actual, Size);
+
+FreeBuffers:
+  if (Expected != NULL) {
+    FreePool (Expected);
+  }
+
+  if (Actual != NULL) {
+    FreePool (Actual);
+  }
+
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+  UT_ASSERT_EQUAL (Difference, 0);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Find the first virtio-blk disk that produces both Block I/O protocols.
+
+  @retval EFI_SUCCESS    mBlockIo, mBlockIo2 and mRegionSize are set.
+  @retval EFI_NOT_FOUND  There is no such disk.
+**/
+EFI_STATUS
+FindVirtioBlkDisk (
+  VOID
+  )
+{
+  EFI_STATUS              Status;
+  EFI_HANDLE              *Handles;
+  UINTN                   HandleCount;
+  UINTN                   Index;
+  VIRTIO_DEVICE_PROTOCOL  *VirtIo;
+  UINT64                  DiskSize;
+
+  Status = gBS->LocateHandleBuffer (
+                  ByProtocol,
+                  &gEfiBlockIo2ProtocolGuid,
+                  NULL,
+                  &HandleCount,
+                  &Handles
+                  );
+  if (EFI_ERROR (Status)) {
+    return EFI_NOT_FOUND;
+  }
+
+  Status = EFI_NOT_FOUND;
+  for (Index = 0; Index < HandleCount; Index++) {
+    if (EFI_ERROR (gBS->HandleProtocol (Handles[Index], &gVirtioDeviceProtocolGuid, (VOID **)&VirtIo)) ||
+        (VirtIo->SubSystemDeviceId != VIRTIO_SUBSYSTEM_BLOCK_DEVICE) ||
+        EFI_ERROR (gBS->HandleProtocol (Handles[Index], &gEfiBlockIoProtocolGuid, (VOID **)&mBlockIo)) ||
+        EFI_ERROR (gBS->HandleProtocol (Handles[Index], &gEfiBlockIo2ProtocolGuid, (VOID **)&mBlockIo2)) ||
+        !mBlockIo->Media->MediaPresent)
+    {
+      continue;
+    }
+
+    DiskSize    = MultU64x32 (mBlockIo->Media->LastBlock + 1, mBlockIo->Media->BlockSize);
+    mRegionSize = (UINTN)MIN (DiskSize, THROUGHPUT_REGION_SIZE);
+    mRegionSize = mRegionSize - mRegionSize % mBlockIo->Media->BlockSize;
+    Status      = EFI_SUCCESS;
+    break;
+  }
+
+  FreePool (Handles);
+  return Status;
+}
+
+/**
+  Initialize the unit test framework, suite, and unit tests for the
+  VirtioBlkDxe throughput test, and run them.
+
+  @retval  EFI_SUCCESS           All test cases were dispatched.
+  @retval  EFI_NOT_FOUND         There is no virtio-blk disk to test.
+  @retval  EFI_OUT_OF_RESOURCES  There are not enough resources available to
+                                 initialize the unit tests.
+**/
+EFI_STATUS
+EFIAPI
+UefiTestMain (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      ThroughputTests;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_NAME, UNIT_TEST_VERSION));
+
+  Status = FindVirtioBlkDisk ();
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "No virtio-blk disk with Block I/O 2 found\n"));
+    return Status;
+  }
+
+  GetPerformanceCounterProperties (&mCounterStart, &mCounterEnd);
+
+  //
+  // Start setting up the test framework for running the tests.
+  //
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_NAME, gEfiCallerBaseName, UNIT_TEST_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  //
+  // Populate the ThroughputTests Unit Test Suite.
+  //
+  Status = CreateUnitTestSuite (&ThroughputTests, Framework, "VirtioBlkDxe Throughput Tests", "VirtioBlkDxe.Throughput", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for ThroughputTests\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  AddTestCase (ThroughputTests, "Blocking BlockIo reads", "BlockIoRead", BlockIoReadThroughput, NULL, NULL, NULL);
+  AddTestCase (ThroughputTests, "BlockIo2 reads kept in flight", "BlockIo2Read", BlockIo2ReadThroughput, NULL, NULL, NULL);
+  AddTestCase (ThroughputTests, "BlockIo2 reads of mixed sizes return the BlockIo data", "BlockIo2Data", BlockIo2DataMatchesBlockIo, NULL, NULL, NULL);
+
+  //
+  // Execute the tests.
+  //
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return Status;
+}
+
+/**
+  Standard UEFI entry point for target based unit test execution from UEFI
+  Shell.
+**/
+EFI_STATUS
+EFIAPI
+DxeEntryPoint (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  )
+{
+  return UefiTestMain ();
+}
@@ -1,7 +1,7 @@
 /** @file
 
   Internal definitions for the virtio-blk driver, which produces Block I/O
-  Protocol instances for virtio-blk devices.
+  and Block I/O 2 Protocol instances for virtio-blk devices.
 
   Copyright (C) 2012, Red Hat, Inc.
 
@@ -13,13 +13,82 @@
 #define _VIRTIO_BLK_DXE_H_
 
 #include <Protocol/BlockIo.h>
+#include <Protocol/BlockIo2.h>
 #include <Protocol/ComponentName.h>
 #include <Protocol/DriverBinding.h>
 
 #include <IndustryStandard/Virtio.h>
+#include <IndustryStandard/VirtioBlk.h>
 
 #define VBLK_SIG  SIGNATURE_32 ('V', 'B', 'L', 'K')
 
+//
+// A request occupies a header, a data and a status descriptor; flush requests
+// have no data descriptor.
+//
+#define VBLK_DESC_PER_REQUEST  3
+
+//
+// Upper limit for the number of requests in flight on the virtqueue.
+//
+#define VBLK_MAX_REQUEST_SLOTS  128
+
+//
+// Read and write requests are split into segments of at most this size, so
+// that a large transfer keeps several requests in flight.
+//
+#define VBLK_SEGMENT_SIZE  SIZE_256KB
+
+//
+// Period of the timer that completes the Block I/O 2 requests. The timer only
+// runs while requests are queued.
+//
+#define VBLK_ASYNC_TIMER  EFI_TIMER_PERIOD_MILLISECONDS (1)
+
+//
+// The part of a request slot that the device accesses. Each slot has its own
+// header, status byte and indirect descriptor table, so the slots can be in
+// flight at the same time.
+//
+typedef struct {
+  VIRTIO_BLK_REQ    Header;
+  VRING_DESC        Desc[VBLK_DESC_PER_REQUEST]; // used only with
+                                                 // VIRTIO_F_RING_INDIRECT_DESC
+  volatile UINT8    HostStatus;
+  UINT8             Reserved[15];                // keep Desc 16-byte aligned
+} VBLK_SHARED_SLOT;
+
+#define VBLK_IO_REQ_SIG  SIGNATURE_32 ('V', 'B', 'R', 'Q')
+
+//
+// A read, write or flush request, queued on VBLK_DEV.RequestList until all of
+// its segments have completed.
+//
+typedef struct {
+  UINT32                 Signature;
+  LIST_ENTRY             Link;
+  EFI_BLOCK_IO2_TOKEN    *Token;      // NULL for a blocking request
+  EFI_LBA                Lba;         // first block not yet submitted
+  UINT8                  *Buffer;     // first byte not yet submitted
+  UINTN                  Remaining;   // bytes not yet submitted
+  UINTN                  InFlight;    // segments submitted, not yet completed
+  BOOLEAN                IsWrite;
+  BOOLEAN                IsFlush;
+  BOOLEAN                Completed;
+  EFI_STATUS             Status;
+} VBLK_IO_REQ;
+
+#define VBLK_IO_REQ_FROM_LINK(LinkPointer) \
+        CR (LinkPointer, VBLK_IO_REQ, Link, VBLK_IO_REQ_SIG)
+
+//
+// The guest side state of a request slot.
+//
+typedef struct {
+  VBLK_IO_REQ    *Req;                  // NULL if the slot is free
+  VOID           *DataMapping;          // NULL for flush requests
+} VBLK_SLOT;
+
 typedef struct {
   //
   // Parts of this structure are initialized / torn down in various functions
@@ -35,11 +104,30 @@ typedef struct {
   EFI_BLOCK_IO_PROTOCOL     BlockIo;           // VirtioBlkInit       1
   EFI_BLOCK_IO_MEDIA        BlockIoMedia;      // VirtioBlkInit       1
   VOID                      *RingMap;          // VirtioRingMap       2
+  EFI_BLOCK_IO2_PROTOCOL    BlockIo2;          // VirtioBlkInit       1
+  BOOLEAN                   IndirectDesc;      // VirtioBlkInit       1
+  UINT32                    SegmentSize;       // VirtioBlkInit       1
+  UINT16                    SlotCount;         // VirtioBlkInitSlots  2
+  VBLK_SLOT                 *Slot;             // VirtioBlkInitSlots  2
+  UINT16                    *FreeSlot;         // VirtioBlkInitSlots  2
+  UINT16                    FreeSlotCount;     // VirtioBlkInitSlots  2
+  VBLK_SHARED_SLOT          *Shared;           // VirtioBlkInitSlots  2
+  EFI_PHYSICAL_ADDRESS      SharedDeviceAddr;  // VirtioBlkInitSlots  2
+  VOID                      *SharedMap;        // VirtioBlkInitSlots  2
+  UINT16                    NextAvailIdx;      // VirtioBlkInitSlots  2
+  UINT16                    LastUsedIdx;       // VirtioBlkInitSlots  2
+  LIST_ENTRY                RequestList;       // VirtioBlkInitSlots  2
+  BOOLEAN                   DeviceError;       // VirtioBlkInitSlots  2
+  BOOLEAN                   AsyncTimerArmed;   // VirtioBlkInitSlots  2
+  EFI_EVENT                 AsyncTimer;        // DriverBindingStart  0
 } VBLK_DEV;
 
 #define VIRTIO_BLK_FROM_BLOCK_IO(BlockIoPointer) \
         CR (BlockIoPointer, VBLK_DEV, BlockIo, VBLK_SIG)
 
+#define VIRTIO_BLK_FROM_BLOCK_IO2(BlockIo2Pointer) \
+        CR (BlockIo2Pointer, VBLK_DEV, BlockIo2, VBLK_SIG)
+
 /**
 
   Device probe function for this driver.
@@ -103,7 +191,8 @@ VirtioBlkDriverBindingSupported (
 
   @retval EFI_SUCCESS           Driver instance has been created and
                                 initialized  for the virtio-blk device, it
-                                is now accessible via EFI_BLOCK_IO_PROTOCOL.
+                                is now accessible via EFI_BLOCK_IO_PROTOCOL
+                                and EFI_BLOCK_IO2_PROTOCOL.
 
   @retval EFI_OUT_OF_RESOURCES  Memory allocation failed.
 
@@ -123,7 +212,8 @@ VirtioBlkDriverBindingStart (
 
 /**
 
-  Stop driving a virtio-blk device and remove its BlockIo interface.
+  Stop driving a virtio-blk device and remove its BlockIo and BlockIo2
+  interfaces.
 
   This function replays the success path of DriverBindingStart() in reverse.
   The host side virtio-blk device is reset, so that the OS boot loader or the
@@ -244,6 +334,185 @@ VirtioBlkFlushBlocks (
   IN EFI_BLOCK_IO_PROTOCOL  *This
   );
 
+//
+// UEFI Spec 2.9, 13.10 EFI Block I/O 2 Protocol
+//
+EFI_STATUS
+EFIAPI
+VirtioBlkResetEx (
+  IN EFI_BLOCK_IO2_PROTOCOL  *This,
+  IN BOOLEAN                 ExtendedVerification
+  );
+
+/**
+
+  ReadBlocksEx() operation for virtio-blk.
+
+  The request is queued and submitted to the device in segments; Token->Event
+  is signaled from the timer of the device once all segments have completed.
+  If Token->Event is NULL, the request is completed before returning.
+
+  Parameter checks are implemented in VerifyReadWriteRequest().
+
+**/
+
+EFI_STATUS
+EFIAPI
+VirtioBlkReadBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL  *This,
+  IN     UINT32                  MediaId,
+  IN     EFI_LBA                 Lba,
+  IN OUT EFI_BLOCK_IO2_TOKEN     *Token,
+  IN     UINTN                   BufferSize,
+  OUT    VOID                    *Buffer
+  );
+
+/**
+
+  WriteBlocksEx() operation for virtio-blk.
+
+  See VirtioBlkReadBlocksEx() for the completion of the request.
+
+**/
+
+EFI_STATUS
+EFIAPI
+VirtioBlkWriteBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL  *This,
+  IN     UINT32                  MediaId,
+  IN     EFI_LBA                 Lba,
+  IN OUT EFI_BLOCK_IO2_TOKEN     *Token,
+  IN     UINTN                   BufferSize,
+  IN     VOID                    *Buffer
+  );
+
+/**
+
+  FlushBlocksEx() operation for virtio-blk.
+
+  The flush request is submitted once the requests queued before it have
+  completed, and the requests queued after it wait for the flush.
+
+**/
+
+EFI_STATUS
+EFIAPI
+VirtioBlkFlushBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL  *This,
+  IN OUT EFI_BLOCK_IO2_TOKEN     *Token
+  );
+
+//
+// Request queue of the virtio-blk driver, implemented in VirtioBlkRequest.c.
+//
+
+/**
+
+  Set up the request slots of a virtio-blk device, after its virtqueue has
+  been initialized and mapped.
+
+  @param[in out] Dev  The device to set up. Dev->Ring, Dev->IndirectDesc and
+                      Dev->SegmentSize must be valid.
+
+  @retval EFI_SUCCESS           The request slots are set up.
+
+  @retval EFI_OUT_OF_RESOURCES  Memory allocation failed.
+
+  @return                       Error codes from AllocateSharedPages() or
+                                VirtioMapAllBytesInSharedBuffer().
+
+**/
+EFI_STATUS
+VirtioBlkInitSlots (
+  IN OUT VBLK_DEV  *Dev
+  );
+
+/**
+
+  Release the request slots of a virtio-blk device. The device must have been
+  reset, and no request may be queued.
+
+  @param[in out] Dev  The device to clean up.
+
+**/
+VOID
+VirtioBlkUninitSlots (
+  IN OUT VBLK_DEV  *Dev
+  );
+
+/**
+
+  Queue a read, write or flush request on a virtio-blk device, and submit as
+  much of it as the free request slots allow.
+
+  The request parameters must have been verified by the caller, see
+  SynchronousRequest() in VirtioBlk.c.
+
+  @param[in] Dev             The virtio-blk device the request is targeted at.
+
+  @param[in] Token           The token to signal when the request completes.
+                             If NULL, or if Token->Event is NULL, the function
+                             waits for the request to complete.
+
+  @param[in] Lba             Logical Block Address of the transfer; zero for a
+                             flush.
+
+  @param[in] BufferSize      Size of the transfer, in bytes. Zero for a flush,
+                             positive otherwise.
+
+  @param[in out] Buffer      The guest side area of the transfer.
+
+  @param[in] RequestIsWrite  TRUE iff data transfer goes from guest to device.
+                             TRUE for a flush.
+
+  @retval EFI_SUCCESS           The request completed successfully, or it has
+                                been queued for Token.
+
+  @retval EFI_OUT_OF_RESOURCES  The request could not be queued.
+
+  @retval EFI_DEVICE_ERROR      The request failed.
+
+**/
+EFI_STATUS
+VirtioBlkQueueRequest (
+  IN     VBLK_DEV             *Dev,
+  IN     EFI_BLOCK_IO2_TOKEN  *Token OPTIONAL,
+  IN     EFI_LBA              Lba,
+  IN     UINTN                BufferSize,
+  IN OUT VOID                 *Buffer,
+  IN     BOOLEAN              RequestIsWrite
+  );
+
+/**
+
+  Timer notification function that completes the requests of a virtio-blk
+  device and submits the queued ones.
+
+  @param[in] Event    Event whose notification function is being invoked.
+
+  @param[in] Context  Pointer to the VBLK_DEV structure.
+
+**/
+VOID
+EFIAPI
+VirtioBlkAsyncTimer (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  );
+
+/**
+
+  Abort the queued Block I/O 2 requests of a virtio-blk device, and wait for
+  the requests already submitted to the device.
+
+  @param[in out] Dev  The device whose requests to abort.
+
+**/
+VOID
+VirtioBlkAbortRequests (
+  IN OUT VBLK_DEV  *Dev
+  );
+
 //
 // The purpose of the following scaffolding (EFI_COMPONENT_NAME_PROTOCOL and
 // EFI_COMPONENT_NAME2_PROTOCOL implementation) is to format the driver's name
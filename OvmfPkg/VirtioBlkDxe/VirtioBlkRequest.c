@@ -0,0 +1,821 @@
+/** @file
+
+  Request queue of the virtio-blk driver.
+
+  Read and write requests are split into segments, and each segment is placed
+  in a request slot of its own. As many slots as the virtqueue can hold are in
+  flight at the same time, and the available ring index is published, and the
+  device notified, once per batch of segments.
+
+  Without VIRTIO_F_RING_INDIRECT_DESC, slot N uses the three descriptors
+  starting at N * VBLK_DESC_PER_REQUEST in the descriptor table. With it, slot
+  N uses descriptor N only, which points at the indirect descriptor table of
+  the slot.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/VirtioLib.h>
+
+#include "VirtioBlk.h"
+
+/**
+
+  Set up the request slots of a virtio-blk device, after its virtqueue has
+  been initialized and mapped.
+
+  @param[in out] Dev  The device to set up. Dev->Ring, Dev->IndirectDesc and
+                      Dev->SegmentSize must be valid.
+
+  @retval EFI_SUCCESS           The request slots are set up.
+
+  @retval EFI_OUT_OF_RESOURCES  Memory allocation failed.
+
+  @return                       Error codes from AllocateSharedPages() or
+                                VirtioMapAllBytesInSharedBuffer().
+
+**/
+EFI_STATUS
+VirtioBlkInitSlots (
+  IN OUT VBLK_DEV  *Dev
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       SharedPages;
+  VOID        *Shared;
+  UINT16      Index;
+
+  if (Dev->IndirectDesc) {
+    Dev->SlotCount = Dev->Ring.QueueSize;
+  } else {
+    Dev->SlotCount = (UINT16)(Dev->Ring.QueueSize / VBLK_DESC_PER_REQUEST);
+  }
+
+  Dev->SlotCount = (UINT16)MIN (Dev->SlotCount, VBLK_MAX_REQUEST_SLOTS);
+  ASSERT (Dev->SlotCount > 0);
+
+  Dev->Slot     = AllocateZeroPool (Dev->SlotCount * sizeof *Dev->Slot);
+  Dev->FreeSlot = AllocatePool (Dev->SlotCount * sizeof *Dev->FreeSlot);
+  if ((Dev->Slot == NULL) || (Dev->FreeSlot == NULL)) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto FreeSlots;
+  }
+
+  //
+  // The headers, status bytes and indirect descriptor tables are accessed
+  // equally by the processor and the device, for the lifetime of the device.
+  //
+  SharedPages = EFI_SIZE_TO_PAGES (Dev->SlotCount * sizeof *Dev->Shared);
+  Status      = Dev->VirtIo->AllocateSharedPages (
+                               Dev->VirtIo,
+                               SharedPages,
+                               &Shared
+                               );
+  if (EFI_ERROR (Status)) {
+    goto FreeSlots;
+  }
+
+  ZeroMem (Shared, EFI_PAGES_TO_SIZE (SharedPages));
+
+  Status = VirtioMapAllBytesInSharedBuffer (
+             Dev->VirtIo,
+             VirtioOperationBusMasterCommonBuffer,
+             Shared,
+             EFI_PAGES_TO_SIZE (SharedPages),
+             &Dev->SharedDeviceAddr,
+             &Dev->SharedMap
+             );
+  if (EFI_ERROR (Status)) {
+    goto FreeSharedPages;
+  }
+
+  Dev->Shared = Shared;
+
+  //
+  // Hand out the slots in ascending order.
+  //
+  for (Index = 0; Index < Dev->SlotCount; Index++) {
+    Dev->FreeSlot[Index] = (UINT16)(Dev->SlotCount - 1 - Index);
+  }
+
+  Dev->FreeSlotCount = Dev->SlotCount;
+  Dev->NextAvailIdx  = *Dev->Ring.Avail.Idx;
+  Dev->LastUsedIdx   = *Dev->Ring.Used.Idx;
+  InitializeListHead (&Dev->RequestList);
+  Dev->DeviceError     = FALSE;
+  Dev->AsyncTimerArmed = FALSE;
+
+  //
+  // We're going to poll the answers, the host should not send interrupts.
+  //
+  *Dev->Ring.Avail.Flags = (UINT16)VRING_AVAIL_F_NO_INTERRUPT;
+
+  return EFI_SUCCESS;
+
+FreeSharedPages:
+  Dev->VirtIo->FreeSharedPages (Dev->VirtIo, SharedPages, Shared);
+
+FreeSlots:
+  if (Dev->Slot != NULL) {
+    FreePool (Dev->Slot);
+    Dev->Slot = NULL;
+  }
+
+  if (Dev->FreeSlot != NULL) {
+    FreePool (Dev->FreeSlot);
+    Dev->FreeSlot = NULL;
+  }
+
+  return Status;
+}
+
+/**
+
+  Release the request slots of a virtio-blk device. The device must have been
+  reset, and no request may be queued.
+
+  @param[in out] Dev  The device to clean up.
+
+**/
+VOID
+VirtioBlkUninitSlots (
+  IN OUT VBLK_DEV  *Dev
+  )
+{
+  ASSERT (IsListEmpty (&Dev->RequestList));
+
+  Dev->VirtIo->UnmapSharedBuffer (Dev->VirtIo, Dev->SharedMap);
+  Dev->VirtIo->FreeSharedPages (
+                 Dev->VirtIo,
+                 EFI_SIZE_TO_PAGES (Dev->SlotCount * sizeof *Dev->Shared),
+                 Dev->Shared
+                 );
+  FreePool (Dev->Slot);
+  FreePool (Dev->FreeSlot);
+
+  Dev->Shared        = NULL;
+  Dev->Slot          = NULL;
+  Dev->FreeSlot      = NULL;
+  Dev->SlotCount     = 0;
+  Dev->FreeSlotCount = 0;
+}
+
+/**
+
+  Remove a request whose segments have all completed from the queue, and
+  report its status.
+
+  @param[in out] Dev  The virtio-blk device the request was queued on.
+
+  @param[in]     Req  The request to complete. A request with a token is
+                      freed.
+
+**/
+STATIC
+VOID
+VirtioBlkCompleteRequest (
+  IN OUT VBLK_DEV     *Dev,
+  IN     VBLK_IO_REQ  *Req
+  )
+{
+  ASSERT (Req->InFlight == 0);
+  ASSERT (Req->Remaining == 0);
+
+  RemoveEntryList (&Req->Link);
+
+  if (Req->Token == NULL) {
+    Req->Completed = TRUE;
+    return;
+  }
+
+  Req->Token->TransactionStatus = Req->Status;
+  gBS->SignalEvent (Req->Token->Event);
+  FreePool (Req);
+}
+
+/**
+
+  Place the next segment of a request in a free request slot. The available
+  ring index is not published.
+
+  Must be called at TPL_NOTIFY, with at least one free request slot.
+
+  @param[in out] Dev  The virtio-blk device the request is queued on.
+
+  @param[in out] Req  The request to submit a segment of.
+
+  @retval EFI_SUCCESS       The segment has been placed in a slot.
+
+  @retval EFI_DEVICE_ERROR  The data buffer of the segment could not be
+                            mapped for a bus master operation.
+
+**/
+STATIC
+EFI_STATUS
+VirtioBlkSubmitSegment (
+  IN OUT VBLK_DEV     *Dev,
+  IN OUT VBLK_IO_REQ  *Req
+  )
+{
+  UINT16                SlotIdx;
+  VBLK_SHARED_SLOT      *Shared;
+  EFI_PHYSICAL_ADDRESS  SharedDeviceAddr;
+  UINT32                SegmentSize;
+  EFI_PHYSICAL_ADDRESS  DataDeviceAddr;
+  VOID                  *DataMapping;
+  volatile VRING_DESC   *Desc;
+  UINT16                HeadDescIdx;
+  UINT16                BaseDescIdx;
+  UINT16                NumDesc;
+  EFI_STATUS            Status;
+
+  ASSERT (Dev->FreeSlotCount > 0);
+
+  SlotIdx          = Dev->FreeSlot[Dev->FreeSlotCount - 1];
+  Shared           = &Dev->Shared[SlotIdx];
+  SharedDeviceAddr = Dev->SharedDeviceAddr + SlotIdx * sizeof *Shared;
+
+  //
+  // Dev->SegmentSize is a whole number of blocks, and so is Req->Remaining.
+  //
+  SegmentSize    = (UINT32)MIN (Req->Remaining, Dev->SegmentSize);
+  DataDeviceAddr = 0;
+  DataMapping    = NULL;
+  if (SegmentSize > 0) {
+    Status = VirtioMapAllBytesInSharedBuffer (
+               Dev->VirtIo,
+               (Req->IsWrite ?
+                VirtioOperationBusMasterRead :
+                VirtioOperationBusMasterWrite),
+               Req->Buffer,
+               SegmentSize,
+               &DataDeviceAddr,
+               &DataMapping
+               );
+    if (EFI_ERROR (Status)) {
+      return EFI_DEVICE_ERROR;
+    }
+  }
+
+  //
+  // IO Priority is homogeneously 0. Preset a host status that we do not
+  // accept as success.
+  //
+  Shared->Header.Type = Req->IsFlush ? VIRTIO_BLK_T_FLUSH :
+                        Req->IsWrite ? VIRTIO_BLK_T_OUT :
+                        VIRTIO_BLK_T_IN;
+  Shared->Header.IoPrio = 0;
+  Shared->Header.Sector = MultU64x32 (Req->Lba, Dev->BlockIoMedia.BlockSize / 512);
+  Shared->HostStatus    = VIRTIO_BLK_S_IOERR;
+
+  //
+  // The Next fields of an indirect descriptor table index the table itself.
+  //
+  if (Dev->IndirectDesc) {
+    HeadDescIdx = SlotIdx;
+    BaseDescIdx = 0;
+    Desc        = Shared->Desc;
+  } else {
+    HeadDescIdx = (UINT16)(SlotIdx * VBLK_DESC_PER_REQUEST);
+    BaseDescIdx = HeadDescIdx;
+    Desc        = &Dev->Ring.Desc[HeadDescIdx];
+  }
+
+  //
+  // virtio-blk header in first desc
+  //
+  NumDesc             = 0;
+  Desc[NumDesc].Addr  = SharedDeviceAddr + OFFSET_OF (VBLK_SHARED_SLOT, Header);
+  Desc[NumDesc].Len   = sizeof Shared->Header;
+  Desc[NumDesc].Flags = VRING_DESC_F_NEXT;
+  Desc[NumDesc].Next  = (UINT16)(BaseDescIdx + NumDesc + 1);
+  NumDesc++;
+
+  //
+  // data buffer for read/write in second desc; VRING_DESC_F_WRITE is
+  // interpreted from the host's point of view.
+  //
+  if (SegmentSize > 0) {
+    Desc[NumDesc].Addr  = DataDeviceAddr;
+    Desc[NumDesc].Len   = SegmentSize;
+    Desc[NumDesc].Flags = (UINT16)(VRING_DESC_F_NEXT |
+                                   (Req->IsWrite ? 0 : VRING_DESC_F_WRITE));
+    Desc[NumDesc].Next = (UINT16)(BaseDescIdx + NumDesc + 1);
+    NumDesc++;
+  }
+
+  //
+  // host status in last (second or third) desc
+  //
+  Desc[NumDesc].Addr  = SharedDeviceAddr + OFFSET_OF (VBLK_SHARED_SLOT, HostStatus);
+  Desc[NumDesc].Len   = sizeof Shared->HostStatus;
+  Desc[NumDesc].Flags = VRING_DESC_F_WRITE;
+  Desc[NumDesc].Next  = 0;
+  NumDesc++;
+
+  if (Dev->IndirectDesc) {
+    Dev->Ring.Desc[HeadDescIdx].Addr  = SharedDeviceAddr +
+                                        OFFSET_OF (VBLK_SHARED_SLOT, Desc);
+    Dev->Ring.Desc[HeadDescIdx].Len   = (UINT32)(NumDesc * sizeof (VRING_DESC));
+    Dev->Ring.Desc[HeadDescIdx].Flags = VRING_DESC_F_INDIRECT;
+    Dev->Ring.Desc[HeadDescIdx].Next  = 0;
+  }
+
+  //
+  // virtio-0.9.5, 2.4.1.2 Updating the Available Ring
+  //
+  Dev->Ring.Avail.Ring[Dev->NextAvailIdx++ % Dev->Ring.QueueSize] = HeadDescIdx;
+
+  Dev->FreeSlotCount--;
+  Dev->Slot[SlotIdx].Req         = Req;
+  Dev->Slot[SlotIdx].DataMapping = DataMapping;
+
+  Req->InFlight++;
+  Req->Lba       += SegmentSize / Dev->BlockIoMedia.BlockSize;
+  Req->Buffer    += SegmentSize;
+  Req->Remaining -= SegmentSize;
+
+  return EFI_SUCCESS;
+}
+
+/**
+
+  Submit segments of the queued requests, in queue order, while there are free
+  request slots, then notify the device once.
+
+  A flush request is submitted only when no other request is in flight, and
+  the requests queued after it wait until it completes.
+
+  Must be called at TPL_NOTIFY.
+
+  @param[in out] Dev  The virtio-blk device to submit requests to.
+
+**/
+STATIC
+VOID
+VirtioBlkSubmitRequests (
+  IN OUT VBLK_DEV  *Dev
+  )
+{
+  LIST_ENTRY   *Link;
+  LIST_ENTRY   *NextLink;
+  VBLK_IO_REQ  *Req;
+  UINT16       Submitted;
+  EFI_STATUS   Status;
+
+  Submitted = 0;
+  for (Link = GetFirstNode (&Dev->RequestList);
+       !IsNull (&Dev->RequestList, Link) && (Dev->FreeSlotCount > 0);
+       Link = NextLink)
+  {
+    NextLink = GetNextNode (&Dev->RequestList, Link);
+    Req      = VBLK_IO_REQ_FROM_LINK (Link);
+
+    if (Req->IsFlush) {
+      if ((Req->InFlight > 0) || (Link != GetFirstNode (&Dev->RequestList)) ||
+          (Dev->FreeSlotCount < Dev->SlotCount))
+      {
+        break;
+      }
+
+      Status = VirtioBlkSubmitSegment (Dev, Req);
+      ASSERT_EFI_ERROR (Status);
+      Submitted++;
+      break;
+    }
+
+    while ((Req->Remaining > 0) && (Dev->FreeSlotCount > 0)) {
+      Status = VirtioBlkSubmitSegment (Dev, Req);
+      if (EFI_ERROR (Status)) {
+        //
+        // Let the segments in flight finish, then fail the request.
+        //
+        Req->Status    = Status;
+        Req->Remaining = 0;
+        if (Req->InFlight == 0) {
+          VirtioBlkCompleteRequest (Dev, Req);
+        }
+
+        break;
+      }
+
+      Submitted++;
+    }
+  }
+
+  if (Submitted == 0) {
+    return;
+  }
+
+  //
+  // virtio-0.9.5, 2.4.1.3 Updating the Index Field
+  //
+  MemoryFence ();
+  *Dev->Ring.Avail.Idx = Dev->NextAvailIdx;
+
+  //
+  // virtio-0.9.5, 2.4.1.4 Notifying the Device. virtio-blk's only virtqueue
+  // is #0, called "requestq" (see Appendix D).
+  //
+  MemoryFence ();
+  Status = Dev->VirtIo->SetQueueNotify (Dev->VirtIo, 0);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "%a: SetQueueNotify: %r\n", __FUNCTION__, Status));
+  }
+}
+
+/**
+
+  Stop a virtio-blk device that returned a used ring element that does not
+  match a request slot in flight, and fail all of its requests.
+
+  The device is reset first, so it no longer accesses the request slots or
+  the data buffers, which are then released. Later requests fail at once.
+
+  Must be called at TPL_NOTIFY.
+
+  @param[in out] Dev  The virtio-blk device to stop.
+
+**/
+STATIC
+VOID
+VirtioBlkFailDevice (
+  IN OUT VBLK_DEV  *Dev
+  )
+{
+  UINT16       SlotIdx;
+  VBLK_SLOT    *Slot;
+  LIST_ENTRY   *Link;
+  LIST_ENTRY   *NextLink;
+  VBLK_IO_REQ  *Req;
+
+  Dev->DeviceError = TRUE;
+  Dev->VirtIo->SetDeviceStatus (Dev->VirtIo, 0);
+
+  for (SlotIdx = 0; SlotIdx < Dev->SlotCount; SlotIdx++) {
+    Slot = &Dev->Slot[SlotIdx];
+    if (Slot->Req == NULL) {
+      continue;
+    }
+
+    if (Slot->DataMapping != NULL) {
+      Dev->VirtIo->UnmapSharedBuffer (Dev->VirtIo, Slot->DataMapping);
+    }
+
+    Slot->Req->InFlight--;
+    Slot->Req                           = NULL;
+    Slot->DataMapping                   = NULL;
+    Dev->FreeSlot[Dev->FreeSlotCount++] = SlotIdx;
+  }
+
+  for (Link = GetFirstNode (&Dev->RequestList);
+       !IsNull (&Dev->RequestList, Link);
+       Link = NextLink)
+  {
+    NextLink       = GetNextNode (&Dev->RequestList, Link);
+    Req            = VBLK_IO_REQ_FROM_LINK (Link);
+    Req->Status    = EFI_DEVICE_ERROR;
+    Req->Remaining = 0;
+    ASSERT (Req->InFlight == 0);
+    VirtioBlkCompleteRequest (Dev, Req);
+  }
+}
+
+/**
+
+  Release the request slots that the device has returned in the used ring,
+  and complete the requests whose segments have all completed.
+
+  A used ring element that does not name a request slot in flight fails the
+  device, see VirtioBlkFailDevice().
+
+  Must be called at TPL_NOTIFY.
+
+  @param[in out] Dev  The virtio-blk device to reap.
+
+  @retval TRUE   At least one request slot has been released.
+
+  @retval FALSE  The device has not returned any request slot.
+
+**/
+STATIC
+BOOLEAN
+VirtioBlkReapRequests (
+  IN OUT VBLK_DEV  *Dev
+  )
+{
+  UINT16                          UsedIdx;
+  volatile CONST VRING_USED_ELEM  *UsedElem;
+  UINT32                          DescIdx;
+  UINT32                          DescPerSlot;
+  UINT16                          SlotIdx;
+  VBLK_SLOT                       *Slot;
+  VBLK_IO_REQ                     *Req;
+  EFI_STATUS                      UnmapStatus;
+  BOOLEAN                         Progress;
+
+  //
+  // virtio-0.9.5, 2.4.2 Receiving Used Buffers From the Device
+  //
+  MemoryFence ();
+  UsedIdx = *Dev->Ring.Used.Idx;
+  MemoryFence ();
+
+  if (Dev->DeviceError) {
+    return FALSE;
+  }
+
+  Progress    = FALSE;
+  DescPerSlot = Dev->IndirectDesc ? 1 : VBLK_DESC_PER_REQUEST;
+  while (Dev->LastUsedIdx != UsedIdx) {
+    UsedElem = &Dev->Ring.Used.UsedElem[Dev->LastUsedIdx++ % Dev->Ring.QueueSize];
+    DescIdx  = UsedElem->Id;
+
+    //
+    // The device may only return the head descriptor of a slot in flight.
+    //
+    if ((DescIdx % DescPerSlot != 0) || (DescIdx / DescPerSlot >= Dev->SlotCount) ||
+        (Dev->Slot[DescIdx / DescPerSlot].Req == NULL))
+    {
+      DEBUG ((DEBUG_ERROR, "%a: unexpected used descriptor %u\n", __FUNCTION__, DescIdx));
+      VirtioBlkFailDevice (Dev);
+      return TRUE;
+    }
+
+    SlotIdx = (UINT16)(DescIdx / DescPerSlot);
+    Slot    = &Dev->Slot[SlotIdx];
+    Req     = Slot->Req;
+
+    if (Slot->DataMapping != NULL) {
+      UnmapStatus = Dev->VirtIo->UnmapSharedBuffer (Dev->VirtIo, Slot->DataMapping);
+      if (EFI_ERROR (UnmapStatus) && !Req->IsWrite) {
+        //
+        // Data from the bus master may not reach the caller; fail the request.
+        //
+        Req->Status = EFI_DEVICE_ERROR;
+      }
+    }
+
+    if (Dev->Shared[SlotIdx].HostStatus != VIRTIO_BLK_S_OK) {
+      Req->Status    = EFI_DEVICE_ERROR;
+      Req->Remaining = 0;
+    }
+
+    Slot->Req                           = NULL;
+    Slot->DataMapping                   = NULL;
+    Dev->FreeSlot[Dev->FreeSlotCount++] = SlotIdx;
+    Progress                            = TRUE;
+
+    Req->InFlight--;
+    if ((Req->InFlight == 0) && (Req->Remaining == 0)) {
+      VirtioBlkCompleteRequest (Dev, Req);
+    }
+  }
+
+  return Progress;
+}
+
+/**
+
+  Complete the requests that the device has finished, and submit the queued
+  ones.
+
+  @param[in out] Dev  The virtio-blk device to process.
+
+  @retval TRUE   At least one request slot has been released.
+
+  @retval FALSE  The device has not returned any request slot.
+
+**/
+STATIC
+BOOLEAN
+VirtioBlkProcessRequests (
+  IN OUT VBLK_DEV  *Dev
+  )
+{
+  EFI_TPL  OldTpl;
+  BOOLEAN  Progress;
+
+  OldTpl   = gBS->RaiseTPL (TPL_NOTIFY);
+  Progress = VirtioBlkReapRequests (Dev);
+  VirtioBlkSubmitRequests (Dev);
+
+  //
+  // Stop the timer of the Block I/O 2 requests until a request is queued.
+  //
+  if (Dev->AsyncTimerArmed && IsListEmpty (&Dev->RequestList)) {
+    gBS->SetTimer (Dev->AsyncTimer, TimerCancel, 0);
+    Dev->AsyncTimerArmed = FALSE;
+  }
+
+  gBS->RestoreTPL (OldTpl);
+
+  return Progress;
+}
+
+/**
+
+  Poll a virtio-blk device until no request is queued on it, or until a
+  blocking request has completed.
+
+  @param[in out] Dev  The virtio-blk device to poll.
+
+  @param[in]     Req  The blocking request to wait for, or NULL to wait for
+                      all requests.
+
+**/
+STATIC
+VOID
+VirtioBlkWaitRequests (
+  IN OUT VBLK_DEV     *Dev,
+  IN     VBLK_IO_REQ  *Req OPTIONAL
+  )
+{
+  UINTN  PollPeriodUsecs;
+
+  //
+  // Keep slowing down until we reach a poll period of slightly above 1 ms, and
+  // speed up again whenever a segment completes.
+  //
+  PollPeriodUsecs = 1;
+  while ((Req != NULL) ? !Req->Completed : !IsListEmpty (&Dev->RequestList)) {
+    gBS->Stall (PollPeriodUsecs);
+
+    if (VirtioBlkProcessRequests (Dev)) {
+      PollPeriodUsecs = 1;
+    } else if (PollPeriodUsecs < 1024) {
+      PollPeriodUsecs *= 2;
+    }
+  }
+}
+
+/**
+
+  Queue a read, write or flush request on a virtio-blk device, and submit as
+  much of it as the free request slots allow.
+
+  The request parameters must have been verified by the caller, see
+  SynchronousRequest() in VirtioBlk.c.
+
+  @param[in] Dev             The virtio-blk device the request is targeted at.
+
+  @param[in] Token           The token to signal when the request completes.
+                             If NULL, or if Token->Event is NULL, the function
+                             waits for the request to complete.
+
+  @param[in] Lba             Logical Block Address of the transfer; zero for a
+                             flush.
+
+  @param[in] BufferSize      Size of the transfer, in bytes. Zero for a flush,
+                             positive otherwise.
+
+  @param[in out] Buffer      The guest side area of the transfer.
+
+  @param[in] RequestIsWrite  TRUE iff data transfer goes from guest to device.
+                             TRUE for a flush.
+
+  @retval EFI_SUCCESS           The request completed successfully, or it has
+                                been queued for Token.
+
+  @retval EFI_OUT_OF_RESOURCES  The request could not be queued.
+
+  @retval EFI_DEVICE_ERROR      The request failed, or the device has failed.
+
+**/
+EFI_STATUS
+VirtioBlkQueueRequest (
+  IN     VBLK_DEV             *Dev,
+  IN     EFI_BLOCK_IO2_TOKEN  *Token OPTIONAL,
+  IN     EFI_LBA              Lba,
+  IN     UINTN                BufferSize,
+  IN OUT VOID                 *Buffer,
+  IN     BOOLEAN              RequestIsWrite
+  )
+{
+  VBLK_IO_REQ  BlockingReq;
+  VBLK_IO_REQ  *Req;
+  EFI_TPL      OldTpl;
+
+  ASSERT (BufferSize % Dev->BlockIoMedia.BlockSize == 0);
+
+  if (Dev->DeviceError) {
+    return EFI_DEVICE_ERROR;
+  }
+
+  if ((Token != NULL) && (Token->Event == NULL)) {
+    Token = NULL;
+  }
+
+  if (Token == NULL) {
+    Req = &BlockingReq;
+  } else {
+    Req = AllocatePool (sizeof *Req);
+    if (Req == NULL) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+  }
+
+  Req->Signature = VBLK_IO_REQ_SIG;
+  Req->Token     = Token;
+  Req->Lba       = Lba;
+  Req->Buffer    = Buffer;
+  Req->Remaining = BufferSize;
+  Req->InFlight  = 0;
+  Req->IsWrite   = RequestIsWrite;
+  Req->IsFlush   = (BOOLEAN)(RequestIsWrite && (BufferSize == 0));
+  Req->Completed = FALSE;
+  Req->Status    = EFI_SUCCESS;
+
+  OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+  InsertTailList (&Dev->RequestList, &Req->Link);
+  VirtioBlkSubmitRequests (Dev);
+
+  //
+  // Nothing but the timer completes a Block I/O 2 request.
+  //
+  if ((Token != NULL) && !Dev->AsyncTimerArmed) {
+    gBS->SetTimer (Dev->AsyncTimer, TimerPeriodic, VBLK_ASYNC_TIMER);
+    Dev->AsyncTimerArmed = TRUE;
+  }
+
+  gBS->RestoreTPL (OldTpl);
+
+  if (Token != NULL) {
+    return EFI_SUCCESS;
+  }
+
+  VirtioBlkWaitRequests (Dev, Req);
+  return Req->Status;
+}
+
+/**
+
+  Timer notification function that completes the requests of a virtio-blk
+  device and submits the queued ones.
+
+  @param[in] Event    Event whose notification function is being invoked.
+
+  @param[in] Context  Pointer to the VBLK_DEV structure.
+
+**/
+VOID
+EFIAPI
+VirtioBlkAsyncTimer (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  VirtioBlkProcessRequests (Context);
+}
+
+/**
+
+  Abort the queued Block I/O 2 requests of a virtio-blk device, and wait for
+  the requests already submitted to the device.
+
+  @param[in out] Dev  The device whose requests to abort.
+
+**/
+VOID
+VirtioBlkAbortRequests (
+  IN OUT VBLK_DEV  *Dev
+  )
+{
+  LIST_ENTRY   *Link;
+  LIST_ENTRY   *NextLink;
+  VBLK_IO_REQ  *Req;
+  EFI_TPL      OldTpl;
+
+  OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+  for (Link = GetFirstNode (&Dev->RequestList);
+       !IsNull (&Dev->RequestList, Link);
+       Link = NextLink)
+  {
+    NextLink = GetNextNode (&Dev->RequestList, Link);
+    Req      = VBLK_IO_REQ_FROM_LINK (Link);
+    if (Req->Token == NULL) {
+      continue;
+    }
+
+    Req->Remaining = 0;
+    if (!EFI_ERROR (Req->Status)) {
+      Req->Status = EFI_ABORTED;
+    }
+
+    if (Req->InFlight == 0) {
+      VirtioBlkCompleteRequest (Dev, Req);
+    }
+  }
+
+  gBS->RestoreTPL (OldTpl);
+
+  VirtioBlkWaitRequests (Dev, NULL);
+}